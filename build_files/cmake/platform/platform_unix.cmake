@@ -449,6 +449,14 @@ if(WITH_XR_OPENXR)
   endif()
 endif()
 
+if(WITH_ZSTD)
+  find_package_wrapper(Zstd)
+  if(NOT ZSTD_FOUND)
+    message(WARNING "Zstd not found, disabling WITH_ZSTD")
+    set(WITH_ZSTD OFF)
+  endif()
+endif()
+
 if(WITH_GMP)
   find_package_wrapper(GMP)
   if(NOT GMP_FOUND)
@@ -773,6 +773,12 @@ if(WITH_XR_OPENXR)
   endif()
 endif()
 
+if(WITH_ZSTD)
+  set(ZSTD_INCLUDE_DIRS ${LIBDIR}/zstd/include)
+  set(ZSTD_LIBRARIES ${LIBDIR}/zstd/lib/zstd_static.lib)
+  set(ZSTD_FOUND On)
+endif()
+
 if(WITH_GMP)
   set(GMP_INCLUDE_DIRS ${LIBDIR}/gmp/include)
   set(GMP_LIBRARIES ${LIBDIR}/gmp/lib/libgmp-10.lib optimized ${LIBDIR}/gmp/lib/libgmpxx.lib debug ${LIBDIR}/gmp/lib/libgmpxx_d.lib)
@@ -74,6 +74,13 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /**
+   * Share the data of the source layers, which are freed by their last user. The new layers are
+   * read-only like #CD_REFERENCE ones and have to be made mutable with
+   * #CustomData_duplicate_referenced_layer first, which only copies data that is still shared.
+   * Same restriction on the number of elements as #CD_DUPLICATE.
+   */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -218,8 +225,8 @@ bool CustomData_has_layer(const struct CustomData *data, int type);
 int CustomData_number_of_layers(const struct CustomData *data, int type);
 int CustomData_number_of_layers_typemask(const struct CustomData *data, CustomDataMask mask);
 
-/* duplicate data of a layer with flag NOFREE, and remove that flag.
- * returns the layer data */
+/* duplicate data of a layer with flag NOFREE or which is shared with other layers
+ * (see #CD_SHARE), and remove that flag. returns the layer data */
 void *CustomData_duplicate_referenced_layer(struct CustomData *data,
                                             const int type,
                                             const int totelem);
@@ -232,6 +239,9 @@ void *CustomData_duplicate_referenced_layer_named(struct CustomData *data,
                                                   const char *name,
                                                   const int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
+/* same as #CustomData_duplicate_referenced_layer for all layers, before writing to them
+ * in-place */
+void CustomData_duplicate_referenced_layers(struct CustomData *data, const int totelem);
 
 /* set the CD_FLAG_NOCOPY flag in custom data layers where the mask is
  * zero for the layer type, so only layer types specified by the mask
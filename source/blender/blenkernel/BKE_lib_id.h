@@ -115,7 +115,12 @@ enum {
   LIB_ID_COPY_CACHES = 1 << 18,
   /** Don't copy id->adt, used by ID datablock localization routines. */
   LIB_ID_COPY_NO_ANIMDATA = 1 << 19,
-  /** Mesh: Reference CD data layers instead of doing real copy - USE WITH CAUTION! */
+  /**
+   * Mesh, hair & point-cloud: Share CD data layers with the source instead of doing real copy,
+   * they have to be made mutable with #CustomData_duplicate_referenced_layer before writing.
+   * Writes to the source layers aren't detected, code writing to them in-place has to make them
+   * mutable too (e.g. #BKE_mesh_duplicate_referenced_layers) - USE WITH CAUTION!
+   */
   LIB_ID_COPY_CD_REFERENCE = 1 << 20,
 
   /* *** XXX Hackish/not-so-nice specific behaviors needed for some corner cases. *** */
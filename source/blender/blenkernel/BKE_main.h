@@ -69,8 +69,8 @@ typedef struct MainIDRelationsEntry {
 } MainIDRelationsEntry;
 
 typedef struct MainIDRelations {
-  struct GHash *id_user_to_used;
-  struct GHash *id_used_to_user;
+  struct OHash *id_user_to_used;
+  struct OHash *id_used_to_user;
 
   short flag;
 
@@ -0,0 +1,102 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Caching of the results of mesh modifiers which have #eModifierFlag_CacheResult set,
+ * so the modifier stack evaluation can resume after them when only later modifiers changed.
+ *
+ * Results are stored in the run-time data of the evaluated object, keyed on a hash of all data
+ * the evaluation up to that modifier depends on: the input mesh and the settings of the
+ * modifiers before it. Modifiers depending on anything else (time, other data-blocks, data they
+ * point to) can't be hashed, neither their results nor the ones of the modifiers after them are
+ * cached.
+ */
+
+#include "BLI_sys_types.h"
+
+#include "DNA_customdata_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Mesh;
+struct ModifierData;
+struct ModifierStackCache;
+struct Object;
+struct Scene;
+
+typedef struct ModifierCacheKey {
+  uint32_t hash[2];
+  /** False once a modifier which can't be cached was added. */
+  bool is_valid;
+} ModifierCacheKey;
+
+/** State of the modifier stack evaluation after a modifier. */
+typedef struct ModifierCacheState {
+  struct Mesh *mesh;
+  struct Mesh *mesh_orco;
+  struct Mesh *mesh_orco_cloth;
+  CustomData_MeshMasks append_mask;
+  bool have_non_onlydeform_modifiers_applied;
+} ModifierCacheState;
+
+/** Statistics of the caches of all objects. */
+typedef struct ModifierCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  /** Evaluations which reused the hash of their unchanged input mesh. */
+  uint64_t input_reuses;
+  size_t memory_used;
+  size_t memory_limit;
+} ModifierCacheStats;
+
+void BKE_modifier_cache_key_init(ModifierCacheKey *r_key,
+                                 const struct Scene *scene,
+                                 struct Object *ob,
+                                 struct Mesh *mesh,
+                                 const float (*vert_coords)[3],
+                                 const bool use_render,
+                                 const bool need_mapping,
+                                 const CustomData_MeshMasks *final_mask);
+void BKE_modifier_cache_key_add(ModifierCacheKey *key,
+                                const struct ModifierData *md,
+                                const CustomData_MeshMasks *mask);
+
+bool BKE_modifier_cache_lookup(struct Object *ob,
+                               const struct ModifierData *md,
+                               const ModifierCacheKey *key,
+                               ModifierCacheState *r_state);
+void BKE_modifier_cache_store(struct Object *ob,
+                              const struct ModifierData *md,
+                              const ModifierCacheKey *key,
+                              const ModifierCacheState *state);
+void BKE_modifier_cache_remove_unused(struct Object *ob);
+
+void BKE_modifier_cache_state_free(ModifierCacheState *state);
+void BKE_modifier_cache_free(struct ModifierStackCache *cache);
+
+void BKE_modifier_cache_memory_limit_set(const size_t limit);
+void BKE_modifier_cache_stats_get(ModifierCacheStats *r_stats);
+void BKE_modifier_cache_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
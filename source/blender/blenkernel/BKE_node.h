@@ -1250,6 +1250,7 @@ void ntreeCompositRegisterPass(struct bNodeTree *ntree,
                                const char *name,
                                eNodeSocketDatatype type);
 void ntreeCompositClearTags(struct bNodeTree *ntree);
+void ntreeCompositClearCaches(void);
 
 struct bNodeSocket *ntreeCompositOutputFileAddSocket(struct bNodeTree *ntree,
                                                      struct bNode *node,
@@ -115,6 +115,12 @@ int BKE_packedfile_seek(struct PackedFile *pf, int offset, int whence);
 void BKE_packedfile_rewind(struct PackedFile *pf);
 int BKE_packedfile_read(struct PackedFile *pf, void *data, int size);
 
+/* Load data which wasn't read when opening the file (see #BLO_READ_LAZY_PACKED_DATA),
+ * must be called before accessing #PackedFile.data, returns false when it can't be read. */
+bool BKE_packedfile_data_ensure(struct PackedFile *pf);
+/* Load the data of all packed files in \a bmain, reporting the ones which can't be read. */
+bool BKE_packedfile_data_ensure_all(struct Main *bmain, struct ReportList *reports);
+
 /* ID should be not NULL, return 1 if there's a packed file */
 bool BKE_packedfile_id_check(struct ID *id);
 /* ID should be not NULL, throws error when ID is Library */
@@ -0,0 +1,62 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Evaluation of the frames following the current one during animation playback, on separate
+ * dependency graphs in background threads (see #SCE_PLAYBACK_PREFETCH).
+ *
+ * The evaluated meshes of these frames are kept until playback reaches them, the active
+ * dependency graph then uses them instead of evaluating the modifier stacks itself.
+ * Any change to the original data discards them and stops the background evaluation,
+ * it's started again once playback went on for a few steps without changes.
+ */
+
+#include "BLI_sys_types.h"
+
+#include "DNA_customdata_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Depsgraph;
+struct Main;
+struct Mesh;
+struct Object;
+struct Scene;
+struct ViewLayer;
+
+void BKE_playback_prefetch_update(struct Main *bmain,
+                                  struct Scene *scene,
+                                  struct ViewLayer *view_layer,
+                                  const bool reverse);
+void BKE_playback_prefetch_stop(struct Scene *scene);
+bool BKE_playback_prefetch_is_running(const struct Scene *scene);
+void BKE_playback_prefetch_tag_update(struct Main *bmain, const int recalc);
+
+bool BKE_playback_prefetch_mesh_get(struct Depsgraph *depsgraph,
+                                    struct Object *ob,
+                                    const CustomData_MeshMasks *data_mask,
+                                    const bool need_mapping,
+                                    struct Mesh **r_mesh_eval,
+                                    struct Mesh **r_mesh_deform_eval);
+
+#ifdef __cplusplus
+}
+#endif
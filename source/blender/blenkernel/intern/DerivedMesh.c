@@ -59,10 +59,12 @@
 #include "BKE_mesh_tangent.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
+#include "BKE_modifier_cache.h"
 #include "BKE_multires.h"
 #include "BKE_object.h"
 #include "BKE_object_deform.h"
 #include "BKE_paint.h"
+#include "BKE_playback_prefetch.h"
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
@@ -869,6 +871,102 @@ void BKE_mesh_wrapper_deferred_finalize(Mesh *me_eval,
   BLI_assert(me_eval->runtime.wrapper_type_finalize == 0);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Modifier Result Cache
+ *
+ * Results of modifiers with #eModifierFlag_CacheResult are kept with the evaluated object,
+ * so the evaluation can resume after the last one when only later modifiers changed.
+ * \{ */
+
+/** A modifier which will be applied by #mesh_calc_modifiers, with the key of its result. */
+typedef struct ModifierCacheStep {
+  ModifierData *md;
+  CDMaskLink *md_datamask;
+  ModifierCacheKey key;
+} ModifierCacheStep;
+
+/**
+ * Compute the keys of the results of the modifiers from \a md on, skipping the same modifiers as
+ * #mesh_calc_modifiers (without sculpt mode, which doesn't use the cache).
+ * Returns NULL when none of them has its result cached.
+ */
+static ModifierCacheStep *mesh_calc_modifiers_cache_steps(Scene *scene,
+                                                          Object *ob,
+                                                          Mesh *mesh_input,
+                                                          const float (*deformed_verts)[3],
+                                                          ModifierData *md,
+                                                          CDMaskLink *md_datamask,
+                                                          const bool use_render,
+                                                          const bool need_mapping,
+                                                          const CustomData_MeshMasks *final_mask,
+                                                          int *r_steps_len)
+{
+  const int required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
+  bool use_cache = false;
+  int steps_len = 0;
+  for (ModifierData *md_iter = md; md_iter; md_iter = md_iter->next) {
+    use_cache |= (md_iter->flag & eModifierFlag_CacheResult) != 0;
+    steps_len++;
+  }
+  if (!use_cache) {
+    return NULL;
+  }
+
+  ModifierCacheStep *steps = MEM_malloc_arrayN((size_t)steps_len, sizeof(*steps), __func__);
+  ModifierCacheKey key;
+  BKE_modifier_cache_key_init(
+      &key, scene, ob, mesh_input, deformed_verts, use_render, need_mapping, final_mask);
+
+  bool have_non_onlydeform_modifiers_applied = false;
+  steps_len = 0;
+  for (; md; md = md->next, md_datamask = md_datamask->next) {
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+    if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
+      continue;
+    }
+    if ((mti->flags & eModifierTypeFlag_RequiresOriginalData) &&
+        have_non_onlydeform_modifiers_applied) {
+      continue;
+    }
+    if (need_mapping && !BKE_modifier_supports_mapping(md)) {
+      continue;
+    }
+    if (mti->type != eModifierTypeType_OnlyDeform) {
+      have_non_onlydeform_modifiers_applied = true;
+    }
+
+    BKE_modifier_cache_key_add(&key, md, &md_datamask->mask);
+
+    ModifierCacheStep *step = &steps[steps_len++];
+    step->md = md;
+    step->md_datamask = md_datamask;
+    step->key = key;
+  }
+
+  *r_steps_len = steps_len;
+  return steps;
+}
+
+/**
+ * Errors are only set while evaluating, results of modifier stacks with errors aren't cached
+ * so that the errors are still reported when they're used.
+ */
+static bool mesh_calc_modifiers_have_errors(ModifierData *md_first, ModifierData *md_last)
+{
+  for (ModifierData *md = md_first; md; md = md->next) {
+    if (md->error) {
+      return true;
+    }
+    if (md == md_last) {
+      break;
+    }
+  }
+  return false;
+}
+
+/** \} */
+
 static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
                                 Scene *scene,
                                 Object *ob,
@@ -1008,6 +1106,49 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
 
   /* Apply all remaining constructive and deforming modifiers. */
   bool have_non_onlydeform_modifiers_appled = false;
+
+  /* Resume after the last modifier with a cached result for the current input. */
+  ModifierCacheStep *cache_steps = NULL;
+  int cache_steps_len = 0;
+  int cache_step_index = 0;
+  if (use_cache && index == -1 && useDeform > 0 && !sculpt_mode && md) {
+    cache_steps = mesh_calc_modifiers_cache_steps(scene,
+                                                  ob,
+                                                  mesh_input,
+                                                  (const float(*)[3])deformed_verts,
+                                                  md,
+                                                  md_datamask,
+                                                  use_render,
+                                                  need_mapping,
+                                                  &final_datamask,
+                                                  &cache_steps_len);
+  }
+  for (int i = cache_steps_len - 1; i >= 0; i--) {
+    ModifierCacheStep *step = &cache_steps[i];
+    ModifierCacheState state;
+    if ((step->md->flag & eModifierFlag_CacheResult) &&
+        BKE_modifier_cache_lookup(ob, step->md, &step->key, &state)) {
+      if (mesh_final) {
+        BKE_id_free(NULL, mesh_final);
+      }
+      if (deformed_verts) {
+        MEM_freeN(deformed_verts);
+        deformed_verts = NULL;
+      }
+      mesh_final = state.mesh;
+      mesh_orco = state.mesh_orco;
+      mesh_orco_cloth = state.mesh_orco_cloth;
+      append_mask = state.append_mask;
+      have_non_onlydeform_modifiers_appled = state.have_non_onlydeform_modifiers_applied;
+      isPrevDeform = false;
+
+      md = step->md->next;
+      md_datamask = step->md_datamask->next;
+      cache_step_index = i + 1;
+      break;
+    }
+  }
+
   for (; md; md = md->next, md_datamask = md_datamask->next) {
     const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
 
@@ -1267,6 +1408,32 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
 
     isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
 
+    if (cache_steps && (md->flag & eModifierFlag_CacheResult)) {
+      while (cache_step_index < cache_steps_len && cache_steps[cache_step_index].md != md) {
+        cache_step_index++;
+      }
+      if (cache_step_index < cache_steps_len &&
+          !mesh_calc_modifiers_have_errors(firstmd, md)) {
+        /* Pending deformations are only applied to a copy, to keep evaluating the same way. */
+        Mesh *mesh_deformed = NULL;
+        if (deformed_verts) {
+          mesh_deformed = BKE_mesh_copy_for_eval(mesh_final ? mesh_final : mesh_input, true);
+          BKE_mesh_vert_coords_apply(mesh_deformed, deformed_verts);
+        }
+        const ModifierCacheState state = {
+            .mesh = mesh_deformed ? mesh_deformed : mesh_final,
+            .mesh_orco = mesh_orco,
+            .mesh_orco_cloth = mesh_orco_cloth,
+            .append_mask = append_mask,
+            .have_non_onlydeform_modifiers_applied = have_non_onlydeform_modifiers_appled,
+        };
+        BKE_modifier_cache_store(ob, md, &cache_steps[cache_step_index].key, &state);
+        if (mesh_deformed) {
+          BKE_id_free(NULL, mesh_deformed);
+        }
+      }
+    }
+
     /* grab modifiers until index i */
     if ((index != -1) && (BLI_findindex(&ob->modifiers, md) >= index)) {
       break;
@@ -1279,6 +1446,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
 
   BLI_linklist_free((LinkNode *)datamasks, NULL);
 
+  if (cache_steps) {
+    MEM_freeN(cache_steps);
+  }
+  BKE_modifier_cache_remove_unused(ob);
+
   for (md = firstmd; md; md = md->next) {
     BKE_modifier_free_temporary_data(md);
   }
@@ -1785,17 +1957,21 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
 #endif
 
   Mesh *mesh_eval = NULL, *mesh_deform_eval = NULL;
-  mesh_calc_modifiers(depsgraph,
-                      scene,
-                      ob,
-                      1,
-                      need_mapping,
-                      dataMask,
-                      -1,
-                      true,
-                      true,
-                      &mesh_deform_eval,
-                      &mesh_eval);
+  /* Use the result of evaluating this frame ahead during playback if possible. */
+  if (!BKE_playback_prefetch_mesh_get(
+          depsgraph, ob, dataMask, need_mapping, &mesh_eval, &mesh_deform_eval)) {
+    mesh_calc_modifiers(depsgraph,
+                        scene,
+                        ob,
+                        1,
+                        need_mapping,
+                        dataMask,
+                        -1,
+                        true,
+                        true,
+                        &mesh_deform_eval,
+                        &mesh_eval);
+  }
 
   /* The modifier stack evaluation is storing result in mesh->runtime.mesh_eval, but this result
    * is not guaranteed to be owned by object.
@@ -129,6 +129,13 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
     }
     /* success = */ /* UNUSED */ BLO_write_file_mem(bmain, prevfile, &mfu->memfile, G.fileflags);
     mfu->undo_size = mfu->memfile.size;
+    mfu->undo_size_shared = mfu->memfile.size_shared;
+
+    if (G.debug & G_DEBUG_IO) {
+      printf("Undo step: %zu bytes unique, %zu bytes shared with other steps\n",
+             mfu->undo_size,
+             mfu->undo_size_shared);
+    }
   }
 
   bmain->is_memfile_undo_written = true;
@@ -61,6 +61,8 @@
 
 #include "CLG_log.h"
 
+#include "atomic_ops.h"
+
 /* only for customdata_data_transfer_interp_normal_normals */
 #include "data_transfer_intern.h"
 
@@ -2073,6 +2075,141 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 }
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name Layer Data Sharing
+ *
+ * Layers copied with #CD_SHARE use the data array of their source layer instead of a copy,
+ * all the layers using the same array point to a #CustomDataSharingInfo counting them,
+ * so that the array is freed by its last user.
+ *
+ * The copies are flagged with #CD_FLAG_NOFREE, so code which is careful about referenced
+ * layers (calling #CustomData_duplicate_referenced_layer before writing) works as-is and only
+ * copies data that is actually modified. The source layer stays writable, just like with
+ * #CD_REFERENCE, except for operations which would free or move the array.
+ * \{ */
+
+typedef struct CustomDataSharingInfo {
+  /** Number of layers using the data, including the one it was first shared from. */
+  int32_t users;
+} CustomDataSharingInfo;
+
+static bool customData_layer_can_share(const CustomDataLayer *layer)
+{
+  /* Referenced data isn't ours to share, external data is freed & reloaded in place. */
+  if (layer->data == NULL || (layer->flag & CD_FLAG_EXTERNAL)) {
+    return false;
+  }
+  return (layer->sharing_info != NULL) || !(layer->flag & CD_FLAG_NOFREE);
+}
+
+/**
+ * Add a user to the data of \a layer.
+ *
+ * \note The same source data may be copied by multiple threads at once
+ * (copy-on-write of an original mesh used by multiple dependency graphs).
+ */
+static CustomDataSharingInfo *customData_layer_share(CustomDataLayer *layer)
+{
+  CustomDataSharingInfo *sharing_info = layer->sharing_info;
+  if (sharing_info == NULL) {
+    CustomDataSharingInfo *sharing_info_new = MEM_mallocN(sizeof(*sharing_info_new), __func__);
+    sharing_info_new->users = 1;
+    sharing_info = atomic_cas_ptr((void **)&layer->sharing_info, NULL, sharing_info_new);
+    if (sharing_info == NULL) {
+      sharing_info = sharing_info_new;
+    }
+    else {
+      MEM_freeN(sharing_info_new);
+    }
+  }
+  atomic_add_and_fetch_int32(&sharing_info->users, 1);
+  return sharing_info;
+}
+
+static bool customData_layer_is_shared(CustomDataLayer *layer)
+{
+  return (layer->sharing_info != NULL) &&
+         (atomic_add_and_fetch_int32(&layer->sharing_info->users, 0) > 1);
+}
+
+/**
+ * Remove \a layer from the users of its data.
+ * \return True when it was the last user, the layer then owns the data.
+ */
+static bool customData_layer_sharing_release(CustomDataLayer *layer)
+{
+  CustomDataSharingInfo *sharing_info = layer->sharing_info;
+  layer->sharing_info = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing_info->users, 1) == 0) {
+    MEM_freeN(sharing_info);
+    return true;
+  }
+  return false;
+}
+
+static void *customData_layer_data_duplicate(const CustomDataLayer *layer, const int totelem)
+{
+  /* MEM_dupallocN won't work in case of complex layers, like e.g.
+   * CD_MDEFORMVERT, which has pointers to allocated data...
+   * So in case a custom copy function is defined, use it!
+   */
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+
+  if (typeInfo->copy) {
+    void *dst_data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD duplicate ref layer");
+    typeInfo->copy(layer->data, dst_data, totelem);
+    return dst_data;
+  }
+  return MEM_dupallocN(layer->data);
+}
+
+static void customData_layer_data_free(const int type, void *data, const int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->free) {
+    typeInfo->free(data, totelem, typeInfo->size);
+  }
+
+  MEM_freeN(data);
+}
+
+/**
+ * Make \a layer the only user of its data, copying the data when it's still used elsewhere.
+ */
+static void customData_layer_ensure_unshared(CustomDataLayer *layer, const int totelem)
+{
+  if (layer->sharing_info == NULL) {
+    return;
+  }
+
+  if (customData_layer_is_shared(layer)) {
+    void *data_shared = layer->data;
+    layer->data = customData_layer_data_duplicate(layer, totelem);
+    if (customData_layer_sharing_release(layer)) {
+      /* Other users were freed in the meantime. */
+      customData_layer_data_free(layer->type, data_shared, totelem);
+    }
+  }
+  else {
+    customData_layer_sharing_release(layer);
+  }
+
+  layer->flag &= ~CD_FLAG_NOFREE;
+}
+
+/**
+ * Number of elements allocated for the data of \a layer,
+ * for the few operations on shared layers which aren't passed the number of elements.
+ */
+static int customData_layer_data_len(const CustomDataLayer *layer)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+  return (typeInfo->size > 0) ? (int)(MEM_allocN_len(layer->data) / (size_t)typeInfo->size) : 0;
+}
+
+/** \} */
+
 bool CustomData_merge(const struct CustomData *source,
                       struct CustomData *dest,
                       CustomDataMask mask,
@@ -2120,10 +2257,17 @@ bool CustomData_merge(const struct CustomData *source,
       continue;
     }
 
-    switch (alloctype) {
+    eCDAllocType layer_alloctype = alloctype;
+    if ((alloctype == CD_SHARE) || (alloctype == CD_ASSIGN && layer->sharing_info)) {
+      /* Data which is shared already can't be assigned, add a user instead. */
+      layer_alloctype = customData_layer_can_share(layer) ? CD_SHARE : CD_DUPLICATE;
+    }
+
+    switch (layer_alloctype) {
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -2131,12 +2275,20 @@ bool CustomData_merge(const struct CustomData *source,
         break;
     }
 
-    if ((alloctype == CD_ASSIGN) && (flag & CD_FLAG_NOFREE)) {
+    if ((layer_alloctype == CD_ASSIGN) && (flag & CD_FLAG_NOFREE)) {
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if (layer_alloctype == CD_SHARE) {
+      newlayer = customData_add_layer__internal(
+          dest, type, CD_REFERENCE, data, totelem, layer->name);
+      if (newlayer && newlayer->data == data && newlayer->sharing_info == NULL) {
+        newlayer->sharing_info = customData_layer_share(layer);
+      }
+    }
     else {
-      newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
+      newlayer = customData_add_layer__internal(
+          dest, type, layer_alloctype, data, totelem, layer->name);
     }
 
     if (newlayer) {
@@ -2164,6 +2316,10 @@ void CustomData_realloc(CustomData *data, int totelem)
     if (layer->flag & CD_FLAG_NOFREE) {
       continue;
     }
+    if (layer->sharing_info) {
+      /* Don't move data which other layers still use. */
+      customData_layer_ensure_unshared(layer, customData_layer_data_len(layer));
+    }
     typeInfo = layerType_getInfo(layer->type);
     layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
   }
@@ -2186,18 +2342,18 @@ void CustomData_copy(const struct CustomData *source,
 
 static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
-  const LayerTypeInfo *typeInfo;
-
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
-    typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->free) {
-      typeInfo->free(layer->data, totelem, typeInfo->size);
+  if (layer->sharing_info) {
+    /* Shared data is freed by its last user. */
+    if (!customData_layer_sharing_release(layer)) {
+      return;
     }
+  }
+  else if (layer->flag & CD_FLAG_NOFREE) {
+    return;
+  }
 
-    if (layer->data) {
-      MEM_freeN(layer->data);
-    }
+  if (layer->data) {
+    customData_layer_data_free(layer->type, layer->data, totelem);
   }
 }
 
@@ -2504,6 +2660,8 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
    * most likely a bug */
   BLI_assert(!layerdata || (alloctype == CD_ASSIGN) || (alloctype == CD_DUPLICATE) ||
              (alloctype == CD_REFERENCE));
+  /* Sharing needs the source layer, see #CustomData_merge. */
+  BLI_assert(alloctype != CD_SHARE);
 
   if (!typeInfo->defaultname && CustomData_has_layer(data, type)) {
     return &data->layers[CustomData_get_layer_index(data, type)];
@@ -2563,6 +2721,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  data->layers[index].sharing_info = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2744,23 +2903,11 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
 
   CustomDataLayer *layer = &data->layers[layer_index];
 
-  if (layer->flag & CD_FLAG_NOFREE) {
-    /* MEM_dupallocN won't work in case of complex layers, like e.g.
-     * CD_MDEFORMVERT, which has pointers to allocated data...
-     * So in case a custom copy function is defined, use it!
-     */
-    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->copy) {
-      void *dst_data = MEM_malloc_arrayN(
-          (size_t)totelem, typeInfo->size, "CD duplicate ref layer");
-      typeInfo->copy(layer->data, dst_data, totelem);
-      layer->data = dst_data;
-    }
-    else {
-      layer->data = MEM_dupallocN(layer->data);
-    }
-
+  if (layer->sharing_info) {
+    customData_layer_ensure_unshared(layer, totelem);
+  }
+  else if (layer->flag & CD_FLAG_NOFREE) {
+    layer->data = customData_layer_data_duplicate(layer, totelem);
     layer->flag &= ~CD_FLAG_NOFREE;
   }
 
@@ -2797,6 +2944,13 @@ void *CustomData_duplicate_referenced_layer_named(CustomData *data,
   return customData_duplicate_referenced_layer_index(data, layer_index, totelem);
 }
 
+void CustomData_duplicate_referenced_layers(CustomData *data, const int totelem)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    customData_duplicate_referenced_layer_index(data, i, totelem);
+  }
+}
+
 bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 {
   /* get the layer index of the first layer of type */
@@ -2984,6 +3138,11 @@ void CustomData_free_elem(CustomData *data, int index, int count)
       const LayerTypeInfo *typeInfo = layerType_getInfo(data->layers[i].type);
 
       if (typeInfo->free) {
+        if (data->layers[i].sharing_info) {
+          /* Other users of the data keep the freed elements. */
+          customData_layer_ensure_unshared(&data->layers[i],
+                                           customData_layer_data_len(&data->layers[i]));
+        }
         size_t offset = (size_t)index * typeInfo->size;
 
         typeInfo->free(POINTER_OFFSET(data->layers[i].data, offset), count, typeInfo->size);
@@ -3243,6 +3402,16 @@ const char *CustomData_get_layer_name(const CustomData *data, int type, int n)
   return (layer_index == -1) ? NULL : data->layers[layer_index].name;
 }
 
+static void customData_layer_set_data(CustomDataLayer *layer, void *ptr)
+{
+  if (layer->sharing_info) {
+    /* Like for referenced layers the caller is responsible for the previous data,
+     * which must only be freed when it's not shared. */
+    customData_layer_sharing_release(layer);
+  }
+  layer->data = ptr;
+}
+
 void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
 {
   /* get the layer index of the first layer of type */
@@ -3252,7 +3421,7 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return NULL;
   }
 
-  data->layers[layer_index].data = ptr;
+  customData_layer_set_data(&data->layers[layer_index], ptr);
 
   return ptr;
 }
@@ -3265,7 +3434,7 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return NULL;
   }
 
-  data->layers[layer_index].data = ptr;
+  customData_layer_set_data(&data->layers[layer_index], ptr);
 
   return ptr;
 }
@@ -3859,7 +4028,7 @@ bool CustomData_has_interp(const struct CustomData *data)
 bool CustomData_has_referenced(const struct CustomData *data)
 {
   for (int i = 0; i < data->totlayer; i++) {
-    if (data->layers[i].flag & CD_FLAG_NOFREE) {
+    if ((data->layers[i].flag & CD_FLAG_NOFREE) || customData_layer_is_shared(&data->layers[i])) {
       return true;
     }
   }
@@ -4245,7 +4414,9 @@ void CustomData_blend_write_prepare(CustomData *data,
         }
         write_layers_size += chunk_size;
       }
-      write_layers[j++] = *layer;
+      write_layers[j] = *layer;
+      /* Run-time only. */
+      write_layers[j++].sharing_info = NULL;
     }
   }
   BLI_assert(j == data->totlayer);
@@ -5174,6 +5345,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing_info = NULL;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
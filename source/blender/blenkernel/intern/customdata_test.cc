@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+static const int TOTELEM = 16;
+
+static void customdata_float_init(CustomData *data)
+{
+  CustomData_reset(data);
+  float *values = static_cast<float *>(
+      CustomData_add_layer(data, CD_PROP_FLOAT, CD_CALLOC, nullptr, TOTELEM));
+  for (int i = 0; i < TOTELEM; i++) {
+    values[i] = float(i);
+  }
+}
+
+TEST(customdata, ShareFreeSourceFirst)
+{
+  CustomData src, dst;
+  customdata_float_init(&src);
+
+  CustomData_copy(&src, &dst, CD_MASK_PROP_FLOAT, CD_SHARE, TOTELEM);
+  const float *values = static_cast<const float *>(CustomData_get_layer(&dst, CD_PROP_FLOAT));
+  EXPECT_EQ(values, CustomData_get_layer(&src, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&dst, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&src, CD_PROP_FLOAT));
+
+  /* The copy keeps the data alive. */
+  CustomData_free(&src, TOTELEM);
+  for (int i = 0; i < TOTELEM; i++) {
+    EXPECT_EQ(values[i], float(i));
+  }
+
+  /* Last user, so no copy is needed to make it mutable. */
+  EXPECT_EQ(CustomData_duplicate_referenced_layer(&dst, CD_PROP_FLOAT, TOTELEM), values);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&dst, CD_PROP_FLOAT));
+
+  CustomData_free(&dst, TOTELEM);
+}
+
+TEST(customdata, ShareCopyOnWrite)
+{
+  CustomData src, dst_a, dst_b;
+  customdata_float_init(&src);
+
+  CustomData_copy(&src, &dst_a, CD_MASK_PROP_FLOAT, CD_SHARE, TOTELEM);
+  /* Sharing from a shared copy adds a user to the same data. */
+  CustomData_copy(&dst_a, &dst_b, CD_MASK_PROP_FLOAT, CD_SHARE, TOTELEM);
+  const float *values_src = static_cast<const float *>(CustomData_get_layer(&src, CD_PROP_FLOAT));
+  EXPECT_EQ(CustomData_get_layer(&dst_b, CD_PROP_FLOAT), values_src);
+
+  float *values_a = static_cast<float *>(
+      CustomData_duplicate_referenced_layer(&dst_a, CD_PROP_FLOAT, TOTELEM));
+  EXPECT_NE(values_a, values_src);
+  values_a[0] = -1.0f;
+  EXPECT_EQ(values_src[0], 0.0f);
+  EXPECT_EQ(values_a[TOTELEM - 1], float(TOTELEM - 1));
+
+  /* Making a shared source layer mutable copies it as well. */
+  CustomData_free(&dst_b, TOTELEM);
+  CustomData_copy(&src, &dst_b, CD_MASK_PROP_FLOAT, CD_SHARE, TOTELEM);
+  EXPECT_NE(CustomData_duplicate_referenced_layer(&src, CD_PROP_FLOAT, TOTELEM), values_src);
+  EXPECT_EQ(CustomData_get_layer(&dst_b, CD_PROP_FLOAT), values_src);
+
+  CustomData_free(&src, TOTELEM);
+  CustomData_free(&dst_a, TOTELEM);
+  CustomData_free(&dst_b, TOTELEM);
+}
+
+TEST(customdata, ShareDeformVert)
+{
+  CustomData src, dst;
+  CustomData_reset(&src);
+  MDeformVert *dverts = static_cast<MDeformVert *>(
+      CustomData_add_layer(&src, CD_MDEFORMVERT, CD_CALLOC, nullptr, TOTELEM));
+  for (int i = 0; i < TOTELEM; i++) {
+    dverts[i].dw = static_cast<MDeformWeight *>(MEM_callocN(sizeof(MDeformWeight), __func__));
+    dverts[i].dw->def_nr = i;
+    dverts[i].totweight = 1;
+  }
+
+  CustomData_copy(&src, &dst, CD_MASK_MDEFORMVERT, CD_SHARE, TOTELEM);
+  CustomData_free(&src, TOTELEM);
+
+  /* The weights were not freed with the source. */
+  MDeformVert *dverts_dst = static_cast<MDeformVert *>(
+      CustomData_get_layer(&dst, CD_MDEFORMVERT));
+  EXPECT_EQ(dverts_dst, dverts);
+  for (int i = 0; i < TOTELEM; i++) {
+    EXPECT_EQ(dverts_dst[i].dw->def_nr, i);
+  }
+
+  CustomData_free(&dst, TOTELEM);
+}
+
+}  // namespace blender::bke::tests
@@ -262,7 +262,7 @@ static VFontData *vfont_get_data(VFont *vfont)
       pf = get_builtin_packedfile();
     }
     else {
-      if (vfont->packedfile) {
+      if (vfont->packedfile && BKE_packedfile_data_ensure(vfont->packedfile)) {
         pf = vfont->packedfile;
 
         /* We need to copy a tmp font to memory unless it is already there */
@@ -4389,7 +4389,7 @@ static ImBuf *load_image_single(Image *ima,
     flag |= imbuf_alpha_flags_for_image(ima);
 
     imapf = BLI_findlink(&ima->packedfiles, view_id);
-    if (imapf->packedfile) {
+    if (imapf->packedfile && BKE_packedfile_data_ensure(imapf->packedfile)) {
       ibuf = IMB_ibImageFromMemory((unsigned char *)imapf->packedfile->data,
                                    imapf->packedfile->size,
                                    flag,
@@ -50,6 +50,7 @@
 
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_ohash.h"
 #include "BLI_string.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -371,7 +372,7 @@ static bool lib_override_hierarchy_recursive_tag(Main *bmain,
                                                  const uint tag,
                                                  Library *override_group_lib_reference)
 {
-  void **entry_vp = BLI_ghash_lookup_p(bmain->relations->id_user_to_used, id);
+  void **entry_vp = BLI_ohash_lookup_p(bmain->relations->id_user_to_used, id);
   if (entry_vp == NULL) {
     /* Already processed. */
     return (id->tag & tag) != 0;
@@ -1563,7 +1564,7 @@ static void lib_override_library_id_hierarchy_recursive_reset(Main *bmain, ID *i
     return;
   }
 
-  void **entry_pp = BLI_ghash_lookup(bmain->relations->id_user_to_used, id_root);
+  void **entry_pp = BLI_ohash_lookup(bmain->relations->id_user_to_used, id_root);
   if (entry_pp == NULL) {
     /* Already processed. */
     return;
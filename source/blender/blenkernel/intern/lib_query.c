@@ -28,6 +28,7 @@
 #include "BLI_ghash.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_listbase.h"
+#include "BLI_ohash.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_anim_data.h"
@@ -237,7 +238,7 @@ static void library_foreach_ID_link(Main *bmain,
        * but we might as well use it (Main->relations is always assumed valid,
        * it's responsibility of code creating it to free it,
        * especially if/when it starts modifying Main database). */
-      MainIDRelationsEntry *entry = BLI_ghash_lookup(bmain->relations->id_user_to_used, id);
+      MainIDRelationsEntry *entry = BLI_ohash_lookup(bmain->relations->id_user_to_used, id);
       for (; entry != NULL; entry = entry->next) {
         BKE_lib_query_foreachid_process(&data, entry->id_pointer, entry->usage_flag);
       }
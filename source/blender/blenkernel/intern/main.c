@@ -30,6 +30,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
 #include "BLI_mempool.h"
+#include "BLI_ohash.h"
 #include "BLI_threads.h"
 
 #include "DNA_ID.h"
@@ -220,7 +221,7 @@ static int main_relations_create_idlink_cb(LibraryIDLinkCallbackData *cb_data)
     MainIDRelationsEntry *entry, **entry_p;
 
     entry = BLI_mempool_alloc(rel->entry_pool);
-    if (BLI_ghash_ensure_p(rel->id_user_to_used, id_self, (void ***)&entry_p)) {
+    if (BLI_ohash_ensure_p(rel->id_user_to_used, id_self, (void ***)&entry_p)) {
       entry->next = *entry_p;
     }
     else {
@@ -231,7 +232,7 @@ static int main_relations_create_idlink_cb(LibraryIDLinkCallbackData *cb_data)
     *entry_p = entry;
 
     entry = BLI_mempool_alloc(rel->entry_pool);
-    if (BLI_ghash_ensure_p(rel->id_used_to_user, *id_pointer, (void ***)&entry_p)) {
+    if (BLI_ohash_ensure_p(rel->id_used_to_user, *id_pointer, (void ***)&entry_p)) {
       entry->next = *entry_p;
     }
     else {
@@ -253,10 +254,8 @@ void BKE_main_relations_create(Main *bmain, const short flag)
   }
 
   bmain->relations = MEM_mallocN(sizeof(*bmain->relations), __func__);
-  bmain->relations->id_used_to_user = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
-  bmain->relations->id_user_to_used = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
+  bmain->relations->id_used_to_user = BLI_ohash_ptr_new(__func__);
+  bmain->relations->id_user_to_used = BLI_ohash_ptr_new(__func__);
   bmain->relations->entry_pool = BLI_mempool_create(
       sizeof(MainIDRelationsEntry), 128, 128, BLI_MEMPOOL_NOP);
 
@@ -276,10 +275,10 @@ void BKE_main_relations_free(Main *bmain)
 {
   if (bmain->relations) {
     if (bmain->relations->id_used_to_user) {
-      BLI_ghash_free(bmain->relations->id_used_to_user, NULL, NULL);
+      BLI_ohash_free(bmain->relations->id_used_to_user, NULL, NULL);
     }
     if (bmain->relations->id_user_to_used) {
-      BLI_ghash_free(bmain->relations->id_user_to_used, NULL, NULL);
+      BLI_ohash_free(bmain->relations->id_user_to_used, NULL, NULL);
     }
     BLI_mempool_destroy(bmain->relations->entry_pool);
     MEM_freeN(bmain->relations);
@@ -302,10 +301,10 @@ void BKE_main_relations_ID_remove(Main *bmain, ID *id)
     /* Note: we do not free the entries from the mempool, those will be dealt with when finally
      * freeing the whole relations. */
     if (bmain->relations->id_used_to_user) {
-      BLI_ghash_remove(bmain->relations->id_used_to_user, id, NULL, NULL);
+      BLI_ohash_remove(bmain->relations->id_used_to_user, id, NULL, NULL);
     }
     if (bmain->relations->id_user_to_used) {
-      BLI_ghash_remove(bmain->relations->id_user_to_used, id, NULL, NULL);
+      BLI_ohash_remove(bmain->relations->id_user_to_used, id, NULL, NULL);
     }
   }
 }
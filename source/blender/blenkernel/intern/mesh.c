@@ -125,7 +125,7 @@ static void mesh_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const int
 
   mesh_dst->mat = MEM_dupallocN(mesh_src->mat);
 
-  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_REFERENCE : CD_DUPLICATE;
+  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_SHARE : CD_DUPLICATE;
   CustomData_copy(&mesh_src->vdata, &mesh_dst->vdata, mask.vmask, alloc_type, mesh_dst->totvert);
   CustomData_copy(&mesh_src->edata, &mesh_dst->edata, mask.emask, alloc_type, mesh_dst->totedge);
   CustomData_copy(&mesh_src->ldata, &mesh_dst->ldata, mask.lmask, alloc_type, mesh_dst->totloop);
@@ -751,6 +751,21 @@ void BKE_mesh_update_customdata_pointers(Mesh *me, const bool do_ensure_tess_cd)
   me->mloopuv = CustomData_get_layer(&me->ldata, CD_MLOOPUV);
 }
 
+/**
+ * Make all layers of \a me mutable, for code writing to them in-place
+ * (they may be shared with evaluated copies, see #LIB_ID_COPY_CD_REFERENCE).
+ * Only copies the layers which are actually shared.
+ */
+void BKE_mesh_duplicate_referenced_layers(Mesh *me)
+{
+  CustomData_duplicate_referenced_layers(&me->vdata, me->totvert);
+  CustomData_duplicate_referenced_layers(&me->edata, me->totedge);
+  CustomData_duplicate_referenced_layers(&me->fdata, me->totface);
+  CustomData_duplicate_referenced_layers(&me->ldata, me->totloop);
+  CustomData_duplicate_referenced_layers(&me->pdata, me->totpoly);
+  BKE_mesh_update_customdata_pointers(me, false);
+}
+
 bool BKE_mesh_has_custom_loop_normals(Mesh *me)
 {
   if (me->edit_mesh) {
@@ -1367,6 +1382,7 @@ void BKE_mesh_material_remap(Mesh *me, const unsigned int *remap, unsigned int r
 
 void BKE_mesh_smooth_flag_set(Mesh *me, const bool use_smooth)
 {
+  me->mpoly = CustomData_duplicate_referenced_layer(&me->pdata, CD_MPOLY, me->totpoly);
   if (use_smooth) {
     for (int i = 0; i < me->totpoly; i++) {
       me->mpoly[i].flag |= ME_SMOOTH;
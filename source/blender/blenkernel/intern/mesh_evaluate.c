@@ -770,10 +770,19 @@ void BKE_lnor_space_custom_normal_to_data(MLoopNorSpace *lnor_space,
   }
 }
 
-#define LOOP_SPLIT_TASK_BLOCK_SIZE 1024
+/** Minimum number of loops to process the smooth fans in parallel. */
+#define LOOP_SPLIT_THREADING_MIN_LOOPS 8192
+
+/** #LoopSplitTaskDataCommon.loop_flags */
+enum {
+  /** Loop already walked when looking for cyclic smooth fans. */
+  LOOP_SPLIT_SKIP = (1 << 0),
+  /** Loop from which a smooth fan (or a single loop) is computed. */
+  LOOP_SPLIT_FAN_START = (1 << 1),
+};
 
 typedef struct LoopSplitTaskData {
-  /* Specific to each instance (each task). */
+  /* Specific to each smooth fan. */
 
   /** We have to create those outside of tasks, since afaik memarena is not threadsafe. */
   MLoopNorSpace *lnor_space;
@@ -786,20 +795,23 @@ typedef struct LoopSplitTaskData {
   const int *e2l_prev;
   int mp_index;
 
-  /** This one is special, it's owned and managed by worker tasks,
+  /** This one is special, it's owned and managed by worker threads,
    * avoid to have to create it for each fan! */
   BLI_Stack *edge_vectors;
-
-  char pad_c;
 } LoopSplitTaskData;
 
+typedef struct LoopSplitTLSData {
+  BLI_Stack *edge_vectors;
+} LoopSplitTLSData;
+
 typedef struct LoopSplitTaskDataCommon {
   /* Read/write.
-   * Note we do not need to protect it, though, since two different tasks will *always* affect
-   * different elements in the arrays. */
+   * Note we do not need to protect it, though, since smooth fans are processed per vertex,
+   * two different tasks will *always* affect different elements in the arrays. */
   MLoopNorSpaceArray *lnors_spacearr;
   float (*loopnors)[3];
   short (*clnors_data)[2];
+  char *loop_flags;
 
   /* Read-only. */
   const MVert *mverts;
@@ -810,6 +822,15 @@ typedef struct LoopSplitTaskDataCommon {
   int *loop_to_poly;
   const float (*polynors)[3];
 
+  /** Mapping vertex -> loops, as offsets in (and a flat array of) loop indices. */
+  int *vert_loop_offsets;
+  int *vert_loops;
+
+  /** Spaces of all fans, with the offsets of the ones of each vertex in that array. */
+  MLoopNorSpace *lnor_spaces;
+  int *vert_space_offsets;
+
+  int numVerts;
   int numEdges;
   int numLoops;
   int numPolys;
@@ -825,7 +846,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
                                  const float split_angle,
                                  const bool do_sharp_edges_tag)
 {
-  const MVert *mverts = data->mverts;
   const MEdge *medges = data->medges;
   const MLoop *mloops = data->mloops;
 
@@ -834,7 +854,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
   const int numEdges = data->numEdges;
   const int numPolys = data->numPolys;
 
-  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
   const float(*polynors)[3] = data->polynors;
 
   int(*edge_to_loops)[2] = data->edge_to_loops;
@@ -860,13 +879,6 @@ static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
 
       loop_to_poly[ml_curr_index] = mp_index;
 
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
-
       /* Check whether current edge might be smooth or sharp */
       if ((e2l[0] | e2l[1]) == 0) {
         /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
@@ -1312,54 +1324,30 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
+BLI_INLINE int loop_split_prev_index(const MPoly *mp, const int ml_index)
 {
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
-
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
-    }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
+  return (ml_index == mp->loopstart) ? (mp->loopstart + mp->totloop - 1) : (ml_index - 1);
 }
 
 /**
  * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
+ *
+ * Only the loops of the pivot vertex are walked (and tagged in \a loop_flags),
+ * so different vertices can safely be checked in parallel.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_check_cyclic_smooth_fan(const MLoop *mloops,
+                                               const MPoly *mpolys,
+                                               const int (*edge_to_loops)[2],
+                                               const int *loop_to_poly,
+                                               const int *e2l_prev,
+                                               char *loop_flags,
+                                               const MLoop *ml_curr,
+                                               const MLoop *ml_prev,
+                                               const int ml_curr_index,
+                                               const int ml_prev_index,
+                                               const int mp_curr_index)
 {
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
@@ -1382,8 +1370,8 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+  BLI_assert((loop_flags[mlfan_vert_index] & LOOP_SPLIT_SKIP) == 0);
+  loop_flags[mlfan_vert_index] |= LOOP_SPLIT_SKIP;
 
   while (true) {
     /* Find next loop of the smooth fan. */
@@ -1404,7 +1392,7 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
       return false;
     }
     /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
+    if (loop_flags[mlfan_vert_index] & LOOP_SPLIT_SKIP) {
       if (mlfan_vert_index == ml_curr_index) {
         /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
          * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
@@ -1415,185 +1403,208 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
     }
 
     /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+    loop_flags[mlfan_vert_index] |= LOOP_SPLIT_SKIP;
   }
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+/**
+ * Tag the loops from which the smooth fans around given vertex are walked,
+ * returns the number of fans.
+ *
+ * Loops are visited in polygons order, as the loop used as 'entry point' of a cyclic smooth fan
+ * is the first one found (and the result of the whole computation depends on it).
+ */
+static int loop_split_vert_fans_tag(LoopSplitTaskDataCommon *common_data, const int mv_index)
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
-
   const MLoop *mloops = common_data->mloops;
   const MPoly *mpolys = common_data->mpolys;
-  const int *loop_to_poly = common_data->loop_to_poly;
   const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
-
-  const MPoly *mp;
-  int mp_index;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const int *vert_loops = common_data->vert_loops;
+  const int vl_end = common_data->vert_loop_offsets[mv_index + 1];
+  char *loop_flags = common_data->loop_flags;
+  int fans_num = 0;
+
+  for (int vl = common_data->vert_loop_offsets[mv_index]; vl < vl_end; vl++) {
+    const int ml_curr_index = vert_loops[vl];
+    const int mp_index = loop_to_poly[ml_curr_index];
+    const int ml_prev_index = loop_split_prev_index(&mpolys[mp_index], ml_curr_index);
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
+    const int *e2l_prev = edge_to_loops[ml_prev->e];
+
+    /* A smooth edge, we have to check for cyclic smooth fan case.
+     * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
+     * as 'entry point', otherwise we can skip it.
+     *
+     * We *do not need* to check/tag loops as already computed otherwise!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding). */
+    if (!IS_EDGE_SHARP(e2l_curr) && ((loop_flags[ml_curr_index] & LOOP_SPLIT_SKIP) ||
+                                     !loop_split_check_cyclic_smooth_fan(mloops,
+                                                                         mpolys,
+                                                                         edge_to_loops,
+                                                                         loop_to_poly,
+                                                                         e2l_prev,
+                                                                         loop_flags,
+                                                                         ml_curr,
+                                                                         ml_prev,
+                                                                         ml_curr_index,
+                                                                         ml_prev_index,
+                                                                         mp_index))) {
+      continue;
+    }
 
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+    loop_flags[ml_curr_index] |= LOOP_SPLIT_FAN_START;
+    fans_num++;
+  }
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+  return fans_num;
+}
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+/**
+ * Compute the normals (and spaces, if \a lnor_spaces is given) of the smooth fans around given
+ * vertex, which must have been tagged by #loop_split_vert_fans_tag.
+ */
+static void loop_split_vert_fans_compute(LoopSplitTaskDataCommon *common_data,
+                                         const int mv_index,
+                                         MLoopNorSpace *lnor_spaces,
+                                         BLI_Stack *edge_vectors)
+{
+  float(*loopnors)[3] = common_data->loopnors;
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const int *vert_loops = common_data->vert_loops;
+  const int vl_start = common_data->vert_loop_offsets[mv_index];
+  const int vl_end = common_data->vert_loop_offsets[mv_index + 1];
+  const char *loop_flags = common_data->loop_flags;
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+  /* Pre-populate all loop normals as if the vertex was all-smooth,
+   * this is used as fallback for fans with a degenerate normal. */
+  for (int vl = vl_start; vl < vl_end; vl++) {
+    normal_short_to_float_v3(loopnors[vert_loops[vl]], common_data->mverts[mv_index].no);
+  }
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
-#endif
+  for (int vl = vl_start; vl < vl_end; vl++) {
+    const int ml_curr_index = vert_loops[vl];
+    if ((loop_flags[ml_curr_index] & LOOP_SPLIT_FAN_START) == 0) {
+      continue;
+    }
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+    const int mp_index = loop_to_poly[ml_curr_index];
+    const int ml_prev_index = loop_split_prev_index(&mpolys[mp_index], ml_curr_index);
+    const int *e2l_curr = edge_to_loops[mloops[ml_curr_index].e];
+    const int *e2l_prev = edge_to_loops[mloops[ml_prev_index].e];
+    LoopSplitTaskData data = {NULL};
+
+    data.ml_curr = &mloops[ml_curr_index];
+    data.ml_prev = &mloops[ml_prev_index];
+    data.ml_curr_index = ml_curr_index;
+    data.mp_index = mp_index;
+    if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
+      data.lnor = &loopnors[ml_curr_index];
+    }
+    else {
+      data.ml_prev_index = ml_prev_index;
+      data.e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
+    }
+    if (lnor_spaces) {
+      data.lnor_space = lnor_spaces++;
     }
-  }
 
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
+    loop_split_worker_do(common_data, &data, edge_vectors);
+  }
+}
 
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+static void loop_split_vert_fans_tag_task(void *__restrict userdata,
+                                          const int mv_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  common_data->vert_space_offsets[mv_index] = loop_split_vert_fans_tag(common_data, mv_index);
+}
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+static void loop_split_vert_fans_compute_task(void *__restrict userdata,
+                                              const int mv_index,
+                                              const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  LoopSplitTLSData *tls_data = tls->userdata_chunk;
+  MLoopNorSpace *lnor_spaces = NULL;
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+  if (common_data->lnors_spacearr) {
+    /* Fans were already tagged, to allocate their spaces beforehand. */
+    lnor_spaces = &common_data->lnor_spaces[common_data->vert_space_offsets[mv_index]];
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+    /* Temp edge vectors stack, only used when computing lnor spacearr. */
+    if (tls_data->edge_vectors == NULL) {
+      tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+    }
+  }
+  else {
+    loop_split_vert_fans_tag(common_data, mv_index);
+  }
 
-        //              printf("PROCESSING!\n");
+  loop_split_vert_fans_compute(common_data, mv_index, lnor_spaces, tls_data->edge_vectors);
+}
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+static void loop_split_tls_free(const void *__restrict UNUSED(userdata), void *__restrict chunk)
+{
+  LoopSplitTLSData *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+  }
+}
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+/**
+ * Mapping vertex -> loops, with the loops of each vertex in polygons order.
+ */
+static void loop_split_vert_loops_map_create(LoopSplitTaskDataCommon *common_data)
+{
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int numVerts = common_data->numVerts;
+  const int numPolys = common_data->numPolys;
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
-      }
+  int *vert_loop_offsets = MEM_calloc_arrayN(
+      (size_t)numVerts + 1, sizeof(*vert_loop_offsets), __func__);
+  int *vert_loops = MEM_malloc_arrayN(
+      (size_t)common_data->numLoops, sizeof(*vert_loops), __func__);
 
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
+  for (int mp_index = 0; mp_index < numPolys; mp_index++) {
+    const MPoly *mp = &mpolys[mp_index];
+    for (int ml_index = mp->loopstart; ml_index < mp->loopstart + mp->totloop; ml_index++) {
+      vert_loop_offsets[mloops[ml_index].v]++;
     }
   }
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
+  /* Offsets of the end of each vertex' loops for now... */
+  for (int mv_index = 1; mv_index < numVerts; mv_index++) {
+    vert_loop_offsets[mv_index] += vert_loop_offsets[mv_index - 1];
+  }
+  if (numVerts) {
+    vert_loop_offsets[numVerts] = vert_loop_offsets[numVerts - 1];
   }
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+  /* ... which are turned into offsets of their start by filling them backwards,
+   * this also keeps the loops in polygons order. */
+  for (int mp_index = numPolys - 1; mp_index >= 0; mp_index--) {
+    const MPoly *mp = &mpolys[mp_index];
+    for (int ml_index = mp->loopstart + mp->totloop - 1; ml_index >= mp->loopstart; ml_index--) {
+      vert_loops[--vert_loop_offsets[mloops[ml_index].v]] = ml_index;
+    }
   }
-  MEM_freeN(skip_loops);
 
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_generator);
-#endif
+  common_data->vert_loop_offsets = vert_loop_offsets;
+  common_data->vert_loops = vert_loops;
 }
 
 /**
@@ -1602,7 +1613,7 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
  * (splitting edges).
  */
 void BKE_mesh_normals_loop_split(const MVert *mverts,
-                                 const int UNUSED(numVerts),
+                                 const int numVerts,
                                  MEdge *medges,
                                  const int numEdges,
                                  MLoop *mloops,
@@ -1702,6 +1713,7 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .edge_to_loops = edge_to_loops,
       .loop_to_poly = loop_to_poly,
       .polynors = polynors,
+      .numVerts = numVerts,
       .numEdges = numEdges,
       .numLoops = numLoops,
       .numPolys = numPolys,
@@ -1710,20 +1722,52 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
   /* This first loop check which edges are actually smooth, and compute edge vectors. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
+  /* Smooth fans are all around a single vertex, so they are found and computed in parallel
+   * over vertices, using flat arrays of loop indices instead of walking polygons. */
+  loop_split_vert_loops_map_create(&common_data);
+  common_data.loop_flags = MEM_calloc_arrayN(
+      (size_t)numLoops, sizeof(*common_data.loop_flags), __func__);
 
-    loop_split_generator(task_pool, &common_data);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Not enough loops to be worth the whole threading overhead otherwise... */
+  settings.use_threading = (numLoops >= LOOP_SPLIT_THREADING_MIN_LOOPS);
+  settings.min_iter_per_thread = 1024;
 
-    BLI_task_pool_work_and_wait(task_pool);
+  if (r_lnors_spacearr) {
+    /* The memarena of the spaces is not thread-safe, so fans are counted first,
+     * to allocate all their spaces at once. */
+    common_data.vert_space_offsets = MEM_malloc_arrayN(
+        (size_t)numVerts + 1, sizeof(*common_data.vert_space_offsets), __func__);
+    BLI_task_parallel_range(
+        0, numVerts, &common_data, loop_split_vert_fans_tag_task, &settings);
+
+    int fans_num = 0;
+    for (int mv_index = 0; mv_index < numVerts; mv_index++) {
+      const int vert_fans_num = common_data.vert_space_offsets[mv_index];
+      common_data.vert_space_offsets[mv_index] = fans_num;
+      fans_num += vert_fans_num;
+    }
+    common_data.vert_space_offsets[numVerts] = fans_num;
 
-    BLI_task_pool_free(task_pool);
+    if (fans_num) {
+      common_data.lnor_spaces = BLI_memarena_calloc(r_lnors_spacearr->mem,
+                                                    sizeof(MLoopNorSpace) * (size_t)fans_num);
+      r_lnors_spacearr->num_spaces += fans_num;
+    }
   }
 
+  LoopSplitTLSData tls_data = {NULL};
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = loop_split_tls_free;
+  BLI_task_parallel_range(
+      0, numVerts, &common_data, loop_split_vert_fans_compute_task, &settings);
+
+  MEM_freeN(common_data.vert_loop_offsets);
+  MEM_freeN(common_data.vert_loops);
+  MEM_freeN(common_data.loop_flags);
+  MEM_SAFE_FREE(common_data.vert_space_offsets);
   MEM_freeN(edge_to_loops);
   if (!r_loop_to_poly) {
     MEM_freeN(loop_to_poly);
@@ -50,6 +50,7 @@
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
+#include "BLI_profile.h"
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
@@ -1039,7 +1040,11 @@ struct Mesh *BKE_modifier_modify_mesh(ModifierData *md,
   if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
-  return mti->modifyMesh(md, ctx, me);
+
+  BLI_PROFILE_BEGIN(modify_mesh);
+  Mesh *result = mti->modifyMesh(md, ctx, me);
+  BLI_PROFILE_END(modify_mesh, mti->name);
+  return result;
 }
 
 void BKE_modifier_deform_verts(ModifierData *md,
@@ -1054,7 +1059,10 @@ void BKE_modifier_deform_verts(ModifierData *md,
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
+
+  BLI_PROFILE_BEGIN(deform_verts);
   mti->deformVerts(md, ctx, me, vertexCos, numVerts);
+  BLI_PROFILE_END(deform_verts, mti->name);
 }
 
 void BKE_modifier_deform_vertsEM(ModifierData *md,
@@ -1070,7 +1078,10 @@ void BKE_modifier_deform_vertsEM(ModifierData *md,
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     BKE_mesh_calc_normals(me);
   }
+
+  BLI_PROFILE_BEGIN(deform_verts);
   mti->deformVertsEM(md, ctx, em, me, vertexCos, numVerts);
+  BLI_PROFILE_END(deform_verts, mti->name);
 }
 
 /* end modifier callback wrappers */
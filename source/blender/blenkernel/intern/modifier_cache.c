@@ -0,0 +1,639 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_sdna_types.h"
+
+#include "BLI_hash_mm2a.h"
+#include "BLI_listbase.h"
+#include "BLI_session_uuid.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_modifier_cache.h"
+
+#include "DNA_genfile.h"
+
+#include "CLG_log.h"
+
+#include "atomic_ops.h"
+
+static CLG_LogRef LOG = {"bke.modifier_cache"};
+
+typedef struct ModifierCacheEntry {
+  struct ModifierCacheEntry *next, *prev;
+  /** Link in #cache_lru, data points to the entry. */
+  LinkData lru_link;
+  /** Cache of the object this entry belongs to. */
+  struct ModifierStackCache *cache;
+  /** Modifier this is the result of. */
+  SessionUUID session_uuid;
+  ModifierCacheKey key;
+  ModifierCacheState state;
+  size_t memory;
+} ModifierCacheEntry;
+
+/** The input mesh of the last evaluation, its hash is reused while the mesh is unchanged. */
+typedef struct ModifierCacheInput {
+  const Mesh *mesh;
+  uint session_uuid;
+  /** See #Mesh_Runtime.modifier_cache_input_id. */
+  uint64_t input_id;
+  ModifierCacheKey key;
+} ModifierCacheInput;
+
+typedef struct ModifierStackCache {
+  /** Protected by #cache_lock. */
+  ListBase entries;
+  /** Protected by #mutex. */
+  ModifierCacheInput input;
+  ThreadMutex mutex;
+} ModifierStackCache;
+
+/* Shared by the caches of all objects. */
+static size_t cache_memory_limit = (size_t)1024 * 1024 * 1024;
+static size_t cache_memory_used = 0;
+/* Entries of all objects, the most recently used first. Evicting from the end keeps results of
+ * idle objects from holding the memory budget. Protects the entries of all caches too. */
+static ListBase cache_lru = {NULL, NULL};
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
+static uint64_t cache_hits = 0;
+static uint64_t cache_misses = 0;
+static uint64_t cache_evictions = 0;
+static uint64_t cache_input_reuses = 0;
+/* Last identifier given to the data of an input mesh. */
+static uint64_t cache_input_id = 0;
+
+static ModifierStackCache *modifier_cache_ensure(Object *ob);
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ *
+ * Two 32 bit hashes (with different seeds) are used, to make collisions unlikely enough.
+ * \{ */
+
+typedef struct ModifierCacheHasher {
+  BLI_HashMurmur2A mm2[2];
+} ModifierCacheHasher;
+
+static void hasher_init(ModifierCacheHasher *hasher, const ModifierCacheKey *key)
+{
+  BLI_hash_mm2a_init(&hasher->mm2[0], key ? key->hash[0] : 0);
+  BLI_hash_mm2a_init(&hasher->mm2[1], key ? key->hash[1] : 0x9e3779b9);
+}
+
+static void hasher_add(ModifierCacheHasher *hasher, const void *data, const size_t len)
+{
+  BLI_hash_mm2a_add(&hasher->mm2[0], data, len);
+  BLI_hash_mm2a_add(&hasher->mm2[1], data, len);
+}
+
+static void hasher_end(ModifierCacheHasher *hasher, ModifierCacheKey *r_key)
+{
+  r_key->hash[0] = BLI_hash_mm2a_end(&hasher->mm2[0]);
+  r_key->hash[1] = BLI_hash_mm2a_end(&hasher->mm2[1]);
+}
+
+/**
+ * Hash the data of all layers, returns false when a layer references data
+ * which isn't stored in the layer itself (except for deform weights, which are hashed too).
+ */
+static bool hash_custom_data(ModifierCacheHasher *hasher,
+                             const CustomData *data,
+                             const int totelem)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+
+    hasher_add(hasher, &layer->type, sizeof(layer->type));
+    hasher_add(hasher, &layer->active, sizeof(int[4]));
+    hasher_add(hasher, layer->name, strlen(layer->name));
+
+    if (layer->data == NULL) {
+      continue;
+    }
+
+    switch (layer->type) {
+      case CD_MDEFORMVERT: {
+        const MDeformVert *dvert = layer->data;
+        for (int j = 0; j < totelem; j++, dvert++) {
+          hasher_add(hasher, &dvert->totweight, sizeof(dvert->totweight));
+          if (dvert->dw) {
+            hasher_add(hasher, dvert->dw, sizeof(*dvert->dw) * (size_t)dvert->totweight);
+          }
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+      case CD_BM_ELEM_PYPTR:
+        return false;
+      default:
+        hasher_add(hasher, layer->data, (size_t)CustomData_sizeof(layer->type) * (size_t)totelem);
+        break;
+    }
+  }
+  return true;
+}
+
+/**
+ * Hash the DNA struct \a struct_nr from its member \a member_start on (to skip headers),
+ * recursing into nested structs. Returns false when a pointer is set,
+ * since what it points to is unknown.
+ */
+static bool hash_dna_struct(ModifierCacheHasher *hasher,
+                            const SDNA *sdna,
+                            const int struct_nr,
+                            const char *data,
+                            const int member_start)
+{
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+  int offset = 0;
+
+  for (int i = 0; i < struct_info->members_len; i++) {
+    const SDNA_StructMember *member = &struct_info->members[i];
+    const char *name = sdna->names[member->name];
+    const int size = DNA_elem_size_nr(sdna, member->type, member->name);
+
+    if (i >= member_start) {
+      if (name[0] == '*' || (name[0] == '(' && name[1] == '*')) {
+        for (int p = 0; p < size; p += sdna->pointer_size) {
+          if (*(void *const *)(data + offset + p) != NULL) {
+            return false;
+          }
+        }
+      }
+      else {
+        const int member_struct_nr = DNA_struct_find_nr(sdna, sdna->types[member->type]);
+        if (member_struct_nr != -1) {
+          const int member_size = sdna->types_size[member->type];
+          for (int j = 0; j < sdna->names_array_len[member->name]; j++) {
+            if (!hash_dna_struct(
+                    hasher, sdna, member_struct_nr, data + offset + j * member_size, 0)) {
+              return false;
+            }
+          }
+        }
+        else {
+          hasher_add(hasher, data + offset, (size_t)size);
+        }
+      }
+    }
+
+    offset += size;
+  }
+  return true;
+}
+
+/** Hash the settings and data of \a mesh. */
+static void modifier_cache_mesh_key(ModifierCacheKey *r_key, const Mesh *mesh)
+{
+  ModifierCacheHasher hasher;
+  hasher_init(&hasher, NULL);
+
+  const int mesh_len[4] = {mesh->totvert, mesh->totedge, mesh->totloop, mesh->totpoly};
+  hasher_add(&hasher, mesh_len, sizeof(mesh_len));
+  hasher_add(&hasher, mesh->loc, sizeof(mesh->loc));
+  hasher_add(&hasher, mesh->size, sizeof(mesh->size));
+  hasher_add(&hasher, &mesh->texflag, sizeof(mesh->texflag));
+  hasher_add(&hasher, &mesh->flag, sizeof(mesh->flag));
+  hasher_add(&hasher, &mesh->smoothresh, sizeof(mesh->smoothresh));
+  hasher_add(&hasher, &mesh->cd_flag, sizeof(mesh->cd_flag));
+  hasher_add(&hasher, &mesh->totcol, sizeof(mesh->totcol));
+
+  r_key->is_valid = hash_custom_data(&hasher, &mesh->vdata, mesh->totvert) &&
+                    hash_custom_data(&hasher, &mesh->edata, mesh->totedge) &&
+                    hash_custom_data(&hasher, &mesh->ldata, mesh->totloop) &&
+                    hash_custom_data(&hasher, &mesh->pdata, mesh->totpoly);
+
+  hasher_end(&hasher, r_key);
+}
+
+/**
+ * Get the hash of the input mesh, reusing the one of the last evaluation of \a ob when the mesh
+ * is unchanged: evaluated meshes are copied from the original again when it changes, which resets
+ * the identifier of their data.
+ */
+static void modifier_cache_input_key(ModifierCacheKey *r_key, Object *ob, Mesh *mesh)
+{
+  uint64_t input_id = atomic_add_and_fetch_uint64(&mesh->runtime.modifier_cache_input_id, 0);
+  if (input_id == 0) {
+    /* Objects using the same mesh might be evaluated at the same time. */
+    const uint64_t input_id_new = atomic_add_and_fetch_uint64(&cache_input_id, 1);
+    input_id = atomic_cas_uint64(&mesh->runtime.modifier_cache_input_id, 0, input_id_new);
+    if (input_id == 0) {
+      input_id = input_id_new;
+    }
+  }
+
+  ModifierStackCache *cache = modifier_cache_ensure(ob);
+  ModifierCacheInput *input = &cache->input;
+
+  BLI_mutex_lock(&cache->mutex);
+  const bool is_unchanged = input->mesh == mesh && input->session_uuid == mesh->id.session_uuid &&
+                            input->input_id == input_id;
+  if (is_unchanged) {
+    *r_key = input->key;
+  }
+  BLI_mutex_unlock(&cache->mutex);
+
+  if (is_unchanged) {
+    atomic_add_and_fetch_uint64(&cache_input_reuses, 1);
+    return;
+  }
+
+  modifier_cache_mesh_key(r_key, mesh);
+
+  BLI_mutex_lock(&cache->mutex);
+  input->mesh = mesh;
+  input->session_uuid = mesh->id.session_uuid;
+  input->input_id = input_id;
+  input->key = *r_key;
+  BLI_mutex_unlock(&cache->mutex);
+}
+
+void BKE_modifier_cache_key_init(ModifierCacheKey *r_key,
+                                 const Scene *scene,
+                                 Object *ob,
+                                 Mesh *mesh,
+                                 const float (*vert_coords)[3],
+                                 const bool use_render,
+                                 const bool need_mapping,
+                                 const CustomData_MeshMasks *final_mask)
+{
+  ModifierCacheHasher hasher;
+  hasher_init(&hasher, NULL);
+
+  /* Evaluation settings. */
+  hasher_add(&hasher, &use_render, sizeof(use_render));
+  hasher_add(&hasher, &need_mapping, sizeof(need_mapping));
+  hasher_add(&hasher, final_mask, sizeof(*final_mask));
+
+  /* Data modifiers use besides the mesh. */
+  const int simplify[3] = {
+      scene->r.mode & R_SIMPLIFY, scene->r.simplify_subsurf, scene->r.simplify_subsurf_render};
+  hasher_add(&hasher, simplify, sizeof(simplify));
+  hasher_add(&hasher, ob->obmat, sizeof(ob->obmat));
+  LISTBASE_FOREACH (const bDeformGroup *, dg, &ob->defbase) {
+    hasher_add(&hasher, dg->name, strlen(dg->name) + 1);
+  }
+
+  /* Mesh settings and data. */
+  ModifierCacheKey mesh_key;
+  modifier_cache_input_key(&mesh_key, ob, mesh);
+  r_key->is_valid = mesh_key.is_valid;
+  hasher_add(&hasher, mesh_key.hash, sizeof(mesh_key.hash));
+
+  if (vert_coords) {
+    hasher_add(&hasher, vert_coords, sizeof(*vert_coords) * (size_t)mesh->totvert);
+  }
+
+  hasher_end(&hasher, r_key);
+}
+
+static bool modifier_is_hashable(const ModifierData *md, const ModifierTypeInfo *mti)
+{
+  if (md->mode & eModifierMode_Virtual) {
+    /* Depends on data of the object or the mesh, e.g. shape keys. */
+    return false;
+  }
+  if (mti->dependsOnTime && mti->dependsOnTime((ModifierData *)md)) {
+    return false;
+  }
+  return DNA_sdna_current_get() != NULL;
+}
+
+void BKE_modifier_cache_key_add(ModifierCacheKey *key,
+                                const ModifierData *md,
+                                const CustomData_MeshMasks *mask)
+{
+  if (!key->is_valid) {
+    return;
+  }
+
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+  if (!modifier_is_hashable(md, mti)) {
+    key->is_valid = false;
+    return;
+  }
+
+  const SDNA *sdna = DNA_sdna_current_get();
+  const int struct_nr = DNA_struct_find_nr(sdna, mti->structName);
+  BLI_assert(struct_nr != -1);
+  BLI_assert(STREQ(sdna->types[sdna->structs[struct_nr]->members[0].type], "ModifierData"));
+
+  ModifierCacheHasher hasher;
+  hasher_init(&hasher, key);
+  hasher_add(&hasher, &md->type, sizeof(md->type));
+  hasher_add(&hasher, mask, sizeof(*mask));
+
+  /* Settings of the modifier, without the #ModifierData header. */
+  if (!hash_dna_struct(&hasher, sdna, struct_nr, (const char *)md, 1)) {
+    key->is_valid = false;
+    return;
+  }
+
+  hasher_end(&hasher, key);
+}
+
+static bool modifier_cache_key_equal(const ModifierCacheKey *a, const ModifierCacheKey *b)
+{
+  return a->is_valid && b->is_valid && a->hash[0] == b->hash[0] && a->hash[1] == b->hash[1];
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Entries
+ * \{ */
+
+static size_t custom_data_memory(const CustomData *data, const int totelem)
+{
+  size_t memory = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    memory += (size_t)CustomData_sizeof(layer->type) * (size_t)totelem;
+    if (layer->type == CD_MDEFORMVERT && layer->data) {
+      const MDeformVert *dvert = layer->data;
+      for (int j = 0; j < totelem; j++) {
+        memory += sizeof(MDeformWeight) * (size_t)dvert[j].totweight;
+      }
+    }
+  }
+  return memory;
+}
+
+static size_t mesh_memory(const Mesh *mesh)
+{
+  if (mesh == NULL) {
+    return 0;
+  }
+  return sizeof(Mesh) + custom_data_memory(&mesh->vdata, mesh->totvert) +
+         custom_data_memory(&mesh->edata, mesh->totedge) +
+         custom_data_memory(&mesh->ldata, mesh->totloop) +
+         custom_data_memory(&mesh->pdata, mesh->totpoly);
+}
+
+/* The copies share the data of their source (which is only copied when written to),
+ * so storing and restoring states is cheap. */
+static Mesh *mesh_copy_shared(const Mesh *mesh)
+{
+  return mesh ? BKE_mesh_copy_for_eval((Mesh *)mesh, true) : NULL;
+}
+
+static void modifier_cache_state_copy(ModifierCacheState *dst, const ModifierCacheState *src)
+{
+  *dst = *src;
+  dst->mesh = mesh_copy_shared(src->mesh);
+  dst->mesh_orco = mesh_copy_shared(src->mesh_orco);
+  dst->mesh_orco_cloth = mesh_copy_shared(src->mesh_orco_cloth);
+}
+
+void BKE_modifier_cache_state_free(ModifierCacheState *state)
+{
+  if (state->mesh) {
+    BKE_id_free(NULL, state->mesh);
+  }
+  if (state->mesh_orco) {
+    BKE_id_free(NULL, state->mesh_orco);
+  }
+  if (state->mesh_orco_cloth) {
+    BKE_id_free(NULL, state->mesh_orco_cloth);
+  }
+  memset(state, 0, sizeof(*state));
+}
+
+static ModifierCacheEntry *modifier_cache_entry_find(ModifierStackCache *cache,
+                                                     const ModifierData *md)
+{
+  LISTBASE_FOREACH (ModifierCacheEntry *, entry, &cache->entries) {
+    if (BLI_session_uuid_is_equal(&entry->session_uuid, &md->session_uuid)) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/* Move to the front of #cache_lru. */
+static void modifier_cache_entry_touch(ModifierCacheEntry *entry)
+{
+  BLI_remlink(&cache_lru, &entry->lru_link);
+  BLI_addhead(&cache_lru, &entry->lru_link);
+}
+
+static void modifier_cache_entry_remove(ModifierCacheEntry *entry)
+{
+  BLI_remlink(&entry->cache->entries, entry);
+  BLI_remlink(&cache_lru, &entry->lru_link);
+  atomic_sub_and_fetch_z(&cache_memory_used, entry->memory);
+  BKE_modifier_cache_state_free(&entry->state);
+  MEM_freeN(entry);
+}
+
+static ModifierStackCache *modifier_cache_ensure(Object *ob)
+{
+  ModifierStackCache *cache = ob->runtime.modifier_cache;
+  if (cache == NULL) {
+    /* The mesh of the object can be evaluated from multiple threads (when other objects need
+     * different data layers from it), make sure only one cache is created. */
+    ModifierStackCache *cache_new = MEM_callocN(sizeof(*cache_new), __func__);
+    BLI_mutex_init(&cache_new->mutex);
+    cache = atomic_cas_ptr((void **)&ob->runtime.modifier_cache, NULL, cache_new);
+    if (cache == NULL) {
+      cache = cache_new;
+    }
+    else {
+      BKE_modifier_cache_free(cache_new);
+    }
+  }
+  return cache;
+}
+
+/**
+ * Get a copy of the state cached after \a md, if its key matches.
+ */
+bool BKE_modifier_cache_lookup(Object *ob,
+                               const ModifierData *md,
+                               const ModifierCacheKey *key,
+                               ModifierCacheState *r_state)
+{
+  ModifierStackCache *cache = ob->runtime.modifier_cache;
+  bool found = false;
+
+  if (cache && key->is_valid) {
+    BLI_mutex_lock(&cache_lock);
+    ModifierCacheEntry *entry = modifier_cache_entry_find(cache, md);
+    if (entry && modifier_cache_key_equal(&entry->key, key)) {
+      modifier_cache_state_copy(r_state, &entry->state);
+      modifier_cache_entry_touch(entry);
+      found = true;
+    }
+    BLI_mutex_unlock(&cache_lock);
+  }
+
+  atomic_add_and_fetch_uint64(found ? &cache_hits : &cache_misses, 1);
+  CLOG_INFO(&LOG,
+            2,
+            "Object: \"%s\", Modifier: \"%s\", %s",
+            ob->id.name + 2,
+            md->name,
+            found ? "hit" : "miss");
+
+  return found;
+}
+
+/**
+ * Store a copy of the state after \a md, evicting the least recently used results of all
+ * objects when over the memory limit.
+ */
+void BKE_modifier_cache_store(Object *ob,
+                              const ModifierData *md,
+                              const ModifierCacheKey *key,
+                              const ModifierCacheState *state)
+{
+  if (!key->is_valid) {
+    return;
+  }
+
+  const size_t memory = mesh_memory(state->mesh) + mesh_memory(state->mesh_orco) +
+                        mesh_memory(state->mesh_orco_cloth);
+  if (memory > cache_memory_limit) {
+    return;
+  }
+
+  ModifierStackCache *cache = modifier_cache_ensure(ob);
+  BLI_mutex_lock(&cache_lock);
+
+  ModifierCacheEntry *entry = modifier_cache_entry_find(cache, md);
+  if (entry) {
+    modifier_cache_entry_remove(entry);
+  }
+
+  while (cache_memory_used + memory > cache_memory_limit) {
+    LinkData *link_lru = cache_lru.last;
+    if (link_lru == NULL) {
+      break;
+    }
+    modifier_cache_entry_remove(link_lru->data);
+    atomic_add_and_fetch_uint64(&cache_evictions, 1);
+  }
+
+  entry = MEM_callocN(sizeof(*entry), __func__);
+  entry->lru_link.data = entry;
+  entry->cache = cache;
+  entry->session_uuid = md->session_uuid;
+  entry->key = *key;
+  modifier_cache_state_copy(&entry->state, state);
+  entry->memory = memory;
+  BLI_addtail(&cache->entries, entry);
+  BLI_addhead(&cache_lru, &entry->lru_link);
+  atomic_add_and_fetch_z(&cache_memory_used, memory);
+
+  BLI_mutex_unlock(&cache_lock);
+}
+
+/**
+ * Remove results of modifiers which were removed or don't use the cache anymore.
+ */
+void BKE_modifier_cache_remove_unused(Object *ob)
+{
+  ModifierStackCache *cache = ob->runtime.modifier_cache;
+  if (cache == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&cache_lock);
+  LISTBASE_FOREACH_MUTABLE (ModifierCacheEntry *, entry, &cache->entries) {
+    bool is_used = false;
+    LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+      if (BLI_session_uuid_is_equal(&entry->session_uuid, &md->session_uuid)) {
+        is_used = (md->flag & eModifierFlag_CacheResult) != 0;
+        break;
+      }
+    }
+    if (!is_used) {
+      modifier_cache_entry_remove(entry);
+    }
+  }
+  BLI_mutex_unlock(&cache_lock);
+}
+
+void BKE_modifier_cache_free(ModifierStackCache *cache)
+{
+  BLI_mutex_lock(&cache_lock);
+  LISTBASE_FOREACH_MUTABLE (ModifierCacheEntry *, entry, &cache->entries) {
+    modifier_cache_entry_remove(entry);
+  }
+  BLI_mutex_unlock(&cache_lock);
+  BLI_mutex_end(&cache->mutex);
+  MEM_freeN(cache);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Limits & Statistics
+ * \{ */
+
+void BKE_modifier_cache_memory_limit_set(const size_t limit)
+{
+  cache_memory_limit = limit;
+}
+
+void BKE_modifier_cache_stats_get(ModifierCacheStats *r_stats)
+{
+  r_stats->hits = atomic_add_and_fetch_uint64(&cache_hits, 0);
+  r_stats->misses = atomic_add_and_fetch_uint64(&cache_misses, 0);
+  r_stats->evictions = atomic_add_and_fetch_uint64(&cache_evictions, 0);
+  r_stats->input_reuses = atomic_add_and_fetch_uint64(&cache_input_reuses, 0);
+  r_stats->memory_used = atomic_add_and_fetch_z(&cache_memory_used, 0);
+  r_stats->memory_limit = cache_memory_limit;
+}
+
+static void stat_reset(uint64_t *value)
+{
+  uint64_t value_old = atomic_add_and_fetch_uint64(value, 0);
+  uint64_t value_prev;
+  while ((value_prev = atomic_cas_uint64(value, value_old, 0)) != value_old) {
+    value_old = value_prev;
+  }
+}
+
+void BKE_modifier_cache_stats_reset(void)
+{
+  stat_reset(&cache_hits);
+  stat_reset(&cache_misses);
+  stat_reset(&cache_evictions);
+  stat_reset(&cache_input_reuses);
+}
+
+/** \} */
@@ -0,0 +1,283 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_modifier_cache.h"
+
+#include "BLI_listbase.h"
+
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "CLG_log.h"
+
+namespace blender::bke::tests {
+
+class ModifierCacheTest : public testing::Test {
+ protected:
+  Scene scene = {{nullptr}};
+  Object *ob = nullptr;
+  Mesh *mesh = nullptr;
+
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    DNA_sdna_current_init();
+    BKE_idtype_init();
+    BKE_modifier_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    DNA_sdna_current_free();
+    CLG_exit();
+  }
+
+  virtual void SetUp()
+  {
+    mesh = BKE_mesh_new_nomain(4, 0, 0, 0, 0);
+    for (int i = 0; i < mesh->totvert; i++) {
+      mesh->mvert[i].co[0] = (float)i;
+    }
+    ob = static_cast<Object *>(BKE_id_new_nomain(ID_OB, "Object"));
+    ob->type = OB_MESH;
+    ob->data = mesh;
+    BKE_modifier_cache_stats_reset();
+  }
+
+  virtual void TearDown()
+  {
+    BKE_id_free(nullptr, ob);
+    BKE_id_free(nullptr, mesh);
+    BKE_modifier_cache_memory_limit_set((size_t)1024 * 1024 * 1024);
+  }
+
+  ModifierData *modifier_add(const ModifierType type)
+  {
+    ModifierData *md = BKE_modifier_new(type);
+    BLI_addtail(&ob->modifiers, md);
+    return md;
+  }
+
+  /* Key of the result of the modifiers up to \a md_last. */
+  ModifierCacheKey modifier_key(ModifierData *md_last)
+  {
+    const CustomData_MeshMasks mask = {0};
+    ModifierCacheKey key;
+    BKE_modifier_cache_key_init(&key, &scene, ob, mesh, nullptr, false, false, &mask);
+    LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+      BKE_modifier_cache_key_add(&key, md, &mask);
+      if (md == md_last) {
+        break;
+      }
+    }
+    return key;
+  }
+
+  void modifier_store(ModifierData *md)
+  {
+    ModifierCacheState state = {nullptr};
+    state.mesh = mesh;
+    const ModifierCacheKey key = modifier_key(md);
+    BKE_modifier_cache_store(ob, md, &key, &state);
+  }
+
+  bool modifier_lookup(ModifierData *md, const ModifierCacheKey &key)
+  {
+    ModifierCacheState state = {nullptr};
+    if (!BKE_modifier_cache_lookup(ob, md, &key, &state)) {
+      return false;
+    }
+    EXPECT_NE(state.mesh, nullptr);
+    BKE_modifier_cache_state_free(&state);
+    return true;
+  }
+
+  ModifierCacheStats stats_get()
+  {
+    ModifierCacheStats stats;
+    BKE_modifier_cache_stats_get(&stats);
+    return stats;
+  }
+};
+
+static bool key_equal(const ModifierCacheKey &a, const ModifierCacheKey &b)
+{
+  return a.is_valid && b.is_valid && a.hash[0] == b.hash[0] && a.hash[1] == b.hash[1];
+}
+
+TEST_F(ModifierCacheTest, KeySettings)
+{
+  ModifierData *md = modifier_add(eModifierType_Subsurf);
+  const ModifierCacheKey key = modifier_key(md);
+  EXPECT_TRUE(key.is_valid);
+  EXPECT_TRUE(key_equal(key, modifier_key(md)));
+
+  ((SubsurfModifierData *)md)->levels++;
+  EXPECT_FALSE(key_equal(key, modifier_key(md)));
+  ((SubsurfModifierData *)md)->levels--;
+  EXPECT_TRUE(key_equal(key, modifier_key(md)));
+
+  /* Results of modifiers before a changed one are still valid. */
+  ModifierData *md_next = modifier_add(eModifierType_Subsurf);
+  const ModifierCacheKey key_next = modifier_key(md_next);
+  ((SubsurfModifierData *)md_next)->levels++;
+  EXPECT_TRUE(key_equal(key, modifier_key(md)));
+  EXPECT_FALSE(key_equal(key_next, modifier_key(md_next)));
+}
+
+TEST_F(ModifierCacheTest, KeyInvalid)
+{
+  /* Depends on another object. */
+  ModifierData *md_boolean = modifier_add(eModifierType_Boolean);
+  ((BooleanModifierData *)md_boolean)->object = ob;
+  EXPECT_FALSE(modifier_key(md_boolean).is_valid);
+  ((BooleanModifierData *)md_boolean)->object = nullptr;
+  EXPECT_TRUE(modifier_key(md_boolean).is_valid);
+
+  /* Invalid for all modifiers after it too. */
+  md_boolean->mode |= eModifierMode_Virtual;
+  ModifierData *md_next = modifier_add(eModifierType_Subsurf);
+  EXPECT_FALSE(modifier_key(md_next).is_valid);
+}
+
+TEST_F(ModifierCacheTest, KeyMesh)
+{
+  ModifierData *md = modifier_add(eModifierType_Subsurf);
+  const ModifierCacheKey key = modifier_key(md);
+  EXPECT_EQ(stats_get().input_reuses, 0u);
+
+  /* The hash of the unchanged mesh is reused. */
+  EXPECT_TRUE(key_equal(key, modifier_key(md)));
+  EXPECT_EQ(stats_get().input_reuses, 1u);
+
+  /* Evaluated meshes are only changed by copying them again, which resets their identifier. */
+  mesh->mvert[0].co[0] += 1.0f;
+  mesh->runtime.modifier_cache_input_id = 0;
+  EXPECT_FALSE(key_equal(key, modifier_key(md)));
+  EXPECT_EQ(stats_get().input_reuses, 1u);
+
+  mesh->mvert[0].co[0] -= 1.0f;
+  mesh->runtime.modifier_cache_input_id = 0;
+  EXPECT_TRUE(key_equal(key, modifier_key(md)));
+}
+
+TEST_F(ModifierCacheTest, LookupStore)
+{
+  ModifierData *md = modifier_add(eModifierType_Subsurf);
+  const ModifierCacheKey key = modifier_key(md);
+  EXPECT_FALSE(modifier_lookup(md, key));
+
+  modifier_store(md);
+  EXPECT_TRUE(modifier_lookup(md, key));
+  EXPECT_GT(stats_get().memory_used, 0u);
+
+  ((SubsurfModifierData *)md)->levels++;
+  EXPECT_FALSE(modifier_lookup(md, modifier_key(md)));
+
+  const ModifierCacheStats stats = stats_get();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.evictions, 0u);
+
+  /* Removed with their modifiers. */
+  BLI_remlink(&ob->modifiers, md);
+  BKE_modifier_free(md);
+  BKE_modifier_cache_remove_unused(ob);
+  EXPECT_EQ(stats_get().memory_used, 0u);
+}
+
+TEST_F(ModifierCacheTest, EvictLeastRecentlyUsed)
+{
+  ModifierData *md_a = modifier_add(eModifierType_Subsurf);
+  ModifierData *md_b = modifier_add(eModifierType_Subsurf);
+  ModifierData *md_c = modifier_add(eModifierType_Subsurf);
+  LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+    md->flag |= eModifierFlag_CacheResult;
+  }
+
+  /* Room for two results. */
+  modifier_store(md_a);
+  const size_t result_memory = stats_get().memory_used;
+  BKE_modifier_cache_memory_limit_set(result_memory * 2 + result_memory / 2);
+  modifier_store(md_b);
+  EXPECT_EQ(stats_get().memory_used, result_memory * 2);
+
+  EXPECT_TRUE(modifier_lookup(md_a, modifier_key(md_a)));
+  modifier_store(md_c);
+
+  EXPECT_FALSE(modifier_lookup(md_b, modifier_key(md_b)));
+  EXPECT_TRUE(modifier_lookup(md_a, modifier_key(md_a)));
+  EXPECT_TRUE(modifier_lookup(md_c, modifier_key(md_c)));
+
+  const ModifierCacheStats stats = stats_get();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.memory_used, result_memory * 2);
+  EXPECT_EQ(stats.memory_limit, result_memory * 2 + result_memory / 2);
+
+  /* Results larger than the limit aren't stored. */
+  BKE_modifier_cache_memory_limit_set(result_memory / 2);
+  md_b->flag &= ~eModifierFlag_CacheResult;
+  BKE_modifier_cache_remove_unused(ob);
+  modifier_store(md_b);
+  EXPECT_FALSE(modifier_lookup(md_b, modifier_key(md_b)));
+}
+
+TEST_F(ModifierCacheTest, EvictOtherObjects)
+{
+  /* Result of another object which isn't evaluated anymore. */
+  Object *ob_idle = static_cast<Object *>(BKE_id_new_nomain(ID_OB, "ObjectIdle"));
+  ob_idle->type = OB_MESH;
+  ob_idle->data = mesh;
+  ModifierData *md_idle = BKE_modifier_new(eModifierType_Subsurf);
+  BLI_addtail(&ob_idle->modifiers, md_idle);
+  const CustomData_MeshMasks mask = {0};
+  ModifierCacheKey key_idle;
+  BKE_modifier_cache_key_init(&key_idle, &scene, ob_idle, mesh, nullptr, false, false, &mask);
+  BKE_modifier_cache_key_add(&key_idle, md_idle, &mask);
+  ModifierCacheState state = {nullptr};
+  state.mesh = mesh;
+  BKE_modifier_cache_store(ob_idle, md_idle, &key_idle, &state);
+  const size_t result_memory = stats_get().memory_used;
+
+  /* Room for one result, the idle one is evicted. */
+  BKE_modifier_cache_memory_limit_set(result_memory + result_memory / 2);
+  ModifierData *md = modifier_add(eModifierType_Subsurf);
+  modifier_store(md);
+  EXPECT_TRUE(modifier_lookup(md, modifier_key(md)));
+  EXPECT_FALSE(BKE_modifier_cache_lookup(ob_idle, md_idle, &key_idle, &state));
+
+  const ModifierCacheStats stats = stats_get();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.memory_used, result_memory);
+
+  BKE_id_free(nullptr, ob_idle);
+  EXPECT_EQ(stats_get().memory_used, result_memory);
+}
+
+}  // namespace blender::bke::tests
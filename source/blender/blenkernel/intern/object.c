@@ -119,6 +119,7 @@
 #include "BKE_mesh.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_modifier.h"
+#include "BKE_modifier_cache.h"
 #include "BKE_multires.h"
 #include "BKE_node.h"
 #include "BKE_object.h"
@@ -334,6 +335,11 @@ static void object_free_data(ID *id)
     ob->runtime.curve_cache = NULL;
   }
 
+  if (ob->runtime.modifier_cache) {
+    BKE_modifier_cache_free(ob->runtime.modifier_cache);
+    ob->runtime.modifier_cache = NULL;
+  }
+
   BKE_previewimg_free(&ob->preview);
 }
 
@@ -4931,6 +4937,7 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
   runtime->gpd_eval = NULL;
   runtime->mesh_deform_eval = NULL;
   runtime->curve_cache = NULL;
+  runtime->modifier_cache = NULL;
   runtime->object_as_temp_mesh = NULL;
   runtime->geometry_set_eval = NULL;
 }
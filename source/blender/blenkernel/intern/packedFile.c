@@ -41,6 +41,8 @@
 #include "DNA_volume_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_font.h"
@@ -55,6 +57,7 @@
 #include "IMB_imbuf_types.h"
 
 #include "BLO_read_write.h"
+#include "BLO_readfile.h"
 
 int BKE_packedfile_seek(PackedFile *pf, int offset, int whence)
 {
@@ -93,9 +96,129 @@ void BKE_packedfile_rewind(PackedFile *pf)
   BKE_packedfile_seek(pf, 0, SEEK_SET);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Lazy Data
+ *
+ * Location in the .blend file of the data of packed files which isn't loaded yet
+ * (see #BLO_READ_LAZY_PACKED_DATA). Run-time only, so it's kept out of #PackedFile.
+ * \{ */
+
+/** Seek position of packed files written to undo steps without their data. */
+#define PACKEDFILE_SEEK_LAZY -1
+
+/** #PackedFile -> #BlendFileLazyData, NULL until lazy data is read. */
+static GHash *packedfile_lazy_data = NULL;
+static ThreadMutex packedfile_lazy_data_lock = BLI_MUTEX_INITIALIZER;
+
+static void packedfile_lazy_data_set(PackedFile *pf, BlendFileLazyData *lazy_data)
+{
+  BLI_assert(pf->data == NULL);
+  BLI_mutex_lock(&packedfile_lazy_data_lock);
+  if (packedfile_lazy_data == NULL) {
+    packedfile_lazy_data = BLI_ghash_ptr_new(__func__);
+  }
+  BLI_ghash_insert(packedfile_lazy_data, pf, lazy_data);
+  BLI_mutex_unlock(&packedfile_lazy_data_lock);
+}
+
+/* The caller must hold the lock. */
+static BlendFileLazyData *packedfile_lazy_data_get(const PackedFile *pf)
+{
+  return packedfile_lazy_data ? BLI_ghash_lookup(packedfile_lazy_data, pf) : NULL;
+}
+
+/* The caller must hold the lock. */
+static void packedfile_lazy_data_remove(PackedFile *pf)
+{
+  if (packedfile_lazy_data) {
+    BLI_ghash_remove(packedfile_lazy_data, pf, NULL, MEM_freeN);
+    /* Don't keep the map once all the data is read or freed. */
+    if (BLI_ghash_len(packedfile_lazy_data) == 0) {
+      BLI_ghash_free(packedfile_lazy_data, NULL, NULL);
+      packedfile_lazy_data = NULL;
+    }
+  }
+}
+
+static void packedfile_lazy_data_free(PackedFile *pf)
+{
+  BLI_mutex_lock(&packedfile_lazy_data_lock);
+  packedfile_lazy_data_remove(pf);
+  BLI_mutex_unlock(&packedfile_lazy_data_lock);
+}
+
+static BlendFileLazyData *packedfile_lazy_data_duplicate(const PackedFile *pf)
+{
+  BLI_mutex_lock(&packedfile_lazy_data_lock);
+  BlendFileLazyData *lazy_data = packedfile_lazy_data_get(pf);
+  if (lazy_data) {
+    lazy_data = MEM_dupallocN(lazy_data);
+  }
+  BLI_mutex_unlock(&packedfile_lazy_data_lock);
+  return lazy_data;
+}
+
+/** \} */
+
+bool BKE_packedfile_data_ensure(PackedFile *pf)
+{
+  if (pf->data != NULL) {
+    return true;
+  }
+
+  /* Users of the same packed file may be in different threads (e.g. image loading). */
+  BLI_mutex_lock(&packedfile_lazy_data_lock);
+  BlendFileLazyData *lazy_data = packedfile_lazy_data_get(pf);
+  if (pf->data == NULL && lazy_data != NULL) {
+    BLI_assert(lazy_data->len >= pf->size);
+    /* On failure the location is kept, so saving fails instead of silently losing the data. */
+    pf->data = BLO_read_lazy_data(lazy_data, NULL);
+    if (pf->data != NULL) {
+      packedfile_lazy_data_remove(pf);
+    }
+  }
+  BLI_mutex_unlock(&packedfile_lazy_data_lock);
+
+  return pf->data != NULL;
+}
+
+static bool packedfile_data_ensure_report(PackedFile *pf, ID *id, ReportList *reports)
+{
+  if (pf == NULL || BKE_packedfile_data_ensure(pf)) {
+    return true;
+  }
+  BKE_reportf(reports, RPT_ERROR, "Unable to read the packed data of '%s'", id->name + 2);
+  return false;
+}
+
+bool BKE_packedfile_data_ensure_all(Main *bmain, ReportList *reports)
+{
+  bool ok = true;
+
+  LISTBASE_FOREACH (Image *, ima, &bmain->images) {
+    LISTBASE_FOREACH (ImagePackedFile *, imapf, &ima->packedfiles) {
+      ok &= packedfile_data_ensure_report(imapf->packedfile, &ima->id, reports);
+    }
+  }
+  LISTBASE_FOREACH (VFont *, vf, &bmain->fonts) {
+    ok &= packedfile_data_ensure_report(vf->packedfile, &vf->id, reports);
+  }
+  LISTBASE_FOREACH (bSound *, sound, &bmain->sounds) {
+    ok &= packedfile_data_ensure_report(sound->packedfile, &sound->id, reports);
+  }
+  LISTBASE_FOREACH (Volume *, volume, &bmain->volumes) {
+    ok &= packedfile_data_ensure_report(volume->packedfile, &volume->id, reports);
+  }
+  LISTBASE_FOREACH (Library *, lib, &bmain->libraries) {
+    ok &= packedfile_data_ensure_report(lib->packedfile, &lib->id, reports);
+  }
+
+  return ok;
+}
+
 int BKE_packedfile_read(PackedFile *pf, void *data, int size)
 {
-  if ((pf != NULL) && (size >= 0) && (data != NULL)) {
+  if ((pf != NULL) && (size >= 0) && (data != NULL) && BKE_packedfile_data_ensure(pf)) {
     if (size + pf->seek > pf->size) {
       size = pf->size - pf->seek;
     }
@@ -155,9 +278,12 @@ int BKE_packedfile_count_all(Main *bmain)
 void BKE_packedfile_free(PackedFile *pf)
 {
   if (pf) {
-    BLI_assert(pf->data != NULL);
-
-    MEM_SAFE_FREE(pf->data);
+    if (pf->data) {
+      MEM_freeN(pf->data);
+    }
+    else {
+      packedfile_lazy_data_free(pf);
+    }
     MEM_freeN(pf);
   }
   else {
@@ -168,12 +294,18 @@ void BKE_packedfile_free(PackedFile *pf)
 PackedFile *BKE_packedfile_duplicate(const PackedFile *pf_src)
 {
   BLI_assert(pf_src != NULL);
-  BLI_assert(pf_src->data != NULL);
-
   PackedFile *pf_dst;
 
   pf_dst = MEM_dupallocN(pf_src);
-  pf_dst->data = MEM_dupallocN(pf_src->data);
+  if (pf_src->data) {
+    pf_dst->data = MEM_dupallocN(pf_src->data);
+  }
+  else {
+    /* Copies don't need to load the data before it's used either. */
+    BlendFileLazyData *lazy_data = packedfile_lazy_data_duplicate(pf_src);
+    BLI_assert(lazy_data != NULL);
+    packedfile_lazy_data_set(pf_dst, lazy_data);
+  }
 
   return pf_dst;
 }
@@ -318,6 +450,11 @@ int BKE_packedfile_write_to_file(ReportList *reports,
   BLI_strncpy(name, filename, sizeof(name));
   BLI_path_abs(name, ref_file_name);
 
+  if (!BKE_packedfile_data_ensure(pf)) {
+    BKE_reportf(reports, RPT_ERROR, "Unable to read packed data of '%s'", name);
+    return RET_ERROR;
+  }
+
   if (BLI_exists(name)) {
     for (number = 1; number <= 999; number++) {
       BLI_snprintf(tempname, sizeof(tempname), "%s.%03d_", name, number);
@@ -396,7 +533,7 @@ enum ePF_FileCompare BKE_packedfile_compare_to_file(const char *ref_file_name,
   if (BLI_stat(name, &st) == -1) {
     ret_val = PF_CMP_NOFILE;
   }
-  else if (st.st_size != pf->size) {
+  else if (st.st_size != pf->size || !BKE_packedfile_data_ensure(pf)) {
     ret_val = PF_CMP_DIFFERS;
   }
   else {
@@ -534,7 +671,8 @@ static void unpack_generate_paths(const char *name,
     /* For images we can add the file extension based on the file magic. */
     if (id_type == ID_IM) {
       ImagePackedFile *imapf = ((Image *)id)->packedfiles.last;
-      if (imapf != NULL && imapf->packedfile != NULL) {
+      if (imapf != NULL && imapf->packedfile != NULL &&
+          BKE_packedfile_data_ensure(imapf->packedfile)) {
         const PackedFile *pf = imapf->packedfile;
         enum eImbFileType ftype = IMB_ispic_type_from_memory((const uchar *)pf->data, pf->size);
         if (ftype != IMB_FTYPE_NONE) {
@@ -878,6 +1016,23 @@ void BKE_packedfile_blend_write(BlendWriter *writer, PackedFile *pf)
   if (pf == NULL) {
     return;
   }
+  if (pf->data == NULL && BLO_write_is_undo(writer)) {
+    /* Undo steps only keep the location of data which isn't loaded yet, flagged by an invalid
+     * seek position, see #BKE_packedfile_blend_read. */
+    BLI_mutex_lock(&packedfile_lazy_data_lock);
+    BlendFileLazyData *lazy_data = packedfile_lazy_data_get(pf);
+    BLI_assert(lazy_data != NULL);
+    PackedFile pf_lazy = *pf;
+    pf_lazy.seek = PACKEDFILE_SEEK_LAZY;
+    pf_lazy.data = lazy_data;
+    BLO_write_struct_at_address(writer, PackedFile, pf, &pf_lazy);
+    BLO_write_raw(writer, sizeof(*lazy_data), lazy_data);
+    BLI_mutex_unlock(&packedfile_lazy_data_lock);
+    return;
+  }
+
+  /* Saving loads it first, see #BKE_packedfile_data_ensure_all. */
+  BLI_assert(pf->data != NULL);
   BLO_write_struct(writer, PackedFile, pf);
   BLO_write_raw(writer, pf->size, pf->data);
 }
@@ -890,6 +1045,20 @@ void BKE_packedfile_blend_read(BlendDataReader *reader, PackedFile **pf_p)
     return;
   }
 
+  /* Large data may not be read yet, see #BKE_packedfile_data_ensure. */
+  BlendFileLazyData *lazy_data = BLO_read_get_lazy_data(reader, pf->data);
+  if (lazy_data == NULL && pf->seek == PACKEDFILE_SEEK_LAZY) {
+    BLI_assert(BLO_read_data_is_undo(reader));
+    BLO_read_packed_address(reader, &pf->data);
+    lazy_data = pf->data;
+  }
+  if (lazy_data != NULL) {
+    pf->data = NULL;
+    pf->seek = 0;
+    packedfile_lazy_data_set(pf, lazy_data);
+    return;
+  }
+
   BLO_read_packed_address(reader, &pf->data);
   if (pf->data == NULL) {
     /* We cannot allow a PackedFile with a NULL data field,
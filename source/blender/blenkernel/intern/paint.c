@@ -1626,6 +1626,10 @@ static void sculpt_update_object(Depsgraph *depsgraph,
   /* tessfaces aren't used and will become invalid */
   BKE_mesh_tessface_clear(me);
 
+  /* Sculpt and paint modes write to the layers in-place, copy the ones still shared with the
+   * evaluated mesh. */
+  BKE_mesh_duplicate_referenced_layers(me);
+
   ss->shapekey_active = (mmd == NULL) ? BKE_keyblock_from_object(ob) : NULL;
 
   /* NOTE: Weight pPaint require mesh info for loop lookup, but it never uses multires code path,
@@ -1678,6 +1682,11 @@ static void sculpt_update_object(Depsgraph *depsgraph,
   BLI_assert(pbvh == ss->pbvh);
   UNUSED_VARS_NDEBUG(pbvh);
 
+  if (BKE_pbvh_type(ss->pbvh) == PBVH_FACES) {
+    /* The layers may have been copied above. */
+    BKE_pbvh_update_mesh_pointers(ss->pbvh, me);
+  }
+
   BKE_pbvh_subdiv_cgg_set(ss->pbvh, ss->subdiv_ccg);
   BKE_pbvh_face_sets_set(ss->pbvh, ss->face_sets);
 
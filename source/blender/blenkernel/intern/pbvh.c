@@ -622,6 +622,22 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   MEM_freeN(pbvh->vert_bitmap);
 }
 
+/**
+ * Update the pointers to the arrays of \a mesh, after they were reallocated without changing
+ * the topology (e.g. to copy layers shared with evaluated meshes).
+ */
+void BKE_pbvh_update_mesh_pointers(PBVH *pbvh, Mesh *mesh)
+{
+  BLI_assert(pbvh->type == PBVH_FACES);
+  pbvh->mesh = mesh;
+  pbvh->mpoly = mesh->mpoly;
+  pbvh->mloop = mesh->mloop;
+  /* Deformed coordinates are owned by the PBVH. */
+  if (!pbvh->deformed) {
+    pbvh->verts = mesh->mvert;
+  }
+}
+
 /* Do a full rebuild with on Grids data structure */
 void BKE_pbvh_build_grids(PBVH *pbvh,
                           CCGElem **grids,
@@ -0,0 +1,513 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ *
+ * Works like the sequencer prefetching (`sequencer/intern/prefetch.c`): every worker thread has
+ * its own dependency graph, registered in a separate #Main so it doesn't get tagged for updates
+ * of the original data while evaluating. Those are built on the main thread when the job starts.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_playback_prefetch.h"
+#include "BKE_pointcache.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+
+#include "CLG_log.h"
+
+static CLG_LogRef LOG = {"bke.playback_prefetch"};
+
+/* Dependency graphs evaluating frames at the same time, every one uses multiple threads too. */
+#define PLAYBACK_PREFETCH_WORKERS_MAX 8
+/* Frames evaluated ahead of the current one, per worker. */
+#define PLAYBACK_PREFETCH_FRAMES_PER_WORKER 2
+/* Playback steps without changes of the original data before prefetching starts again, so
+ * changes made during playback don't build new dependency graphs for every change. */
+#define PLAYBACK_PREFETCH_RESTART_STEPS 8
+
+/** Evaluated mesh of an object, owned by the frame. */
+typedef struct PlaybackPrefetchMesh {
+  struct Mesh *mesh_eval;
+  struct Mesh *mesh_deform_eval;
+  CustomData_MeshMasks data_mask;
+  bool need_mapping;
+} PlaybackPrefetchMesh;
+
+typedef struct PlaybackPrefetchFrame {
+  struct PlaybackPrefetchFrame *next, *prev;
+  int frame;
+  /** False while a worker is evaluating the frame. */
+  bool is_done;
+  /** Original #Object to #PlaybackPrefetchMesh. */
+  GHash *meshes;
+} PlaybackPrefetchFrame;
+
+typedef struct PlaybackPrefetchWorker {
+  struct PlaybackPrefetchJob *job;
+  struct Depsgraph *depsgraph;
+} PlaybackPrefetchWorker;
+
+typedef struct PlaybackPrefetchJob {
+  struct Scene *scene;
+  struct ViewLayer *view_layer;
+  struct Main *bmain_eval;
+
+  PlaybackPrefetchWorker workers[PLAYBACK_PREFETCH_WORKERS_MAX];
+  int workers_len;
+  ListBase threads;
+
+  /** Protects everything below. */
+  ThreadMutex mutex;
+  ThreadCondition cond;
+
+  /** Frames evaluated or being evaluated, see #PlaybackPrefetchFrame. */
+  ListBase frames;
+  /** Current frame of the playback and the direction of the following ones. */
+  int cfra;
+  bool reverse;
+  int frames_ahead;
+
+  bool stop;
+} PlaybackPrefetchJob;
+
+/* Only the scene which is played back is prefetched. Only changed from the main thread, with
+ * #prefetch_job_lock locked for writing. Other threads lock it for reading while using the job. */
+static PlaybackPrefetchJob *prefetch_job = NULL;
+static ThreadRWMutex prefetch_job_lock = BLI_RWLOCK_INITIALIZER;
+/* Playback steps left before the job is started again, after a change of the original data. */
+static int prefetch_restart_steps = 0;
+
+/* -------------------------------------------------------------------- */
+/** \name Frames
+ * \{ */
+
+static void prefetch_mesh_free(void *mesh_v)
+{
+  PlaybackPrefetchMesh *mesh = mesh_v;
+  BKE_id_free(NULL, mesh->mesh_eval);
+  if (mesh->mesh_deform_eval) {
+    BKE_id_free(NULL, mesh->mesh_deform_eval);
+  }
+  MEM_freeN(mesh);
+}
+
+static void prefetch_frame_free(PlaybackPrefetchFrame *frame)
+{
+  if (frame->meshes) {
+    BLI_ghash_free(frame->meshes, NULL, prefetch_mesh_free);
+  }
+  MEM_freeN(frame);
+}
+
+static PlaybackPrefetchFrame *prefetch_frame_find(PlaybackPrefetchJob *job, const int cfra)
+{
+  LISTBASE_FOREACH (PlaybackPrefetchFrame *, frame, &job->frames) {
+    if (frame->frame == cfra) {
+      return frame;
+    }
+  }
+  return NULL;
+}
+
+/** The \a step-th frame after the current one, wrapping around the playback range. */
+static int prefetch_frame_ahead(const PlaybackPrefetchJob *job, const int step)
+{
+  const Scene *scene = job->scene;
+  const int sfra = PSFRA;
+  const int efra = PEFRA;
+  const int range = efra - sfra + 1;
+  int cfra = job->cfra - sfra + (job->reverse ? -step : step);
+  cfra %= range;
+  if (cfra < 0) {
+    cfra += range;
+  }
+  return sfra + cfra;
+}
+
+static bool prefetch_frame_is_ahead(const PlaybackPrefetchJob *job, const int cfra)
+{
+  for (int step = 0; step < job->frames_ahead; step++) {
+    if (prefetch_frame_ahead(job, step) == cfra) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** Remove evaluated frames which playback won't reach soon, with the job locked. */
+static void prefetch_frames_remove_passed(PlaybackPrefetchJob *job)
+{
+  LISTBASE_FOREACH_MUTABLE (PlaybackPrefetchFrame *, frame, &job->frames) {
+    if (frame->is_done && !prefetch_frame_is_ahead(job, frame->frame)) {
+      BLI_remlink(&job->frames, frame);
+      prefetch_frame_free(frame);
+    }
+  }
+}
+
+/**
+ * Whether the evaluated mesh of \a ob depends on the time or on previous frames (simulations,
+ * point caches, particles). Workers evaluate frames out of order with inactive dependency graphs,
+ * so their results would be wrong, and the active dependency graph has to step simulations itself.
+ */
+static bool prefetch_object_is_time_dependent(Scene *scene, Object *ob)
+{
+  if (!BLI_listbase_is_empty(&ob->particlesystem) || ob->soft != NULL) {
+    return true;
+  }
+  LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+    if (BKE_modifier_depends_ontime(md)) {
+      return true;
+    }
+  }
+  return BKE_ptcache_object_has(scene, ob, 0);
+}
+
+/** Store copies of the evaluated meshes, sharing their data. */
+static GHash *prefetch_frame_meshes_collect(Depsgraph *depsgraph)
+{
+  GHash *meshes = BLI_ghash_ptr_new(__func__);
+  Scene *scene = DEG_get_evaluated_scene(depsgraph);
+
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         ob,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | DEG_ITER_OBJECT_FLAG_VISIBLE) {
+    /* Meshes without modifiers are cheap to evaluate and not owned by the object,
+     * sculpt and edit mode need more than the evaluated mesh. */
+    if (ob->type != OB_MESH || ob->mode != OB_MODE_OBJECT || !ob->runtime.is_data_eval_owned ||
+        ob->runtime.data_eval == NULL) {
+      continue;
+    }
+    if (prefetch_object_is_time_dependent(scene, ob)) {
+      continue;
+    }
+
+    PlaybackPrefetchMesh *mesh = MEM_callocN(sizeof(*mesh), __func__);
+    mesh->mesh_eval = BKE_mesh_copy_for_eval((Mesh *)ob->runtime.data_eval, true);
+    if (ob->runtime.mesh_deform_eval) {
+      mesh->mesh_deform_eval = BKE_mesh_copy_for_eval(ob->runtime.mesh_deform_eval, true);
+    }
+    mesh->data_mask = ob->runtime.last_data_mask;
+    mesh->need_mapping = ob->runtime.last_need_mapping;
+    BLI_ghash_insert(meshes, DEG_get_original_object(ob), mesh);
+  }
+  DEG_OBJECT_ITER_END;
+
+  return meshes;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Job
+ * \{ */
+
+/** Claim the next frame which isn't evaluated yet, with the job locked. */
+static PlaybackPrefetchFrame *prefetch_frame_claim(PlaybackPrefetchJob *job)
+{
+  /* The current frame is evaluated by the active dependency graph. */
+  for (int step = 1; step < job->frames_ahead; step++) {
+    const int cfra = prefetch_frame_ahead(job, step);
+    if (prefetch_frame_find(job, cfra) == NULL) {
+      PlaybackPrefetchFrame *frame = MEM_callocN(sizeof(*frame), __func__);
+      frame->frame = cfra;
+      BLI_addtail(&job->frames, frame);
+      return frame;
+    }
+  }
+  return NULL;
+}
+
+static void *prefetch_worker_run(void *worker_v)
+{
+  PlaybackPrefetchWorker *worker = worker_v;
+  PlaybackPrefetchJob *job = worker->job;
+
+  BLI_mutex_lock(&job->mutex);
+  while (!job->stop) {
+    PlaybackPrefetchFrame *frame = prefetch_frame_claim(job);
+    if (frame == NULL) {
+      /* Wait for playback to advance. */
+      BLI_condition_wait(&job->cond, &job->mutex);
+      continue;
+    }
+    BLI_mutex_unlock(&job->mutex);
+
+    DEG_evaluate_on_framechange(worker->depsgraph, (float)frame->frame);
+    GHash *meshes = prefetch_frame_meshes_collect(worker->depsgraph);
+
+    BLI_mutex_lock(&job->mutex);
+    frame->meshes = meshes;
+    frame->is_done = true;
+    /* Playback might have passed the frame already. */
+    prefetch_frames_remove_passed(job);
+  }
+  BLI_mutex_unlock(&job->mutex);
+
+  return NULL;
+}
+
+static PlaybackPrefetchJob *prefetch_job_start(Scene *scene, ViewLayer *view_layer)
+{
+  PlaybackPrefetchJob *job = MEM_callocN(sizeof(*job), __func__);
+  job->scene = scene;
+  job->view_layer = view_layer;
+  job->bmain_eval = BKE_main_new();
+  job->workers_len = clamp_i(BLI_system_thread_count() / 8, 1, PLAYBACK_PREFETCH_WORKERS_MAX);
+  job->frames_ahead = 1 + job->workers_len * PLAYBACK_PREFETCH_FRAMES_PER_WORKER;
+  BLI_mutex_init(&job->mutex);
+  BLI_condition_init(&job->cond);
+
+  BLI_threadpool_init(&job->threads, prefetch_worker_run, job->workers_len);
+  for (int i = 0; i < job->workers_len; i++) {
+    PlaybackPrefetchWorker *worker = &job->workers[i];
+    worker->job = job;
+    worker->depsgraph = DEG_graph_new(job->bmain_eval, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_debug_name_set(worker->depsgraph, "PLAYBACK PREFETCH");
+    DEG_graph_build_from_view_layer(worker->depsgraph);
+  }
+
+  CLOG_INFO(&LOG, 1, "Start prefetching \"%s\", %d workers", scene->id.name + 2, job->workers_len);
+
+  return job;
+}
+
+static void prefetch_job_free(PlaybackPrefetchJob *job)
+{
+  BLI_mutex_lock(&job->mutex);
+  job->stop = true;
+  BLI_condition_notify_all(&job->cond);
+  BLI_mutex_unlock(&job->mutex);
+  BLI_threadpool_end(&job->threads);
+
+  for (int i = 0; i < job->workers_len; i++) {
+    DEG_graph_free(job->workers[i].depsgraph);
+  }
+  LISTBASE_FOREACH_MUTABLE (PlaybackPrefetchFrame *, frame, &job->frames) {
+    prefetch_frame_free(frame);
+  }
+  BKE_main_free(job->bmain_eval);
+  BLI_mutex_end(&job->mutex);
+  BLI_condition_end(&job->cond);
+  MEM_freeN(job);
+}
+
+/** Replace the current job, waiting until no other thread uses it before freeing it. */
+static void prefetch_job_set(PlaybackPrefetchJob *job)
+{
+  BLI_assert(BLI_thread_is_main());
+
+  BLI_rw_mutex_lock(&prefetch_job_lock, THREAD_LOCK_WRITE);
+  PlaybackPrefetchJob *job_prev = prefetch_job;
+  prefetch_job = job;
+  BLI_rw_mutex_unlock(&prefetch_job_lock);
+
+  if (job_prev) {
+    prefetch_job_free(job_prev);
+  }
+}
+
+/**
+ * Called for every playback step before evaluating the new current frame of \a scene:
+ * starts prefetching or moves on to the next frames.
+ */
+void BKE_playback_prefetch_update(Main *UNUSED(bmain),
+                                  Scene *scene,
+                                  ViewLayer *view_layer,
+                                  const bool reverse)
+{
+  BLI_assert(BLI_thread_is_main());
+
+  if (prefetch_job && (prefetch_job->scene != scene || prefetch_job->view_layer != view_layer ||
+                       (scene->flag & SCE_PLAYBACK_PREFETCH) == 0)) {
+    prefetch_job_set(NULL);
+  }
+  if ((scene->flag & SCE_PLAYBACK_PREFETCH) == 0) {
+    return;
+  }
+  if (prefetch_restart_steps > 0) {
+    prefetch_restart_steps--;
+    return;
+  }
+
+  const bool start = (prefetch_job == NULL);
+  if (start) {
+    prefetch_job_set(prefetch_job_start(scene, view_layer));
+  }
+
+  PlaybackPrefetchJob *job = prefetch_job;
+  BLI_mutex_lock(&job->mutex);
+  job->cfra = scene->r.cfra;
+  job->reverse = reverse;
+  prefetch_frames_remove_passed(job);
+  BLI_condition_notify_all(&job->cond);
+  BLI_mutex_unlock(&job->mutex);
+
+  if (start) {
+    for (int i = 0; i < job->workers_len; i++) {
+      BLI_threadpool_insert(&job->threads, &job->workers[i]);
+    }
+  }
+}
+
+/** Stop prefetching for \a scene, when playback stops or the scene is freed. */
+void BKE_playback_prefetch_stop(Scene *scene)
+{
+  if (scene == NULL || (prefetch_job && prefetch_job->scene == scene)) {
+    prefetch_job_set(NULL);
+    /* Starting playback again starts prefetching right away. */
+    prefetch_restart_steps = 0;
+  }
+}
+
+/** Whether frames of \a scene are being prefetched. */
+bool BKE_playback_prefetch_is_running(const Scene *scene)
+{
+  BLI_assert(BLI_thread_is_main());
+  return prefetch_job && prefetch_job->scene == scene;
+}
+
+/**
+ * Original data was changed, prefetched frames are outdated. The job is started again once
+ * playback went on for #PLAYBACK_PREFETCH_RESTART_STEPS steps without further changes, building
+ * new dependency graphs (their relations might have changed too).
+ */
+void BKE_playback_prefetch_tag_update(Main *UNUSED(bmain), const int recalc)
+{
+  /* Evaluation might tag original data, the workers are stopped from the main thread. */
+  if (!BLI_thread_is_main()) {
+    return;
+  }
+  /* Changes which don't affect the evaluated geometry. */
+  const int recalc_ignore = ID_RECALC_SELECT | ID_RECALC_EDITORS | ID_RECALC_AUDIO_SEEK |
+                            ID_RECALC_AUDIO_FPS | ID_RECALC_AUDIO_VOLUME | ID_RECALC_AUDIO_MUTE |
+                            ID_RECALC_AUDIO_LISTENER | ID_RECALC_AUDIO;
+  if (recalc != 0 && (recalc & ~recalc_ignore) == 0) {
+    return;
+  }
+  prefetch_restart_steps = PLAYBACK_PREFETCH_RESTART_STEPS;
+  if (prefetch_job) {
+    prefetch_job_set(NULL);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Evaluation
+ * \{ */
+
+/** Use the data-blocks of \a mesh_input instead of the ones of the worker's dependency graph. */
+static void prefetch_mesh_remap_ids(Mesh *mesh, const Mesh *mesh_input)
+{
+  mesh->key = mesh_input->key;
+  mesh->texcomesh = mesh_input->texcomesh;
+  if (mesh->totcol == mesh_input->totcol && mesh->totcol) {
+    memcpy(mesh->mat, mesh_input->mat, sizeof(*mesh->mat) * (size_t)mesh->totcol);
+  }
+}
+
+/**
+ * Get the prefetched evaluated mesh of \a ob for the frame \a depsgraph is evaluating,
+ * when it was evaluated with the same data mask. Only for the active dependency graph.
+ */
+bool BKE_playback_prefetch_mesh_get(Depsgraph *depsgraph,
+                                    Object *ob,
+                                    const CustomData_MeshMasks *data_mask,
+                                    const bool need_mapping,
+                                    Mesh **r_mesh_eval,
+                                    Mesh **r_mesh_deform_eval)
+{
+  if (!DEG_is_active(depsgraph) || ob->mode != OB_MODE_OBJECT) {
+    return false;
+  }
+  /* Not collected, but settings might have changed since (the job is restarted then). */
+  if (prefetch_object_is_time_dependent(DEG_get_evaluated_scene(depsgraph), ob)) {
+    return false;
+  }
+  const float ctime = DEG_get_ctime(depsgraph);
+  if (ctime != (float)(int)ctime) {
+    return false;
+  }
+
+  /* Called from the threads evaluating the active dependency graph, while the main thread might
+   * stop the job (it doesn't wait for the evaluation to be done). */
+  BLI_rw_mutex_lock(&prefetch_job_lock, THREAD_LOCK_READ);
+  PlaybackPrefetchJob *job = prefetch_job;
+  if (job == NULL || DEG_get_input_scene(depsgraph) != job->scene ||
+      DEG_get_input_view_layer(depsgraph) != job->view_layer) {
+    BLI_rw_mutex_unlock(&prefetch_job_lock);
+    return false;
+  }
+
+  bool found = false;
+  BLI_mutex_lock(&job->mutex);
+  PlaybackPrefetchFrame *frame = prefetch_frame_find(job, (int)ctime);
+  if (frame && frame->is_done) {
+    PlaybackPrefetchMesh *mesh = BLI_ghash_lookup(frame->meshes, DEG_get_original_object(ob));
+    Mesh *mesh_input = ob->data;
+    if (mesh && mesh->need_mapping == need_mapping &&
+        CustomData_MeshMasks_are_matching(&mesh->data_mask, data_mask) &&
+        mesh->mesh_eval->totcol == mesh_input->totcol) {
+      *r_mesh_eval = BKE_mesh_copy_for_eval(mesh->mesh_eval, true);
+      *r_mesh_deform_eval = mesh->mesh_deform_eval ?
+                                BKE_mesh_copy_for_eval(mesh->mesh_deform_eval, true) :
+                                NULL;
+      found = true;
+    }
+  }
+  BLI_mutex_unlock(&job->mutex);
+  BLI_rw_mutex_unlock(&prefetch_job_lock);
+
+  if (found) {
+    prefetch_mesh_remap_ids(*r_mesh_eval, ob->data);
+    if (*r_mesh_deform_eval) {
+      prefetch_mesh_remap_ids(*r_mesh_deform_eval, ob->data);
+    }
+  }
+
+  return found;
+}
+
+/** \} */
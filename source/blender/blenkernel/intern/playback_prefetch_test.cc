@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <atomic>
+#include <thread>
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_playback_prefetch.h"
+#include "BKE_scene.h"
+
+#include "BLI_threads.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "IMB_imbuf.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "CLG_log.h"
+
+namespace blender::bke::tests {
+
+class PlaybackPrefetchTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    /* Color management, used by the scene defaults. */
+    IMB_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestCase()
+  {
+    DEG_free_node_types();
+    IMB_exit();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  virtual void SetUp()
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    scene->flag |= SCE_PLAYBACK_PREFETCH;
+    view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+  }
+
+  virtual void TearDown()
+  {
+    BKE_playback_prefetch_stop(nullptr);
+    BKE_main_free(bmain);
+  }
+
+  void playback_step()
+  {
+    scene->r.cfra = (scene->r.cfra < scene->r.efra) ? scene->r.cfra + 1 : scene->r.sfra;
+    BKE_playback_prefetch_update(bmain, scene, view_layer, false);
+  }
+
+  /* Playback steps until prefetching starts, -1 when it doesn't start within \a steps_max. */
+  int playback_steps_until_running(const int steps_max)
+  {
+    for (int step = 0; step < steps_max; step++) {
+      playback_step();
+      if (BKE_playback_prefetch_is_running(scene)) {
+        return step;
+      }
+    }
+    return -1;
+  }
+};
+
+TEST_F(PlaybackPrefetchTest, StartStop)
+{
+  playback_step();
+  EXPECT_TRUE(BKE_playback_prefetch_is_running(scene));
+
+  BKE_playback_prefetch_stop(scene);
+  EXPECT_FALSE(BKE_playback_prefetch_is_running(scene));
+
+  playback_step();
+  EXPECT_TRUE(BKE_playback_prefetch_is_running(scene));
+
+  scene->flag &= ~SCE_PLAYBACK_PREFETCH;
+  playback_step();
+  EXPECT_FALSE(BKE_playback_prefetch_is_running(scene));
+}
+
+TEST_F(PlaybackPrefetchTest, TagUpdateIgnored)
+{
+  playback_step();
+  BKE_playback_prefetch_tag_update(bmain, ID_RECALC_SELECT);
+  EXPECT_TRUE(BKE_playback_prefetch_is_running(scene));
+}
+
+TEST_F(PlaybackPrefetchTest, TagUpdateRestartDelayed)
+{
+  playback_step();
+  BKE_playback_prefetch_tag_update(bmain, ID_RECALC_GEOMETRY);
+  EXPECT_FALSE(BKE_playback_prefetch_is_running(scene));
+
+  /* Not started again right away. */
+  const int steps_restart = playback_steps_until_running(100);
+  EXPECT_GT(steps_restart, 0);
+
+  /* Changes on every step (for e.g. editing during playback) keep it stopped. */
+  BKE_playback_prefetch_tag_update(bmain, ID_RECALC_GEOMETRY);
+  for (int step = 0; step < steps_restart * 2; step++) {
+    playback_step();
+    EXPECT_FALSE(BKE_playback_prefetch_is_running(scene));
+    BKE_playback_prefetch_tag_update(bmain, ID_RECALC_GEOMETRY);
+  }
+
+  EXPECT_EQ(playback_steps_until_running(100), steps_restart);
+}
+
+TEST_F(PlaybackPrefetchTest, MeshGetWhileStopping)
+{
+  Depsgraph *depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+  DEG_graph_build_from_view_layer(depsgraph);
+  DEG_make_active(depsgraph);
+
+  Object ob = {{nullptr}};
+  ob.type = OB_MESH;
+  ob.mode = OB_MODE_OBJECT;
+
+  /* Look up meshes from other threads, like the evaluation of the active dependency graph,
+   * while the main thread stops and starts the job. */
+  std::atomic<bool> stop(false);
+  std::thread lookup_thread([&]() {
+    while (!stop) {
+      Mesh *mesh_eval = nullptr, *mesh_deform_eval = nullptr;
+      CustomData_MeshMasks data_mask = {0};
+      EXPECT_FALSE(BKE_playback_prefetch_mesh_get(
+          depsgraph, &ob, &data_mask, false, &mesh_eval, &mesh_deform_eval));
+    }
+  });
+
+  for (int i = 0; i < 20; i++) {
+    playback_steps_until_running(100);
+    BKE_playback_prefetch_tag_update(bmain, ID_RECALC_GEOMETRY);
+  }
+
+  stop = true;
+  lookup_thread.join();
+  DEG_graph_free(depsgraph);
+}
+
+}  // namespace blender::bke::tests
@@ -91,6 +91,7 @@
 #include "BKE_node.h"
 #include "BKE_object.h"
 #include "BKE_paint.h"
+#include "BKE_playback_prefetch.h"
 #include "BKE_pointcache.h"
 #include "BKE_rigidbody.h"
 #include "BKE_scene.h"
@@ -372,6 +373,7 @@ static void scene_free_data(ID *id)
   Scene *scene = (Scene *)id;
   const bool do_id_user = false;
 
+  BKE_playback_prefetch_stop(scene);
   BKE_sequencer_editing_free(scene, do_id_user);
 
   BKE_keyingsets_free(&scene->keyingsets);
@@ -99,6 +99,10 @@ typedef struct ShrinkwrapCalcCBData {
 
   float *proj_axis;
   SpaceTransform *local2aux;
+
+  /* Batched nearest search: vertex coordinates in target space and their results. */
+  float (*tree_co)[3];
+  BVHTreeNearest *nearest;
 } ShrinkwrapCalcCBData;
 
 /* Checks if the modifier needs target normals with these settings. */
@@ -345,6 +349,67 @@ void BKE_shrinkwrap_compute_boundary_data(struct Mesh *mesh)
   mesh->runtime.shrinkwrap_data = shrinkwrap_build_boundary_data(mesh);
 }
 
+static float shrinkwrap_calc_vert_weight(const ShrinkwrapCalcData *calc, const int i)
+{
+  const float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
+  return calc->invert_vgroup ? 1.0f - weight : weight;
+}
+
+/**
+ * Fill the coordinates of the batched nearest search in target space.
+ * Vertices with a zero weight are skipped by using a zero search distance.
+ */
+static void shrinkwrap_calc_nearest_batch_init_cb_ex(void *__restrict userdata,
+                                                     const int i,
+                                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
+  ShrinkwrapCalcData *calc = data->calc;
+  BVHTreeNearest *nearest = &data->nearest[i];
+
+  nearest->index = -1;
+  nearest->dist_sq = (shrinkwrap_calc_vert_weight(calc, i) == 0.0f) ? 0.0f : FLT_MAX;
+
+  /* Convert the vertex to tree coordinates */
+  if (calc->vert) {
+    copy_v3_v3(data->tree_co[i], calc->vert[i].co);
+  }
+  else {
+    copy_v3_v3(data->tree_co[i], calc->vertexCos[i]);
+  }
+  BLI_space_transform_apply(&calc->local2target, data->tree_co[i]);
+}
+
+/**
+ * Find the nearest target elements of all vertices at once with #BLI_bvhtree_find_nearest_batch,
+ * the results are stored in `data->nearest`.
+ */
+static void shrinkwrap_calc_nearest_batch(ShrinkwrapCalcCBData *data,
+                                          BVHTree *bvh,
+                                          BVHTree_NearestPointCallback callback,
+                                          void *userdata)
+{
+  ShrinkwrapCalcData *calc = data->calc;
+
+  data->tree_co = MEM_malloc_arrayN((size_t)calc->numVerts, sizeof(float[3]), __func__);
+  data->nearest = MEM_malloc_arrayN((size_t)calc->numVerts, sizeof(BVHTreeNearest), __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
+  BLI_task_parallel_range(
+      0, calc->numVerts, data, shrinkwrap_calc_nearest_batch_init_cb_ex, &settings);
+
+  BLI_bvhtree_find_nearest_batch(
+      bvh, (const float(*)[3])data->tree_co, calc->numVerts, data->nearest, callback, userdata);
+}
+
+static void shrinkwrap_calc_nearest_batch_free(ShrinkwrapCalcCBData *data)
+{
+  MEM_freeN(data->tree_co);
+  MEM_freeN(data->nearest);
+}
+
 /**
  * Shrink-wrap to the nearest vertex
  *
@@ -353,48 +418,16 @@ void BKE_shrinkwrap_compute_boundary_data(struct Mesh *mesh)
  */
 static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
                                                  const int i,
-                                                 const TaskParallelTLS *__restrict tls)
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
 {
   ShrinkwrapCalcCBData *data = userdata;
 
   ShrinkwrapCalcData *calc = data->calc;
-  BVHTreeFromMesh *treeData = &data->tree->treeData;
-  BVHTreeNearest *nearest = tls->userdata_chunk;
+  BVHTreeNearest *nearest = &data->nearest[i];
 
   float *co = calc->vertexCos[i];
   float tmp_co[3];
-  float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
-
-  if (calc->invert_vgroup) {
-    weight = 1.0f - weight;
-  }
-
-  if (weight == 0.0f) {
-    return;
-  }
-
-  /* Convert the vertex to tree coordinates */
-  if (calc->vert) {
-    copy_v3_v3(tmp_co, calc->vert[i].co);
-  }
-  else {
-    copy_v3_v3(tmp_co, co);
-  }
-  BLI_space_transform_apply(&calc->local2target, tmp_co);
-
-  /* Use local proximity heuristics (to reduce the nearest search)
-   *
-   * If we already had an hit before.. we assume this vertex is going to have a close hit to that
-   * other vertex so we can initiate the "nearest.dist" with the expected value to that last hit.
-   * This will lead in pruning of the search tree. */
-  if (nearest->index != -1) {
-    nearest->dist_sq = len_squared_v3v3(tmp_co, nearest->co);
-  }
-  else {
-    nearest->dist_sq = FLT_MAX;
-  }
-
-  BLI_bvhtree_find_nearest(treeData->tree, tmp_co, nearest, treeData->nearest_callback, treeData);
+  float weight = shrinkwrap_calc_vert_weight(calc, i);
 
   /* Found the nearest vertex */
   if (nearest->index != -1) {
@@ -415,23 +448,21 @@ static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
 
 static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 {
-  BVHTreeNearest nearest = NULL_BVHTreeNearest;
-
-  /* Setup nearest */
-  nearest.index = -1;
-  nearest.dist_sq = FLT_MAX;
+  BVHTreeFromMesh *treeData = &calc->tree->treeData;
 
   ShrinkwrapCalcCBData data = {
       .calc = calc,
       .tree = calc->tree,
   };
+  shrinkwrap_calc_nearest_batch(&data, treeData->tree, treeData->nearest_callback, treeData);
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
-  settings.userdata_chunk = &nearest;
-  settings.userdata_chunk_size = sizeof(nearest);
   BLI_task_parallel_range(
       0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
+
+  shrinkwrap_calc_nearest_batch_free(&data);
 }
 
 /*
@@ -1134,49 +1165,40 @@ static void shrinkwrap_calc_nearest_surface_point_cb_ex(void *__restrict userdat
   ShrinkwrapCalcCBData *data = userdata;
 
   ShrinkwrapCalcData *calc = data->calc;
-  BVHTreeNearest *nearest = tls->userdata_chunk;
+  BVHTreeNearest *nearest;
 
   float *co = calc->vertexCos[i];
   float tmp_co[3];
-  float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
-
-  if (calc->invert_vgroup) {
-    weight = 1.0f - weight;
-  }
+  float weight = shrinkwrap_calc_vert_weight(calc, i);
 
   if (weight == 0.0f) {
     return;
   }
 
-  /* Convert the vertex to tree coordinates */
-  if (calc->vert) {
-    copy_v3_v3(tmp_co, calc->vert[i].co);
+  if (data->nearest) {
+    /* Already found by the batched search. */
+    nearest = &data->nearest[i];
+    copy_v3_v3(tmp_co, data->tree_co[i]);
   }
   else {
-    copy_v3_v3(tmp_co, co);
-  }
-  BLI_space_transform_apply(&calc->local2target, tmp_co);
+    nearest = tls->userdata_chunk;
 
-  /* Use local proximity heuristics (to reduce the nearest search)
-   *
-   * If we already had an hit before.. we assume this vertex is going to have a close hit to that
-   * other vertex so we can initiate the "nearest.dist" with the expected value to that last hit.
-   * This will lead in pruning of the search tree. */
-  if (nearest->index != -1) {
-    if (calc->smd->shrinkType == MOD_SHRINKWRAP_TARGET_PROJECT) {
-      /* Heuristic doesn't work because of additional restrictions. */
-      nearest->index = -1;
-      nearest->dist_sq = FLT_MAX;
+    /* Convert the vertex to tree coordinates */
+    if (calc->vert) {
+      copy_v3_v3(tmp_co, calc->vert[i].co);
     }
     else {
-      nearest->dist_sq = len_squared_v3v3(tmp_co, nearest->co);
+      copy_v3_v3(tmp_co, co);
     }
-  }
-  else {
+    BLI_space_transform_apply(&calc->local2target, tmp_co);
+
+    /* Local proximity heuristics don't work with target projection
+     * because of additional restrictions. */
+    nearest->index = -1;
     nearest->dist_sq = FLT_MAX;
-  }
 
-  BKE_shrinkwrap_find_nearest_surface(data->tree, nearest, tmp_co, calc->smd->shrinkType);
+    BKE_shrinkwrap_find_nearest_surface(data->tree, nearest, tmp_co, calc->smd->shrinkType);
+  }
 
   /* Found the nearest vertex */
   if (nearest->index != -1) {
@@ -1395,6 +1417,13 @@ static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
       .calc = calc,
       .tree = calc->tree,
   };
+
+  /* Target projection needs a per vertex search with a special callback. */
+  if (calc->smd->shrinkType != MOD_SHRINKWRAP_TARGET_PROJECT) {
+    BVHTreeFromMesh *treeData = &calc->tree->treeData;
+    shrinkwrap_calc_nearest_batch(&data, calc->tree->bvh, treeData->nearest_callback, treeData);
+  }
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
@@ -1402,6 +1431,10 @@ static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
   settings.userdata_chunk_size = sizeof(nearest);
   BLI_task_parallel_range(
       0, calc->numVerts, &data, shrinkwrap_calc_nearest_surface_point_cb_ex, &settings);
+
+  if (data.nearest) {
+    shrinkwrap_calc_nearest_batch_free(&data);
+  }
 }
 
 /* Main shrinkwrap function */
@@ -543,7 +543,7 @@ static void sound_load_audio(Main *bmain, bSound *sound, bool free_waveform)
     BLI_path_abs(fullpath, ID_BLEND_PATH(bmain, &sound->id));
 
     /* but we need a packed file then */
-    if (pf) {
+    if (pf && BKE_packedfile_data_ensure(pf)) {
       sound->handle = AUD_Sound_bufferFile((unsigned char *)pf->data, pf->size);
     }
     else {
@@ -38,6 +38,7 @@ typedef struct KDTreeNearest {
 KDTree *BLI_kdtree_nd_(new)(unsigned int maxsize);
 void BLI_kdtree_nd_(free)(KDTree *tree);
 void BLI_kdtree_nd_(balance)(KDTree *tree) ATTR_NONNULL(1);
+int BLI_kdtree_nd_(refit)(KDTree *tree, const float (*co)[KD_DIMS]) ATTR_NONNULL(1, 2);
 
 void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS]) ATTR_NONNULL(1, 3);
 int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
@@ -48,6 +49,12 @@ int BLI_kdtree_nd_(find_nearest_n)(const KDTree *tree,
                                    const float co[KD_DIMS],
                                    KDTreeNearest *r_nearest,
                                    const uint nearest_len_capacity) ATTR_NONNULL(1, 2, 3);
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          const uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          const uint nearest_len_capacity,
+                                          int *r_nearest_len) ATTR_NONNULL(1, 2, 4);
 
 int BLI_kdtree_nd_(range_search)(const KDTree *tree,
                                  const float co[KD_DIMS],
@@ -83,6 +83,13 @@ enum {
    * order of allocation when no chunks have been freed.
    */
   BLI_MEMPOOL_ALLOW_ITER = (1 << 0),
+  /** Allow allocating and freeing elements from multiple threads at once.
+   *
+   * \note Each thread uses its own free list, taking free elements from the other threads
+   * before allocating new chunks. Other operations (iterating, clearing... etc)
+   * must not run while elements are allocated or freed.
+   */
+  BLI_MEMPOOL_THREADSAFE = (1 << 1),
 };
 
 void BLI_mempool_iternew(BLI_mempool *pool, BLI_mempool_iter *iter) ATTR_NONNULL();
@@ -0,0 +1,125 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * OHash is an open-addressing hash-map (unordered key, value pairs) with the same API as #GHash.
+ *
+ * Keys, values and hashes are stored in a single array of slots, so lookups don't follow
+ * pointers to separately allocated entries (as #GHash does), which is much more cache friendly.
+ * Use it for maps which are hot in profiles, the hashing and comparison callbacks from
+ * `BLI_ghash.h` can be used as-is.
+ *
+ * \note Pointers returned by #BLI_ohash_lookup_p and #BLI_ohash_ensure_p
+ * are only valid until the next insertion (which may grow the table).
+ */
+
+#include "BLI_compiler_attrs.h"
+#include "BLI_ghash.h"
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct OHash OHash;
+
+typedef struct OHashIterator {
+  OHash *oh;
+  /** Index of the current slot, the table size when done. */
+  unsigned int slot_index;
+} OHashIterator;
+
+/* -------------------------------------------------------------------- */
+/** \name OHash API
+ *
+ * Defined in ``BLI_ohash.c``
+ * \{ */
+
+OHash *BLI_ohash_new_ex(GHashHashFP hashfp,
+                        GHashCmpFP cmpfp,
+                        const char *info,
+                        const unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_new(GHashHashFP hashfp,
+                     GHashCmpFP cmpfp,
+                     const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void BLI_ohash_free(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+void BLI_ohash_reserve(OHash *oh, const unsigned int nentries_reserve);
+void BLI_ohash_insert(OHash *oh, void *key, void *val);
+bool BLI_ohash_reinsert(
+    OHash *oh, void *key, void *val, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+void *BLI_ohash_lookup(const OHash *oh, const void *key) ATTR_WARN_UNUSED_RESULT;
+void *BLI_ohash_lookup_default(const OHash *oh,
+                               const void *key,
+                               void *val_default) ATTR_WARN_UNUSED_RESULT;
+void **BLI_ohash_lookup_p(OHash *oh, const void *key) ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohash_ensure_p(OHash *oh, void *key, void ***r_val) ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohash_ensure_p_ex(OHash *oh, const void *key, void ***r_key, void ***r_val)
+    ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohash_remove(OHash *oh,
+                      const void *key,
+                      GHashKeyFreeFP keyfreefp,
+                      GHashValFreeFP valfreefp);
+void BLI_ohash_clear(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+void *BLI_ohash_popkey(OHash *oh,
+                       const void *key,
+                       GHashKeyFreeFP keyfreefp) ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohash_haskey(const OHash *oh, const void *key) ATTR_WARN_UNUSED_RESULT;
+unsigned int BLI_ohash_len(const OHash *oh) ATTR_WARN_UNUSED_RESULT;
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name OHash Iterator
+ *
+ * Removing the current item while iterating is supported, inserting is not.
+ * \{ */
+
+void BLI_ohashIterator_init(OHashIterator *ohi, OHash *oh);
+void BLI_ohashIterator_step(OHashIterator *ohi);
+void *BLI_ohashIterator_getKey(OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+void *BLI_ohashIterator_getValue(OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+void **BLI_ohashIterator_getValue_p(OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+bool BLI_ohashIterator_done(const OHashIterator *ohi) ATTR_WARN_UNUSED_RESULT;
+
+#define OHASH_ITER(oh_iter_, ohash_) \
+  for (BLI_ohashIterator_init(&oh_iter_, ohash_); BLI_ohashIterator_done(&oh_iter_) == false; \
+       BLI_ohashIterator_step(&oh_iter_))
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name OHash Creation Wrappers
+ * \{ */
+
+OHash *BLI_ohash_ptr_new_ex(const char *info, const unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_ptr_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_str_new_ex(const char *info, const unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_str_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_int_new_ex(const char *info, const unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+OHash *BLI_ohash_int_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+
+/** \} */
+
+#ifdef __cplusplus
+}
+#endif
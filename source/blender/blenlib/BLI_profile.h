@@ -0,0 +1,105 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Low overhead trace profiling, enabled at run-time (`--profile` command line argument).
+ *
+ * Code marks the begin and end of a scope, every thread records these in its own ring buffer
+ * (the oldest events are overwritten when it's full). The recorded events are written as a
+ * Chrome trace JSON file, which can be opened in `chrome://tracing` or Perfetto.
+ *
+ * When profiling is disabled a marker only costs the check of a global flag.
+ *
+ * Names must be static strings, they're only stored as pointers.
+ */
+
+#include "BLI_sys_types.h"
+#include "BLI_utildefines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Don't access directly, use #BLI_profile_is_enabled. */
+extern bool bli_profile_is_enabled;
+
+BLI_INLINE bool BLI_profile_is_enabled(void)
+{
+  return bli_profile_is_enabled;
+}
+
+void BLI_profile_enable(const char *filepath);
+bool BLI_profile_write(void);
+void BLI_profile_clear(void);
+
+uint64_t BLI_profile_time_get(void);
+void BLI_profile_event_add(const char *name, const uint64_t time_begin);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * Markers for C code, the scope between begin and end must not be left early.
+ *
+ * \code{.c}
+ * BLI_PROFILE_BEGIN(mesh_calc);
+ * ...
+ * BLI_PROFILE_END(mesh_calc, "mesh_calc_modifiers");
+ * \endcode
+ */
+#define BLI_PROFILE_BEGIN(id) \
+  const uint64_t _profile_begin_##id = BLI_profile_is_enabled() ? BLI_profile_time_get() : 0
+
+#define BLI_PROFILE_END(id, name) \
+  if (_profile_begin_##id != 0) { \
+    BLI_profile_event_add(name, _profile_begin_##id); \
+  } \
+  ((void)0)
+
+#ifdef __cplusplus
+
+namespace blender::profile {
+
+/** Records an event for its lifetime. */
+class ScopedMarker {
+ private:
+  const char *name_;
+  uint64_t begin_;
+
+ public:
+  ScopedMarker(const char *name)
+      : name_(name), begin_(BLI_profile_is_enabled() ? BLI_profile_time_get() : 0)
+  {
+  }
+
+  ~ScopedMarker()
+  {
+    if (begin_ != 0) {
+      BLI_profile_event_add(name_, begin_);
+    }
+  }
+};
+
+}  // namespace blender::profile
+
+#  define BLI_PROFILE_SCOPE(name) blender::profile::ScopedMarker _profile_scope(name)
+
+#endif
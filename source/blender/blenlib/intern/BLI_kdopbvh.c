@@ -44,6 +44,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -1469,7 +1470,9 @@ int *BLI_bvhtree_intersect_plane(BVHTree *tree, float plane[4], uint *r_intersec
 
 /* Determines the nearest point of the given node BV.
  * Returns the squared distance to that point. */
-static float calc_nearest_point_squared(const float proj[3], BVHNode *node, float nearest[3])
+static float calc_nearest_point_squared(const float proj[3],
+                                        const BVHNode *node,
+                                        float nearest[3])
 {
   int i;
   const float *bv = node->bv;
@@ -2058,6 +2061,375 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_find_nearest_batch / BLI_bvhtree_ray_cast_batch
+ *
+ * Batched queries traverse the tree with packets of #BVH_PACKET_SIZE queries at once.
+ * Each node is visited once for the whole packet, its bounds are tested against all queries
+ * of the packet together (loops over per-axis arrays which the compiler can vectorize)
+ * and only the queries which pass the test continue into the children.
+ *
+ * This works best when consecutive queries are spatially coherent (as the vertices of a mesh
+ * usually are), since they then tend to visit the same nodes.
+ *
+ * \{ */
+
+#define BVH_PACKET_SIZE 8
+
+typedef struct BVHNearestPacket {
+  const BVHTree *tree;
+  BVHTree_NearestPointCallback callback;
+  void *userdata;
+
+  const float (*co)[3];
+  BVHTreeNearest *nearest;
+
+  /* Coordinates and current nearest squared distances of the packet, stored per axis.
+   * Unused entries have a zero distance, so they never pass a bounds test. */
+  float co_axis[3][BVH_PACKET_SIZE];
+  float dist_sq[BVH_PACKET_SIZE];
+} BVHNearestPacket;
+
+typedef struct BVHRayCastPacket {
+  const BVHTree *tree;
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+
+  BVHTreeRay ray[BVH_PACKET_SIZE];
+#ifdef USE_KDOPBVH_WATERTIGHT
+  struct IsectRayPrecalc isect_precalc[BVH_PACKET_SIZE];
+#endif
+  BVHTreeRayHit *hit;
+
+  /* Sum of the ray directions, to pick the order to dive into the tree. */
+  float direction_sum[3];
+
+  /* Ray origins, inverse directions and current hit distances of the packet, stored per axis.
+   * Unused entries have a zero distance, so they never pass a bounds test. */
+  float origin_axis[3][BVH_PACKET_SIZE];
+  float idot_axis[3][BVH_PACKET_SIZE];
+  float dist[BVH_PACKET_SIZE];
+  float radius;
+} BVHRayCastPacket;
+
+typedef struct BVHBatchData {
+  const BVHTree *tree;
+  int queries_num;
+
+  const float (*co)[3];
+  const float (*dir)[3];
+  float radius;
+  int flag;
+
+  union {
+    BVHTree_NearestPointCallback nearest;
+    BVHTree_RayCastCallback raycast;
+  } callback;
+  void *userdata;
+
+  union {
+    BVHTreeNearest *nearest;
+    BVHTreeRayHit *hit;
+  } result;
+} BVHBatchData;
+
+/**
+ * \return the mask of the queries in \a mask which are closer to the node bounds
+ * than their current nearest result.
+ */
+static uint nearest_packet_test(const BVHNearestPacket *packet, const float *bv, const uint mask)
+{
+  float dist_sq[BVH_PACKET_SIZE] = {0.0f};
+
+  /* Distance to the AABB hull, as #calc_nearest_point_squared. */
+  for (int axis = 0; axis != 3; axis++, bv += 2) {
+    const float *co_axis = packet->co_axis[axis];
+    for (int i = 0; i < BVH_PACKET_SIZE; i++) {
+      const float d = max_ff(bv[0] - co_axis[i], 0.0f) + max_ff(co_axis[i] - bv[1], 0.0f);
+      dist_sq[i] += d * d;
+    }
+  }
+
+  uint result = 0;
+  for (int i = 0; i < BVH_PACKET_SIZE; i++) {
+    result |= (uint)(dist_sq[i] < packet->dist_sq[i]) << i;
+  }
+  return result & mask;
+}
+
+static void dfs_find_nearest_packet(BVHNearestPacket *packet, const BVHNode *node, uint mask)
+{
+  mask = nearest_packet_test(packet, node->bv, mask);
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (uint m = mask; m; m &= m - 1) {
+      const uint i = bitscan_forward_uint(m);
+      BVHTreeNearest *nearest = &packet->nearest[i];
+      if (packet->callback) {
+        packet->callback(packet->userdata, node->index, packet->co[i], nearest);
+      }
+      else {
+        nearest->index = node->index;
+        nearest->dist_sq = calc_nearest_point_squared(packet->co[i], node, nearest->co);
+      }
+      packet->dist_sq[i] = nearest->dist_sq;
+    }
+  }
+  else {
+    /* Dive into the tree using the same heuristic as #dfs_find_nearest_dfs,
+     * based on the first query of the packet. */
+    const float proj = dot_v3v3(packet->co[bitscan_forward_uint(mask)],
+                                bvhtree_kdop_axes[node->main_axis]);
+    if (proj <= node->children[0]->bv[node->main_axis * 2 + 1]) {
+      for (int i = 0; i != node->totnode; i++) {
+        dfs_find_nearest_packet(packet, node->children[i], mask);
+      }
+    }
+    else {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        dfs_find_nearest_packet(packet, node->children[i], mask);
+      }
+    }
+  }
+}
+
+static void bvhtree_find_nearest_batch_cb(void *__restrict userdata,
+                                          const int packet_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHBatchData *data = userdata;
+  const int start = packet_index * BVH_PACKET_SIZE;
+  const int len = min_ii(data->queries_num - start, BVH_PACKET_SIZE);
+
+  BVHNearestPacket packet = {
+      .tree = data->tree,
+      .callback = data->callback.nearest,
+      .userdata = data->userdata,
+      .co = &data->co[start],
+      .nearest = &data->result.nearest[start],
+  };
+
+  for (int i = 0; i < len; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      packet.co_axis[axis][i] = packet.co[i][axis];
+    }
+    packet.dist_sq[i] = packet.nearest[i].dist_sq;
+  }
+
+  dfs_find_nearest_packet(&packet, data->tree->nodes[data->tree->totleaf], (1u << len) - 1);
+}
+
+/**
+ * Find the nearest node for many coordinates at once,
+ * this is much faster than calling #BLI_bvhtree_find_nearest for each of them.
+ *
+ * \param nearest: Array of \a co_num results, which must be initialized as for
+ * #BLI_bvhtree_find_nearest (a zero `dist_sq` can be used to skip a query).
+ * \param callback: Called from multiple threads, so must be thread-safe.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_num,
+                                    BVHTreeNearest *nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata)
+{
+  if (tree->nodes[tree->totleaf] == NULL || co_num == 0) {
+    return;
+  }
+
+  BVHBatchData data = {
+      .tree = tree,
+      .queries_num = co_num,
+      .co = co,
+      .callback.nearest = callback,
+      .userdata = userdata,
+      .result.nearest = nearest,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (co_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  BLI_task_parallel_range(0,
+                          (co_num + BVH_PACKET_SIZE - 1) / BVH_PACKET_SIZE,
+                          &data,
+                          bvhtree_find_nearest_batch_cb,
+                          &settings);
+}
+
+/**
+ * \return the mask of the rays in \a mask which hit the node bounds
+ * before their current hit, with the distances to the bounds in \a r_dist.
+ */
+static uint ray_packet_test(const BVHRayCastPacket *packet,
+                            const float *bv,
+                            const uint mask,
+                            float r_dist[BVH_PACKET_SIZE])
+{
+  float upper[BVH_PACKET_SIZE];
+
+  for (int i = 0; i < BVH_PACKET_SIZE; i++) {
+    r_dist[i] = 0.0f;
+    upper[i] = packet->dist[i];
+  }
+
+  /* Slab test against the AABB hull expanded by the ray radius, as #ray_nearest_hit. */
+  for (int axis = 0; axis != 3; axis++, bv += 2) {
+    const float bv_min = bv[0] - packet->radius;
+    const float bv_max = bv[1] + packet->radius;
+    const float *origin_axis = packet->origin_axis[axis];
+    const float *idot_axis = packet->idot_axis[axis];
+    for (int i = 0; i < BVH_PACKET_SIZE; i++) {
+      const float t1 = (bv_min - origin_axis[i]) * idot_axis[i];
+      const float t2 = (bv_max - origin_axis[i]) * idot_axis[i];
+      r_dist[i] = max_ff(r_dist[i], min_ff(t1, t2));
+      upper[i] = min_ff(upper[i], max_ff(t1, t2));
+    }
+  }
+
+  uint result = 0;
+  for (int i = 0; i < BVH_PACKET_SIZE; i++) {
+    result |= (uint)((r_dist[i] <= upper[i]) & (r_dist[i] < packet->dist[i])) << i;
+  }
+  return result & mask;
+}
+
+static void dfs_raycast_packet(BVHRayCastPacket *packet, const BVHNode *node, uint mask)
+{
+  float dist[BVH_PACKET_SIZE];
+
+  mask = ray_packet_test(packet, node->bv, mask, dist);
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (uint m = mask; m; m &= m - 1) {
+      const uint i = bitscan_forward_uint(m);
+      const BVHTreeRay *ray = &packet->ray[i];
+      BVHTreeRayHit *hit = &packet->hit[i];
+      if (packet->callback) {
+        packet->callback(packet->userdata, node->index, ray, hit);
+      }
+      else {
+        hit->index = node->index;
+        hit->dist = dist[i];
+        madd_v3_v3v3fl(hit->co, ray->origin, ray->direction, dist[i]);
+      }
+      packet->dist[i] = hit->dist;
+    }
+  }
+  else {
+    /* Pick loop direction to dive into the tree (based on ray directions and split axis). */
+    if (dot_v3v3(packet->direction_sum, bvhtree_kdop_axes[node->main_axis]) > 0.0f) {
+      for (int i = 0; i != node->totnode; i++) {
+        dfs_raycast_packet(packet, node->children[i], mask);
+      }
+    }
+    else {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        dfs_raycast_packet(packet, node->children[i], mask);
+      }
+    }
+  }
+}
+
+static void bvhtree_ray_cast_batch_cb(void *__restrict userdata,
+                                      const int packet_index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHBatchData *data = userdata;
+  const int start = packet_index * BVH_PACKET_SIZE;
+  const int len = min_ii(data->queries_num - start, BVH_PACKET_SIZE);
+
+  BVHRayCastPacket packet = {
+      .tree = data->tree,
+      .callback = data->callback.raycast,
+      .userdata = data->userdata,
+      .hit = &data->result.hit[start],
+      .radius = data->radius,
+  };
+
+  for (int i = 0; i < len; i++) {
+    BVHTreeRay *ray = &packet.ray[i];
+
+    BLI_ASSERT_UNIT_V3(data->dir[start + i]);
+
+    copy_v3_v3(ray->origin, data->co[start + i]);
+    copy_v3_v3(ray->direction, data->dir[start + i]);
+    ray->radius = data->radius;
+#ifdef USE_KDOPBVH_WATERTIGHT
+    if (data->flag & BVH_RAYCAST_WATERTIGHT) {
+      isect_ray_tri_watertight_v3_precalc(&packet.isect_precalc[i], ray->direction);
+      ray->isect_precalc = &packet.isect_precalc[i];
+    }
+    else {
+      ray->isect_precalc = NULL;
+    }
+#endif
+    add_v3_v3(packet.direction_sum, ray->direction);
+
+    for (int axis = 0; axis < 3; axis++) {
+      packet.origin_axis[axis][i] = ray->origin[axis];
+      /* Same as #bvhtree_ray_cast_data_precalc. */
+      packet.idot_axis[axis][i] = (fabsf(ray->direction[axis]) < FLT_EPSILON) ?
+                                      FLT_MAX :
+                                      1.0f / ray->direction[axis];
+    }
+    packet.dist[i] = packet.hit[i].dist;
+  }
+
+  dfs_raycast_packet(&packet, data->tree->nodes[data->tree->totleaf], (1u << len) - 1);
+}
+
+/**
+ * Cast many rays at once, this is much faster than calling #BLI_bvhtree_ray_cast for each of them.
+ *
+ * \param hit: Array of \a rays_num results, which must be initialized as for
+ * #BLI_bvhtree_ray_cast (a zero `dist` can be used to skip a ray).
+ * \param callback: Called from multiple threads, so must be thread-safe.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                const int rays_num,
+                                float radius,
+                                BVHTreeRayHit *hit,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag)
+{
+  if (tree->nodes[tree->totleaf] == NULL || rays_num == 0) {
+    return;
+  }
+
+  BVHBatchData data = {
+      .tree = tree,
+      .queries_num = rays_num,
+      .co = co,
+      .dir = dir,
+      .radius = radius,
+      .flag = flag,
+      .callback.raycast = callback,
+      .userdata = userdata,
+      .result.hit = hit,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (rays_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  BLI_task_parallel_range(0,
+                          (rays_num + BVH_PACKET_SIZE - 1) / BVH_PACKET_SIZE,
+                          &data,
+                          bvhtree_ray_cast_batch_cb,
+                          &settings);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
@@ -27,6 +27,8 @@
  * - Freeing chunks.
  * - Iterating over allocated chunks
  *   (optionally when using the #BLI_MEMPOOL_ALLOW_ITER flag).
+ * - Allocating and freeing from multiple threads
+ *   (optionally when using the #BLI_MEMPOOL_THREADSAFE flag).
  */
 
 #include <stdlib.h>
@@ -37,6 +39,8 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_mempool.h" /* own include */
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -106,6 +110,18 @@ typedef struct BLI_mempool_chunk {
   struct BLI_mempool_chunk *next;
 } BLI_mempool_chunk;
 
+/**
+ * Free elements used by one or more threads, for pools using #BLI_MEMPOOL_THREADSAFE.
+ *
+ * Threads use the list matching their task thread ID, so the lock is rarely contended.
+ * Padded so the lists of different threads don't share cache lines.
+ */
+typedef struct BLI_mempool_freelist {
+  SpinLock lock;
+  BLI_freenode *free;
+  char _pad[64];
+} BLI_mempool_freelist;
+
 /**
  * The mempool, stores and tracks memory \a chunks and elements within those chunks \a free.
  */
@@ -131,6 +147,13 @@ struct BLI_mempool {
   uint maxchunks;
   /** Number of elements currently in use. */
   uint totused;
+
+  /** Free lists used instead of #BLI_mempool.free with #BLI_MEMPOOL_THREADSAFE. */
+  BLI_mempool_freelist *freelists;
+  /** Number of #BLI_mempool.freelists minus one (the number is a power of two). */
+  uint freelists_mask;
+  /** Protects the chunk list with #BLI_MEMPOOL_THREADSAFE. */
+  SpinLock chunk_lock;
 #ifdef USE_TOTALLOC
   /** Number of elements allocated in total. */
   uint totalloc;
@@ -184,6 +207,41 @@ static BLI_mempool_chunk *mempool_chunk_alloc(BLI_mempool *pool)
   return MEM_mallocN(sizeof(BLI_mempool_chunk) + (size_t)pool->csize, "BLI_Mempool Chunk");
 }
 
+/**
+ * Link all elements of a new chunk into a free list.
+ *
+ * \return The last element of the list (its next pointer is NULL).
+ */
+static BLI_freenode *mempool_chunk_nodes_init(const BLI_mempool *pool, BLI_mempool_chunk *mpchunk)
+{
+  const uint esize = pool->esize;
+  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
+  uint j;
+
+  /* loop through the allocated data, building the pointer structures */
+  j = pool->pchunk;
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode->freeword = FREEWORD;
+      curnode = curnode->next;
+    }
+  }
+  else {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode = curnode->next;
+    }
+  }
+
+  /* terminate the list (rewind one)
+   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
+  curnode = NODE_STEP_PREV(curnode);
+  curnode->next = NULL;
+
+  return curnode;
+}
+
 /**
  * Initialize a chunk and add into \a pool->chunks
  *
@@ -197,9 +255,7 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
                                        BLI_mempool_chunk *mpchunk,
                                        BLI_freenode *last_tail)
 {
-  const uint esize = pool->esize;
   BLI_freenode *curnode = CHUNK_DATA(mpchunk);
-  uint j;
 
   /* append */
   if (pool->chunk_tail) {
@@ -217,26 +273,7 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
     pool->free = curnode;
   }
 
-  /* loop through the allocated data, building the pointer structures */
-  j = pool->pchunk;
-  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode->freeword = FREEWORD;
-      curnode = curnode->next;
-    }
-  }
-  else {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode = curnode->next;
-    }
-  }
-
-  /* terminate the list (rewind one)
-   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
-  curnode = NODE_STEP_PREV(curnode);
-  curnode->next = NULL;
+  curnode = mempool_chunk_nodes_init(pool, mpchunk);
 
 #ifdef USE_TOTALLOC
   pool->totalloc += pool->pchunk;
@@ -265,6 +302,213 @@ static void mempool_chunk_free_all(BLI_mempool_chunk *mpchunk)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Thread-Safe Allocation
+ *
+ * With #BLI_MEMPOOL_THREADSAFE, #BLI_mempool.free is unused: each thread allocates from and
+ * frees into its own #BLI_mempool_freelist. When it runs out, it steals up to a chunk worth
+ * of elements from the other lists, only allocating a new chunk when all lists are empty.
+ * \{ */
+
+#ifndef BLI_MEMPOOL_NO_THREADSAFE
+
+static void mempool_threadsafe_chunks_lock(BLI_mempool *pool)
+{
+  BLI_spin_lock(&pool->chunk_lock);
+}
+
+static void mempool_threadsafe_chunks_unlock(BLI_mempool *pool)
+{
+  BLI_spin_unlock(&pool->chunk_lock);
+}
+
+static void mempool_threadsafe_init(BLI_mempool *pool)
+{
+  const uint freelists_num = power_of_2_max_u((uint)BLI_system_thread_count());
+  pool->freelists = MEM_mallocN_aligned(
+      sizeof(*pool->freelists) * freelists_num, 64, "BLI_Mempool Free Lists");
+  pool->freelists_mask = freelists_num - 1;
+  for (uint i = 0; i < freelists_num; i++) {
+    BLI_spin_init(&pool->freelists[i].lock);
+    pool->freelists[i].free = NULL;
+  }
+  BLI_spin_init(&pool->chunk_lock);
+}
+
+static void mempool_threadsafe_end(BLI_mempool *pool)
+{
+  for (uint i = 0; i <= pool->freelists_mask; i++) {
+    BLI_spin_end(&pool->freelists[i].lock);
+  }
+  BLI_spin_end(&pool->chunk_lock);
+  MEM_freeN(pool->freelists);
+}
+
+/** Move the elements of the single threaded free list into the first thread's list. */
+static void mempool_threadsafe_reset(BLI_mempool *pool)
+{
+  for (uint i = 0; i <= pool->freelists_mask; i++) {
+    pool->freelists[i].free = NULL;
+  }
+  pool->freelists[0].free = pool->free;
+  pool->free = NULL;
+}
+
+BLI_INLINE BLI_mempool_freelist *mempool_threadsafe_freelist(BLI_mempool *pool)
+{
+  return &pool->freelists[(uint)BLI_task_parallel_thread_id(NULL) & pool->freelists_mask];
+}
+
+/**
+ * Take up to a chunk worth of elements from the free list of another thread.
+ */
+static BLI_freenode *mempool_threadsafe_steal(BLI_mempool *pool, const BLI_mempool_freelist *own)
+{
+  const uint own_index = (uint)(own - pool->freelists);
+  for (uint i = 1; i <= pool->freelists_mask; i++) {
+    BLI_mempool_freelist *freelist = &pool->freelists[(own_index + i) & pool->freelists_mask];
+    /* Unlocked read, only used to skip empty lists. */
+    if (freelist->free == NULL) {
+      continue;
+    }
+
+    BLI_spin_lock(&freelist->lock);
+    BLI_freenode *stolen = freelist->free;
+    if (stolen != NULL) {
+      BLI_freenode *tail = stolen;
+      for (uint j = 1; j < pool->pchunk && tail->next != NULL; j++) {
+        tail = tail->next;
+      }
+      freelist->free = tail->next;
+      tail->next = NULL;
+    }
+    BLI_spin_unlock(&freelist->lock);
+
+    if (stolen != NULL) {
+      return stolen;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Allocate a new chunk, returning its elements as a free list.
+ */
+static BLI_freenode *mempool_threadsafe_chunk_add(BLI_mempool *pool)
+{
+  BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
+  mempool_chunk_nodes_init(pool, mpchunk);
+  mpchunk->next = NULL;
+
+  mempool_threadsafe_chunks_lock(pool);
+  if (pool->chunk_tail) {
+    pool->chunk_tail->next = mpchunk;
+  }
+  else {
+    pool->chunks = mpchunk;
+  }
+  pool->chunk_tail = mpchunk;
+#ifdef USE_TOTALLOC
+  pool->totalloc += pool->pchunk;
+#endif
+  mempool_threadsafe_chunks_unlock(pool);
+
+  return CHUNK_DATA(mpchunk);
+}
+
+static BLI_freenode *mempool_threadsafe_alloc(BLI_mempool *pool)
+{
+  BLI_mempool_freelist *freelist = mempool_threadsafe_freelist(pool);
+  BLI_freenode *free_pop;
+
+  BLI_spin_lock(&freelist->lock);
+  free_pop = freelist->free;
+  if (LIKELY(free_pop != NULL)) {
+    freelist->free = free_pop->next;
+  }
+  BLI_spin_unlock(&freelist->lock);
+
+  if (UNLIKELY(free_pop == NULL)) {
+    /* Don't hold the lock of this list while locking others, to avoid dead-locks. */
+    free_pop = mempool_threadsafe_steal(pool, freelist);
+    if (free_pop == NULL) {
+      free_pop = mempool_threadsafe_chunk_add(pool);
+    }
+
+    /* Keep the remaining elements for later allocations. */
+    BLI_freenode *remaining = free_pop->next;
+    if (remaining != NULL) {
+      BLI_spin_lock(&freelist->lock);
+      if (freelist->free != NULL) {
+        /* Elements were freed meanwhile (by another thread sharing this list). */
+        BLI_freenode *tail = remaining;
+        while (tail->next != NULL) {
+          tail = tail->next;
+        }
+        tail->next = freelist->free;
+      }
+      freelist->free = remaining;
+      BLI_spin_unlock(&freelist->lock);
+    }
+  }
+
+  atomic_add_and_fetch_uint32(&pool->totused, 1);
+  return free_pop;
+}
+
+static void mempool_threadsafe_free(BLI_mempool *pool, BLI_freenode *newhead)
+{
+  BLI_mempool_freelist *freelist = mempool_threadsafe_freelist(pool);
+
+  BLI_spin_lock(&freelist->lock);
+  newhead->next = freelist->free;
+  freelist->free = newhead;
+  BLI_spin_unlock(&freelist->lock);
+
+  atomic_sub_and_fetch_uint32(&pool->totused, 1);
+}
+
+#else /* BLI_MEMPOOL_NO_THREADSAFE */
+
+/* Stand-alone builds of this file (`makesdna`) don't link the threading code of blenlib,
+ * #BLI_MEMPOOL_THREADSAFE isn't supported there. */
+
+static void mempool_threadsafe_init(BLI_mempool *UNUSED(pool))
+{
+  BLI_assert(!"Thread-safe pools are not supported in this build.\n");
+}
+
+static void mempool_threadsafe_end(BLI_mempool *UNUSED(pool))
+{
+}
+
+static void mempool_threadsafe_reset(BLI_mempool *UNUSED(pool))
+{
+}
+
+static BLI_freenode *mempool_threadsafe_alloc(BLI_mempool *UNUSED(pool))
+{
+  return NULL;
+}
+
+static void mempool_threadsafe_free(BLI_mempool *UNUSED(pool), BLI_freenode *UNUSED(newhead))
+{
+}
+
+#  ifndef NDEBUG
+static void mempool_threadsafe_chunks_lock(BLI_mempool *UNUSED(pool))
+{
+}
+
+static void mempool_threadsafe_chunks_unlock(BLI_mempool *UNUSED(pool))
+{
+}
+#  endif
+
+#endif /* BLI_MEMPOOL_NO_THREADSAFE */
+
+/** \} */
+
 BLI_mempool *BLI_mempool_create(uint esize, uint totelem, uint pchunk, uint flag)
 {
   BLI_mempool *pool;
@@ -324,6 +568,13 @@ BLI_mempool *BLI_mempool_create(uint esize, uint totelem, uint pchunk, uint flag
     }
   }
 
+  pool->freelists = NULL;
+  pool->freelists_mask = 0;
+  if (flag & BLI_MEMPOOL_THREADSAFE) {
+    mempool_threadsafe_init(pool);
+    mempool_threadsafe_reset(pool);
+  }
+
 #ifdef WITH_MEM_VALGRIND
   VALGRIND_CREATE_MEMPOOL(pool, 0, false);
 #endif
@@ -335,6 +586,17 @@ void *BLI_mempool_alloc(BLI_mempool *pool)
 {
   BLI_freenode *free_pop;
 
+  if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+    free_pop = mempool_threadsafe_alloc(pool);
+    if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+      free_pop->freeword = USEDWORD;
+    }
+#ifdef WITH_MEM_VALGRIND
+    VALGRIND_MEMPOOL_ALLOC(pool, free_pop, pool->esize);
+#endif
+    return (void *)free_pop;
+  }
+
   if (UNLIKELY(pool->free == NULL)) {
     /* Need to allocate a new chunk. */
     BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
@@ -379,12 +641,18 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
   {
     BLI_mempool_chunk *chunk;
     bool found = false;
+    if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+      mempool_threadsafe_chunks_lock(pool);
+    }
     for (chunk = pool->chunks; chunk; chunk = chunk->next) {
       if (ARRAY_HAS_ITEM((char *)addr, (char *)CHUNK_DATA(chunk), pool->csize)) {
         found = true;
         break;
       }
     }
+    if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+      mempool_threadsafe_chunks_unlock(pool);
+    }
     if (!found) {
       BLI_assert(!"Attempt to free data which is not in pool.\n");
     }
@@ -404,6 +672,15 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
     newhead->freeword = FREEWORD;
   }
 
+  if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+    /* Chunks are kept until the pool is cleared, other threads may be using them. */
+    mempool_threadsafe_free(pool, newhead);
+#ifdef WITH_MEM_VALGRIND
+    VALGRIND_MEMPOOL_FREE(pool, addr);
+#endif
+    return;
+  }
+
   newhead->next = pool->free;
   pool->free = newhead;
 
@@ -741,6 +1018,10 @@ void BLI_mempool_clear_ex(BLI_mempool *pool, const int totelem_reserve)
     chunks_temp = mpchunk->next;
     last_tail = mempool_chunk_add(pool, mpchunk, last_tail);
   }
+
+  if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+    mempool_threadsafe_reset(pool);
+  }
 }
 
 /**
@@ -758,6 +1039,10 @@ void BLI_mempool_destroy(BLI_mempool *pool)
 {
   mempool_chunk_free_all(pool->chunks);
 
+  if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+    mempool_threadsafe_end(pool);
+  }
+
 #ifdef WITH_MEM_VALGRIND
   VALGRIND_DESTROY_MEMPOOL(pool);
 #endif
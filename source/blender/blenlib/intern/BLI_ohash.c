@@ -0,0 +1,595 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * Open-addressing hash-map, using linear probing.
+ *
+ * The table size is a power of two, the slot of a key is found using Fibonacci hashing
+ * (multiplying by the golden ratio and keeping the high bits), so hash functions
+ * which only vary in their high or low bits (pointers, integers) still spread well.
+ * Removed slots are kept as tombstones until the next resize,
+ * the table is kept at most half full (counting tombstones).
+ *
+ * \note The API matches BLI_ghash.c, but the implementation is different.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_ghash.h"
+#include "BLI_ohash.h" /* own include */
+#include "BLI_utildefines.h"
+
+#include "BLI_strict_flags.h" /* keep last */
+
+/* -------------------------------------------------------------------- */
+/** \name Structs & Constants
+ * \{ */
+
+#define OHASH_SLOTS_LEN_BITS_MIN 3
+
+enum {
+  OHASH_SLOT_EMPTY = 0,
+  OHASH_SLOT_USED = 1,
+  OHASH_SLOT_REMOVED = 2,
+};
+
+typedef struct OHashSlot {
+  void *key;
+  void *val;
+  /** Hash of the key, compared before calling #OHash.cmpfp. */
+  uint hash;
+  /** One of the `OHASH_SLOT_*` values. */
+  uint state;
+} OHashSlot;
+
+struct OHash {
+  GHashHashFP hashfp;
+  GHashCmpFP cmpfp;
+
+  OHashSlot *slots;
+  uint slots_len_bits;
+  uint slots_mask;
+
+  /** Number of used slots. */
+  uint nentries;
+  /** Number of used and removed slots, both make probing longer. */
+  uint nentries_used_or_removed;
+
+  const char *info;
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Internal Utility API
+ * \{ */
+
+BLI_INLINE uint ohash_slot_first(const OHash *oh, const uint hash)
+{
+  /* Fibonacci hashing. */
+  return (hash * 2654435769u) >> (32u - oh->slots_len_bits);
+}
+
+BLI_INLINE uint ohash_slot_next(const OHash *oh, const uint index)
+{
+  return (index + 1) & oh->slots_mask;
+}
+
+/** Smallest table size keeping the table at most half full. */
+static uint ohash_slots_len_bits_for_entries(const uint nentries)
+{
+  uint bits = OHASH_SLOTS_LEN_BITS_MIN;
+  while (bits < 31 && ((uint64_t)1 << bits) < (uint64_t)nentries * 2) {
+    bits++;
+  }
+  return bits;
+}
+
+static void ohash_slots_alloc(OHash *oh, const uint slots_len_bits)
+{
+  const uint slots_len = 1u << slots_len_bits;
+  oh->slots = MEM_calloc_arrayN(slots_len, sizeof(*oh->slots), oh->info);
+  oh->slots_len_bits = slots_len_bits;
+  oh->slots_mask = slots_len - 1;
+  oh->nentries = 0;
+  oh->nentries_used_or_removed = 0;
+}
+
+/** Insert a key known not to be in the table, there must be room for it. */
+static OHashSlot *ohash_insert_slot_new(OHash *oh, void *key, const uint hash)
+{
+  uint index = ohash_slot_first(oh, hash);
+  while (oh->slots[index].state == OHASH_SLOT_USED) {
+    index = ohash_slot_next(oh, index);
+  }
+  OHashSlot *slot = &oh->slots[index];
+  if (slot->state == OHASH_SLOT_EMPTY) {
+    oh->nentries_used_or_removed++;
+  }
+  slot->key = key;
+  slot->hash = hash;
+  slot->state = OHASH_SLOT_USED;
+  oh->nentries++;
+  return slot;
+}
+
+static void ohash_resize(OHash *oh, const uint slots_len_bits)
+{
+  OHashSlot *slots_old = oh->slots;
+  const uint slots_len_old = oh->slots_mask + 1;
+
+  ohash_slots_alloc(oh, slots_len_bits);
+
+  for (uint i = 0; i < slots_len_old; i++) {
+    if (slots_old[i].state == OHASH_SLOT_USED) {
+      OHashSlot *slot = ohash_insert_slot_new(oh, slots_old[i].key, slots_old[i].hash);
+      slot->val = slots_old[i].val;
+    }
+  }
+
+  MEM_freeN(slots_old);
+}
+
+/**
+ * Make room for one more entry.
+ */
+BLI_INLINE void ohash_ensure_room(OHash *oh)
+{
+  if (UNLIKELY((oh->nentries_used_or_removed + 1) * 2 > oh->slots_mask + 1)) {
+    /* Grow to a third full, so tables with many removals don't resize too often.
+     * This may also only clear the tombstones, without growing. */
+    ohash_resize(oh, ohash_slots_len_bits_for_entries(((oh->nentries + 1) * 3 + 1) / 2));
+  }
+}
+
+static OHashSlot *ohash_lookup_slot(const OHash *oh, const void *key, const uint hash)
+{
+  for (uint index = ohash_slot_first(oh, hash);; index = ohash_slot_next(oh, index)) {
+    OHashSlot *slot = &oh->slots[index];
+    if (slot->state == OHASH_SLOT_EMPTY) {
+      return NULL;
+    }
+    if (slot->state == OHASH_SLOT_USED && slot->hash == hash && !oh->cmpfp(key, slot->key)) {
+      return slot;
+    }
+  }
+}
+
+/**
+ * Find the slot of \a key, or the slot where it should be inserted.
+ *
+ * \return true when the key was found.
+ */
+static bool ohash_lookup_or_insert_slot(OHash *oh,
+                                        const void *key,
+                                        const uint hash,
+                                        OHashSlot **r_slot)
+{
+  OHashSlot *slot_removed = NULL;
+  for (uint index = ohash_slot_first(oh, hash);; index = ohash_slot_next(oh, index)) {
+    OHashSlot *slot = &oh->slots[index];
+    if (slot->state == OHASH_SLOT_EMPTY) {
+      if (slot_removed != NULL) {
+        slot = slot_removed;
+      }
+      else {
+        oh->nentries_used_or_removed++;
+      }
+      slot->hash = hash;
+      slot->state = OHASH_SLOT_USED;
+      oh->nentries++;
+      *r_slot = slot;
+      return false;
+    }
+    if (slot->state == OHASH_SLOT_REMOVED) {
+      if (slot_removed == NULL) {
+        slot_removed = slot;
+      }
+    }
+    else if (slot->hash == hash && !oh->cmpfp(key, slot->key)) {
+      *r_slot = slot;
+      return true;
+    }
+  }
+}
+
+static void ohash_slot_remove(OHash *oh, OHashSlot *slot)
+{
+  const uint index = (uint)(slot - oh->slots);
+  if (oh->slots[ohash_slot_next(oh, index)].state == OHASH_SLOT_EMPTY) {
+    /* No probing sequence continues after this slot. */
+    slot->state = OHASH_SLOT_EMPTY;
+    oh->nentries_used_or_removed--;
+  }
+  else {
+    slot->state = OHASH_SLOT_REMOVED;
+  }
+  oh->nentries--;
+}
+
+static void ohash_free_slots(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  if (keyfreefp || valfreefp) {
+    for (uint i = 0; i <= oh->slots_mask; i++) {
+      OHashSlot *slot = &oh->slots[i];
+      if (slot->state == OHASH_SLOT_USED) {
+        if (keyfreefp) {
+          keyfreefp(slot->key);
+        }
+        if (valfreefp) {
+          valfreefp(slot->val);
+        }
+      }
+    }
+  }
+  MEM_freeN(oh->slots);
+  oh->slots = NULL;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+/**
+ * Creates a new, empty OHash.
+ *
+ * \param hashfp: Hash callback.
+ * \param cmpfp: Comparison callback.
+ * \param info: Identifier string for the OHash.
+ * \param nentries_reserve: Optionally reserve the number of members that the hash will hold.
+ * Use this to avoid resizing buckets if the size is known or can be closely approximated.
+ * \return  An empty OHash.
+ */
+OHash *BLI_ohash_new_ex(GHashHashFP hashfp,
+                        GHashCmpFP cmpfp,
+                        const char *info,
+                        const uint nentries_reserve)
+{
+  OHash *oh = MEM_mallocN(sizeof(*oh), info);
+  oh->hashfp = hashfp;
+  oh->cmpfp = cmpfp;
+  oh->info = info;
+  ohash_slots_alloc(oh, ohash_slots_len_bits_for_entries(nentries_reserve));
+  return oh;
+}
+
+/**
+ * Wraps #BLI_ohash_new_ex with zero entries reserved.
+ */
+OHash *BLI_ohash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
+{
+  return BLI_ohash_new_ex(hashfp, cmpfp, info, 0);
+}
+
+/**
+ * Frees the OHash and its members.
+ *
+ * \param oh: The OHash to free.
+ * \param keyfreefp: Optional callback to free the key.
+ * \param valfreefp: Optional callback to free the value.
+ */
+void BLI_ohash_free(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  ohash_free_slots(oh, keyfreefp, valfreefp);
+  MEM_freeN(oh);
+}
+
+/**
+ * Reserve given amount of entries (resize \a oh accordingly if needed).
+ */
+void BLI_ohash_reserve(OHash *oh, const uint nentries_reserve)
+{
+  const uint slots_len_bits = ohash_slots_len_bits_for_entries(nentries_reserve);
+  if (slots_len_bits > oh->slots_len_bits) {
+    ohash_resize(oh, slots_len_bits);
+  }
+}
+
+/**
+ * Insert a key/value pair into the \a oh.
+ *
+ * \note Duplicates are not checked,
+ * the caller is expected to ensure elements are unique (as with #BLI_ghash_insert).
+ */
+void BLI_ohash_insert(OHash *oh, void *key, void *val)
+{
+  ohash_ensure_room(oh);
+  const uint hash = oh->hashfp(key);
+  BLI_assert(ohash_lookup_slot(oh, key, hash) == NULL);
+  OHashSlot *slot = ohash_insert_slot_new(oh, key, hash);
+  slot->val = val;
+}
+
+/**
+ * Inserts a new value to a key that may already be in the OHash.
+ *
+ * Avoids #BLI_ohash_remove, #BLI_ohash_insert calls (double lookups)
+ *
+ * \returns true if a new key has been added.
+ */
+bool BLI_ohash_reinsert(
+    OHash *oh, void *key, void *val, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  ohash_ensure_room(oh);
+  OHashSlot *slot;
+  if (ohash_lookup_or_insert_slot(oh, key, oh->hashfp(key), &slot)) {
+    if (keyfreefp) {
+      keyfreefp(slot->key);
+    }
+    if (valfreefp) {
+      valfreefp(slot->val);
+    }
+    slot->key = key;
+    slot->val = val;
+    return false;
+  }
+  slot->key = key;
+  slot->val = val;
+  return true;
+}
+
+/**
+ * Lookup the value of \a key in \a oh.
+ *
+ * \param key: The key to lookup.
+ * \returns the value for \a key or NULL.
+ */
+void *BLI_ohash_lookup(const OHash *oh, const void *key)
+{
+  const OHashSlot *slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  return slot ? slot->val : NULL;
+}
+
+/**
+ * A version of #BLI_ohash_lookup which accepts a fallback argument.
+ */
+void *BLI_ohash_lookup_default(const OHash *oh, const void *key, void *val_default)
+{
+  const OHashSlot *slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  return slot ? slot->val : val_default;
+}
+
+/**
+ * Lookup a pointer to the value of \a key in \a oh.
+ *
+ * \param key: The key to lookup.
+ * \returns the pointer to value for \a key or NULL.
+ */
+void **BLI_ohash_lookup_p(OHash *oh, const void *key)
+{
+  OHashSlot *slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  return slot ? &slot->val : NULL;
+}
+
+/**
+ * Ensure \a key is exists in \a oh.
+ *
+ * This handles the common situation where the caller needs ensure a key is added to \a oh,
+ * constructing a new value in the case the key isn't found.
+ * Otherwise use the existing value.
+ *
+ * \param r_val: The pointer to assign the value to.
+ * \returns true when the value didn't need to be added.
+ * (when false, the caller _must_ initialize the value).
+ */
+bool BLI_ohash_ensure_p(OHash *oh, void *key, void ***r_val)
+{
+  ohash_ensure_room(oh);
+  OHashSlot *slot;
+  const bool haskey = ohash_lookup_or_insert_slot(oh, key, oh->hashfp(key), &slot);
+  if (!haskey) {
+    slot->key = key;
+    slot->val = NULL;
+  }
+  *r_val = &slot->val;
+  return haskey;
+}
+
+/**
+ * A version of #BLI_ohash_ensure_p that allows caller to re-assign the key.
+ * Typically used when the key is to be duplicated.
+ *
+ * \warning Caller _must_ write to \a r_key when returning false.
+ */
+bool BLI_ohash_ensure_p_ex(OHash *oh, const void *key, void ***r_key, void ***r_val)
+{
+  ohash_ensure_room(oh);
+  OHashSlot *slot;
+  const bool haskey = ohash_lookup_or_insert_slot(oh, key, oh->hashfp(key), &slot);
+  if (!haskey) {
+    /* Pass the key to the caller to initialize. */
+    slot->key = NULL;
+    slot->val = NULL;
+  }
+  *r_key = &slot->key;
+  *r_val = &slot->val;
+  return haskey;
+}
+
+/**
+ * Remove \a key from \a oh, or return false if the key wasn't found.
+ *
+ * \param key: The key to remove.
+ * \param keyfreefp: Optional callback to free the key.
+ * \param valfreefp: Optional callback to free the value.
+ * \return true if \a key was removed from \a oh.
+ */
+bool BLI_ohash_remove(OHash *oh,
+                      const void *key,
+                      GHashKeyFreeFP keyfreefp,
+                      GHashValFreeFP valfreefp)
+{
+  OHashSlot *slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  if (slot == NULL) {
+    return false;
+  }
+  if (keyfreefp) {
+    keyfreefp(slot->key);
+  }
+  if (valfreefp) {
+    valfreefp(slot->val);
+  }
+  ohash_slot_remove(oh, slot);
+  return true;
+}
+
+/**
+ * Reset \a oh clearing all entries.
+ *
+ * \param keyfreefp: Optional callback to free the key.
+ * \param valfreefp: Optional callback to free the value.
+ */
+void BLI_ohash_clear(OHash *oh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  ohash_free_slots(oh, keyfreefp, valfreefp);
+  ohash_slots_alloc(oh, OHASH_SLOTS_LEN_BITS_MIN);
+}
+
+/**
+ * Remove \a key from \a oh, returning the value or NULL if the key wasn't found.
+ *
+ * \param key: The key to remove.
+ * \param keyfreefp: Optional callback to free the key.
+ * \return the value of \a key int \a oh or NULL.
+ */
+void *BLI_ohash_popkey(OHash *oh, const void *key, GHashKeyFreeFP keyfreefp)
+{
+  OHashSlot *slot = ohash_lookup_slot(oh, key, oh->hashfp(key));
+  if (slot == NULL) {
+    return NULL;
+  }
+  if (keyfreefp) {
+    keyfreefp(slot->key);
+  }
+  void *val = slot->val;
+  ohash_slot_remove(oh, slot);
+  return val;
+}
+
+/**
+ * \return true if the \a key is in \a oh.
+ */
+bool BLI_ohash_haskey(const OHash *oh, const void *key)
+{
+  return ohash_lookup_slot(oh, key, oh->hashfp(key)) != NULL;
+}
+
+/**
+ * \return size of the OHash.
+ */
+uint BLI_ohash_len(const OHash *oh)
+{
+  return oh->nentries;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Iterator API
+ * \{ */
+
+static void ohashIterator_skip_unused(OHashIterator *ohi)
+{
+  const OHash *oh = ohi->oh;
+  while (ohi->slot_index <= oh->slots_mask &&
+         oh->slots[ohi->slot_index].state != OHASH_SLOT_USED) {
+    ohi->slot_index++;
+  }
+}
+
+/**
+ * Init an already allocated OHashIterator. The hash table must not
+ * be mutated while the iterator is in use, except for removing the current item.
+ *
+ * \param ohi: The OHashIterator to initialize.
+ * \param oh: The OHash to iterate over.
+ */
+void BLI_ohashIterator_init(OHashIterator *ohi, OHash *oh)
+{
+  ohi->oh = oh;
+  ohi->slot_index = 0;
+  ohashIterator_skip_unused(ohi);
+}
+
+/**
+ * Steps the iterator to the next index.
+ */
+void BLI_ohashIterator_step(OHashIterator *ohi)
+{
+  ohi->slot_index++;
+  ohashIterator_skip_unused(ohi);
+}
+
+void *BLI_ohashIterator_getKey(OHashIterator *ohi)
+{
+  return ohi->oh->slots[ohi->slot_index].key;
+}
+
+void *BLI_ohashIterator_getValue(OHashIterator *ohi)
+{
+  return ohi->oh->slots[ohi->slot_index].val;
+}
+
+void **BLI_ohashIterator_getValue_p(OHashIterator *ohi)
+{
+  return &ohi->oh->slots[ohi->slot_index].val;
+}
+
+bool BLI_ohashIterator_done(const OHashIterator *ohi)
+{
+  return ohi->slot_index > ohi->oh->slots_mask;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Convenience OHash Creation Functions
+ * \{ */
+
+OHash *BLI_ohash_ptr_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_ohash_new_ex(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, info, nentries_reserve);
+}
+OHash *BLI_ohash_ptr_new(const char *info)
+{
+  return BLI_ohash_ptr_new_ex(info, 0);
+}
+
+OHash *BLI_ohash_str_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_ohash_new_ex(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, info, nentries_reserve);
+}
+OHash *BLI_ohash_str_new(const char *info)
+{
+  return BLI_ohash_str_new_ex(info, 0);
+}
+
+OHash *BLI_ohash_int_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_ohash_new_ex(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, info, nentries_reserve);
+}
+OHash *BLI_ohash_int_new(const char *info)
+{
+  return BLI_ohash_int_new_ex(info, 0);
+}
+
+/** \} */
@@ -20,9 +20,11 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_bitmap.h"
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
 #include "BLI_strict_flags.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #define _CONCAT_AUX(MACRO_ARG1, MACRO_ARG2) MACRO_ARG1##MACRO_ARG2
@@ -56,6 +58,11 @@ struct KDTree {
 #define KD_NEAR_ALLOC_INC 100 /* alloc increment for collecting nearest */
 #define KD_FOUND_ALLOC_INC 50 /* alloc increment for collecting nearest */
 
+/* Sub-trees with more nodes than this are balanced in their own task. */
+#define KD_BALANCE_TASK_NODES_MIN 8192
+/* Batched searches with more queries than this are done in parallel. */
+#define KD_SEARCH_THREADED_QUERIES_MIN 1024
+
 #define KD_NODE_UNSET ((uint)-1)
 
 /**
@@ -145,20 +152,15 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Partition the nodes around the median along \a axis (quicksort style).
+ * \return the index of the median.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, uint nodes_len, uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
-  /* quicksort style sorting around median */
   left = 0;
   right = nodes_len - 1;
   median = nodes_len / 2;
@@ -190,6 +192,29 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+/**
+ * \note The nodes of each sub-tree are stored in a contiguous range of the array,
+ * with the root of the sub-tree at its median (`nodes_len / 2`).
+ * #kdtree_refit relies on this layout.
+ */
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  /* quicksort style sorting around median */
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* set node and sort subnodes */
   node = &nodes[median];
   node->d = axis;
@@ -201,6 +226,76 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+  /** Where to store the root of the balanced sub-tree. */
+  uint *r_root;
+} KDTreeBalanceTask;
+
+static uint kdtree_balance_threaded(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs);
+
+static void kdtree_balance_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  KDTreeBalanceTask *task = taskdata;
+  *task->r_root = kdtree_balance_threaded(
+      pool, task->nodes, task->nodes_len, task->axis, task->ofs);
+}
+
+/**
+ * Same as #kdtree_balance, large left sub-trees are balanced in tasks of \a pool.
+ */
+static uint kdtree_balance_threaded(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= KD_BALANCE_TASK_NODES_MIN) {
+    return kdtree_balance(nodes, nodes_len, axis, ofs);
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
+  node = &nodes[median];
+  node->d = axis;
+  axis = (axis + 1) % KD_DIMS;
+
+  /* Both sides are stored in separate ranges of the array, so they can be balanced in parallel.
+   * The task only writes `node->left`. */
+  KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+  task->nodes = nodes;
+  task->nodes_len = median;
+  task->axis = axis;
+  task->ofs = ofs;
+  task->r_root = &node->left;
+  BLI_task_pool_push(pool, kdtree_balance_task_run, task, true, NULL);
+
+  node->right = kdtree_balance_threaded(
+      pool, nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+
+  return median + ofs;
+}
+
+/**
+ * Balance the nodes, using multiple threads for large trees.
+ */
+static uint kdtree_balance_range(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  if (nodes_len <= KD_BALANCE_TASK_NODES_MIN) {
+    return kdtree_balance(nodes, nodes_len, axis, ofs);
+  }
+
+  TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  const uint root = kdtree_balance_threaded(pool, nodes, nodes_len, axis, ofs);
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
+  return root;
+}
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -210,13 +305,131 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  tree->root = kdtree_balance_range(tree->nodes, tree->nodes_len, 0, 0);
 
 #ifdef DEBUG
   tree->is_balanced = true;
 #endif
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_kdtree_3d_refit
+ * \{ */
+
+/**
+ * Calculate the bounds of the sub-tree stored in `nodes[0..nodes_len]`,
+ * tagging sub-trees which have nodes on the wrong side of their root in \a r_invalid.
+ */
+static void kdtree_refit_calc_bounds(const KDTreeNode *nodes,
+                                     const uint nodes_len,
+                                     const uint ofs,
+                                     BLI_bitmap *r_invalid,
+                                     float r_min[KD_DIMS],
+                                     float r_max[KD_DIMS])
+{
+  const uint median = nodes_len / 2;
+  const KDTreeNode *node = &nodes[median];
+
+  copy_vn_vn(r_min, node->co);
+  copy_vn_vn(r_max, node->co);
+
+  if (nodes_len == 1) {
+    return;
+  }
+
+  float min[KD_DIMS], max[KD_DIMS];
+  bool is_valid = true;
+
+  if (median > 0) {
+    kdtree_refit_calc_bounds(nodes, median, ofs, r_invalid, min, max);
+    is_valid &= (max[node->d] <= node->co[node->d]);
+    for (uint j = 0; j < KD_DIMS; j++) {
+      r_min[j] = min_ff(r_min[j], min[j]);
+      r_max[j] = max_ff(r_max[j], max[j]);
+    }
+  }
+  if (median + 1 < nodes_len) {
+    kdtree_refit_calc_bounds(
+        nodes + median + 1, nodes_len - (median + 1), ofs + median + 1, r_invalid, min, max);
+    is_valid &= (min[node->d] >= node->co[node->d]);
+    for (uint j = 0; j < KD_DIMS; j++) {
+      r_min[j] = min_ff(r_min[j], min[j]);
+      r_max[j] = max_ff(r_max[j], max[j]);
+    }
+  }
+
+  if (!is_valid) {
+    BLI_BITMAP_ENABLE(r_invalid, ofs + median);
+  }
+}
+
+/**
+ * Re-balance the highest invalid sub-trees, leaving the valid parts of the tree untouched.
+ * \return the number of re-balanced nodes.
+ */
+static uint kdtree_refit_rebalance(KDTreeNode *nodes,
+                                   const uint nodes_len,
+                                   const uint ofs,
+                                   const BLI_bitmap *invalid)
+{
+  if (nodes_len <= 1) {
+    return 0;
+  }
+
+  const uint median = nodes_len / 2;
+  const KDTreeNode *node = &nodes[median];
+
+  if (BLI_BITMAP_TEST(invalid, ofs + median)) {
+    for (uint i = 0; i < nodes_len; i++) {
+      nodes[i].left = KD_NODE_UNSET;
+      nodes[i].right = KD_NODE_UNSET;
+    }
+    /* The same median is used, so the parent links remain valid. */
+    kdtree_balance_range(nodes, nodes_len, node->d, ofs);
+    return nodes_len;
+  }
+
+  return kdtree_refit_rebalance(nodes, median, ofs, invalid) +
+         kdtree_refit_rebalance(
+             nodes + median + 1, nodes_len - (median + 1), ofs + median + 1, invalid);
+}
+
+/**
+ * Move the points of a balanced tree, keeping the tree balanced.
+ *
+ * Only the sub-trees which are no longer valid are re-balanced (in place),
+ * which is much faster than building a new tree when few points move between updates.
+ * Points moving across the split planes near the root of the tree
+ * still cause most of the tree to be re-balanced.
+ *
+ * \param co: The new coordinates, indexed by the index passed to #BLI_kdtree_3d_insert.
+ * \return the number of nodes which were re-balanced.
+ */
+int BLI_kdtree_nd_(refit)(KDTree *tree, const float (*co)[KD_DIMS])
+{
+#ifdef DEBUG
+  BLI_assert(tree->is_balanced == true);
+#endif
+
+  if (tree->nodes_len == 0) {
+    return 0;
+  }
+
+  for (uint i = 0; i < tree->nodes_len; i++) {
+    copy_vn_vn(tree->nodes[i].co, co[tree->nodes[i].index]);
+  }
+
+  BLI_bitmap *invalid = BLI_BITMAP_NEW(tree->nodes_len, __func__);
+  float min[KD_DIMS], max[KD_DIMS];
+  kdtree_refit_calc_bounds(tree->nodes, tree->nodes_len, 0, invalid, min, max);
+  const uint rebalanced_len = kdtree_refit_rebalance(tree->nodes, tree->nodes_len, 0, invalid);
+  MEM_freeN(invalid);
+
+  return (int)rebalanced_len;
+}
+
+/** \} */
+
 static uint *realloc_nodes(uint *stack, uint *stack_len_capacity, const bool is_alloc)
 {
   uint *stack_new = MEM_mallocN((*stack_len_capacity + KD_NEAR_ALLOC_INC) * sizeof(uint),
@@ -600,6 +813,58 @@ int BLI_kdtree_nd_(find_nearest_n)(const KDTree *tree,
       tree, co, r_nearest, nearest_len_capacity, NULL, NULL);
 }
 
+typedef struct KDTreeFindNearestNBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  KDTreeNearest *r_nearest;
+  uint nearest_len_capacity;
+  int *r_nearest_len;
+} KDTreeFindNearestNBatchData;
+
+static void kdtree_find_nearest_n_batch_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeFindNearestNBatchData *data = userdata;
+  const int nearest_len = BLI_kdtree_nd_(find_nearest_n)(
+      data->tree,
+      data->co[i],
+      &data->r_nearest[(size_t)i * data->nearest_len_capacity],
+      data->nearest_len_capacity);
+  if (data->r_nearest_len) {
+    data->r_nearest_len[i] = nearest_len;
+  }
+}
+
+/**
+ * Find the \a nearest_len_capacity nearest points of each of the \a co_len coordinates,
+ * large batches are searched in parallel.
+ *
+ * \param r_nearest: An array of `co_len * nearest_len_capacity` results,
+ * the results of the coordinate `i` start at `i * nearest_len_capacity`.
+ * \param r_nearest_len: Optional, the number of points found for each coordinate.
+ */
+void BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                          const float (*co)[KD_DIMS],
+                                          const uint co_len,
+                                          KDTreeNearest *r_nearest,
+                                          const uint nearest_len_capacity,
+                                          int *r_nearest_len)
+{
+  KDTreeFindNearestNBatchData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+      .nearest_len_capacity = nearest_len_capacity,
+      .r_nearest_len = r_nearest_len,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (co_len > KD_SEARCH_THREADED_QUERIES_MIN);
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_n_batch_cb, &settings);
+}
+
 static int nearest_cmp_dist(const void *a, const void *b)
 {
   const KDTreeNearest *kda = a;
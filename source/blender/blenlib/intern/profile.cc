@@ -0,0 +1,187 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BLI_fileops.h"
+#include "BLI_profile.h"
+
+bool bli_profile_is_enabled = false;
+
+namespace blender::profile {
+
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+  const char *name;
+  uint64_t begin;
+  uint64_t end;
+};
+
+/* Per thread, to record events without any locking. The buffers live until exit, so they are
+ * allocated with the standard allocator to not be reported as leaks. */
+static constexpr uint64_t events_per_thread = 1 << 16;
+
+struct ThreadEvents {
+  int thread_index;
+  std::vector<Event> events = std::vector<Event>(events_per_thread);
+  /** Only written by the owning thread, the ring buffer index is this modulo its size. */
+  std::atomic<uint64_t> events_num = 0;
+
+  ThreadEvents(const int thread_index) : thread_index(thread_index)
+  {
+  }
+};
+
+static struct {
+  std::mutex mutex;
+  std::string filepath;
+  std::vector<std::unique_ptr<ThreadEvents>> threads;
+  Clock::time_point time_start = Clock::now();
+} profile;
+
+static ThreadEvents &thread_events_get()
+{
+  static thread_local ThreadEvents *thread_events = nullptr;
+  if (thread_events == nullptr) {
+    std::lock_guard lock{profile.mutex};
+    profile.threads.push_back(std::make_unique<ThreadEvents>((int)profile.threads.size()));
+    thread_events = profile.threads.back().get();
+  }
+  return *thread_events;
+}
+
+static void json_string_write(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c; c++) {
+    if (ELEM(*c, '"', '\\')) {
+      fputc('\\', file);
+    }
+    fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+static bool write_chrome_trace(const char *filepath)
+{
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", file);
+  bool is_first = true;
+
+  std::lock_guard lock{profile.mutex};
+  for (const std::unique_ptr<ThreadEvents> &thread : profile.threads) {
+    const uint64_t events_num = thread->events_num.load(std::memory_order_acquire);
+    const uint64_t first = events_num > events_per_thread ? events_num - events_per_thread : 0;
+    for (uint64_t i = first; i < events_num; i++) {
+      const Event &event = thread->events[i % events_per_thread];
+      fputs(is_first ? "  {\"name\": " : ",\n  {\"name\": ", file);
+      json_string_write(file, event.name);
+      /* Time stamps are in microseconds. */
+      fprintf(file,
+              ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+              thread->thread_index,
+              (double)event.begin / 1000.0,
+              (double)(event.end - event.begin) / 1000.0);
+      is_first = false;
+    }
+  }
+
+  fputs("\n]}\n", file);
+  const bool success = (ferror(file) == 0);
+  fclose(file);
+  return success;
+}
+
+}  // namespace blender::profile
+
+using namespace blender::profile;
+
+/** Start recording events, to be written to \a filepath by #BLI_profile_write. */
+void BLI_profile_enable(const char *filepath)
+{
+  {
+    std::lock_guard lock{profile.mutex};
+    profile.filepath = filepath;
+  }
+  bli_profile_is_enabled = true;
+}
+
+/**
+ * Stop recording and write the events of all threads, which shouldn't be recording anymore.
+ * Returns false when the file couldn't be written.
+ */
+bool BLI_profile_write(void)
+{
+  if (!bli_profile_is_enabled) {
+    return true;
+  }
+  bli_profile_is_enabled = false;
+
+  std::string filepath;
+  {
+    std::lock_guard lock{profile.mutex};
+    filepath = profile.filepath;
+  }
+  const bool success = write_chrome_trace(filepath.c_str());
+  if (success) {
+    printf("Profile written to '%s'\n", filepath.c_str());
+  }
+  else {
+    fprintf(stderr, "Error: could not write profile to '%s'\n", filepath.c_str());
+  }
+  return success;
+}
+
+/** Discard all recorded events. */
+void BLI_profile_clear(void)
+{
+  std::lock_guard lock{profile.mutex};
+  for (std::unique_ptr<ThreadEvents> &thread : profile.threads) {
+    thread->events_num.store(0, std::memory_order_release);
+  }
+}
+
+/** Current time in nanoseconds, never zero. */
+uint64_t BLI_profile_time_get(void)
+{
+  const Clock::duration time = Clock::now() - profile.time_start;
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() + 1;
+}
+
+/** Record an event from \a time_begin (see #BLI_profile_time_get) until now. */
+void BLI_profile_event_add(const char *name, const uint64_t time_begin)
+{
+  const uint64_t time_end = BLI_profile_time_get();
+  ThreadEvents &thread = thread_events_get();
+  const uint64_t index = thread.events_num.load(std::memory_order_relaxed);
+  thread.events[index % events_per_thread] = {name, time_begin, time_end};
+  thread.events_num.store(index + 1, std::memory_order_release);
+}
@@ -132,3 +132,124 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/**
+ * Batched queries must find the same results as the one-by-one queries.
+ */
+static void find_nearest_batch_test(int points_len, float scale, int round, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+
+  void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*points)[3] = (float(*)[3])mem;
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, round, scale);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Query other random coordinates, skipping some of them. */
+  const int co_len = points_len * 2 + 3;
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * co_len, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * co_len, __func__);
+  for (int i = 0; i < co_len; i++) {
+    rng_v3_round(co[i], 3, rng, round, scale);
+    nearest[i].index = -1;
+    nearest[i].dist_sq = (i % 7 == 3) ? 0.0f : FLT_MAX;
+  }
+
+  BLI_bvhtree_find_nearest_batch(tree, co, co_len, nearest, nullptr, nullptr);
+
+  for (int i = 0; i < co_len; i++) {
+    if (i % 7 == 3) {
+      EXPECT_EQ(nearest[i].index, -1);
+      continue;
+    }
+    BVHTreeNearest nearest_single;
+    nearest_single.index = -1;
+    nearest_single.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, co[i], &nearest_single, nullptr, nullptr);
+    EXPECT_GE(nearest[i].index, 0);
+    EXPECT_FLOAT_EQ(nearest[i].dist_sq, nearest_single.dist_sq);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(co);
+  MEM_freeN(nearest);
+}
+
+TEST(kdopbvh, FindNearestBatch_1)
+{
+  find_nearest_batch_test(1, 1.0, 1000, 1234);
+}
+TEST(kdopbvh, FindNearestBatch_500)
+{
+  find_nearest_batch_test(500, 1.0, 1000, 12);
+}
+
+static void ray_cast_batch_test(int points_len, float radius, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, 8, 8);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Rays from outside the points, aimed roughly at the center. */
+  const int rays_len = points_len * 4 + 5;
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  BVHTreeRayHit *hit = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hit) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    float target[3];
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+    mul_v3_fl(co[i], 2.0f);
+    rng_v3_round(target, 3, rng, 1000, 0.5f);
+    sub_v3_v3v3(dir[i], target, co[i]);
+    normalize_v3(dir[i]);
+    hit[i].index = -1;
+    hit[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(
+      tree, co, dir, rays_len, radius, hit, nullptr, nullptr, BVH_RAYCAST_DEFAULT);
+
+  int hits_len = 0;
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit_single;
+    hit_single.index = -1;
+    hit_single.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co[i], dir[i], radius, &hit_single, nullptr, nullptr);
+    /* Points on the rounding grid may be hit at the same distance,
+     * so only compare the index when nothing was hit. */
+    EXPECT_EQ(hit[i].index == -1, hit_single.index == -1);
+    if (hit_single.index != -1) {
+      EXPECT_NEAR(hit[i].dist, hit_single.dist, 1e-5f);
+      hits_len++;
+    }
+  }
+  EXPECT_GT(hits_len, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hit);
+}
+
+TEST(kdopbvh, RayCastBatch_500)
+{
+  ray_cast_batch_test(500, 0.0f, 12);
+}
+TEST(kdopbvh, RayCastBatchRadius_500)
+{
+  ray_cast_batch_test(500, 0.05f, 123);
+}
@@ -0,0 +1,155 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static int find_nearest_brute_force(const float (*points)[3], int points_len, const float co[3])
+{
+  int index = -1;
+  float dist_sq_best = FLT_MAX;
+  for (int i = 0; i < points_len; i++) {
+    const float dist_sq = len_squared_v3v3(points[i], co);
+    if (dist_sq < dist_sq_best) {
+      dist_sq_best = dist_sq;
+      index = i;
+    }
+  }
+  return index;
+}
+
+/* Check the nearest point of random coordinates (and of the points themselves) is found. */
+static void find_nearest_check(const KDTree_3d *tree,
+                               const float (*points)[3],
+                               int points_len,
+                               RNG *rng)
+{
+  for (int i = 0; i < 200; i++) {
+    float co[3];
+    BLI_rng_get_float_unit_v3(rng, co);
+    KDTreeNearest_3d nearest;
+    EXPECT_EQ(BLI_kdtree_3d_find_nearest(tree, co, &nearest),
+              find_nearest_brute_force(points, points_len, co));
+  }
+  for (int i = 0; i < points_len; i += 97) {
+    KDTreeNearest_3d nearest;
+    BLI_kdtree_3d_find_nearest(tree, points[i], &nearest);
+    EXPECT_EQ(nearest.dist, 0.0f);
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+/* Large enough to balance sub-trees in parallel. */
+#define POINTS_LEN 50000
+
+TEST(kdtree, Balance)
+{
+  RNG *rng = BLI_rng_new(1);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * POINTS_LEN, __func__);
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(POINTS_LEN);
+  for (int i = 0; i < POINTS_LEN; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  find_nearest_check(tree, points, POINTS_LEN, rng);
+
+  /* Balancing again must give the same result. */
+  BLI_kdtree_3d_balance(tree);
+  find_nearest_check(tree, points, POINTS_LEN, rng);
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+  BLI_rng_free(rng);
+}
+
+TEST(kdtree, Refit)
+{
+  RNG *rng = BLI_rng_new(2);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * POINTS_LEN, __func__);
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(POINTS_LEN);
+  for (int i = 0; i < POINTS_LEN; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  /* Unchanged points don't need any re-balancing. */
+  EXPECT_EQ(BLI_kdtree_3d_refit(tree, points), 0);
+
+  /* Small moves of some of the points only re-balance parts of the tree. */
+  for (int i = 0; i < POINTS_LEN; i++) {
+    if (points[i][0] > 0.5f) {
+      for (int j = 0; j < 3; j++) {
+        points[i][j] += (BLI_rng_get_float(rng) - 0.5f) * 1e-3f;
+      }
+    }
+  }
+  const int rebalanced_len = BLI_kdtree_3d_refit(tree, points);
+  EXPECT_LT(rebalanced_len, POINTS_LEN);
+  find_nearest_check(tree, points, POINTS_LEN, rng);
+
+  /* Large moves. */
+  for (int i = 0; i < POINTS_LEN; i++) {
+    mul_v3_fl(points[i], -2.0f);
+    points[i][0] += (float)(i % 7);
+  }
+  BLI_kdtree_3d_refit(tree, points);
+  find_nearest_check(tree, points, POINTS_LEN, rng);
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+  BLI_rng_free(rng);
+}
+
+TEST(kdtree, FindNearestNBatch)
+{
+  const int points_len = 1000;
+  const int co_len = 2000;
+  const uint nearest_len = 5;
+  RNG *rng = BLI_rng_new(3);
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(points_len);
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    BLI_rng_get_float_unit_v3(rng, co);
+    BLI_kdtree_3d_insert(tree, i, co);
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * co_len, __func__);
+  for (int i = 0; i < co_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+  }
+
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_mallocN(
+      sizeof(*nearest) * co_len * nearest_len, __func__);
+  int *found_len = (int *)MEM_mallocN(sizeof(int) * co_len, __func__);
+  BLI_kdtree_3d_find_nearest_n_batch(tree, co, co_len, nearest, nearest_len, found_len);
+
+  for (int i = 0; i < co_len; i++) {
+    KDTreeNearest_3d nearest_single[nearest_len];
+    EXPECT_EQ(found_len[i], BLI_kdtree_3d_find_nearest_n(tree, co[i], nearest_single, nearest_len));
+    for (int j = 0; j < found_len[i]; j++) {
+      EXPECT_EQ(nearest[i * nearest_len + j].index, nearest_single[j].index);
+    }
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(co);
+  MEM_freeN(nearest);
+  MEM_freeN(found_len);
+  BLI_rng_free(rng);
+}
@@ -0,0 +1,165 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_ohash.h"
+#include "BLI_utildefines.h"
+
+#define TESTCASE_SIZE 10000
+
+/* Unique keys spread over the whole integer range (multiplying by an odd number is a bijection),
+ * including zero which is a NULL key. */
+static unsigned int test_key(const int i)
+{
+  return (unsigned int)i * 2654435761u;
+}
+
+TEST(ohash, InsertLookup)
+{
+  OHash *ohash = BLI_ohash_int_new(__func__);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    BLI_ohash_insert(ohash, POINTER_FROM_UINT(test_key(i)), POINTER_FROM_INT(i));
+  }
+
+  EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    void **v_p = BLI_ohash_lookup_p(ohash, POINTER_FROM_UINT(test_key(i)));
+    ASSERT_NE(v_p, nullptr);
+    EXPECT_EQ(POINTER_AS_INT(*v_p), i);
+  }
+  EXPECT_FALSE(BLI_ohash_haskey(ohash, POINTER_FROM_UINT(test_key(TESTCASE_SIZE))));
+  EXPECT_EQ(BLI_ohash_lookup(ohash, POINTER_FROM_UINT(test_key(TESTCASE_SIZE))), nullptr);
+  EXPECT_EQ(BLI_ohash_lookup_default(
+                ohash, POINTER_FROM_UINT(test_key(TESTCASE_SIZE)), POINTER_FROM_INT(-1)),
+            POINTER_FROM_INT(-1));
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+}
+
+TEST(ohash, InsertRemove)
+{
+  OHash *ohash = BLI_ohash_int_new(__func__);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    BLI_ohash_insert(ohash, POINTER_FROM_UINT(test_key(i)), POINTER_FROM_INT(i));
+  }
+
+  /* Remove every other key, the remaining ones must still be found (across tombstones). */
+  for (int i = 0; i < TESTCASE_SIZE; i += 2) {
+    void *v = BLI_ohash_popkey(ohash, POINTER_FROM_UINT(test_key(i)), nullptr);
+    EXPECT_EQ(POINTER_AS_INT(v), i);
+  }
+  EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE / 2);
+  EXPECT_FALSE(BLI_ohash_remove(ohash, POINTER_FROM_UINT(test_key(0)), nullptr, nullptr));
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    EXPECT_EQ(BLI_ohash_haskey(ohash, POINTER_FROM_UINT(test_key(i))), (i % 2) != 0);
+  }
+
+  for (int i = 1; i < TESTCASE_SIZE; i += 2) {
+    EXPECT_TRUE(BLI_ohash_remove(ohash, POINTER_FROM_UINT(test_key(i)), nullptr, nullptr));
+  }
+  EXPECT_EQ(BLI_ohash_len(ohash), 0);
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+}
+
+/* Many insertions & removals of different keys, reusing removed slots. */
+TEST(ohash, InsertRemoveCycle)
+{
+  OHash *ohash = BLI_ohash_int_new(__func__);
+
+  for (int i = 0; i < TESTCASE_SIZE * 10; i++) {
+    BLI_ohash_insert(ohash, POINTER_FROM_UINT(test_key(i)), POINTER_FROM_INT(i));
+    if (i >= 100) {
+      void *v = BLI_ohash_popkey(ohash, POINTER_FROM_UINT(test_key(i - 100)), nullptr);
+      EXPECT_EQ(POINTER_AS_INT(v), i - 100);
+    }
+  }
+  EXPECT_EQ(BLI_ohash_len(ohash), 100);
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+}
+
+TEST(ohash, EnsureReinsert)
+{
+  OHash *ohash = BLI_ohash_int_new(__func__);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    void **v_p;
+    EXPECT_FALSE(BLI_ohash_ensure_p(ohash, POINTER_FROM_UINT(test_key(i)), &v_p));
+    *v_p = POINTER_FROM_INT(i);
+  }
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    void **v_p;
+    EXPECT_TRUE(BLI_ohash_ensure_p(ohash, POINTER_FROM_UINT(test_key(i)), &v_p));
+    EXPECT_EQ(POINTER_AS_INT(*v_p), i);
+  }
+
+  EXPECT_FALSE(BLI_ohash_reinsert(
+      ohash, POINTER_FROM_UINT(test_key(0)), POINTER_FROM_INT(-1), nullptr, nullptr));
+  EXPECT_EQ(BLI_ohash_lookup(ohash, POINTER_FROM_UINT(test_key(0))), POINTER_FROM_INT(-1));
+  EXPECT_TRUE(BLI_ohash_reinsert(ohash,
+                                 POINTER_FROM_UINT(test_key(TESTCASE_SIZE)),
+                                 POINTER_FROM_INT(TESTCASE_SIZE),
+                                 nullptr,
+                                 nullptr));
+  EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE + 1);
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+}
+
+TEST(ohash, Iter)
+{
+  OHash *ohash = BLI_ohash_int_new_ex(__func__, TESTCASE_SIZE);
+
+  int sum = 0;
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    BLI_ohash_insert(ohash, POINTER_FROM_UINT(test_key(i)), POINTER_FROM_INT(i));
+    sum += i;
+  }
+
+  /* Remove odd values while iterating. */
+  OHashIterator oh_iter;
+  int num_iter = 0;
+  OHASH_ITER (oh_iter, ohash) {
+    const int i = POINTER_AS_INT(BLI_ohashIterator_getValue(&oh_iter));
+    EXPECT_EQ(POINTER_AS_UINT(BLI_ohashIterator_getKey(&oh_iter)), test_key(i));
+    sum -= i;
+    num_iter++;
+    if (i % 2) {
+      EXPECT_TRUE(
+          BLI_ohash_remove(ohash, BLI_ohashIterator_getKey(&oh_iter), nullptr, nullptr));
+    }
+  }
+  EXPECT_EQ(num_iter, TESTCASE_SIZE);
+  EXPECT_EQ(sum, 0);
+  EXPECT_EQ(BLI_ohash_len(ohash), TESTCASE_SIZE / 2);
+
+  BLI_ohash_clear(ohash, nullptr, nullptr);
+  EXPECT_EQ(BLI_ohash_len(ohash), 0);
+  BLI_ohashIterator_init(&oh_iter, ohash);
+  EXPECT_TRUE(BLI_ohashIterator_done(&oh_iter));
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+}
+
+TEST(ohash, String)
+{
+  OHash *ohash = BLI_ohash_str_new(__func__);
+  const char *names[] = {"Cube", "Camera", "Light", "Cube.001", ""};
+
+  for (int i = 0; i < ARRAY_SIZE(names); i++) {
+    BLI_ohash_insert(ohash, (void *)names[i], POINTER_FROM_INT(i));
+  }
+  for (int i = 0; i < ARRAY_SIZE(names); i++) {
+    char name[16];
+    strcpy(name, names[i]);
+    EXPECT_EQ(BLI_ohash_lookup(ohash, name), POINTER_FROM_INT(i));
+  }
+  EXPECT_FALSE(BLI_ohash_haskey(ohash, "Cube.002"));
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+}
@@ -0,0 +1,102 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "BLI_fileops.h"
+#include "BLI_profile.h"
+
+namespace blender::profile::tests {
+
+static std::string file_read(const std::string &filepath)
+{
+  std::ifstream file(filepath);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+static int count_occurrences(const std::string &str, const std::string &sub)
+{
+  int count = 0;
+  for (size_t pos = str.find(sub); pos != std::string::npos; pos = str.find(sub, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+TEST(profile, Disabled)
+{
+  EXPECT_FALSE(BLI_profile_is_enabled());
+  {
+    BLI_PROFILE_SCOPE("disabled_scope");
+  }
+  /* Nothing to write when profiling isn't enabled. */
+  EXPECT_TRUE(BLI_profile_write());
+}
+
+TEST(profile, WriteChromeTrace)
+{
+  const std::string filepath =
+      (std::filesystem::temp_directory_path() / "blender_profile_test.json").string();
+
+  BLI_profile_clear();
+  BLI_profile_enable(filepath.c_str());
+  EXPECT_TRUE(BLI_profile_is_enabled());
+
+  {
+    BLI_PROFILE_SCOPE("outer \"quoted\"");
+    for (int i = 0; i < 3; i++) {
+      BLI_PROFILE_BEGIN(inner);
+      BLI_PROFILE_END(inner, "inner");
+    }
+  }
+  std::thread thread([]() { BLI_PROFILE_SCOPE("other_thread"); });
+  thread.join();
+
+  EXPECT_TRUE(BLI_profile_write());
+  EXPECT_FALSE(BLI_profile_is_enabled());
+
+  const std::string trace = file_read(filepath);
+  BLI_delete(filepath.c_str(), false, false);
+
+  EXPECT_EQ(trace.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": ["), 0);
+  EXPECT_EQ(count_occurrences(trace, "\"ph\": \"X\""), 5);
+  EXPECT_EQ(count_occurrences(trace, "\"name\": \"inner\""), 3);
+  EXPECT_EQ(count_occurrences(trace, "\"name\": \"outer \\\"quoted\\\"\""), 1);
+  EXPECT_EQ(count_occurrences(trace, "\"name\": \"other_thread\""), 1);
+  EXPECT_EQ(count_occurrences(trace, "disabled_scope"), 0);
+
+  BLI_profile_clear();
+}
+
+TEST(profile, RingBufferOverflow)
+{
+  const std::string filepath =
+      (std::filesystem::temp_directory_path() / "blender_profile_overflow_test.json").string();
+
+  BLI_profile_clear();
+  BLI_profile_enable(filepath.c_str());
+
+  /* Only the most recent events of a thread are kept. */
+  std::thread thread([]() {
+    for (int i = 0; i < (1 << 16) + 100; i++) {
+      BLI_PROFILE_SCOPE("event");
+    }
+  });
+  thread.join();
+
+  EXPECT_TRUE(BLI_profile_write());
+  const std::string trace = file_read(filepath);
+  BLI_delete(filepath.c_str(), false, false);
+
+  EXPECT_EQ(count_occurrences(trace, "\"name\": \"event\""), 1 << 16);
+
+  BLI_profile_clear();
+}
+
+}  // namespace blender::profile::tests
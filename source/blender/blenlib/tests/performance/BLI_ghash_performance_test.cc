@@ -8,6 +8,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_ghash.h"
+#include "BLI_ohash.h"
 #include "BLI_rand.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
@@ -347,6 +348,138 @@ TEST(ghash, IntRandMurmur2a50000000)
 }
 #endif
 
+/* Int: same tests as above, using the open-addressing #OHash. */
+
+static void int_ohash_tests(OHash *ohash, const char *id, const unsigned int nbr)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  {
+    unsigned int i = nbr;
+
+    TIMEIT_START(int_insert);
+
+#ifdef GHASH_RESERVE
+    BLI_ohash_reserve(ohash, nbr);
+#endif
+
+    while (i--) {
+      BLI_ohash_insert(ohash, POINTER_FROM_UINT(i), POINTER_FROM_UINT(i));
+    }
+
+    TIMEIT_END(int_insert);
+  }
+
+  {
+    unsigned int i = nbr;
+
+    TIMEIT_START(int_lookup);
+
+    while (i--) {
+      void *v = BLI_ohash_lookup(ohash, POINTER_FROM_UINT(i));
+      EXPECT_EQ(POINTER_AS_UINT(v), i);
+    }
+
+    TIMEIT_END(int_lookup);
+  }
+
+  {
+    unsigned int i = nbr;
+
+    TIMEIT_START(int_remove);
+
+    while (i--) {
+      EXPECT_TRUE(BLI_ohash_remove(ohash, POINTER_FROM_UINT(i), nullptr, nullptr));
+    }
+
+    TIMEIT_END(int_remove);
+  }
+  EXPECT_EQ(BLI_ohash_len(ohash), 0);
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(ghash, IntOHash12000)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+
+  int_ohash_tests(ohash, "IntOHash - OHash - 12000", 12000);
+}
+
+#ifdef GHASH_RUN_BIG
+TEST(ghash, IntOHash100000000)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+
+  int_ohash_tests(ohash, "IntOHash - OHash - 100000000", 100000000);
+}
+#endif
+
+static void randint_ohash_tests(OHash *ohash, const char *id, const unsigned int nbr)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  unsigned int *data = (unsigned int *)MEM_mallocN(sizeof(*data) * (size_t)nbr, __func__);
+  unsigned int *dt;
+  unsigned int i;
+
+  {
+    RNG *rng = BLI_rng_new(1);
+    for (i = nbr, dt = data; i--; dt++) {
+      *dt = BLI_rng_get_uint(rng);
+    }
+    BLI_rng_free(rng);
+  }
+
+  {
+    TIMEIT_START(int_insert);
+
+#ifdef GHASH_RESERVE
+    BLI_ohash_reserve(ohash, nbr);
+#endif
+
+    for (i = nbr, dt = data; i--; dt++) {
+      BLI_ohash_insert(ohash, POINTER_FROM_UINT(*dt), POINTER_FROM_UINT(*dt));
+    }
+
+    TIMEIT_END(int_insert);
+  }
+
+  {
+    TIMEIT_START(int_lookup);
+
+    for (i = nbr, dt = data; i--; dt++) {
+      void *v = BLI_ohash_lookup(ohash, POINTER_FROM_UINT(*dt));
+      EXPECT_EQ(POINTER_AS_UINT(v), *dt);
+    }
+
+    TIMEIT_END(int_lookup);
+  }
+
+  BLI_ohash_free(ohash, nullptr, nullptr);
+  MEM_freeN(data);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(ghash, IntRandOHash12000)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+
+  randint_ohash_tests(ohash, "RandIntOHash - OHash - 12000", 12000);
+}
+
+#ifdef GHASH_RUN_BIG
+TEST(ghash, IntRandOHash50000000)
+{
+  OHash *ohash = BLI_ohash_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+
+  randint_ohash_tests(ohash, "RandIntOHash - OHash - 50000000", 50000000);
+}
+#endif
+
 static unsigned int ghashutil_tests_nohash_p(const void *p)
 {
   return POINTER_AS_UINT(p);
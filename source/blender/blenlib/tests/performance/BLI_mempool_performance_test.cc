@@ -0,0 +1,181 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 10
+
+/* Size of the allocated elements, similar to a #BMVert. */
+#define ELEM_SIZE 80
+
+/* Number of allocations done by each iteration, some of them are freed right away. */
+#define ALLOC_PER_ITER 16
+
+struct MempoolTestData {
+  BLI_mempool *pool;
+  void **elems;
+};
+
+static void mempool_alloc_iter_func(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MempoolTestData *data = (MempoolTestData *)userdata;
+  void **elems = &data->elems[index * ALLOC_PER_ITER];
+
+  for (int i = 0; i < ALLOC_PER_ITER; i++) {
+    elems[i] = BLI_mempool_alloc(data->pool);
+    *(int *)elems[i] = index;
+    if (i % 4 == 3) {
+      /* Free some elements so allocations also reuse freed memory. */
+      BLI_mempool_free(data->pool, elems[i - 1]);
+      elems[i - 1] = nullptr;
+    }
+  }
+}
+
+static void mempool_free_iter_func(void *__restrict userdata,
+                                   const int index,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MempoolTestData *data = (MempoolTestData *)userdata;
+  void **elems = &data->elems[index * ALLOC_PER_ITER];
+
+  for (int i = 0; i < ALLOC_PER_ITER; i++) {
+    if (elems[i] != nullptr) {
+      BLI_mempool_free(data->pool, elems[i]);
+    }
+  }
+}
+
+static void guardedalloc_alloc_iter_func(void *__restrict userdata,
+                                         const int index,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MempoolTestData *data = (MempoolTestData *)userdata;
+  void **elems = &data->elems[index * ALLOC_PER_ITER];
+
+  for (int i = 0; i < ALLOC_PER_ITER; i++) {
+    elems[i] = MEM_mallocN(ELEM_SIZE, __func__);
+    *(int *)elems[i] = index;
+    if (i % 4 == 3) {
+      MEM_freeN(elems[i - 1]);
+      elems[i - 1] = nullptr;
+    }
+  }
+}
+
+static void guardedalloc_free_iter_func(void *__restrict userdata,
+                                        const int index,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MempoolTestData *data = (MempoolTestData *)userdata;
+  void **elems = &data->elems[index * ALLOC_PER_ITER];
+
+  for (int i = 0; i < ALLOC_PER_ITER; i++) {
+    if (elems[i] != nullptr) {
+      MEM_freeN(elems[i]);
+    }
+  }
+}
+
+static void mempool_test(const char *id, const int num_iter, const bool use_mempool)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+
+  MempoolTestData data;
+  data.elems = (void **)MEM_calloc_arrayN(
+      (size_t)num_iter * ALLOC_PER_ITER, sizeof(void *), __func__);
+
+  double averaged_timing = 0.0;
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    const double init_time = PIL_check_seconds_timer();
+    if (use_mempool) {
+      data.pool = BLI_mempool_create(
+          ELEM_SIZE, 0, 512, BLI_MEMPOOL_ALLOW_ITER | BLI_MEMPOOL_THREADSAFE);
+      BLI_task_parallel_range(0, num_iter, &data, mempool_alloc_iter_func, &settings);
+    }
+    else {
+      BLI_task_parallel_range(0, num_iter, &data, guardedalloc_alloc_iter_func, &settings);
+    }
+    const double alloc_time = PIL_check_seconds_timer();
+
+    /* Check every element was allocated once. */
+    for (int i = 0; i < num_iter; i++) {
+      for (int j = 0; j < ALLOC_PER_ITER; j++) {
+        void *elem = data.elems[i * ALLOC_PER_ITER + j];
+        if (elem != nullptr) {
+          EXPECT_EQ(*(int *)elem, i);
+        }
+      }
+    }
+
+    if (use_mempool) {
+      const int num_used = num_iter * (ALLOC_PER_ITER - ALLOC_PER_ITER / 4);
+      EXPECT_EQ(BLI_mempool_len(data.pool), num_used);
+
+      int num_iterated = 0;
+      BLI_mempool_iter iter;
+      BLI_mempool_iternew(data.pool, &iter);
+      while (BLI_mempool_iterstep(&iter)) {
+        num_iterated++;
+      }
+      EXPECT_EQ(num_iterated, num_used);
+    }
+
+    const double check_time = PIL_check_seconds_timer();
+    if (use_mempool) {
+      BLI_task_parallel_range(0, num_iter, &data, mempool_free_iter_func, &settings);
+      EXPECT_EQ(BLI_mempool_len(data.pool), 0);
+      BLI_mempool_destroy(data.pool);
+    }
+    else {
+      BLI_task_parallel_range(0, num_iter, &data, guardedalloc_free_iter_func, &settings);
+    }
+    averaged_timing += (alloc_time - init_time) + (PIL_check_seconds_timer() - check_time);
+  }
+
+  printf("\t%s: done in %fs on average over %d runs\n",
+         id,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  MEM_freeN(data.elems);
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(mempool, ThreadsafeAlloc100k)
+{
+  mempool_test("Threadsafe mempool - 100000 iterations", 100000, true);
+}
+
+TEST(mempool, GuardedAlloc100k)
+{
+  mempool_test("Guarded allocator - 100000 iterations", 100000, false);
+}
+
+TEST(mempool, ThreadsafeAlloc1M)
+{
+  mempool_test("Threadsafe mempool - 1000000 iterations", 1000000, true);
+}
+
+TEST(mempool, GuardedAlloc1M)
+{
+  mempool_test("Guarded allocator - 1000000 iterations", 1000000, false);
+}
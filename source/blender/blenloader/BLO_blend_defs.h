@@ -68,6 +68,11 @@ enum {
    * Terminate reading (no data).
    */
   ENDB = BLEND_MAKE_ID('E', 'N', 'D', 'B'),
+  /**
+   * Index of the data-blocks in the file (names, previews, libraries),
+   * written after #ENDB so regular reading ignores it, see #BlendFileIndexHeader.
+   */
+  INDX = BLEND_MAKE_ID('I', 'N', 'D', 'X'),
 };
 
 #define BLEN_THUMB_MEMSIZE_FILE(_x, _y) (sizeof(int) * (2 + (size_t)(_x) * (size_t)(_y)))
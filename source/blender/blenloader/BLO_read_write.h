@@ -54,6 +54,7 @@ typedef struct BlendExpander BlendExpander;
 typedef struct BlendLibReader BlendLibReader;
 typedef struct BlendWriter BlendWriter;
 
+struct BlendFileLazyData;
 struct Main;
 struct ReportList;
 
@@ -198,6 +199,11 @@ void *BLO_read_get_new_packed_address(BlendDataReader *reader, const void *old_a
 #define BLO_read_packed_address(reader, ptr_p) \
   *((void **)ptr_p) = BLO_read_get_new_packed_address((reader), *(ptr_p))
 
+/* Returns the location of data which wasn't read (see #BLO_READ_LAZY_PACKED_DATA),
+ * or NULL when the data is available through #BLO_read_packed_address. */
+struct BlendFileLazyData *BLO_read_get_lazy_data(BlendDataReader *reader,
+                                                 const void *old_address);
+
 typedef void (*BlendReadListFn)(BlendDataReader *reader, void *data);
 void BLO_read_list_cb(BlendDataReader *reader, struct ListBase *list, BlendReadListFn callback);
 void BLO_read_list(BlendDataReader *reader, struct ListBase *list);
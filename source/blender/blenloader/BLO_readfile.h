@@ -81,7 +81,7 @@ typedef struct BlendFileData {
 } BlendFileData;
 
 struct BlendFileReadParams {
-  uint skip_flags : 3; /* eBLOReadSkip */
+  uint skip_flags : 4; /* eBLOReadSkip */
   uint is_startup : 1;
 
   /** Whether we are reading the memfile for an undo (< 0) or a redo (> 0). */
@@ -95,6 +95,12 @@ typedef enum eBLOReadSkip {
   BLO_READ_SKIP_DATA = (1 << 1),
   /** Do not attempt to re-use IDs from old bmain for unchanged ones in case of undo. */
   BLO_READ_SKIP_UNDO_OLD_MAIN = (1 << 2),
+  /**
+   * Don't read large packed file data (images, sounds, fonts, volumes...) when opening the file,
+   * only record its location so it can be loaded when first accessed,
+   * see #BKE_packedfile_data_ensure. Ignored for compressed (gzip), memory and undo reading.
+   */
+  BLO_READ_LAZY_PACKED_DATA = (1 << 3),
 } eBLOReadSkip;
 #define BLO_READ_SKIP_ALL (BLO_READ_SKIP_USERDEF | BLO_READ_SKIP_DATA)
 
@@ -113,6 +119,18 @@ BlendFileData *BLO_read_from_memfile(struct Main *oldmain,
 
 void BLO_blendfiledata_free(BlendFileData *bfd);
 
+/** Location of data which wasn't read from the file yet, see #BLO_READ_LAZY_PACKED_DATA. */
+typedef struct BlendFileLazyData {
+  char filepath[1024]; /* FILE_MAX */
+  /** Offset of the block header in the (uncompressed) file. */
+  int64_t bhead_offset;
+  /** Address & size of the block when it was written, to check the file didn't change. */
+  const void *old_address;
+  int len;
+} BlendFileLazyData;
+
+void *BLO_read_lazy_data(const BlendFileLazyData *lazy_data, struct ReportList *reports);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -127,6 +145,7 @@ struct LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh,
                                                      int *tot_names);
 struct LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *tot_prev);
 struct LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh);
+struct LinkNode *BLO_blendhandle_get_library_filepaths(BlendHandle *bh, int *tot_libraries);
 
 void BLO_blendhandle_close(BlendHandle *bh);
 
@@ -136,6 +155,7 @@ void BLO_blendhandle_close(BlendHandle *bh);
 #define BLO_EMBEDDED_STARTUP_BLEND "<startup.blend>"
 
 bool BLO_has_bfile_extension(const char *str);
+bool BLO_has_bfile_header(const char *filepath);
 bool BLO_library_path_explode(const char *path, char *r_dir, char **r_group, char **r_name);
 
 /* -------------------------------------------------------------------- */
@@ -24,7 +24,12 @@
  * \ingroup blenloader
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct GHash;
+struct GSet;
 struct Scene;
 
 typedef struct {
@@ -32,7 +37,9 @@ typedef struct {
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the chunk at the same position in the previous
+   * #MemFile and shares its memory (used by undo code to detect unchanged IDs).
+   * Buffers are reference counted, so this does not imply ownership. */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -41,11 +48,18 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the buffer content, used to share identical buffers between chunks regardless of
+   * their position in the stream. */
+  uint hash;
 } MemFileChunk;
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size in bytes of the buffers allocated by this memfile. */
   size_t size;
+  /** Size in bytes of the buffers this memfile shares with other chunks (in this memfile or in
+   * other steps still using them), these are not accounted for in `size`. */
+  size_t size_shared;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -57,12 +71,16 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Set of #MemFileChunk from the reference and written memfiles, hashed by content. */
+  struct GSet *chunk_content_set;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
   char filename[1024]; /* FILE_MAX */
   MemFile memfile;
   size_t undo_size;
+  /** Size of the data shared with other undo steps (not included in `undo_size`). */
+  size_t undo_size_shared;
 } MemFileUndoData;
 
 /* actually only used writefile.c */
@@ -84,3 +102,21 @@ extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+
+/* Incremental auto-save journal. */
+
+/** First bytes of a journal file, used to detect them when reading. */
+#define MEMFILE_JOURNAL_MAGIC "BLENDJNL"
+
+typedef struct MemFileJournal MemFileJournal;
+
+MemFileJournal *BLO_memfile_journal_new(void);
+void BLO_memfile_journal_free(MemFileJournal *journal);
+bool BLO_memfile_journal_write(MemFileJournal *journal,
+                               struct MemFile *memfile,
+                               const char *filepath);
+void *BLO_memfile_journal_read(int file, size_t *r_len);
+
+#ifdef __cplusplus
+}
+#endif
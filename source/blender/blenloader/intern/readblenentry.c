@@ -37,6 +37,7 @@
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
 
+#include "DNA_ID.h"
 #include "DNA_genfile.h"
 #include "DNA_sdna_types.h"
 
@@ -143,6 +144,18 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh, int ofblocktype,
   BHead *bhead;
   int tot = 0;
 
+  if (fd->index != NULL) {
+    const BlendFileIndexEntry *entries = BLEND_FILE_INDEX_ENTRIES(fd->index);
+    for (int i = 0; i < fd->index->entries_len; i++) {
+      if (entries[i].code == ofblocktype) {
+        BLI_linklist_prepend(&names, strdup(entries[i].name + 2));
+        tot++;
+      }
+    }
+    *tot_names = tot;
+    return names;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ofblocktype) {
       const char *idname = blo_bhead_id_name(fd, bhead);
@@ -159,6 +172,57 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh, int ofblocktype,
   return names;
 }
 
+static bool blendhandle_preview_idcode_supported(const short idcode)
+{
+  return ELEM(idcode, ID_MA, ID_TE, ID_IM, ID_WO, ID_LA, ID_OB, ID_GR, ID_SCE);
+}
+
+/**
+ * Read the #PreviewImage block at \a offset (from the file index) and its images.
+ */
+static void blendhandle_preview_read_at(FileData *fd, uint64_t offset, PreviewImage *new_prv)
+{
+  BHead *bhead = blo_bhead_read_detached(fd, offset);
+  if (bhead == NULL) {
+    return;
+  }
+
+  PreviewImage *prv = NULL;
+  if (bhead->code == DATA && bhead->SDNAnr == DNA_struct_find_nr(fd->filesdna, "PreviewImage")) {
+    prv = BLO_library_read_struct(fd, bhead, "PreviewImage");
+  }
+  if (prv == NULL) {
+    blo_bhead_free_detached(bhead);
+    return;
+  }
+
+  const char *rect_names[NUM_ICON_SIZES] = {"PreviewImage Icon Rect", "PreviewImage Image Rect"};
+  memcpy(new_prv, prv, sizeof(PreviewImage));
+
+  /* The images are written right after the #PreviewImage. */
+  BHead *bhead_rect = bhead;
+  for (int i = 0; i < NUM_ICON_SIZES; i++) {
+    new_prv->rect[i] = NULL;
+    if (bhead_rect != NULL && prv->rect[i] && prv->w[i] && prv->h[i]) {
+      BHead *bhead_next = blo_bhead_read_detached_next(fd, bhead_rect);
+      blo_bhead_free_detached(bhead_rect);
+      bhead_rect = bhead_next;
+      if (bhead_rect != NULL) {
+        BLI_assert((new_prv->w[i] * new_prv->h[i] * sizeof(uint)) == bhead_rect->len);
+        new_prv->rect[i] = BLO_library_read_struct(fd, bhead_rect, rect_names[i]);
+      }
+    }
+    if (new_prv->rect[i] == NULL) {
+      new_prv->w[i] = new_prv->h[i] = 0;
+    }
+  }
+  if (bhead_rect != NULL) {
+    blo_bhead_free_detached(bhead_rect);
+  }
+
+  MEM_freeN(prv);
+}
+
 /**
  * Gets the previews of all the data-blocks in a file of a certain type
  * (e.g. all the scene previews in a file).
@@ -178,25 +242,32 @@ LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *to
   PreviewImage *new_prv = NULL;
   int tot = 0;
 
+  if (fd->index != NULL) {
+    /* Seek directly to the previews instead of reading the whole file. */
+    const BlendFileIndexEntry *entries = BLEND_FILE_INDEX_ENTRIES(fd->index);
+    for (int i = 0; i < fd->index->entries_len; i++) {
+      if (entries[i].code == ofblocktype &&
+          blendhandle_preview_idcode_supported(GS(entries[i].name))) {
+        new_prv = MEM_callocN(sizeof(PreviewImage), "newpreview");
+        BLI_linklist_prepend(&previews, new_prv);
+        tot++;
+        if (entries[i].preview_offset != 0) {
+          blendhandle_preview_read_at(fd, entries[i].preview_offset, new_prv);
+        }
+      }
+    }
+    *tot_prev = tot;
+    return previews;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ofblocktype) {
       const char *idname = blo_bhead_id_name(fd, bhead);
-      switch (GS(idname)) {
-        case ID_MA:  /* fall through */
-        case ID_TE:  /* fall through */
-        case ID_IM:  /* fall through */
-        case ID_WO:  /* fall through */
-        case ID_LA:  /* fall through */
-        case ID_OB:  /* fall through */
-        case ID_GR:  /* fall through */
-        case ID_SCE: /* fall through */
-          new_prv = MEM_callocN(sizeof(PreviewImage), "newpreview");
-          BLI_linklist_prepend(&previews, new_prv);
-          tot++;
-          looking = 1;
-          break;
-        default:
-          break;
+      if (blendhandle_preview_idcode_supported(GS(idname))) {
+        new_prv = MEM_callocN(sizeof(PreviewImage), "newpreview");
+        BLI_linklist_prepend(&previews, new_prv);
+        tot++;
+        looking = 1;
       }
     }
     else if (bhead->code == DATA) {
@@ -263,6 +334,22 @@ LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
   LinkNode *names = NULL;
   BHead *bhead;
 
+  if (fd->index != NULL) {
+    const BlendFileIndexEntry *entries = BLEND_FILE_INDEX_ENTRIES(fd->index);
+    for (int i = 0; i < fd->index->entries_len; i++) {
+      const int code = entries[i].code;
+      if (BKE_idtype_idcode_is_valid(code) && BKE_idtype_idcode_is_linkable(code)) {
+        const char *str = BKE_idtype_idcode_to_name(code);
+
+        if (BLI_gset_add(gathered, (void *)str)) {
+          BLI_linklist_prepend(&names, strdup(str));
+        }
+      }
+    }
+    BLI_gset_free(gathered, NULL);
+    return names;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ENDB) {
       break;
@@ -283,6 +370,47 @@ LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
   return names;
 }
 
+/**
+ * Gets the file paths of the libraries used by a file (as stored, so they may be relative).
+ *
+ * \param bh: The blendhandle to access.
+ * \param tot_libraries: The length of the returned list.
+ * \return A BLI_linklist of strings. The string links should be freed with malloc.
+ */
+LinkNode *BLO_blendhandle_get_library_filepaths(BlendHandle *bh, int *tot_libraries)
+{
+  FileData *fd = (FileData *)bh;
+  LinkNode *filepaths = NULL;
+  int tot = 0;
+
+  if (fd->index != NULL) {
+    char(*libraries)[FILE_MAX] = BLEND_FILE_INDEX_LIBRARIES(fd->index);
+    for (int i = 0; i < fd->index->libraries_len; i++) {
+      BLI_linklist_prepend(&filepaths, strdup(libraries[i]));
+      tot++;
+    }
+    *tot_libraries = tot;
+    return filepaths;
+  }
+
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == ID_LI) {
+      Library *lib = BLO_library_read_struct(fd, bhead, "Library");
+      if (lib) {
+        BLI_linklist_prepend(&filepaths, strdup(lib->filepath));
+        tot++;
+        MEM_freeN(lib);
+      }
+    }
+    else if (bhead->code == ENDB) {
+      break;
+    }
+  }
+
+  *tot_libraries = tot;
+  return filepaths;
+}
+
 /**
  * Close and free a blendhandle. The handle becomes invalid after this call.
  *
@@ -65,6 +65,8 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -103,10 +105,16 @@
 
 #include "SEQ_sequencer.h"
 
+#include "PIL_time.h"
+
 #include "readfile.h"
 
 #include <errno.h>
 
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
+
 /* Make preferences read-only. */
 #define U (*((const UserDef *)&U))
 
@@ -164,14 +172,29 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when using gzip compression,
  * while zlib supports seek it's unusably slow, see: T61880.
+ * Zstd compressed files written by Blender include a seek table, so they support it.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
+/**
+ * Decode the structs of all blocks in parallel (DNA reconstruction, endian switching & copying)
+ * before linking the data-blocks, see #read_file_decode_parallel.
+ *
+ * \note Only used when reading blocks doesn't depend on the file position,
+ * so memory mapped files or files that were fully read into memory.
+ *
+ * \note Only the decoding runs in parallel. Reading the data-blocks themselves
+ * (#read_libblock, #direct_link_id) stays single threaded: it inserts into the #OldNewMap's
+ * while looking pointers up in them, adds ID's to #Main in file order and the
+ * `blend_read_data` callbacks of an ID may access data of other ID's.
+ */
+#define USE_PARALLEL_STRUCT_DECODE
+
 /* Use GHash for restoring pointers by name */
 #define USE_GHASH_RESTORE_POINTER
 
@@ -200,6 +223,10 @@ typedef struct BHeadN {
   bool has_data;
 #endif
   bool is_memchunk_identical;
+#ifdef USE_PARALLEL_STRUCT_DECODE
+  /** The result of #read_struct, when it was called ahead of time. */
+  void *data_decoded;
+#endif
   struct BHead bhead;
 } BHeadN;
 
@@ -209,6 +236,12 @@ typedef struct BHeadN {
  * because ID names are used in lookup tables. */
 #define BHEAD_USE_READ_ON_DEMAND(bhead) ((bhead)->code == DATA)
 
+/**
+ * Raw data blocks (as written by #BLO_write_raw) at least this big are not read
+ * when opening a file with #BLO_READ_LAZY_PACKED_DATA, see #read_data_is_lazy.
+ */
+#define LAZY_DATA_MIN_SIZE (64 * 1024)
+
 /**
  * This function ensures that reports are printed,
  * in the case of library linking errors this is important!
@@ -812,6 +845,9 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = fd->file_offset;
           new_bhead->has_data = false;
           new_bhead->is_memchunk_identical = false;
+#ifdef USE_PARALLEL_STRUCT_DECODE
+          new_bhead->data_decoded = NULL;
+#endif
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->seek(fd, bhead.len, SEEK_CUR);
           if (seek_new == -1) {
@@ -835,6 +871,9 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->has_data = true;
 #endif
           new_bhead->is_memchunk_identical = false;
+#ifdef USE_PARALLEL_STRUCT_DECODE
+          new_bhead->data_decoded = NULL;
+#endif
           new_bhead->bhead = bhead;
 
           readsize = fd->read(
@@ -863,6 +902,19 @@ static BHeadN *get_bhead(FileData *fd)
   return new_bhead;
 }
 
+/**
+ * Read the block at the current file position without adding it to #FileData.bhead_list,
+ * used to read blocks at known offsets (file index, lazily read data).
+ */
+static BHeadN *get_bhead_detached(FileData *fd)
+{
+  BHeadN *new_bhead = get_bhead(fd);
+  if (new_bhead) {
+    BLI_remlink(&fd->bhead_list, new_bhead);
+  }
+  return new_bhead;
+}
+
 BHead *blo_bhead_first(FileData *fd)
 {
   BHeadN *new_bhead;
@@ -883,6 +935,44 @@ BHead *blo_bhead_first(FileData *fd)
   return bhead;
 }
 
+/**
+ * Read the block at \a offset (see #BlendFileIndexEntry),
+ * the result must be freed with #blo_bhead_free_detached.
+ */
+BHead *blo_bhead_read_detached(FileData *fd, uint64_t offset)
+{
+  if (fd->seek == NULL || fd->seek(fd, (off64_t)offset, SEEK_SET) == -1) {
+    return NULL;
+  }
+  fd->is_eof = false;
+  BHeadN *new_bhead = get_bhead_detached(fd);
+  return new_bhead ? &new_bhead->bhead : NULL;
+}
+
+/**
+ * Read the block following \a thisblock (which doesn't need to be in #FileData.bhead_list),
+ * the result must be freed with #blo_bhead_free_detached.
+ */
+BHead *blo_bhead_read_detached_next(FileData *fd, BHead *thisblock)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  if (new_bhead->has_data == false) {
+    return blo_bhead_read_detached(fd,
+                                   (uint64_t)new_bhead->file_offset + (uint64_t)thisblock->len);
+  }
+#endif
+  /* The file position is right after blocks which are read fully. */
+  UNUSED_VARS(thisblock);
+  BHeadN *next_bhead = get_bhead_detached(fd);
+  return next_bhead ? &next_bhead->bhead : NULL;
+}
+
+void blo_bhead_free_detached(BHead *bhead)
+{
+  MEM_freeN(BHEADN_FROM_BHEAD(bhead));
+}
+
 BHead *blo_bhead_prev(FileData *UNUSED(fd), BHead *thisblock)
 {
   BHeadN *bheadn = BHEADN_FROM_BHEAD(thisblock);
@@ -923,6 +1013,11 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file != NULL) {
+    /* No need to seek, this also makes reading thread-safe. */
+    return BLI_mmap_read(
+        fd->mmap_file, buf, (size_t)new_bhead->file_offset, (size_t)new_bhead->bhead.len);
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -939,6 +1034,31 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
+/**
+ * Access the data of a block which hasn't been read yet directly from the memory mapped file,
+ * avoiding a copy when the data is only used as input (for DNA reconstruction for e.g.).
+ *
+ * \return NULL when the file isn't memory mapped, and on Windows where IO errors raise an
+ * exception that is only handled while copying with #BLI_mmap_read.
+ * \note Callers must check #BLI_mmap_any_io_error after accessing the data.
+ */
+static const void *blo_bhead_data_mapped(FileData *fd, BHead *thisblock)
+{
+#ifdef WIN32
+  UNUSED_VARS(fd, thisblock);
+  return NULL;
+#else
+  if (fd->mmap_file == NULL) {
+    return NULL;
+  }
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  BLI_assert(new_bhead->file_offset + new_bhead->bhead.len <=
+             (off64_t)BLI_mmap_get_length(fd->mmap_file));
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+#endif
+}
+
 static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
@@ -947,6 +1067,9 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
   new_bhead_data->is_memchunk_identical = false;
+#ifdef USE_PARALLEL_STRUCT_DECODE
+  new_bhead_data->data_decoded = NULL;
+#endif
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
     return NULL;
@@ -1004,6 +1127,29 @@ static void decode_blender_header(FileData *fd)
 /**
  * \return Success if the file is read correctly, else set \a r_error_message.
  */
+static bool read_file_dna_decode(FileData *fd,
+                                 BHead *bhead,
+                                 const int subversion,
+                                 const char **r_error_message)
+{
+  BLI_assert(bhead->code == DNA1);
+  const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
+
+  fd->filesdna = DNA_sdna_from_data(&bhead[1], bhead->len, do_endian_swap, true, r_error_message);
+  if (fd->filesdna) {
+    blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
+    fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+    fd->reconstruct_info = DNA_reconstruct_info_create(fd->filesdna, fd->memsdna, fd->compflags);
+    /* used to retrieve ID names from (bhead+1) */
+    fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
+    BLI_assert(fd->id_name_offs != -1);
+
+    return true;
+  }
+
+  return false;
+}
+
 static bool read_file_dna(FileData *fd, const char **r_error_message)
 {
   BHead *bhead;
@@ -1026,23 +1172,7 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
       subversion = atoi(num);
     }
     else if (bhead->code == DNA1) {
-      const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
-
-      fd->filesdna = DNA_sdna_from_data(
-          &bhead[1], bhead->len, do_endian_swap, true, r_error_message);
-      if (fd->filesdna) {
-        blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
-        fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
-        fd->reconstruct_info = DNA_reconstruct_info_create(
-            fd->filesdna, fd->memsdna, fd->compflags);
-        /* used to retrieve ID names from (bhead+1) */
-        fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
-        BLI_assert(fd->id_name_offs != -1);
-
-        return true;
-      }
-
-      return false;
+      return read_file_dna_decode(fd, bhead, subversion, r_error_message);
     }
     else if (bhead->code == ENDB) {
       break;
@@ -1053,6 +1183,122 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
   return false;
 }
 
+static void read_file_index_switch_endian(BlendFileIndexHeader *index, const size_t index_size)
+{
+  BLI_endian_switch_int32(&index->version);
+  BLI_endian_switch_int32(&index->entries_len);
+  BLI_endian_switch_int32(&index->libraries_len);
+  BLI_endian_switch_int32(&index->subversion);
+  BLI_endian_switch_uint64(&index->dna_offset);
+
+  if (index->entries_len < 0 || index->libraries_len < 0 ||
+      BLEND_FILE_INDEX_SIZE(index->entries_len, index->libraries_len) > index_size) {
+    return;
+  }
+  BlendFileIndexEntry *entries = BLEND_FILE_INDEX_ENTRIES(index);
+  for (int i = 0; i < index->entries_len; i++) {
+    BLI_endian_switch_int32(&entries[i].code);
+    BLI_endian_switch_uint64(&entries[i].bhead_offset);
+    BLI_endian_switch_uint64(&entries[i].preview_offset);
+  }
+}
+
+/**
+ * Read the #INDX block at \a index_offset and the #DNA1 block it points to.
+ */
+static bool read_file_index_block(FileData *fd, const uint64_t index_offset)
+{
+  if (fd->seek(fd, (off64_t)index_offset, SEEK_SET) == -1) {
+    return false;
+  }
+  BHeadN *index_bhead = get_bhead_detached(fd);
+  if (index_bhead == NULL) {
+    return false;
+  }
+
+  BlendFileIndexHeader *index = NULL;
+  const size_t index_size = (size_t)index_bhead->bhead.len;
+  if (index_bhead->bhead.code == INDX && index_size >= sizeof(*index)) {
+    index = MEM_mallocN(index_size, "BlendFileIndex");
+    memcpy(index, &index_bhead->bhead + 1, index_size);
+    if (fd->flags & FD_FLAGS_SWITCH_ENDIAN) {
+      read_file_index_switch_endian(index, index_size);
+    }
+    if ((index->version != BLEND_FILE_INDEX_VERSION) || (index->entries_len < 0) ||
+        (index->libraries_len < 0) ||
+        (BLEND_FILE_INDEX_SIZE(index->entries_len, index->libraries_len) > index_size)) {
+      MEM_freeN(index);
+      index = NULL;
+    }
+  }
+  MEM_freeN(index_bhead);
+
+  if (index == NULL) {
+    return false;
+  }
+
+  /* Don't trust strings from the file. */
+  BlendFileIndexEntry *entries = BLEND_FILE_INDEX_ENTRIES(index);
+  for (int i = 0; i < index->entries_len; i++) {
+    entries[i].name[sizeof(entries[i].name) - 1] = '\0';
+  }
+  char(*libraries)[FILE_MAX] = BLEND_FILE_INDEX_LIBRARIES(index);
+  for (int i = 0; i < index->libraries_len; i++) {
+    libraries[i][FILE_MAX - 1] = '\0';
+  }
+
+  bool success = false;
+  if (fd->seek(fd, (off64_t)index->dna_offset, SEEK_SET) != -1) {
+    BHeadN *dna_bhead = get_bhead_detached(fd);
+    if (dna_bhead != NULL) {
+      const char *error_message = NULL;
+      success = (dna_bhead->bhead.code == DNA1) &&
+                read_file_dna_decode(fd, &dna_bhead->bhead, index->subversion, &error_message);
+      MEM_freeN(dna_bhead);
+    }
+  }
+
+  if (success) {
+    fd->index = index;
+  }
+  else {
+    MEM_freeN(index);
+  }
+  return success;
+}
+
+/**
+ * Read the index written at the end of the file (see #BlendFileIndexHeader) and the DNA,
+ * without reading all blocks of the file. When this fails #read_file_dna has to be used.
+ */
+static bool read_file_index(FileData *fd)
+{
+  if (fd->seek == NULL) {
+    return false;
+  }
+
+  bool success = false;
+  BlendFileIndexTrailer trailer;
+  bool is_memchunk_identical;
+  if ((fd->seek(fd, -(off64_t)sizeof(trailer), SEEK_END) != -1) &&
+      (fd->read(fd, &trailer, sizeof(trailer), &is_memchunk_identical) ==
+       (ssize_t)sizeof(trailer)) &&
+      (memcmp(trailer.magic, BLEND_FILE_INDEX_MAGIC, sizeof(trailer.magic)) == 0)) {
+    if (fd->flags & FD_FLAGS_SWITCH_ENDIAN) {
+      BLI_endian_switch_uint64(&trailer.index_offset);
+    }
+    success = read_file_index_block(fd, trailer.index_offset);
+  }
+
+  /* Blocks are read from the start of the file as usual. */
+  fd->is_eof = false;
+  if (fd->seek(fd, SIZEOFBLENDERHEADER, SEEK_SET) == -1) {
+    fd->is_eof = true;
+    return false;
+  }
+  return success;
+}
+
 static int *read_file_thumbnail(FileData *fd)
 {
   BHead *bhead;
@@ -1145,6 +1391,400 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+#ifdef WITH_ZSTD
+
+/* Zstd file reading.
+ *
+ * Files written by Blender use the Zstandard seekable format (see `writefile.c`),
+ * the seek table is used to decompress only the frames that are actually read.
+ * Without a seek table (files compressed by external tools, or data in memory)
+ * the data is decompressed as a stream and seeking isn't supported. */
+
+#  define ZSTD_MAGIC_0 0x28
+#  define ZSTD_MAGIC_1 0xB5
+#  define ZSTD_MAGIC_2 0x2F
+#  define ZSTD_MAGIC_3 0xFD
+
+#  define ZSTD_SEEKABLE_MAGIC_SKIPPABLE 0x184D2A5E
+#  define ZSTD_SEEKABLE_MAGIC_FOOTER 0x8F92EAB1
+#  define ZSTD_SEEKABLE_FOOTER_SIZE 9
+#  define ZSTD_SEEKABLE_FLAG_CHECKSUM (1 << 7)
+
+typedef struct ZstdSeekFrame {
+  off64_t compressed_offset;
+  off64_t uncompressed_offset;
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+} ZstdSeekFrame;
+
+typedef struct FileDataZstd {
+  ZSTD_DCtx *ctx;
+
+  /** Compressed input, owned unless reading from memory. */
+  ZSTD_inBuffer in;
+  char *in_buf;
+  size_t in_buf_max_len;
+
+  /** Seek table, NULL when the data can only be read as a stream. */
+  ZstdSeekFrame *frames;
+  int frames_num;
+  off64_t uncompressed_size;
+
+  /** The decompressed contents of the frame #frame_cached (-1 when unset). */
+  char *frame_buf;
+  int frame_cached;
+} FileDataZstd;
+
+static bool fd_is_zstd_magic(const uchar *header)
+{
+  return (header[0] == ZSTD_MAGIC_0) && (header[1] == ZSTD_MAGIC_1) &&
+         (header[2] == ZSTD_MAGIC_2) && (header[3] == ZSTD_MAGIC_3);
+}
+
+static uint32_t zstd_read_u32_le(const uchar *buf)
+{
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) |
+         ((uint32_t)buf[3] << 24);
+}
+
+static bool zstd_read_exact(int filedes, off64_t offset, void *buf, size_t size)
+{
+  if (BLI_lseek(filedes, offset, SEEK_SET) != offset) {
+    return false;
+  }
+  return read(filedes, buf, size) == (ssize_t)size;
+}
+
+/**
+ * Load the seek table from the skippable frame at the end of the file.
+ * \return false when the file has no (valid) seek table.
+ */
+static bool fd_zstd_read_seek_table(int filedes, FileDataZstd *zstd)
+{
+  const off64_t file_size = BLI_lseek(filedes, 0, SEEK_END);
+  uchar footer[ZSTD_SEEKABLE_FOOTER_SIZE];
+
+  if (file_size < 8 + ZSTD_SEEKABLE_FOOTER_SIZE ||
+      !zstd_read_exact(filedes, file_size - ZSTD_SEEKABLE_FOOTER_SIZE, footer, sizeof(footer))) {
+    return false;
+  }
+  if (zstd_read_u32_le(footer + 5) != ZSTD_SEEKABLE_MAGIC_FOOTER) {
+    return false;
+  }
+
+  const uint32_t frames_num = zstd_read_u32_le(footer);
+  const uchar flags = footer[4];
+  const uint64_t entry_size = (flags & ZSTD_SEEKABLE_FLAG_CHECKSUM) ? 12 : 8;
+  const uint64_t table_size = (uint64_t)frames_num * entry_size + ZSTD_SEEKABLE_FOOTER_SIZE;
+  if (frames_num == 0 || frames_num > INT_MAX || table_size + 8 > (uint64_t)file_size) {
+    return false;
+  }
+
+  /* The skippable frame header before the table. */
+  const off64_t table_offset = file_size - (off64_t)table_size;
+  uchar header[8];
+  if (!zstd_read_exact(filedes, table_offset - 8, header, sizeof(header)) ||
+      zstd_read_u32_le(header) != ZSTD_SEEKABLE_MAGIC_SKIPPABLE ||
+      zstd_read_u32_le(header + 4) != table_size) {
+    return false;
+  }
+
+  const size_t entries_size = (size_t)(table_size - ZSTD_SEEKABLE_FOOTER_SIZE);
+  uchar *entries = MEM_mallocN(entries_size, __func__);
+  if (!zstd_read_exact(filedes, table_offset, entries, entries_size)) {
+    MEM_freeN(entries);
+    return false;
+  }
+
+  ZstdSeekFrame *frames = MEM_mallocN(sizeof(*frames) * frames_num, __func__);
+  off64_t compressed_offset = 0, uncompressed_offset = 0;
+  uint32_t compressed_size_max = 0, uncompressed_size_max = 0;
+  for (uint32_t i = 0; i < frames_num; i++) {
+    const uchar *entry = entries + (i * entry_size);
+    frames[i].compressed_offset = compressed_offset;
+    frames[i].uncompressed_offset = uncompressed_offset;
+    frames[i].compressed_size = zstd_read_u32_le(entry);
+    frames[i].uncompressed_size = zstd_read_u32_le(entry + 4);
+    compressed_offset += frames[i].compressed_size;
+    uncompressed_offset += frames[i].uncompressed_size;
+    compressed_size_max = MAX2(compressed_size_max, frames[i].compressed_size);
+    uncompressed_size_max = MAX2(uncompressed_size_max, frames[i].uncompressed_size);
+  }
+  MEM_freeN(entries);
+
+  /* The frames must exactly fill the file up to the seek table. */
+  if (compressed_offset != table_offset - 8) {
+    MEM_freeN(frames);
+    return false;
+  }
+
+  zstd->frames = frames;
+  zstd->frames_num = (int)frames_num;
+  zstd->uncompressed_size = uncompressed_offset;
+  zstd->in_buf_max_len = compressed_size_max;
+  zstd->in_buf = MEM_mallocN(MAX2(compressed_size_max, 1), __func__);
+  zstd->frame_buf = MEM_mallocN(MAX2(uncompressed_size_max, 1), __func__);
+  zstd->frame_cached = -1;
+  return true;
+}
+
+static int zstd_frame_find(const FileDataZstd *zstd, off64_t offset)
+{
+  /* Reading is mostly sequential, check the current frame first. */
+  if (zstd->frame_cached != -1) {
+    const ZstdSeekFrame *frame = &zstd->frames[zstd->frame_cached];
+    if (offset >= frame->uncompressed_offset &&
+        offset < frame->uncompressed_offset + frame->uncompressed_size) {
+      return zstd->frame_cached;
+    }
+  }
+
+  int low = 0, high = zstd->frames_num;
+  while (high - low > 1) {
+    const int mid = low + (high - low) / 2;
+    if (zstd->frames[mid].uncompressed_offset <= offset) {
+      low = mid;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+static bool zstd_frame_decompress(FileData *filedata, int frame_index)
+{
+  FileDataZstd *zstd = filedata->zstd;
+  const ZstdSeekFrame *frame = &zstd->frames[frame_index];
+
+  zstd->frame_cached = -1;
+  if (!zstd_read_exact(
+          filedata->filedes, frame->compressed_offset, zstd->in_buf, frame->compressed_size)) {
+    return false;
+  }
+
+  const size_t result = ZSTD_decompressDCtx(
+      zstd->ctx, zstd->frame_buf, frame->uncompressed_size, zstd->in_buf, frame->compressed_size);
+  if (ZSTD_isError(result) || result != frame->uncompressed_size) {
+    return false;
+  }
+
+  zstd->frame_cached = frame_index;
+  return true;
+}
+
+static ssize_t fd_read_zstd_seekable(FileData *filedata,
+                                     void *buffer,
+                                     size_t size,
+                                     bool *UNUSED(r_is_memchunck_identical))
+{
+  FileDataZstd *zstd = filedata->zstd;
+  size_t totread = 0;
+
+  while (totread < size && filedata->file_offset < zstd->uncompressed_size) {
+    const int frame_index = zstd_frame_find(zstd, filedata->file_offset);
+    if (frame_index != zstd->frame_cached) {
+      if (!zstd_frame_decompress(filedata, frame_index)) {
+        return EOF;
+      }
+    }
+
+    const ZstdSeekFrame *frame = &zstd->frames[frame_index];
+    const size_t frame_offset = (size_t)(filedata->file_offset - frame->uncompressed_offset);
+    const size_t readsize = MIN2(size - totread, frame->uncompressed_size - frame_offset);
+
+    memcpy(POINTER_OFFSET(buffer, totread), zstd->frame_buf + frame_offset, readsize);
+    totread += readsize;
+    filedata->file_offset += readsize;
+  }
+
+  return (ssize_t)totread;
+}
+
+static off64_t fd_seek_zstd_seekable(FileData *filedata, off64_t offset, int whence)
+{
+  const FileDataZstd *zstd = filedata->zstd;
+  off64_t new_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = zstd->uncompressed_size + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (new_offset < 0 || new_offset > zstd->uncompressed_size) {
+    return -1;
+  }
+
+  /* Decompression is deferred until the data is read. */
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
+static ssize_t fd_read_zstd_stream(FileData *filedata,
+                                   void *buffer,
+                                   size_t size,
+                                   bool *UNUSED(r_is_memchunck_identical))
+{
+  FileDataZstd *zstd = filedata->zstd;
+  ZSTD_outBuffer output = {buffer, size, 0};
+
+  while (output.pos < output.size) {
+    if (zstd->in.pos == zstd->in.size) {
+      /* Data in memory is passed in as a single input buffer. */
+      if (zstd->in_buf == NULL) {
+        break;
+      }
+      const ssize_t readsize = read(filedata->filedes, zstd->in_buf, zstd->in_buf_max_len);
+      if (readsize < 0) {
+        return EOF;
+      }
+      if (readsize == 0) {
+        break;
+      }
+      zstd->in.src = zstd->in_buf;
+      zstd->in.size = (size_t)readsize;
+      zstd->in.pos = 0;
+    }
+
+    /* Skippable frames (the seek table) are ignored by the decoder. */
+    const size_t result = ZSTD_decompressStream(zstd->ctx, &output, &zstd->in);
+    if (ZSTD_isError(result)) {
+      printf("fd_read_zstd_stream: zstd error: %s\n", ZSTD_getErrorName(result));
+      return EOF;
+    }
+  }
+
+  filedata->file_offset += (off64_t)output.pos;
+  return (ssize_t)output.pos;
+}
+
+/** \return NULL when the decompression context can't be created. */
+static FileDataZstd *fd_zstd_new(void)
+{
+  ZSTD_DCtx *ctx = ZSTD_createDCtx();
+  if (ctx == NULL) {
+    return NULL;
+  }
+  FileDataZstd *zstd = MEM_callocN(sizeof(*zstd), __func__);
+  zstd->ctx = ctx;
+  zstd->frame_cached = -1;
+  return zstd;
+}
+
+/**
+ * Initialize zstd reading for `fd->filedes`,
+ * using the seek table when there is one.
+ */
+static bool fd_zstd_init_from_file(FileData *fd)
+{
+  FileDataZstd *zstd = fd_zstd_new();
+  if (zstd == NULL) {
+    return false;
+  }
+  fd->zstd = zstd;
+
+  if (fd_zstd_read_seek_table(fd->filedes, zstd)) {
+    fd->read = fd_read_zstd_seekable;
+    fd->seek = fd_seek_zstd_seekable;
+  }
+  else {
+    zstd->in_buf_max_len = ZSTD_DStreamInSize();
+    zstd->in_buf = MEM_mallocN(zstd->in_buf_max_len, __func__);
+    if (BLI_lseek(fd->filedes, 0, SEEK_SET) != 0) {
+      return false;
+    }
+    fd->read = fd_read_zstd_stream;
+    fd->seek = NULL;
+  }
+  return true;
+}
+
+static bool fd_zstd_init_from_memory(FileData *fd)
+{
+  FileDataZstd *zstd = fd_zstd_new();
+  if (zstd == NULL) {
+    return false;
+  }
+  fd->zstd = zstd;
+
+  zstd->in.src = fd->buffer;
+  zstd->in.size = fd->buffersize;
+  zstd->in.pos = 0;
+
+  fd->read = fd_read_zstd_stream;
+  return true;
+}
+
+static void fd_zstd_free(FileDataZstd *zstd)
+{
+  ZSTD_freeDCtx(zstd->ctx);
+  MEM_SAFE_FREE(zstd->in_buf);
+  MEM_SAFE_FREE(zstd->frames);
+  MEM_SAFE_FREE(zstd->frame_buf);
+  MEM_freeN(zstd);
+}
+
+#endif /* WITH_ZSTD */
+
+/* Memory mapped file reading.
+ *
+ * Reading from the mapping avoids the system call for every block, blocks that are never
+ * read (see #USE_BHEAD_READ_ON_DEMAND) don't need to be loaded from disk at all. */
+
+static ssize_t fd_read_from_mmap(FileData *filedata,
+                                 void *buffer,
+                                 size_t size,
+                                 bool *UNUSED(r_is_memchunck_identical))
+{
+  /* Don't read more bytes than there are available in the file. */
+  const size_t file_len = BLI_mmap_get_length(filedata->mmap_file);
+  const size_t readsize = MIN2(size, file_len - (size_t)filedata->file_offset);
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, (size_t)filedata->file_offset, readsize)) {
+    return EOF;
+  }
+
+  filedata->file_offset += readsize;
+
+  return (ssize_t)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  const off64_t file_len = (off64_t)BLI_mmap_get_length(filedata->mmap_file);
+  off64_t new_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = file_len + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (new_offset < 0 || new_offset > file_len) {
+    return -1;
+  }
+
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1265,7 +1905,7 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 
   if (fd->flags & FD_FLAGS_FILE_OK) {
     const char *error_message = NULL;
-    if (read_file_dna(fd, &error_message) == false) {
+    if (read_file_index(fd) == false && read_file_dna(fd, &error_message) == false) {
       BKE_reportf(
           reports, RPT_ERROR, "Failed to read blend file '%s': %s", fd->relabase, error_message);
       blo_filedata_free(fd);
@@ -1288,10 +1928,13 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 {
   FileDataReadFn *read_fn = NULL;
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
+  BLI_mmap_file *mmap_file = NULL;
 
   gzFile gzfile = (gzFile)Z_NULL;
+  void *journal_buffer = NULL;
+  size_t journal_buffer_len = 0;
 
-  char header[7];
+  char header[8];
 
   /* Regular file. */
   errno = 0;
@@ -1307,9 +1950,18 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   BLI_lseek(file, 0, SEEK_SET);
 
   /* Regular file. */
-  if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+  if (memcmp(header, "BLENDER", 7) == 0) {
+    /* Prefer memory mapping, falling back to regular reading if the file can't be mapped. */
+    mmap_file = BLI_mmap_open(file);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else {
+      BLI_lseek(file, 0, SEEK_SET);
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
   }
 
   /* Gzip file. */
@@ -1333,7 +1985,26 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
     file = -1;
   }
 
-  if (read_fn == NULL) {
+  /* Incremental auto-save journal, the file it contains is read in memory. */
+  if ((read_fn == NULL) && (memcmp(header, MEMFILE_JOURNAL_MAGIC, sizeof(header)) == 0)) {
+    journal_buffer = BLO_memfile_journal_read(file, &journal_buffer_len);
+    if (journal_buffer == NULL) {
+      BKE_reportf(reports, RPT_WARNING, "Unable to read auto-save journal '%s'", filepath);
+      return NULL;
+    }
+    read_fn = fd_read_from_memory;
+    /* Caller must close. */
+    file = -1;
+  }
+
+#ifdef WITH_ZSTD
+  /* Zstd file, the read & seek functions are chosen once the seek table has been checked. */
+  const bool is_zstd = (read_fn == NULL) && fd_is_zstd_magic((const uchar *)header);
+#else
+  const bool is_zstd = false;
+#endif
+
+  if ((read_fn == NULL) && !is_zstd) {
     BKE_reportf(reports, RPT_WARNING, "Unrecognized file format '%s'", filepath);
     return NULL;
   }
@@ -1342,10 +2013,27 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->mmap_file = mmap_file;
 
   fd->read = read_fn;
   fd->seek = seek_fn;
 
+  if (journal_buffer != NULL) {
+    /* Owned by the file-data, see #FD_FLAGS_NOT_MY_BUFFER. */
+    fd->buffer = journal_buffer;
+    fd->buffersize = journal_buffer_len;
+  }
+
+#ifdef WITH_ZSTD
+  if (is_zstd && !fd_zstd_init_from_file(fd)) {
+    BKE_reportf(reports, RPT_WARNING, "Unable to read '%s'", filepath);
+    /* Caller closes the file. */
+    fd->filedes = -1;
+    blo_filedata_free(fd);
+    return NULL;
+  }
+#endif
+
   return fd;
 }
 
@@ -1455,6 +2143,8 @@ FileData *blo_filedata_from_memory(const void *mem, int memsize, ReportList *rep
 
   fd->buffer = mem;
   fd->buffersize = memsize;
+  /* Set before any early return, the caller owns the buffer. */
+  fd->flags |= FD_FLAGS_NOT_MY_BUFFER;
 
   /* test if gzip */
   if (cp[0] == 0x1f && cp[1] == 0x8b) {
@@ -1463,12 +2153,18 @@ FileData *blo_filedata_from_memory(const void *mem, int memsize, ReportList *rep
       return NULL;
     }
   }
+#ifdef WITH_ZSTD
+  else if (fd_is_zstd_magic((const uchar *)cp)) {
+    if (!fd_zstd_init_from_memory(fd)) {
+      blo_filedata_free(fd);
+      return NULL;
+    }
+  }
+#endif
   else {
     fd->read = fd_read_from_memory;
   }
 
-  fd->flags |= FD_FLAGS_NOT_MY_BUFFER;
-
   return blo_decode_and_check(fd, reports);
 }
 
@@ -1494,6 +2190,10 @@ FileData *blo_filedata_from_memfile(MemFile *memfile,
 void blo_filedata_free(FileData *fd)
 {
   if (fd) {
+    if (fd->mmap_file != NULL) {
+      BLI_mmap_free(fd->mmap_file);
+    }
+
     if (fd->filedes != -1) {
       close(fd->filedes);
     }
@@ -1508,6 +2208,12 @@ void blo_filedata_free(FileData *fd)
       }
     }
 
+#ifdef WITH_ZSTD
+    if (fd->zstd != NULL) {
+      fd_zstd_free(fd->zstd);
+    }
+#endif
+
     if (fd->buffer && !(fd->flags & FD_FLAGS_NOT_MY_BUFFER)) {
       MEM_freeN((void *)fd->buffer);
       fd->buffer = NULL;
@@ -1539,6 +2245,12 @@ void blo_filedata_free(FileData *fd)
     if (fd->datamap) {
       oldnewmap_free(fd->datamap);
     }
+    if (fd->datamap_lazy) {
+      BLI_ghash_free(fd->datamap_lazy, NULL, NULL);
+    }
+    if (fd->index) {
+      MEM_freeN(fd->index);
+    }
     if (fd->globmap) {
       oldnewmap_free(fd->globmap);
     }
@@ -1585,6 +2297,23 @@ bool BLO_has_bfile_extension(const char *str)
   return BLI_path_extension_check_array(str, ext_test);
 }
 
+/**
+ * Check whether the file at \a filepath can be read as a blend file, by reading its header
+ * (decompressing the start of the file for compressed files).
+ *
+ * \param filepath: The path to check.
+ * \return true if the file has a valid blend file header.
+ */
+bool BLO_has_bfile_header(const char *filepath)
+{
+  FileData *fd = blo_filedata_from_file_minimal(filepath);
+  if (fd == NULL) {
+    return false;
+  }
+  blo_filedata_free(fd);
+  return true;
+}
+
 /**
  * Try to explode given path into its 'library components'
  * (i.e. a .blend file, id type/group, and data-block itself).
@@ -1700,15 +2429,35 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 /** \name Old/New Pointer Map
  * \{ */
 
+/**
+ * Data which wasn't read by #read_data_into_datamap is read as soon as it's accessed
+ * like any other data, only packed files keep it unread, see #BLO_read_get_lazy_data.
+ */
+static void datamap_lazy_ensure(FileData *fd, const void *adr)
+{
+  if (fd->datamap_lazy == NULL || adr == NULL || BLI_ghash_len(fd->datamap_lazy) == 0) {
+    return;
+  }
+  BHead *bhead = BLI_ghash_popkey(fd->datamap_lazy, adr, NULL);
+  if (bhead != NULL) {
+    void *data = read_struct(fd, bhead, "lazy data");
+    if (data) {
+      oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+    }
+  }
+}
+
 /* only direct databocks */
 static void *newdataadr(FileData *fd, const void *adr)
 {
+  datamap_lazy_ensure(fd, adr);
   return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* only direct databocks */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
+  datamap_lazy_ensure(fd, adr);
   return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
 }
 
@@ -1725,6 +2474,7 @@ static void *newpackedadr(FileData *fd, const void *adr)
     return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
+  datamap_lazy_ensure(fd, adr);
   return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
@@ -2068,7 +2818,11 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Thread-safe part of #read_struct (as long as #blo_bhead_read_data doesn't need to seek).
+ * \param r_error: Set on failure to read the data.
+ */
+static void *read_struct_decode(FileData *fd, BHead *bh, const char *blockname, bool *r_error)
 {
   void *temp = NULL;
 
@@ -2083,7 +2837,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_error = true;
           return NULL;
         }
       }
@@ -2093,16 +2847,27 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          /* Reconstruct directly from the mapped file when possible, avoiding a copy. */
+          data = blo_bhead_data_mapped(fd, bh);
+          if (data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              *r_error = true;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data);
+        if (UNLIKELY(fd->mmap_file && BLI_mmap_any_io_error(fd->mmap_file))) {
+          *r_error = true;
+          MEM_freeN(temp);
+          temp = NULL;
+        }
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2115,7 +2880,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
           if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_error = true;
             MEM_freeN(temp);
             temp = NULL;
           }
@@ -2136,6 +2901,25 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+#ifdef USE_PARALLEL_STRUCT_DECODE
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(bh);
+  if (new_bhead->data_decoded != NULL) {
+    void *temp = new_bhead->data_decoded;
+    new_bhead->data_decoded = NULL;
+    return temp;
+  }
+#endif
+
+  bool error = false;
+  void *temp = read_struct_decode(fd, bh, blockname, &error);
+  if (UNLIKELY(error)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -3227,6 +4011,29 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+/**
+ * Large raw data which isn't read yet when opening with #BLO_READ_LAZY_PACKED_DATA,
+ * #read_data_into_datamap only records its #BHead in #FileData.datamap_lazy.
+ */
+static bool read_data_is_lazy(const FileData *fd, BHead *bhead)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  return (fd->skip_flags & BLO_READ_LAZY_PACKED_DATA) && (bhead->code == DATA) &&
+         (bhead->SDNAnr == 0) && (bhead->nr == 1) && (bhead->len >= LAZY_DATA_MIN_SIZE) &&
+         (BHEADN_FROM_BHEAD(bhead)->has_data == false);
+#else
+  UNUSED_VARS(fd, bhead);
+  return false;
+#endif
+}
+
+static void read_data_lazy_clear(FileData *fd)
+{
+  if (fd->datamap_lazy != NULL) {
+    BLI_ghash_clear(fd->datamap_lazy, NULL, NULL);
+  }
+}
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
@@ -3249,9 +4056,14 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
     }
 #endif
 
-    void *data = read_struct(fd, bhead, allocname);
-    if (data) {
-      oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+    if (read_data_is_lazy(fd, bhead)) {
+      BLI_ghash_insert(fd->datamap_lazy, (void *)bhead->old, bhead);
+    }
+    else {
+      void *data = read_struct(fd, bhead, allocname);
+      if (data) {
+        oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+      }
     }
 
     bhead = blo_bhead_next(fd, bhead);
@@ -3586,6 +4398,7 @@ static BHead *read_libblock(FileData *fd,
   bhead = read_data_into_datamap(fd, bhead, allocname);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
   oldnewmap_clear(fd->datamap);
+  read_data_lazy_clear(fd);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -3926,6 +4739,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 
   /* free fd->datamap again */
   oldnewmap_clear(fd->datamap);
+  read_data_lazy_clear(fd);
 
   return bhead;
 }
@@ -3936,6 +4750,141 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 /** \name Read File (Internal)
  * \{ */
 
+#ifdef USE_PARALLEL_STRUCT_DECODE
+
+/* Below this, the overhead of threading isn't worth it. Keeps the bundled files on a single
+ * thread: `startup.blend` has 1484 blocks, `preview.blend` 2675. */
+#  define PARALLEL_STRUCT_DECODE_MIN_BLOCKS 4096
+
+typedef struct ReadDecodeItem {
+  BHead *bhead;
+  const char *allocname;
+  bool error;
+} ReadDecodeItem;
+
+typedef struct ReadDecodeData {
+  FileData *fd;
+  ReadDecodeItem *items;
+} ReadDecodeData;
+
+static void read_file_decode_parallel_cb(void *__restrict userdata,
+                                         const int iter,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReadDecodeData *data = userdata;
+  ReadDecodeItem *item = &data->items[iter];
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(item->bhead);
+
+  new_bhead->data_decoded = read_struct_decode(
+      data->fd, item->bhead, item->allocname, &item->error);
+}
+
+static bool read_file_decode_parallel_supported(const FileData *fd)
+{
+  /* Undo restores unchanged data-blocks without reading them. */
+  if (fd->memfile != NULL) {
+    return false;
+  }
+  if (fd->skip_flags & BLO_READ_SKIP_DATA) {
+    return false;
+  }
+  /* Reading data on demand from a regular or compressed file needs to seek,
+   * which isn't thread-safe. */
+  if (fd->seek != NULL && fd->mmap_file == NULL) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Index all blocks of the file, then decode the ID structs and their data in parallel.
+ * The decoded structs are stored in #BHeadN.data_decoded, where #read_struct takes them from
+ * when the data-blocks are read, which still happens on a single thread
+ * (adding the ID's to #Main, filling the #OldNewMap's and the `blend_read_data` callbacks).
+ *
+ * \return The number of indexed blocks.
+ */
+static int read_file_decode_parallel(FileData *fd)
+{
+  /* Index the blocks that #blo_read_file_internal reads with #read_libblock. */
+  int items_len = 0;
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == ENDB) {
+      break;
+    }
+    items_len++;
+  }
+
+  if (items_len < PARALLEL_STRUCT_DECODE_MIN_BLOCKS) {
+    return items_len;
+  }
+
+  ReadDecodeItem *items = MEM_mallocN(sizeof(*items) * (size_t)items_len, __func__);
+  int items_decode_len = 0;
+  /* Allocation name of the data of the last ID, NULL for data that doesn't belong to an ID. */
+  const char *allocname = NULL;
+
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    const char *item_allocname = NULL;
+    switch (bhead->code) {
+      case ENDB:
+        break;
+      case DATA:
+        item_allocname = allocname;
+        break;
+      case DNA1:
+      case TEST:
+      case REND:
+      case GLOB:
+      case USER:
+        allocname = NULL;
+        break;
+      default:
+        item_allocname = "lib block";
+        allocname = dataname((bhead->code == ID_SCRN) ? ID_SCR : bhead->code);
+        break;
+    }
+    if (bhead->code == ENDB) {
+      break;
+    }
+    if (item_allocname != NULL && bhead->len != 0 && !read_data_is_lazy(fd, bhead)) {
+      ReadDecodeItem *item = &items[items_decode_len++];
+      item->bhead = bhead;
+      item->allocname = item_allocname;
+      item->error = false;
+    }
+  }
+
+  ReadDecodeData data = {fd, items};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, items_decode_len, &data, read_file_decode_parallel_cb, &settings);
+
+  for (int i = 0; i < items_decode_len; i++) {
+    if (UNLIKELY(items[i].error)) {
+      fd->flags &= ~FD_FLAGS_FILE_OK;
+      break;
+    }
+  }
+
+  MEM_freeN(items);
+  return items_len;
+}
+
+/** Free structs decoded by #read_file_decode_parallel which weren't used. */
+static void read_file_decode_parallel_free_unused(FileData *fd)
+{
+  LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+    if (new_bhead->data_decoded != NULL) {
+      MEM_freeN(new_bhead->data_decoded);
+      new_bhead->data_decoded = NULL;
+    }
+  }
+}
+
+#endif /* USE_PARALLEL_STRUCT_DECODE */
+
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
   BHead *bhead = blo_bhead_first(fd);
@@ -3946,6 +4895,18 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     DEBUG_PRINTF("\nUNDO: read step\n");
   }
 
+  if (fd->skip_flags & BLO_READ_LAZY_PACKED_DATA) {
+    /* Lazy data is read again from the file later on, which must be possible without reading the
+     * whole file (so not for gzip compression), undo always reads all data. */
+    if (fd->memfile == NULL && fd->seek != NULL && fd->relabase[0] != '\0') {
+      fd->datamap_lazy = BLI_ghash_ptr_new(__func__);
+      BLI_strncpy(fd->lazy_filepath, filepath, sizeof(fd->lazy_filepath));
+    }
+    else {
+      fd->skip_flags &= ~BLO_READ_LAZY_PACKED_DATA;
+    }
+  }
+
   bfd = MEM_callocN(sizeof(BlendFileData), "blendfiledata");
 
   bfd->main = BKE_main_new();
@@ -3981,6 +4942,23 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  /* Timings of the reading phases, printed with `--debug-io`. */
+  const bool use_timing = (G.debug & G_DEBUG_IO) && (fd->memfile == NULL);
+  double time_phase = use_timing ? PIL_check_seconds_timer() : 0.0;
+
+#ifdef USE_PARALLEL_STRUCT_DECODE
+  if (read_file_decode_parallel_supported(fd)) {
+    const int blocks_len = read_file_decode_parallel(fd);
+    if (use_timing) {
+      printf("Read '%s': index & decode %d blocks (parallel): %.4fs\n",
+             fd->relabase,
+             blocks_len,
+             PIL_check_seconds_timer() - time_phase);
+      time_phase = PIL_check_seconds_timer();
+    }
+  }
+#endif
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -4032,6 +5010,17 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+#ifdef USE_PARALLEL_STRUCT_DECODE
+  read_file_decode_parallel_free_unused(fd);
+#endif
+
+  if (use_timing) {
+    printf("Read '%s': read data-blocks (single threaded): %.4fs\n",
+           fd->relabase,
+           PIL_check_seconds_timer() - time_phase);
+    time_phase = PIL_check_seconds_timer();
+  }
+
   /* do before read_libraries, but skip undo case */
   if (fd->memfile == NULL) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
@@ -4050,6 +5039,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
     lib_link_all(fd, bfd->main);
 
+    if (use_timing) {
+      printf("Read '%s': versioning, libraries & linking: %.4fs\n",
+             fd->relabase,
+             PIL_check_seconds_timer() - time_phase);
+      time_phase = PIL_check_seconds_timer();
+    }
+
     /* Skip in undo case. */
     if (fd->memfile == NULL) {
       /* Note that we can't recompute user-counts at this point in undo case, we play too much with
@@ -4095,6 +5091,12 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     fix_relpaths_library(fd->relabase, bfd->main);
 
     link_global(fd, bfd); /* as last */
+
+    if (use_timing) {
+      printf("Read '%s': versioning after linking & overrides: %.4fs\n",
+             fd->relabase,
+             PIL_check_seconds_timer() - time_phase);
+    }
   }
 
   fd->mainlist = NULL; /* Safety, this is local variable, shall not be used afterward. */
@@ -5252,10 +6254,14 @@ static FileData *read_library_file_data(FileData *basefd,
                      TIP_("Read packed library:  '%s', parent '%s'"),
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_memory(pf->data, pf->size, basefd->reports);
+    if (BKE_packedfile_data_ensure(pf)) {
+      fd = blo_filedata_from_memory(pf->data, pf->size, basefd->reports);
+    }
 
-    /* Needed for library_append and read_libraries. */
-    BLI_strncpy(fd->relabase, mainptr->curlib->filepath_abs, sizeof(fd->relabase));
+    if (fd != NULL) {
+      /* Needed for library_append and read_libraries. */
+      BLI_strncpy(fd->relabase, mainptr->curlib->filepath_abs, sizeof(fd->relabase));
+    }
   }
   else {
     /* Read file on disk. */
@@ -5413,6 +6419,28 @@ void *BLO_read_get_new_packed_address(BlendDataReader *reader, const void *old_a
   return newpackedadr(reader->fd, old_address);
 }
 
+BlendFileLazyData *BLO_read_get_lazy_data(BlendDataReader *reader, const void *old_address)
+{
+  FileData *fd = reader->fd;
+  if (fd->datamap_lazy == NULL || old_address == NULL) {
+    return NULL;
+  }
+  BHead *bhead = BLI_ghash_popkey(fd->datamap_lazy, old_address, NULL);
+  if (bhead == NULL) {
+    return NULL;
+  }
+
+  BlendFileLazyData *lazy_data = MEM_mallocN(sizeof(*lazy_data), __func__);
+  BLI_strncpy(lazy_data->filepath, fd->lazy_filepath, sizeof(lazy_data->filepath));
+  lazy_data->bhead_offset = BHEADN_FROM_BHEAD(bhead)->file_offset -
+                            (off64_t)((fd->flags & FD_FLAGS_FILE_POINTSIZE_IS_4) ?
+                                          sizeof(BHead4) :
+                                          sizeof(BHead8));
+  lazy_data->old_address = bhead->old;
+  lazy_data->len = bhead->len;
+  return lazy_data;
+}
+
 ID *BLO_read_get_new_id_address(BlendLibReader *reader, Library *lib, ID *id)
 {
   return newlibadr(reader->fd, lib, id);
@@ -5609,3 +6637,61 @@ void BLO_expand_id(BlendExpander *expander, ID *id)
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Lazy Data Reading
+ *
+ * Read data which was skipped when opening the file with #BLO_READ_LAZY_PACKED_DATA.
+ * \{ */
+
+/**
+ * Read the data block described by \a lazy_data, only reading the file header and the block
+ * itself. The block header is checked against the one read originally, in case the file was
+ * modified in the meantime.
+ *
+ * \return The data (owned by the caller) or NULL on failure.
+ */
+void *BLO_read_lazy_data(const BlendFileLazyData *lazy_data, ReportList *reports)
+{
+  void *data = NULL;
+
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  FileData *fd = blo_filedata_from_file_minimal(lazy_data->filepath);
+  if (fd == NULL) {
+    BKE_reportf(reports, RPT_ERROR, "Unable to open '%s'", lazy_data->filepath);
+    return NULL;
+  }
+
+  BHeadN *new_bhead = NULL;
+  if (fd->seek != NULL && fd->seek(fd, lazy_data->bhead_offset, SEEK_SET) != -1) {
+    new_bhead = get_bhead_detached(fd);
+  }
+
+  if (new_bhead != NULL && new_bhead->has_data == false && new_bhead->bhead.code == DATA &&
+      new_bhead->bhead.old == lazy_data->old_address && new_bhead->bhead.len == lazy_data->len) {
+    data = MEM_mallocN((size_t)lazy_data->len, "lazy data");
+    if (!blo_bhead_read_data(fd, &new_bhead->bhead, data) ||
+        (fd->mmap_file != NULL && BLI_mmap_any_io_error(fd->mmap_file))) {
+      MEM_freeN(data);
+      data = NULL;
+    }
+  }
+
+  if (data == NULL) {
+    BKE_reportf(
+        reports, RPT_ERROR, "Unable to read data from '%s', file changed?", lazy_data->filepath);
+  }
+
+  if (new_bhead != NULL) {
+    MEM_freeN(new_bhead);
+  }
+  blo_filedata_free(fd);
+#else
+  UNUSED_VARS(lazy_data);
+  BKE_report(reports, RPT_ERROR, "Reading data on demand is not supported");
+#endif
+
+  return data;
+}
+
+/** \} */
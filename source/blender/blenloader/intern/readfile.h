@@ -33,7 +33,9 @@
 #include "DNA_windowmanager_types.h" /* for ReportType */
 #include "zlib.h"
 
+struct BLI_mmap_file;
 struct BLOCacheStorage;
+struct FileDataZstd;
 struct GSet;
 struct IDNameLib_Map;
 struct Key;
@@ -47,6 +49,57 @@ struct View3D;
 
 typedef struct IDNameLib_Map IDNameLib_Map;
 
+/* -------------------------------------------------------------------- */
+/** \name File Index
+ *
+ * Written at the end of the file, after #ENDB: an #INDX block (a #BlendFileIndexHeader
+ * followed by its entries and the library file paths) then a #BlendFileIndexTrailer,
+ * which is used to find the #INDX block without reading the whole file.
+ * Offsets are in the uncompressed file, values use the byte-order of the file.
+ * \{ */
+
+#define BLEND_FILE_INDEX_VERSION 1
+#define BLEND_FILE_INDEX_MAGIC "BLENDIDX"
+
+typedef struct BlendFileIndexHeader {
+  int version;
+  int entries_len;
+  int libraries_len;
+  /** Sub-version of the file, needed to read the DNA without reading #GLOB. */
+  int subversion;
+  /** Offset of the #DNA1 block. */
+  uint64_t dna_offset;
+} BlendFileIndexHeader;
+
+typedef struct BlendFileIndexEntry {
+  /** #BHead.code of the data-block. */
+  int code;
+  int _pad0;
+  /** Offset of the data-block. */
+  uint64_t bhead_offset;
+  /** Offset of the #PreviewImage of the data-block, zero when it has none. */
+  uint64_t preview_offset;
+  /** #ID.name */
+  char name[66];
+  char _pad1[6];
+} BlendFileIndexEntry;
+
+typedef struct BlendFileIndexTrailer {
+  /** Offset of the #INDX block. */
+  uint64_t index_offset;
+  char magic[8];
+} BlendFileIndexTrailer;
+
+#define BLEND_FILE_INDEX_ENTRIES(index) ((BlendFileIndexEntry *)((index) + 1))
+/** Library file paths (#Library.filepath), #FILE_MAX bytes each. */
+#define BLEND_FILE_INDEX_LIBRARIES(index) \
+  ((char(*)[FILE_MAX])(BLEND_FILE_INDEX_ENTRIES(index) + (index)->entries_len))
+#define BLEND_FILE_INDEX_SIZE(entries_len, libraries_len) \
+  (sizeof(BlendFileIndexHeader) + sizeof(BlendFileIndexEntry) * (size_t)(entries_len) + \
+   (size_t)FILE_MAX * (size_t)(libraries_len))
+
+/** \} */
+
 enum eFileDataFlag {
   FD_FLAGS_SWITCH_ENDIAN = 1 << 0,
   FD_FLAGS_FILE_POINTSIZE_IS_4 = 1 << 1,
@@ -85,6 +138,8 @@ typedef struct FileData {
 
   /** Regular file reading. */
   int filedes;
+  /** Memory mapped file reading (uncompressed files), NULL when mapping isn't used. */
+  struct BLI_mmap_file *mmap_file;
 
   /** Variables needed for reading from memory / stream. */
   const char *buffer;
@@ -98,6 +153,8 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Zstd decompression state (file or memory), NULL for other formats. */
+  struct FileDataZstd *zstd;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
@@ -119,6 +176,11 @@ typedef struct FileData {
   eBLOReadSkip skip_flags;
 
   struct OldNewMap *datamap;
+  /** Data blocks of the current data-block which weren't read yet, maps their old address to
+   * their #BHead (see #BLO_READ_LAZY_PACKED_DATA). */
+  struct GHash *datamap_lazy;
+  /** File the lazy data is read from later on. */
+  char lazy_filepath[FILE_MAX];
   struct OldNewMap *globmap;
   struct OldNewMap *libmap;
   struct OldNewMap *packedmap;
@@ -127,6 +189,9 @@ typedef struct FileData {
   struct BHeadSort *bheadmap;
   int tot_bheadmap;
 
+  /** Index read from the end of the file, NULL when the file has none. */
+  struct BlendFileIndexHeader *index;
+
   /** See: #USE_GHASH_BHEAD. */
   struct GHash *bhead_idname_hash;
 
@@ -169,6 +234,10 @@ BHead *blo_bhead_first(FileData *fd);
 BHead *blo_bhead_next(FileData *fd, BHead *thisblock);
 BHead *blo_bhead_prev(FileData *fd, BHead *thisblock);
 
+BHead *blo_bhead_read_detached(FileData *fd, uint64_t offset);
+BHead *blo_bhead_read_detached_next(FileData *fd, BHead *thisblock);
+void blo_bhead_free_detached(BHead *bhead);
+
 const char *blo_bhead_id_name(const FileData *fd, const BHead *bhead);
 
 /* do versions stuff */
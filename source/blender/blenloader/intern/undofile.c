@@ -42,7 +42,9 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
+#include "BLO_blend_defs.h"
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
 
@@ -54,55 +56,116 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Chunk Buffers
+ *
+ * Chunk buffers are reference counted, so that identical data can be shared between any chunks,
+ * not only between chunks at the same position in consecutive undo steps.
+ * The user count is stored in a small header allocated right before the data.
+ * \{ */
+
+typedef struct MemFileChunkBuffer {
+  /** Number of #MemFileChunk using this buffer. */
+  uint users;
+  /** Keep the data aligned the same way as a regular allocation. */
+  uint _pad[3];
+} MemFileChunkBuffer;
+
+#define MEMFILE_CHUNK_BUFFER(buf) (((MemFileChunkBuffer *)(buf)) - 1)
+
+static const char *memfile_chunk_buffer_new(const char *buf, size_t size)
+{
+  MemFileChunkBuffer *buffer = MEM_mallocN(sizeof(*buffer) + size, "Chunk buffer");
+  buffer->users = 1;
+  char *buf_new = (char *)(buffer + 1);
+  memcpy(buf_new, buf, size);
+  return buf_new;
+}
+
+static void memfile_chunk_buffer_user_add(const char *buf)
+{
+  MEMFILE_CHUNK_BUFFER(buf)->users++;
+}
+
+static void memfile_chunk_buffer_user_remove(const char *buf)
+{
+  MemFileChunkBuffer *buffer = MEMFILE_CHUNK_BUFFER(buf);
+  BLI_assert(buffer->users > 0);
+  if (--buffer->users == 0) {
+    MEM_freeN(buffer);
+  }
+}
+
+static uint memfile_chunk_content_hash(const void *key)
+{
+  return ((const MemFileChunk *)key)->hash;
+}
+
+/* Returns false when both chunks have the same content (GHash convention). */
+static bool memfile_chunk_content_cmp(const void *a, const void *b)
+{
+  const MemFileChunk *chunk_a = a;
+  const MemFileChunk *chunk_b = b;
+  if (chunk_a->hash != chunk_b->hash || chunk_a->size != chunk_b->size) {
+    return true;
+  }
+  return (chunk_a->buf != chunk_b->buf) &&
+         (memcmp(chunk_a->buf, chunk_b->buf, chunk_a->size) != 0);
+}
+
+/** \} */
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    memfile_chunk_buffer_user_remove(chunk->buf);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
+  memfile->size_shared = 0;
 }
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
-    }
+  /* Buffers are reference counted, the ones still used by the second memfile are kept alive when
+   * freeing the first one. Only the accounting needs to be updated: buffers the second memfile
+   * shared with the first one are unique to it once no other step uses them. */
+  GSet *first_buffers = BLI_gset_ptr_new(__func__);
+  LISTBASE_FOREACH (MemFileChunk *, fc, &first->chunks) {
+    BLI_gset_add(first_buffers, (void *)fc->buf);
   }
 
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
-      if (sc != NULL) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
+  /* Number of chunks of the second memfile using each buffer it shared with the first one. */
+  GHash *second_buffer_users = BLI_ghash_ptr_new(__func__);
+  LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
+    if (BLI_gset_haskey(first_buffers, sc->buf)) {
+      /* Chunks in the second memfile no longer have a previous step to be identical to. */
+      sc->is_identical = false;
+      void **users_p;
+      if (!BLI_ghash_ensure_p(second_buffer_users, (void *)sc->buf, &users_p)) {
+        *users_p = POINTER_FROM_UINT(0);
       }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+      *users_p = POINTER_FROM_UINT(POINTER_AS_UINT(*users_p) + 1);
     }
   }
-
-  BLI_ghash_free(buffer_to_second_memchunk, NULL, NULL);
+  BLI_gset_free(first_buffers, NULL);
 
   BLO_memfile_free(first);
+
+  /* Other users of the buffer are later steps, it stays shared with them. */
+  LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
+    void *users = BLI_ghash_popkey(second_buffer_users, sc->buf, NULL);
+    if (users != NULL && MEMFILE_CHUNK_BUFFER(sc->buf)->users == POINTER_AS_UINT(users)) {
+      second->size += sc->size;
+      second->size_shared -= MIN2(second->size_shared, sc->size);
+    }
+  }
+  BLI_ghash_free(second_buffer_users, NULL, NULL);
 }
 
 /* Clear is_identical_future before adding next memfile. */
@@ -121,6 +184,17 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
 
+  /* Index chunks by content, so that data which moved around in the file (e.g. after adding a new
+   * ID early in the stream) can still be shared with the previous undo step. Chunks written in
+   * this step are added too, to also share duplicated data within a single step. */
+  mem_data->chunk_content_set = BLI_gset_new(
+      memfile_chunk_content_hash, memfile_chunk_content_cmp, __func__);
+  if (reference_memfile != NULL) {
+    LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      BLI_gset_add(mem_data->chunk_content_set, mem_chunk);
+    }
+  }
+
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
    * us to easily find the existing undo memory storage of IDs even when some re-ordering in
@@ -152,6 +226,9 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->chunk_content_set != NULL) {
+    BLI_gset_free(mem_data->chunk_content_set, NULL);
+  }
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -168,6 +245,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  curchunk->hash = 0;
   BLI_addtail(&memfile->chunks, curchunk);
 
   /* we compare compchunk with buf */
@@ -176,6 +254,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
+        curchunk->hash = compchunk->hash;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
       }
@@ -183,12 +262,30 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     *compchunk_step = compchunk->next;
   }
 
-  /* not equal... */
+  /* not equal at the same position, look for the same content anywhere else. */
   if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
+    MemFileChunk key = {
+        .buf = buf,
+        .size = size,
+        .hash = BLI_hash_mm2((const unsigned char *)buf, size, 0),
+    };
+    curchunk->hash = key.hash;
+
+    MemFileChunk *samechunk = BLI_gset_lookup(mem_data->chunk_content_set, &key);
+    if (samechunk != NULL) {
+      /* Not flagged as identical: the data does not belong to the same ID as before. */
+      curchunk->buf = samechunk->buf;
+    }
+  }
+
+  if (curchunk->buf != NULL) {
+    memfile_chunk_buffer_user_add(curchunk->buf);
+    memfile->size_shared += size;
+  }
+  else {
+    curchunk->buf = memfile_chunk_buffer_new(buf, size);
     memfile->size += size;
+    BLI_gset_add(mem_data->chunk_content_set, curchunk);
   }
 }
 
@@ -273,3 +370,281 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
   }
   return true;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Incremental Auto-Save Journal
+ *
+ * A journal stores the memfile of each auto-save as a list of chunk records, followed by a step
+ * record with the offsets of the chunks it is made of. Chunk buffers are shared between undo
+ * steps, so each auto-save only has to append the chunks that were not written before, then a
+ * new step. Reading a journal concatenates the chunks of its last complete step, which is a
+ * regular .blend file (a crash while appending leaves the previous step readable).
+ *
+ * Journals are only meant to be read on the system that wrote them (native byte-order).
+ * \{ */
+
+#define MEMFILE_JOURNAL_VERSION 1
+
+#define MEMFILE_JOURNAL_CHUNK BLEND_MAKE_ID('C', 'H', 'N', 'K')
+#define MEMFILE_JOURNAL_STEP BLEND_MAKE_ID('S', 'T', 'E', 'P')
+
+/** Write the whole journal again once it is this many times larger than the memfile. */
+#define MEMFILE_JOURNAL_REWRITE_FACTOR 3
+
+typedef struct MemFileJournalHeader {
+  char magic[8];
+  int version;
+  int _pad;
+} MemFileJournalHeader;
+
+typedef struct MemFileJournalRecord {
+  int code;
+  int _pad;
+  /** Size of the data following the record. */
+  uint64_t len;
+} MemFileJournalRecord;
+
+struct MemFileJournal {
+  char filepath[FILE_MAX];
+  /** Size of the journal file, zero when it has to be written from the start. */
+  uint64_t file_size;
+  /**
+   * Buffers of the chunks of the last step (each holding a user, so their address can't be
+   * reused by other data), mapped to an index in #MemFileJournal.buffer_offsets.
+   */
+  GHash *buffer_indices;
+  /** Offsets of the records of the buffers in #MemFileJournal.buffer_indices. */
+  uint64_t *buffer_offsets;
+};
+
+MemFileJournal *BLO_memfile_journal_new(void)
+{
+  return MEM_callocN(sizeof(MemFileJournal), __func__);
+}
+
+static void memfile_journal_buffers_free(GHash *buffer_indices, uint64_t *buffer_offsets)
+{
+  if (buffer_indices != NULL) {
+    GHashIterator gh_iter;
+    GHASH_ITER (gh_iter, buffer_indices) {
+      memfile_chunk_buffer_user_remove(BLI_ghashIterator_getKey(&gh_iter));
+    }
+    BLI_ghash_free(buffer_indices, NULL, NULL);
+  }
+  MEM_SAFE_FREE(buffer_offsets);
+}
+
+void BLO_memfile_journal_free(MemFileJournal *journal)
+{
+  memfile_journal_buffers_free(journal->buffer_indices, journal->buffer_offsets);
+  MEM_freeN(journal);
+}
+
+static bool memfile_journal_write_data(int file, const void *data, size_t len)
+{
+#ifdef _WIN32
+  return (size_t)write(file, data, (uint)len) == len;
+#else
+  return (size_t)write(file, data, len) == len;
+#endif
+}
+
+static bool memfile_journal_write_record(int file, int code, const void *data, size_t len)
+{
+  const MemFileJournalRecord record = {.code = code, .len = len};
+  return memfile_journal_write_data(file, &record, sizeof(record)) &&
+         memfile_journal_write_data(file, data, len);
+}
+
+/**
+ * Save \a memfile to the journal at \a filepath, appending only the chunks which were not
+ * written by the previous call using the same \a journal.
+ *
+ * \return success.
+ */
+bool BLO_memfile_journal_write(MemFileJournal *journal, MemFile *memfile, const char *filepath)
+{
+  uint64_t memfile_len = 0;
+  int chunks_len = 0;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    memfile_len += chunk->size;
+    chunks_len++;
+  }
+
+  /* Start over when the file was changed by something else or contains too much old data. */
+  if ((journal->file_size == 0) || !STREQ(journal->filepath, filepath) ||
+      (journal->file_size > memfile_len * MEMFILE_JOURNAL_REWRITE_FACTOR) ||
+      ((uint64_t)BLI_file_size(filepath) != journal->file_size)) {
+    memfile_journal_buffers_free(journal->buffer_indices, journal->buffer_offsets);
+    journal->buffer_indices = NULL;
+    journal->buffer_offsets = NULL;
+    journal->file_size = 0;
+    BLI_strncpy(journal->filepath, filepath, sizeof(journal->filepath));
+  }
+
+  /* See #BLO_memfile_write_file for symbolic links. */
+  int oflags = O_BINARY | O_WRONLY | O_CREAT;
+  if (journal->file_size == 0) {
+    oflags |= O_TRUNC;
+  }
+#ifdef O_NOFOLLOW
+  oflags |= O_NOFOLLOW;
+#endif
+  const int file = BLI_open(filepath, oflags, 0666);
+  if (file == -1) {
+    fprintf(stderr,
+            "Unable to save '%s': %s\n",
+            filepath,
+            errno ? strerror(errno) : "Unknown error opening file");
+    journal->file_size = 0;
+    return false;
+  }
+
+  bool success = true;
+  uint64_t file_size = journal->file_size;
+  if (file_size == 0) {
+    MemFileJournalHeader header = {.version = MEMFILE_JOURNAL_VERSION};
+    memcpy(header.magic, MEMFILE_JOURNAL_MAGIC, sizeof(header.magic));
+    success = memfile_journal_write_data(file, &header, sizeof(header));
+    file_size += sizeof(header);
+  }
+  else {
+    success = BLI_lseek(file, (int64_t)file_size, SEEK_SET) != -1;
+  }
+
+  GHash *buffer_indices = BLI_ghash_ptr_new_ex(__func__, (uint)chunks_len);
+  uint64_t *buffer_offsets = MEM_malloc_arrayN((size_t)chunks_len, sizeof(uint64_t), __func__);
+  uint64_t *step_offsets = MEM_malloc_arrayN((size_t)chunks_len, sizeof(uint64_t), __func__);
+  uint buffers_len = 0;
+  int chunk_index = 0;
+
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (!success) {
+      break;
+    }
+    void **index_p;
+    if (!BLI_ghash_ensure_p(buffer_indices, (void *)chunk->buf, &index_p)) {
+      void **index_prev_p = (journal->buffer_indices != NULL) ?
+                                BLI_ghash_lookup_p(journal->buffer_indices, chunk->buf) :
+                                NULL;
+      if (index_prev_p != NULL) {
+        buffer_offsets[buffers_len] = journal->buffer_offsets[POINTER_AS_UINT(*index_prev_p)];
+      }
+      else {
+        buffer_offsets[buffers_len] = file_size;
+        success = memfile_journal_write_record(
+            file, MEMFILE_JOURNAL_CHUNK, chunk->buf, chunk->size);
+        file_size += sizeof(MemFileJournalRecord) + chunk->size;
+      }
+      memfile_chunk_buffer_user_add(chunk->buf);
+      *index_p = POINTER_FROM_UINT(buffers_len);
+      buffers_len++;
+    }
+    step_offsets[chunk_index++] = buffer_offsets[POINTER_AS_UINT(*index_p)];
+  }
+
+  if (success) {
+    const size_t step_len = sizeof(uint64_t) * (size_t)chunks_len;
+    success = memfile_journal_write_record(file, MEMFILE_JOURNAL_STEP, step_offsets, step_len);
+    file_size += sizeof(MemFileJournalRecord) + step_len;
+  }
+  MEM_freeN(step_offsets);
+
+  if (close(file) == -1) {
+    success = false;
+  }
+
+  /* Only keep users of the buffers of this step, previous ones are never referenced again. */
+  memfile_journal_buffers_free(journal->buffer_indices, journal->buffer_offsets);
+  journal->buffer_indices = buffer_indices;
+  journal->buffer_offsets = buffer_offsets;
+  journal->file_size = success ? file_size : 0;
+
+  if (!success) {
+    fprintf(stderr,
+            "Unable to save '%s': %s\n",
+            filepath,
+            errno ? strerror(errno) : "Unknown error writing file");
+  }
+  return success;
+}
+
+static bool memfile_journal_read_record(int file, int64_t offset, MemFileJournalRecord *r_record)
+{
+  return (BLI_lseek(file, offset, SEEK_SET) != -1) &&
+         (read(file, r_record, sizeof(*r_record)) == sizeof(*r_record));
+}
+
+/**
+ * Read the last complete step of the journal opened as \a file.
+ *
+ * \return The contents of the .blend file (owned by the caller), NULL on failure.
+ */
+void *BLO_memfile_journal_read(int file, size_t *r_len)
+{
+  const uint64_t file_size = BLI_file_descriptor_size(file);
+  MemFileJournalHeader header;
+  if ((file_size == (uint64_t)-1) || (BLI_lseek(file, 0, SEEK_SET) == -1) ||
+      (read(file, &header, sizeof(header)) != sizeof(header)) ||
+      (memcmp(header.magic, MEMFILE_JOURNAL_MAGIC, sizeof(header.magic)) != 0) ||
+      (header.version != MEMFILE_JOURNAL_VERSION)) {
+    return NULL;
+  }
+
+  /* Find the last step which was written completely. */
+  uint64_t step_offset = 0;
+  MemFileJournalRecord step_record = {0};
+  MemFileJournalRecord record;
+  uint64_t offset = sizeof(header);
+  while ((offset + sizeof(record) <= file_size) &&
+         memfile_journal_read_record(file, (int64_t)offset, &record) &&
+         (record.len <= file_size - offset - sizeof(record))) {
+    if (record.code == MEMFILE_JOURNAL_STEP) {
+      step_offset = offset;
+      step_record = record;
+    }
+    offset += sizeof(record) + record.len;
+  }
+  if (step_offset == 0 || (step_record.len % sizeof(uint64_t)) != 0) {
+    return NULL;
+  }
+
+  const size_t chunks_len = (size_t)(step_record.len / sizeof(uint64_t));
+  uint64_t *chunk_offsets = MEM_malloc_arrayN(chunks_len, sizeof(uint64_t), __func__);
+  char *buffer = NULL;
+  size_t buffer_len = 0;
+  /* The chunk offsets follow the step record. */
+  const int64_t chunk_offsets_offset = (int64_t)(step_offset + sizeof(step_record));
+  bool success = (BLI_lseek(file, chunk_offsets_offset, SEEK_SET) != -1) &&
+                 (read(file, chunk_offsets, (size_t)step_record.len) ==
+                  (ssize_t)step_record.len);
+
+  /* Validate the chunks before reading them. */
+  for (size_t i = 0; success && i < chunks_len; i++) {
+    success = (chunk_offsets[i] < step_offset) &&
+              memfile_journal_read_record(file, (int64_t)chunk_offsets[i], &record) &&
+              (record.code == MEMFILE_JOURNAL_CHUNK) &&
+              (record.len <= step_offset - chunk_offsets[i] - sizeof(record));
+    buffer_len += (size_t)record.len;
+  }
+
+  if (success) {
+    buffer = MEM_mallocN(buffer_len, __func__);
+    size_t buffer_offset = 0;
+    for (size_t i = 0; success && i < chunks_len; i++) {
+      success = memfile_journal_read_record(file, (int64_t)chunk_offsets[i], &record) &&
+                (read(file, buffer + buffer_offset, (size_t)record.len) ==
+                 (ssize_t)record.len);
+      buffer_offset += (size_t)record.len;
+    }
+    if (!success) {
+      MEM_SAFE_FREE(buffer);
+    }
+  }
+  MEM_freeN(chunk_offsets);
+
+  *r_len = buffer_len;
+  return buffer;
+}
+
+/** \} */
@@ -246,6 +246,15 @@ static void do_versions_theme(const UserDef *userdef, bTheme *btheme)
     FROM_DEFAULT_V4_UCHAR(space_graph.vertex_active);
   }
 
+  if (!USER_VERSION_ATLEAST(292, 5)) {
+    for (int i = 0; i < COLLECTION_COLOR_TOT; ++i) {
+      FROM_DEFAULT_V4_UCHAR(collection_color[i].color);
+    }
+    FROM_DEFAULT_V4_UCHAR(space_sequencer.row_alternate);
+    FROM_DEFAULT_V4_UCHAR(space_node.nodeclass_geometry);
+    FROM_DEFAULT_V4_UCHAR(space_node.nodeclass_attribute);
+  }
+
   /**
    * Versioning code until next subversion bump goes here.
    *
@@ -257,12 +266,6 @@ static void do_versions_theme(const UserDef *userdef, bTheme *btheme)
    */
   {
     /* Keep this block, even when empty. */
-    for (int i = 0; i < COLLECTION_COLOR_TOT; ++i) {
-      FROM_DEFAULT_V4_UCHAR(collection_color[i].color);
-    }
-    FROM_DEFAULT_V4_UCHAR(space_sequencer.row_alternate);
-    FROM_DEFAULT_V4_UCHAR(space_node.nodeclass_geometry);
-    FROM_DEFAULT_V4_UCHAR(space_node.nodeclass_attribute);
   }
 
 #undef FROM_DEFAULT_V4_UCHAR
@@ -818,6 +821,14 @@ void blo_do_versions_userdef(UserDef *userdef)
     userdef->animation_flag = USER_ANIM_SHOW_CHANNEL_GROUP_COLORS;
   }
 
+  if (!USER_VERSION_ATLEAST(292, 5)) {
+    userdef->compositor_cache_limit = 1024;
+  }
+
+  if (!USER_VERSION_ATLEAST(292, 6)) {
+    userdef->modifier_cache_limit = 1024;
+  }
+
   /**
    * Versioning code until next subversion bump goes here.
    *
@@ -99,7 +99,9 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_endian_switch.h"
 #include "BLI_mempool.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_blender_version.h"
@@ -127,6 +129,10 @@
 
 #include <errno.h>
 
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
+
 /* Make preferences read-only. */
 #define U (*((const UserDef *)&U))
 
@@ -136,9 +142,6 @@
 #define MYWRITE_BUFFER_SIZE (MEM_SIZE_OPTIMAL(1 << 17)) /* 128kb */
 #define MYWRITE_MAX_CHUNK (MEM_SIZE_OPTIMAL(1 << 15))   /* ~32kb */
 
-/** Use if we want to store how many bytes have been written to the file. */
-// #define USE_WRITE_DATA_LEN
-
 /* -------------------------------------------------------------------- */
 /** \name Internal Write Wrapper's (Abstracts Compression)
  * \{ */
@@ -146,8 +149,15 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZLIB,
+#ifdef WITH_ZSTD
+  WW_WRAP_ZSTD,
+#endif
 } eWriteWrapType;
 
+#ifdef WITH_ZSTD
+typedef struct WriteWrapZstd WriteWrapZstd;
+#endif
+
 typedef struct WriteWrap WriteWrap;
 struct WriteWrap {
   /* callbacks */
@@ -162,6 +172,9 @@ struct WriteWrap {
   union {
     int file_handle;
     gzFile gz_handle;
+#ifdef WITH_ZSTD
+    WriteWrapZstd *zstd_handle;
+#endif
   } _user_data;
 };
 
@@ -217,6 +230,256 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+#ifdef WITH_ZSTD
+
+/* zstd */
+
+/**
+ * The output is split into frames which are compressed independently, followed by a seek table
+ * stored in a skippable frame, as described by the Zstandard seekable format:
+ * https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md
+ *
+ * This allows the reader to decompress any part of the file without decompressing
+ * everything before it, see #USE_BHEAD_READ_ON_DEMAND in `readfile.c`.
+ * Files without a seek table (written by external tools for e.g.) can still be read,
+ * only without seeking.
+ *
+ * Since frames are independent, they are compressed in parallel on a thread pool
+ * while the main thread continues writing, then written to the file in order.
+ */
+
+/* Use a larger frame size than #MYWRITE_BUFFER_SIZE, since smaller frames compress poorly. */
+#  define ZSTD_FRAME_SIZE (1 << 20) /* 1mb */
+#  define ZSTD_COMPRESSION_LEVEL 3
+
+#  define ZSTD_SEEKABLE_MAGIC_SKIPPABLE 0x184D2A5E
+#  define ZSTD_SEEKABLE_MAGIC_FOOTER 0x8F92EAB1
+
+typedef struct ZstdFrame {
+  struct ZstdFrame *next, *prev;
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+} ZstdFrame;
+
+/** Compression of a single frame, run on a thread of #WriteWrapZstd.threadpool. */
+typedef struct ZstdWriteTask {
+  struct ZstdWriteTask *next, *prev;
+  struct WriteWrapZstd *zstd;
+  /** Uncompressed data, owned by the task. */
+  char *data;
+  size_t data_len;
+  int frame_index;
+} ZstdWriteTask;
+
+struct WriteWrapZstd {
+  int file_handle;
+
+  /** Uncompressed data of the frame being filled (#ZSTD_FRAME_SIZE), main thread only. */
+  char *in_buf;
+  size_t in_buf_used_len;
+
+  ListBase threadpool;
+  /** #ZstdWriteTask's which haven't been joined yet, in frame order (main thread only). */
+  ListBase tasks;
+  int frames_submitted;
+
+  /** Locks the members below, used by the compression threads. */
+  ThreadMutex mutex;
+  /** Notified when a frame has been written. */
+  ThreadCondition condition;
+  /** Index of the frame to write next, frames are written in order. */
+  int frame_next;
+  /** List of #ZstdFrame, used to write the seek table. */
+  ListBase frames;
+  bool error;
+};
+
+#  define FILE_HANDLE(ww) (ww)->_user_data.zstd_handle
+
+static bool zstd_write_raw(WriteWrapZstd *zstd, const void *buf, size_t buf_len)
+{
+  if (write(zstd->file_handle, buf, buf_len) != (ssize_t)buf_len) {
+    zstd->error = true;
+  }
+  return !zstd->error;
+}
+
+static void zstd_write_u32_le(WriteWrapZstd *zstd, uint32_t val)
+{
+#  ifdef __BIG_ENDIAN__
+  BLI_endian_switch_uint32(&val);
+#  endif
+  zstd_write_raw(zstd, &val, sizeof(val));
+}
+
+static void *zstd_write_task(void *userdata)
+{
+  ZstdWriteTask *task = userdata;
+  WriteWrapZstd *zstd = task->zstd;
+
+  const size_t out_buf_max_len = ZSTD_compressBound(task->data_len);
+  char *out_buf = MEM_mallocN(out_buf_max_len, __func__);
+  const size_t out_len = ZSTD_compress(
+      out_buf, out_buf_max_len, task->data, task->data_len, ZSTD_COMPRESSION_LEVEL);
+
+  BLI_mutex_lock(&zstd->mutex);
+
+  /* Wait for the previous frames to be written. */
+  while (zstd->frame_next != task->frame_index) {
+    BLI_condition_wait(&zstd->condition, &zstd->mutex);
+  }
+
+  if (ZSTD_isError(out_len)) {
+    zstd->error = true;
+  }
+  else if (!zstd->error && zstd_write_raw(zstd, out_buf, out_len)) {
+    ZstdFrame *frame = MEM_mallocN(sizeof(*frame), __func__);
+    frame->compressed_size = (uint32_t)out_len;
+    frame->uncompressed_size = (uint32_t)task->data_len;
+    BLI_addtail(&zstd->frames, frame);
+  }
+
+  zstd->frame_next++;
+  BLI_condition_notify_all(&zstd->condition);
+  BLI_mutex_unlock(&zstd->mutex);
+
+  MEM_freeN(out_buf);
+  MEM_freeN(task->data);
+  task->data = NULL;
+
+  return NULL;
+}
+
+/**
+ * Hand the pending data in #WriteWrapZstd.in_buf over to a compression thread.
+ * \return false when writing has failed.
+ */
+static bool zstd_write_frame(WriteWrapZstd *zstd)
+{
+  if (zstd->in_buf_used_len != 0) {
+    ZstdWriteTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->zstd = zstd;
+    task->data = zstd->in_buf;
+    task->data_len = zstd->in_buf_used_len;
+    task->frame_index = zstd->frames_submitted++;
+
+    zstd->in_buf = MEM_mallocN(ZSTD_FRAME_SIZE, __func__);
+    zstd->in_buf_used_len = 0;
+
+    /* When all threads are busy, wait for the oldest task. All frames before it have been
+     * written, so it never waits for another task. This also limits the memory in use. */
+    if (BLI_available_threads(&zstd->threadpool) == 0) {
+      ZstdWriteTask *task_first = zstd->tasks.first;
+      BLI_threadpool_remove(&zstd->threadpool, task_first);
+      BLI_remlink(&zstd->tasks, task_first);
+      MEM_freeN(task_first);
+    }
+
+    BLI_addtail(&zstd->tasks, task);
+    BLI_threadpool_insert(&zstd->threadpool, task);
+  }
+
+  BLI_mutex_lock(&zstd->mutex);
+  const bool error = zstd->error;
+  BLI_mutex_unlock(&zstd->mutex);
+
+  return !error;
+}
+
+/** Write the seek table as a skippable frame, this must be the last frame in the file. */
+static void zstd_write_seek_table(WriteWrapZstd *zstd)
+{
+  const uint32_t frames_num = (uint32_t)BLI_listbase_count(&zstd->frames);
+  /* Two #uint32_t per frame, followed by the footer (frame count, flags & magic number). */
+  const uint32_t table_size = (frames_num * 8) + 9;
+
+  zstd_write_u32_le(zstd, ZSTD_SEEKABLE_MAGIC_SKIPPABLE);
+  zstd_write_u32_le(zstd, table_size);
+
+  LISTBASE_FOREACH (ZstdFrame *, frame, &zstd->frames) {
+    zstd_write_u32_le(zstd, frame->compressed_size);
+    zstd_write_u32_le(zstd, frame->uncompressed_size);
+  }
+
+  zstd_write_u32_le(zstd, frames_num);
+  /* No per-frame checksums are stored. */
+  const char flags = 0;
+  zstd_write_raw(zstd, &flags, sizeof(flags));
+  zstd_write_u32_le(zstd, ZSTD_SEEKABLE_MAGIC_FOOTER);
+}
+
+static bool ww_open_zstd(WriteWrap *ww, const char *filepath)
+{
+  int file;
+
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+  if (file == -1) {
+    return false;
+  }
+
+  WriteWrapZstd *zstd = MEM_callocN(sizeof(*zstd), __func__);
+  zstd->file_handle = file;
+  zstd->in_buf = MEM_mallocN(ZSTD_FRAME_SIZE, __func__);
+
+  /* Leave one thread for the main thread which generates the data,
+   * unless there is only one. */
+  const int threads_num = MAX2(1, BLI_system_thread_count() - 1);
+  BLI_threadpool_init(&zstd->threadpool, zstd_write_task, threads_num);
+  BLI_mutex_init(&zstd->mutex);
+  BLI_condition_init(&zstd->condition);
+
+  FILE_HANDLE(ww) = zstd;
+  return true;
+}
+static bool ww_close_zstd(WriteWrap *ww)
+{
+  WriteWrapZstd *zstd = FILE_HANDLE(ww);
+
+  zstd_write_frame(zstd);
+
+  /* Wait for all frames to be written, after this only the main thread accesses #zstd. */
+  BLI_threadpool_end(&zstd->threadpool);
+  BLI_freelistN(&zstd->tasks);
+  BLI_mutex_end(&zstd->mutex);
+  BLI_condition_end(&zstd->condition);
+
+  if (!zstd->error) {
+    zstd_write_seek_table(zstd);
+  }
+
+  const bool success = (close(zstd->file_handle) != -1) && !zstd->error;
+
+  BLI_freelistN(&zstd->frames);
+  MEM_freeN(zstd->in_buf);
+  MEM_freeN(zstd);
+
+  return success;
+}
+static size_t ww_write_zstd(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  WriteWrapZstd *zstd = FILE_HANDLE(ww);
+  size_t written_len = 0;
+
+  while (written_len < buf_len) {
+    const size_t chunk_len = MIN2(buf_len - written_len, ZSTD_FRAME_SIZE - zstd->in_buf_used_len);
+    memcpy(zstd->in_buf + zstd->in_buf_used_len, buf + written_len, chunk_len);
+    zstd->in_buf_used_len += chunk_len;
+    written_len += chunk_len;
+
+    if (zstd->in_buf_used_len == ZSTD_FRAME_SIZE) {
+      if (!zstd_write_frame(zstd)) {
+        return 0;
+      }
+    }
+  }
+
+  return written_len;
+}
+#  undef FILE_HANDLE
+
+#endif /* WITH_ZSTD */
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -231,6 +494,16 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = false;
       break;
     }
+#ifdef WITH_ZSTD
+    case WW_WRAP_ZSTD: {
+      r_ww->open = ww_open_zstd;
+      r_ww->close = ww_close_zstd;
+      r_ww->write = ww_write_zstd;
+      /* Buffered into frames by the wrapper itself. */
+      r_ww->use_buf = false;
+      break;
+    }
+#endif
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -255,10 +528,8 @@ typedef struct {
   /** Number of bytes used in #WriteData.buf (flushed when exceeded). */
   size_t buf_used_len;
 
-#ifdef USE_WRITE_DATA_LEN
-  /** Total number of bytes written. */
+  /** Total number of bytes written (the offset in the uncompressed file). */
   size_t write_len;
-#endif
 
   /** Set on unlikely case of an error (ignores further file writing).  */
   bool error;
@@ -274,6 +545,18 @@ typedef struct {
    * Will be NULL for UNDO.
    */
   WriteWrap *ww;
+
+  /** Data-block index, written at the end of the file (see #BlendFileIndexHeader). */
+  struct {
+    /** Only used when writing files, not for undo. */
+    bool use;
+    BlendFileIndexEntry *entries;
+    int entries_len, entries_len_alloc;
+    char (*libraries)[FILE_MAX];
+    int libraries_len, libraries_len_alloc;
+    uint64_t dna_offset;
+    int preview_struct_nr;
+  } index;
 } WriteData;
 
 typedef struct BlendWriter {
@@ -326,6 +609,8 @@ static void writedata_free(WriteData *wd)
   if (wd->buf) {
     MEM_freeN(wd->buf);
   }
+  MEM_SAFE_FREE(wd->index.entries);
+  MEM_SAFE_FREE(wd->index.libraries);
   MEM_freeN(wd);
 }
 
@@ -363,9 +648,7 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
     return;
   }
 
-#ifdef USE_WRITE_DATA_LEN
   wd->write_len += len;
-#endif
 
   if (wd->buf == NULL) {
     writedata_do_write(wd, adr, len);
@@ -416,6 +699,10 @@ static WriteData *mywrite_begin(WriteWrap *ww, MemFile *compare, MemFile *curren
     BLO_memfile_write_init(&wd->mem, current, compare);
     wd->use_memfile = true;
   }
+  else {
+    wd->index.use = true;
+    wd->index.preview_struct_nr = SDNA_TYPE_FROM_STRUCT(PreviewImage);
+  }
 
   return wd;
 }
@@ -487,6 +774,58 @@ static void mywrite_id_end(WriteData *wd, ID *UNUSED(id))
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name File Index Writing
+ * \{ */
+
+/**
+ * Add data-blocks and their previews to the index, \a data is the block about to be written.
+ */
+static void write_index_add_block(WriteData *wd,
+                                  int filecode,
+                                  const int struct_nr,
+                                  const void *data)
+{
+  if (filecode == DATA) {
+    /* The preview of the data-block added last, see #BKE_previewimg_blend_write. */
+    if (struct_nr == wd->index.preview_struct_nr && wd->index.entries_len != 0) {
+      BlendFileIndexEntry *entry = &wd->index.entries[wd->index.entries_len - 1];
+      if (entry->preview_offset == 0) {
+        entry->preview_offset = wd->write_len;
+      }
+    }
+    return;
+  }
+  if (!(filecode == ID_SCRN || BKE_idtype_idcode_is_valid(filecode))) {
+    return;
+  }
+
+  if (wd->index.entries_len == wd->index.entries_len_alloc) {
+    wd->index.entries_len_alloc = MAX2(64, wd->index.entries_len_alloc * 2);
+    wd->index.entries = MEM_reallocN(
+        wd->index.entries, sizeof(*wd->index.entries) * (size_t)wd->index.entries_len_alloc);
+  }
+  BlendFileIndexEntry *entry = &wd->index.entries[wd->index.entries_len++];
+  memset(entry, 0, sizeof(*entry));
+  entry->code = filecode;
+  entry->bhead_offset = wd->write_len;
+  BLI_strncpy(entry->name, ((const ID *)data)->name, sizeof(entry->name));
+
+  if (filecode == ID_LI) {
+    if (wd->index.libraries_len == wd->index.libraries_len_alloc) {
+      wd->index.libraries_len_alloc = MAX2(8, wd->index.libraries_len_alloc * 2);
+      wd->index.libraries = MEM_reallocN(
+          wd->index.libraries,
+          sizeof(*wd->index.libraries) * (size_t)wd->index.libraries_len_alloc);
+    }
+    BLI_strncpy(wd->index.libraries[wd->index.libraries_len++],
+                ((const Library *)data)->filepath,
+                FILE_MAX);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Generic DNA File Writing
  * \{ */
@@ -516,6 +855,10 @@ static void writestruct_at_address_nr(
     return;
   }
 
+  if (wd->index.use) {
+    write_index_add_block(wd, filecode, struct_nr, data);
+  }
+
   mywrite(wd, &bh, sizeof(BHead));
   mywrite(wd, data, (size_t)bh.len);
 }
@@ -550,6 +893,10 @@ static void writedata(WriteData *wd, int filecode, size_t len, const void *adr)
   bh.SDNAnr = 0;
   bh.len = (int)len;
 
+  if (filecode == DNA1) {
+    wd->index.dna_offset = wd->write_len;
+  }
+
   mywrite(wd, &bh, sizeof(BHead));
   mywrite(wd, adr, len);
 }
@@ -904,6 +1251,40 @@ static void write_thumb(WriteData *wd, const BlendThumbnail *thumb)
 /** \name File Writing (Private)
  * \{ */
 
+/**
+ * Write the index after #ENDB, followed by the trailer used to find it.
+ */
+static void write_index(WriteData *wd)
+{
+  const size_t index_size = BLEND_FILE_INDEX_SIZE(wd->index.entries_len,
+                                                  wd->index.libraries_len);
+  BlendFileIndexHeader *index = MEM_callocN(index_size, __func__);
+  index->version = BLEND_FILE_INDEX_VERSION;
+  index->entries_len = wd->index.entries_len;
+  index->libraries_len = wd->index.libraries_len;
+  index->subversion = BLENDER_FILE_SUBVERSION;
+  index->dna_offset = wd->index.dna_offset;
+  if (wd->index.entries_len != 0) {
+    memcpy(BLEND_FILE_INDEX_ENTRIES(index),
+           wd->index.entries,
+           sizeof(*wd->index.entries) * (size_t)wd->index.entries_len);
+  }
+  if (wd->index.libraries_len != 0) {
+    memcpy(BLEND_FILE_INDEX_LIBRARIES(index),
+           wd->index.libraries,
+           sizeof(*wd->index.libraries) * (size_t)wd->index.libraries_len);
+  }
+
+  BlendFileIndexTrailer trailer;
+  trailer.index_offset = wd->write_len;
+  memcpy(trailer.magic, BLEND_FILE_INDEX_MAGIC, sizeof(trailer.magic));
+
+  writedata(wd, INDX, index_size, index);
+  mywrite(wd, &trailer, sizeof(trailer));
+
+  MEM_freeN(index);
+}
+
 /* if MemFile * there's filesave to memory */
 static bool write_file_handle(Main *mainvar,
                               WriteWrap *ww,
@@ -1058,6 +1439,11 @@ static bool write_file_handle(Main *mainvar,
   bhead.code = ENDB;
   mywrite(wd, &bhead, sizeof(BHead));
 
+  /* Readers stop at #ENDB, so older versions of Blender ignore the index. */
+  if (wd->index.use) {
+    write_index(wd);
+  }
+
   blo_join_main(&mainlist);
 
   return mywrite_end(wd);
@@ -1140,11 +1526,21 @@ bool BLO_write_file(Main *mainvar,
     BLO_main_validate_shapekeys(mainvar, reports);
   }
 
+  /* Packed data which isn't loaded yet can't be written, don't save a file missing it. */
+  if (!BKE_packedfile_data_ensure_all(mainvar, reports)) {
+    BKE_report(reports, RPT_ERROR, "Cannot save the file without its packed data");
+    return 0;
+  }
+
   /* open temporary file, so we preserve the original in case we crash */
   BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
   if (write_flags & G_FILE_COMPRESS) {
+#ifdef WITH_ZSTD
+    ww_type = WW_WRAP_ZSTD;
+#else
     ww_type = WW_WRAP_ZLIB;
+#endif
   }
   else {
     ww_type = WW_WRAP_NONE;
@@ -1220,9 +1616,12 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
 
-  ww.close(&ww);
+  /* Compressed output may only be flushed on close, so its errors matter too. */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
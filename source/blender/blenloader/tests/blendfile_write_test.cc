@@ -0,0 +1,253 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_global.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_material.h"
+#include "BKE_mesh.h"
+#include "BKE_packedFile.h"
+#include "BKE_report.h"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_undofile.h"
+#include "BLO_writefile.h"
+
+#include "DNA_ID.h"
+#include "DNA_image_types.h"
+#include "DNA_packedFile_types.h"
+
+class BlendfileWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  struct Main *bmain = nullptr;
+  char filepath[FILE_MAX];
+
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+
+    /* Purged by #BlendfileLoadingBaseTest::TearDownTestCase. */
+    BKE_tempdir_init(nullptr);
+    BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "write_test.blend");
+
+    bmain = BKE_main_new();
+    BKE_mesh_add(bmain, "TestMesh");
+    BKE_material_add(bmain, "TestMaterial");
+  }
+
+  virtual void TearDown()
+  {
+    BKE_main_free(bmain);
+    BLI_delete(filepath, false, false);
+
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  bool blendfile_write(const int write_flags)
+  {
+    BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+    return BLO_write_file(bmain, filepath, write_flags, &params, nullptr);
+  }
+
+  /* Read the file back, checking it contains the data-blocks written by #SetUp. */
+  void blendfile_read_and_check()
+  {
+    bfile = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr);
+    ASSERT_NE(bfile, nullptr);
+    EXPECT_NE(BKE_libblock_find_name(bfile->main, ID_ME, "TestMesh"), nullptr);
+    EXPECT_NE(BKE_libblock_find_name(bfile->main, ID_MA, "TestMaterial"), nullptr);
+  }
+
+  /* The first bytes of the file, as written. */
+  bool blendfile_header_is_uncompressed()
+  {
+    char header[7] = {0};
+    FILE *file = BLI_fopen(filepath, "rb");
+    if (file == nullptr) {
+      return false;
+    }
+    const bool ok = (fread(header, 1, sizeof(header), file) == sizeof(header));
+    fclose(file);
+    return ok && memcmp(header, "BLENDER", sizeof(header)) == 0;
+  }
+
+  /* Remove the last \a len bytes of the file, like an interrupted write. */
+  void blendfile_truncate(const size_t len)
+  {
+    size_t file_len;
+    void *data = BLI_file_read_binary_as_mem(filepath, 0, &file_len);
+    ASSERT_NE(data, nullptr);
+    ASSERT_GT(file_len, len);
+    FILE *file = BLI_fopen(filepath, "wb");
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(fwrite(data, 1, file_len - len, file), file_len - len);
+    fclose(file);
+    MEM_freeN(data);
+  }
+};
+
+TEST_F(BlendfileWriteTest, WriteRead)
+{
+  ASSERT_TRUE(blendfile_write(0));
+  EXPECT_TRUE(blendfile_header_is_uncompressed());
+  EXPECT_TRUE(BLO_has_bfile_header(filepath));
+  blendfile_read_and_check();
+}
+
+TEST_F(BlendfileWriteTest, WriteReadCompressed)
+{
+  ASSERT_TRUE(blendfile_write(G_FILE_COMPRESS));
+  /* Detecting the file needs to decompress its header, see #wm_read_exotic. */
+  EXPECT_FALSE(blendfile_header_is_uncompressed());
+  EXPECT_TRUE(BLO_has_bfile_header(filepath));
+  blendfile_read_and_check();
+}
+
+TEST_F(BlendfileWriteTest, HeaderInvalid)
+{
+  FILE *file = BLI_fopen(filepath, "wb");
+  ASSERT_NE(file, nullptr);
+  const char data[] = "NOT A BLEND FILE";
+  EXPECT_EQ(fwrite(data, 1, sizeof(data), file), sizeof(data));
+  fclose(file);
+
+  EXPECT_FALSE(BLO_has_bfile_header(filepath));
+}
+
+TEST_F(BlendfileWriteTest, JournalWriteRead)
+{
+  MemFile memfile = {{nullptr}};
+  MemFile memfile_next = {{nullptr}};
+  MemFile memfile_last = {{nullptr}};
+  MemFileJournal *journal = BLO_memfile_journal_new();
+
+  ASSERT_TRUE(BLO_write_file_mem(bmain, nullptr, &memfile, 0));
+  EXPECT_TRUE(BLO_memfile_journal_write(journal, &memfile, filepath));
+
+  /* Appended to the journal, reading it gives the last step. */
+  BKE_mesh_add(bmain, "TestMeshNext");
+  ASSERT_TRUE(BLO_write_file_mem(bmain, &memfile, &memfile_next, 0));
+  EXPECT_TRUE(BLO_memfile_journal_write(journal, &memfile_next, filepath));
+
+  /* Interrupted while writing a step, reading it gives the last complete one. */
+  BKE_mesh_add(bmain, "TestMeshLast");
+  ASSERT_TRUE(BLO_write_file_mem(bmain, &memfile_next, &memfile_last, 0));
+  EXPECT_TRUE(BLO_memfile_journal_write(journal, &memfile_last, filepath));
+  blendfile_truncate(1);
+
+  BLO_memfile_journal_free(journal);
+  BLO_memfile_free(&memfile);
+  BLO_memfile_free(&memfile_next);
+  BLO_memfile_free(&memfile_last);
+
+  EXPECT_TRUE(BLO_has_bfile_header(filepath));
+  blendfile_read_and_check();
+  ASSERT_NE(bfile, nullptr);
+  EXPECT_NE(BKE_libblock_find_name(bfile->main, ID_ME, "TestMeshNext"), nullptr);
+  EXPECT_EQ(BKE_libblock_find_name(bfile->main, ID_ME, "TestMeshLast"), nullptr);
+}
+
+TEST_F(BlendfileWriteTest, MemFileMergeShared)
+{
+  MemFile memfile = {{nullptr}};
+  MemFile memfile_next = {{nullptr}};
+  MemFile memfile_last = {{nullptr}};
+
+  /* Unchanged data, the next steps share all of the first one. */
+  ASSERT_TRUE(BLO_write_file_mem(bmain, nullptr, &memfile, 0));
+  ASSERT_TRUE(BLO_write_file_mem(bmain, &memfile, &memfile_next, 0));
+  ASSERT_TRUE(BLO_write_file_mem(bmain, &memfile_next, &memfile_last, 0));
+  const size_t size = memfile.size;
+  EXPECT_GT(size, 0u);
+  EXPECT_EQ(memfile_next.size, 0u);
+  EXPECT_EQ(memfile_last.size, 0u);
+
+  /* Still shared with the last step. */
+  BLO_memfile_merge(&memfile, &memfile_next);
+  EXPECT_EQ(memfile_next.size, 0u);
+  EXPECT_GE(memfile_next.size_shared, size);
+
+  /* Only used by the last step now. */
+  BLO_memfile_merge(&memfile_next, &memfile_last);
+  EXPECT_EQ(memfile_last.size, size);
+
+  BLO_memfile_free(&memfile_last);
+}
+
+TEST_F(BlendfileWriteTest, LazyPackedData)
+{
+  /* Large enough not to be read when opening the file. */
+  const int len = 1 << 17;
+  char *data = static_cast<char *>(MEM_mallocN(len, __func__));
+  memset(data, 7, len);
+  Image *ima = static_cast<Image *>(BKE_id_new(bmain, ID_IM, "TestImage"));
+  ImagePackedFile *imapf = static_cast<ImagePackedFile *>(MEM_callocN(sizeof(*imapf), __func__));
+  imapf->packedfile = BKE_packedfile_new_from_memory(data, len);
+  BLI_addtail(&ima->packedfiles, imapf);
+  ASSERT_TRUE(blendfile_write(0));
+
+  bfile = BLO_read_from_file(filepath, BLO_READ_LAZY_PACKED_DATA, nullptr);
+  ASSERT_NE(bfile, nullptr);
+  Image *ima_read = reinterpret_cast<Image *>(BKE_libblock_find_name(bfile->main, ID_IM, "TestImage"));
+  ASSERT_NE(ima_read, nullptr);
+  ASSERT_NE(ima_read->packedfiles.first, nullptr);
+  PackedFile *pf = static_cast<ImagePackedFile *>(ima_read->packedfiles.first)->packedfile;
+  EXPECT_EQ(pf->data, nullptr);
+
+  /* Undo steps don't read the data, but keep its location. */
+  MemFile memfile = {{nullptr}};
+  ASSERT_TRUE(BLO_write_file_mem(bfile->main, nullptr, &memfile, 0));
+  EXPECT_EQ(pf->data, nullptr);
+  EXPECT_LT(memfile.size, size_t(len));
+  BlendFileReadParams params = {0};
+  params.skip_flags = BLO_READ_SKIP_UNDO_OLD_MAIN;
+  BlendFileData *bfile_undo = BLO_read_from_memfile(
+      bfile->main, filepath, &memfile, &params, nullptr);
+  BLO_memfile_free(&memfile);
+  ASSERT_NE(bfile_undo, nullptr);
+  Image *ima_undo = reinterpret_cast<Image *>(
+      BKE_libblock_find_name(bfile_undo->main, ID_IM, "TestImage"));
+  ASSERT_NE(ima_undo, nullptr);
+  ASSERT_NE(ima_undo->packedfiles.first, nullptr);
+  PackedFile *pf_undo = static_cast<ImagePackedFile *>(ima_undo->packedfiles.first)->packedfile;
+  EXPECT_EQ(pf_undo->data, nullptr);
+  ASSERT_TRUE(BKE_packedfile_data_ensure(pf_undo));
+  EXPECT_EQ(memcmp(pf_undo->data, data, len), 0);
+  BLO_blendfiledata_free(bfile_undo);
+
+  /* Saving fails when the data can't be read anymore, instead of writing the file without it. */
+  BLI_delete(filepath, false, false);
+  ReportList reports;
+  BKE_reports_init(&reports, RPT_STORE);
+  BlendFileWriteParams write_params = {BLO_WRITE_PATH_REMAP_NONE};
+  EXPECT_FALSE(BLO_write_file(bfile->main, filepath, 0, &write_params, &reports));
+  EXPECT_TRUE(BKE_reports_contain(&reports, RPT_ERROR));
+  EXPECT_FALSE(BLI_exists(filepath));
+  BKE_reports_clear(&reports);
+}
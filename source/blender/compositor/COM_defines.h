@@ -58,6 +58,18 @@ typedef enum CompositorPriority {
   COM_PRIORITY_LOW = 0,
 } CompositorPriority;
 
+/**
+ * \brief Possible ways to execute the operations of a node tree
+ * \see CompositorContext.executionModel
+ * \ingroup Execution
+ */
+typedef enum ExecutionModel {
+  /** \brief Output groups are split in chunks which pull their pixels through the operations */
+  COM_EM_TILED = 0,
+  /** \brief Every operation renders its whole area of interest into a buffer at once */
+  COM_EM_FULL_FRAME = 1,
+} ExecutionModel;
+
 // configurable items
 
 // chunk size determination
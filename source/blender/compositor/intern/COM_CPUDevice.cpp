@@ -18,12 +18,20 @@
 
 #include "COM_CPUDevice.h"
 
+#include "BLI_profile.h"
+
 CPUDevice::CPUDevice(int thread_id) : m_thread_id(thread_id)
 {
 }
 
 void CPUDevice::execute(WorkPackage *work)
 {
+  BLI_PROFILE_SCOPE("compositor_work_package");
+  if (work->getExecuteFunction()) {
+    work->getExecuteFunction()();
+    return;
+  }
+
   const unsigned int chunkNumber = work->getChunkNumber();
   ExecutionGroup *executionGroup = work->getExecutionGroup();
   rcti rect;
@@ -77,6 +77,11 @@ class CompositorContext {
    */
   bool m_fastCalculation;
 
+  /**
+   * \brief How the operations are executed, tiled or full frame
+   */
+  ExecutionModel m_executionModel;
+
   /* \brief color management settings */
   const ColorManagedViewSettings *m_viewSettings;
   const ColorManagedDisplaySettings *m_displaySettings;
@@ -250,6 +255,22 @@ class CompositorContext {
     this->m_viewName = viewName;
   }
 
+  /**
+   * \brief set how the operations are executed
+   */
+  void setExecutionModel(ExecutionModel executionModel)
+  {
+    this->m_executionModel = executionModel;
+  }
+
+  /**
+   * \brief get how the operations are executed
+   */
+  ExecutionModel getExecutionModel() const
+  {
+    return this->m_executionModel;
+  }
+
   int getChunksize() const
   {
     return this->getbNodeTree()->chunksize;
@@ -59,6 +59,9 @@ ExecutionGroup::ExecutionGroup()
   this->m_chunksFinished = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  this->m_executionTime = 0;
+  this->m_numberOfChunksExecuted = 0;
+  this->m_chunksExecutionTime = 0;
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -135,6 +138,13 @@ void ExecutionGroup::initExecution()
       this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
     }
   }
+  this->m_chunkThreads = vector<std::atomic<int>>(this->m_numberOfChunks);
+  for (std::atomic<int> &threadId : this->m_chunkThreads) {
+    threadId.store(-1, std::memory_order_relaxed);
+  }
+  this->m_executionTime = 0;
+  this->m_numberOfChunksExecuted = 0;
+  this->m_chunksExecutionTime = 0;
 
   unsigned int maxNumber = 0;
 
@@ -156,6 +166,7 @@ void ExecutionGroup::deinitExecution()
     MEM_freeN(this->m_chunkExecutionStates);
     this->m_chunkExecutionStates = nullptr;
   }
+  this->m_chunkThreads.clear();
   this->m_numberOfChunks = 0;
   this->m_numberOfXChunks = 0;
   this->m_numberOfYChunks = 0;
@@ -340,7 +351,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
       const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
       if (state == COM_ES_NOT_SCHEDULED) {
-        scheduleChunkWhenPossible(graph, xChunk, yChunk);
+        scheduleChunkWhenPossible(graph, xChunk, yChunk, index);
         finished = false;
         startEvaluated = true;
         numberEvaluated++;
@@ -365,6 +376,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       breaked = true;
     }
   }
+  this->m_executionTime = PIL_check_seconds_timer() - this->m_executionStartTime;
   DebugInfo::execution_group_finished(this);
   DebugInfo::graphviz(graph);
 
@@ -438,6 +450,15 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
   }
 }
 
+void ExecutionGroup::recordChunkExecution(unsigned int chunkNumber, int threadId, double time)
+{
+  if (chunkNumber < this->m_chunkThreads.size()) {
+    this->m_chunkThreads[chunkNumber].store(threadId, std::memory_order_relaxed);
+  }
+  this->m_numberOfChunksExecuted++;
+  this->m_chunksExecutionTime += time;
+}
+
 inline void ExecutionGroup::determineChunkRect(rcti *rect,
                                                const unsigned int xChunk,
                                                const unsigned int yChunk) const
@@ -481,15 +502,15 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int /*chunkNumber*/, rcti *re
   return nullptr;
 }
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+void ExecutionGroup::determineAreaChunks(const rcti *area, rcti *r_chunks) const
 {
   if (this->m_singleThreaded) {
-    return scheduleChunkWhenPossible(graph, 0, 0);
+    BLI_rcti_init(r_chunks, 0, 1, 0, 1);
+    return;
   }
   // find all chunks inside the rect
   // determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
 
-  int indexx, indexy;
   int minx = max_ii(area->xmin - m_viewerBorder.xmin, 0);
   int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
   int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
@@ -502,11 +523,40 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   minychunk = max_ii(minychunk, 0);
   maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
   maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
+  BLI_rcti_init(r_chunks, minxchunk, maxxchunk, minychunk, maxychunk);
+}
+
+void ExecutionGroup::countChunkThreads(const rcti *area, vector<unsigned int> &r_counts) const
+{
+  rcti chunks;
+  determineAreaChunks(area, &chunks);
+  for (int indexy = chunks.ymin; indexy < chunks.ymax; indexy++) {
+    for (int indexx = chunks.xmin; indexx < chunks.xmax; indexx++) {
+      /* Only a hint for the preferred thread, the chunk states order the execution. */
+      const int threadId = this->m_chunkThreads[indexy * this->m_numberOfXChunks + indexx].load(
+          std::memory_order_relaxed);
+      if (threadId < 0) {
+        continue;
+      }
+      if ((unsigned int)threadId >= r_counts.size()) {
+        r_counts.resize(threadId + 1, 0);
+      }
+      r_counts[threadId]++;
+    }
+  }
+}
+
+bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph,
+                                              rcti *area,
+                                              unsigned int priority)
+{
+  rcti chunks;
+  determineAreaChunks(area, &chunks);
 
   bool result = true;
-  for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
-    for (indexy = minychunk; indexy < maxychunk; indexy++) {
-      if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
+  for (int indexx = chunks.xmin; indexx < chunks.xmax; indexx++) {
+    for (int indexy = chunks.ymin; indexy < chunks.ymax; indexy++) {
+      if (!scheduleChunkWhenPossible(graph, indexx, indexy, priority)) {
         result = false;
       }
     }
@@ -515,17 +565,22 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   return result;
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber,
+                                   unsigned int priority,
+                                   int preferredThread)
 {
   if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
     this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-    WorkScheduler::schedule(this, chunkNumber);
+    WorkScheduler::schedule(this, chunkNumber, priority, preferredThread);
     return true;
   }
   return false;
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
+bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                               int xChunk,
+                                               int yChunk,
+                                               unsigned int priority)
 {
   if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
     return true;
@@ -553,6 +608,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
   unsigned int index;
   bool canBeExecuted = true;
   rcti area;
+  vector<unsigned int> threadCounts;
 
   for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
     ReadBufferOperation *readOperation =
@@ -563,9 +619,12 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
     ExecutionGroup *group = memoryProxy->getExecutor();
 
     if (group != nullptr) {
-      if (!group->scheduleAreaWhenPossible(graph, &area)) {
+      if (!group->scheduleAreaWhenPossible(graph, &area, priority)) {
         canBeExecuted = false;
       }
+      else {
+        group->countChunkThreads(&area, threadCounts);
+      }
     }
     else {
       throw "ERROR";
@@ -573,7 +632,15 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
   }
 
   if (canBeExecuted) {
-    scheduleChunk(chunkNumber);
+    /* Prefer the thread that executed most of the input chunks. */
+    int preferredThread = -1;
+    for (index = 0; index < threadCounts.size(); index++) {
+      if (threadCounts[index] > 0 &&
+          (preferredThread == -1 || threadCounts[index] > threadCounts[preferredThread])) {
+        preferredThread = index;
+      }
+    }
+    scheduleChunk(chunkNumber, priority, preferredThread);
   }
 
   return false;
@@ -28,6 +28,7 @@
 #include "COM_MemoryProxy.h"
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
+#include <atomic>
 #include <vector>
 
 using std::vector;
@@ -181,6 +182,24 @@ class ExecutionGroup {
    */
   double m_executionStartTime;
 
+  /**
+   * \brief time between the start and the end of the execution of an output ExecutionGroup
+   */
+  double m_executionTime;
+
+  /**
+   * \brief per chunk the thread id of the CPUDevice that executed it, -1 when not executed by a
+   * CPUDevice. Chunks depending on it are scheduled on the same thread, where it's still cached.
+   * \note atomic as it's written by the CPUDevices while chunks are being scheduled.
+   */
+  vector<std::atomic<int>> m_chunkThreads;
+
+  /**
+   * \brief number of chunks executed by CPUDevices and the total time spent on them
+   */
+  unsigned int m_numberOfChunksExecuted;
+  double m_chunksExecutionTime;
+
   // methods
   /**
    * \brief check whether parameter operation can be added to the execution group
@@ -209,6 +228,17 @@ class ExecutionGroup {
    */
   void determineNumberOfChunks();
 
+  /**
+   * \brief determine the range of chunks (minx, maxx, miny, maxy) overlapping an area.
+   */
+  void determineAreaChunks(const rcti *area, rcti *r_chunks) const;
+
+  /**
+   * \brief count per thread id the executed chunks overlapping an area.
+   * \param r_counts: the counts are added to, the vector grows when needed
+   */
+  void countChunkThreads(const rcti *area, vector<unsigned int> &r_counts) const;
+
   /**
    * \brief try to schedule a specific chunk.
    * \note scheduling succeeds when all input requirements are met and the chunks hasn't been
@@ -216,11 +246,15 @@ class ExecutionGroup {
    * \param graph:
    * \param xChunk:
    * \param yChunk:
+   * \param priority: the index in the ChunkOrder of the output chunk that needs this chunk
    * \return [true:false]
    * true: package(s) are scheduled
    * false: scheduling is deferred (depending workpackages are scheduled)
    */
-  bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+  bool scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                 int xChunk,
+                                 int yChunk,
+                                 unsigned int priority);
 
   /**
    * \brief try to schedule a specific area.
@@ -228,17 +262,20 @@ class ExecutionGroup {
    * \note This method is called from other ExecutionGroup's.
    * \param graph:
    * \param area:
+   * \param priority: the index in the ChunkOrder of the output chunk that needs this area
    * \return [true:false]
    * true: package(s) are scheduled
    * false: scheduling is deferred (depending workpackages are scheduled)
    */
-  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area);
+  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area, unsigned int priority);
 
   /**
    * \brief add a chunk to the WorkScheduler.
    * \param chunknumber:
+   * \param priority: packages with a lower priority are executed first
+   * \param preferredThread: thread id of the CPUDevice to execute the chunk, -1 for any
    */
-  bool scheduleChunk(unsigned int chunkNumber);
+  bool scheduleChunk(unsigned int chunkNumber, unsigned int priority, int preferredThread);
 
   /**
    * \brief determine the area of interest of a certain input area
@@ -375,6 +412,38 @@ class ExecutionGroup {
    */
   void finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers);
 
+  /**
+   * \brief store which CPUDevice executed a chunk and how long it took.
+   * \note called by the WorkScheduler with its queue lock held, which serializes the updates of
+   * the counters. The thread ids are also read without that lock by #countChunkThreads.
+   */
+  void recordChunkExecution(unsigned int chunkNumber, int threadId, double time);
+
+  /**
+   * \brief get the number of chunks executed by CPUDevices
+   */
+  unsigned int getNumberOfChunksExecuted() const
+  {
+    return this->m_numberOfChunksExecuted;
+  }
+
+  /**
+   * \brief get the total time CPUDevices spent executing chunks of this ExecutionGroup
+   */
+  double getChunksExecutionTime() const
+  {
+    return this->m_chunksExecutionTime;
+  }
+
+  /**
+   * \brief get the time the execution of an output ExecutionGroup took, including the chunks of
+   * the ExecutionGroups it depends on
+   */
+  double getExecutionTime() const
+  {
+    return this->m_executionTime;
+  }
+
   /**
    * \brief deinitExecution is called just after execution the whole graph.
    * \note It will release all needed resources
@@ -18,9 +18,13 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include "BLI_profile.h"
+#include "BLI_rect.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include "PIL_time.h"
 
+#include "BKE_global.h"
 #include "BKE_node.h"
 
 #include "BLT_translation.h"
@@ -28,8 +32,10 @@
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_FullFrameExecutionModel.h"
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
+#include "COM_OutputCache.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_WorkScheduler.h"
 
@@ -65,6 +71,8 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
   this->m_context.setRenderData(rd);
   this->m_context.setViewSettings(viewSettings);
   this->m_context.setDisplaySettings(displaySettings);
+  this->m_context.setExecutionModel(
+      (editingtree->flag & NTREE_COM_FULL_FRAME) ? COM_EM_FULL_FRAME : COM_EM_TILED);
 
   {
     NodeOperationBuilder builder(&m_context, editingtree);
@@ -127,13 +135,47 @@ void ExecutionSystem::set_operations(const Operations &operations, const Groups
   m_groups = groups;
 }
 
+static void print_group_timings(const ExecutionSystem::Groups &groups)
+{
+  printf("Compositor execution groups:\n");
+  for (unsigned int index = 0; index < groups.size(); index++) {
+    const ExecutionGroup *group = groups[index];
+    if (group->getNumberOfChunksExecuted() == 0) {
+      continue;
+    }
+    printf("  group %u (%ux%u): %u chunks, executing %.3f s",
+           index,
+           group->getWidth(),
+           group->getHeight(),
+           group->getNumberOfChunksExecuted(),
+           group->getChunksExecutionTime());
+    if (group->isOutputExecutionGroup()) {
+      printf(", finished after %.3f s", group->getExecutionTime());
+    }
+    printf("\n");
+  }
+}
+
 void ExecutionSystem::execute()
 {
+  BLI_PROFILE_SCOPE("compositor_execute");
   const bNodeTree *editingtree = this->m_context.getbNodeTree();
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | Initializing execution"));
 
   DebugInfo::execute_started(this);
 
+  if (this->m_context.getExecutionModel() == COM_EM_FULL_FRAME) {
+    WorkScheduler::start(this->m_context);
+    FullFrameExecutionModel executionModel(this->m_context, *this, this->m_operations);
+    executionModel.execute();
+    WorkScheduler::finish();
+    WorkScheduler::stop();
+    return;
+  }
+
+  /* Only used by the full frame execution, don't keep the buffers of a previous one. */
+  OutputCache::clear();
+
   unsigned int order = 0;
   for (vector<NodeOperation *>::iterator iter = this->m_operations.begin();
        iter != this->m_operations.end();
@@ -188,6 +230,10 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  if (G.debug & G_DEBUG) {
+    print_group_timings(this->m_groups);
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -199,6 +245,57 @@ void ExecutionSystem::execute()
   }
 }
 
+void ExecutionSystem::executeWork(const rcti &area,
+                                  const std::function<void(const rcti &splitArea)> &workFunction)
+{
+  if (BLI_rcti_is_empty(&area)) {
+    return;
+  }
+
+  /* Split in bands of rows, which are contiguous in memory. */
+  const int height = BLI_rcti_size_y(&area);
+  const int numSplits = min(max(WorkScheduler::getNumCPUThreads(), 1), height);
+
+  ThreadMutex mutex;
+  ThreadCondition condition;
+  BLI_mutex_init(&mutex);
+  BLI_condition_init(&condition);
+  int numFinished = 0;
+
+  int ymin = area.ymin;
+  for (int i = 0; i < numSplits; i++) {
+    const int splitHeight = height / numSplits + (i < height % numSplits ? 1 : 0);
+    rcti splitArea;
+    BLI_rcti_init(&splitArea, area.xmin, area.xmax, ymin, ymin + splitHeight);
+    ymin += splitHeight;
+
+    WorkScheduler::schedule([&, splitArea]() {
+      if (!isBreaked()) {
+        workFunction(splitArea);
+      }
+      BLI_mutex_lock(&mutex);
+      numFinished++;
+      BLI_condition_notify_one(&condition);
+      BLI_mutex_unlock(&mutex);
+    });
+  }
+
+  BLI_mutex_lock(&mutex);
+  while (numFinished < numSplits) {
+    BLI_condition_wait(&condition, &mutex);
+  }
+  BLI_mutex_unlock(&mutex);
+
+  BLI_condition_end(&condition);
+  BLI_mutex_end(&mutex);
+}
+
+bool ExecutionSystem::isBreaked() const
+{
+  const bNodeTree *tree = this->m_context.getbNodeTree();
+  return tree->test_break && tree->test_break(tree->tbh);
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
   unsigned int index;
@@ -20,6 +20,8 @@ class ExecutionGroup;
 
 #pragma once
 
+#include <functional>
+
 #include "BKE_text.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_Node.h"
@@ -185,6 +187,19 @@ class ExecutionSystem {
     return this->m_context;
   }
 
+  /**
+   * \brief execute a function on an area, split in parts executed in parallel by the
+   * WorkScheduler, and wait for all of them to finish
+   * \note used by the full frame execution model
+   */
+  void executeWork(const rcti &area,
+                   const std::function<void(const rcti &splitArea)> &workFunction);
+
+  /**
+   * \brief has the user cancelled the execution
+   */
+  bool isBreaked() const;
+
  private:
   void executeGroups(CompositorPriority priority);
 
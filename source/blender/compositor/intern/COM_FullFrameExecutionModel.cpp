@@ -0,0 +1,549 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include <cstring>
+#include <typeinfo>
+#include <unordered_set>
+
+#include "COM_BufferOperation.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_FullFrameExecutionModel.h"
+#include "COM_OutputCache.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "BLI_profile.h"
+#include "BLI_rect.h"
+
+#include "BLT_translation.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+FullFrameExecutionModel::FullFrameExecutionModel(const CompositorContext &context,
+                                                 ExecutionSystem &system,
+                                                 const std::vector<NodeOperation *> &operations)
+    : m_context(context), m_system(system), m_operations(operations)
+{
+}
+
+FullFrameExecutionModel::~FullFrameExecutionModel()
+{
+  /* Buffers are only left when the execution was cancelled. */
+  for (auto &item : m_states) {
+    if (item.second.buffer) {
+      releaseBuffer(item.second);
+    }
+  }
+}
+
+static NodeOperation *get_write_buffer_operation(NodeOperation *operation)
+{
+  if (operation->isReadBufferOperation()) {
+    MemoryProxy *memoryProxy = ((ReadBufferOperation *)operation)->getMemoryProxy();
+    if (memoryProxy) {
+      return memoryProxy->getWriteBufferOperation();
+    }
+  }
+  return nullptr;
+}
+
+static NodeOperation *get_input_operation(NodeOperation *operation, unsigned int index)
+{
+  NodeOperationInput *input = operation->getInputSocket(index);
+  return input->isConnected() ? &input->getLink()->getOperation() : nullptr;
+}
+
+/* Depth first, so inputs come before the operations reading them. */
+static void sort_operations_recursive(std::vector<NodeOperation *> &r_order,
+                                      std::unordered_set<NodeOperation *> &visited,
+                                      NodeOperation *operation)
+{
+  if (!visited.insert(operation).second) {
+    return;
+  }
+  for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+    NodeOperation *input = get_input_operation(operation, i);
+    if (input) {
+      sort_operations_recursive(r_order, visited, input);
+    }
+  }
+  NodeOperation *writeOperation = get_write_buffer_operation(operation);
+  if (writeOperation) {
+    sort_operations_recursive(r_order, visited, writeOperation);
+  }
+  r_order.push_back(operation);
+}
+
+static void get_canvas(const NodeOperation *operation, rcti &r_canvas)
+{
+  BLI_rcti_init(&r_canvas, 0, operation->getWidth(), 0, operation->getHeight());
+}
+
+void FullFrameExecutionModel::execute()
+{
+  BLI_PROFILE_SCOPE("compositor_full_frame");
+  const bNodeTree *tree = m_context.getbNodeTree();
+
+  std::vector<NodeOperation *> outputs;
+  getOutputOperations(outputs);
+  determineAreasToRender(outputs);
+  determineHashesNeeded();
+
+  tree->stats_draw(tree->sdh, TIP_("Compositing | Rendering operations"));
+  for (NodeOperation *output : outputs) {
+    if (m_system.isBreaked()) {
+      break;
+    }
+    renderOperation(output);
+  }
+
+  for (NodeOperation *operation : m_writeBufferOperations) {
+    operation->deinitExecution();
+  }
+  m_writeBufferOperations.clear();
+}
+
+void FullFrameExecutionModel::getOutputOperations(std::vector<NodeOperation *> &r_outputs) const
+{
+  const bool rendering = m_context.isRendering();
+  std::vector<CompositorPriority> priorities = {COM_PRIORITY_HIGH};
+  if (!m_context.isFastCalculation()) {
+    priorities.push_back(COM_PRIORITY_MEDIUM);
+    priorities.push_back(COM_PRIORITY_LOW);
+  }
+
+  for (CompositorPriority priority : priorities) {
+    for (NodeOperation *operation : m_operations) {
+      if (operation->isOutputOperation(rendering) &&
+          operation->getRenderPriority() == priority && operation->getWidth() > 0 &&
+          operation->getHeight() > 0) {
+        r_outputs.push_back(operation);
+      }
+    }
+  }
+}
+
+/* Mirrors the render and viewer borders of ExecutionGroup. */
+void FullFrameExecutionModel::determineOutputArea(NodeOperation *output, rcti &r_area) const
+{
+  get_canvas(output, r_area);
+  const bNodeTree *tree = m_context.getbNodeTree();
+  const RenderData *rd = m_context.getRenderData();
+  const int width = output->getWidth();
+  const int height = output->getHeight();
+
+  if (output->isViewerOperation() || output->isPreviewOperation()) {
+    const rctf *border = &tree->viewer_border;
+    if ((tree->flag & NTREE_VIEWER_BORDER) && border->xmin < border->xmax &&
+        border->ymin < border->ymax) {
+      BLI_rcti_init(&r_area,
+                    border->xmin * width,
+                    border->xmax * width,
+                    border->ymin * height,
+                    border->ymax * height);
+    }
+  }
+  else if (m_context.isRendering() && !output->isFileOutputOperation() &&
+           (rd->mode & R_BORDER) && !(rd->mode & R_CROP)) {
+    /* Case when cropping to render border happens is handled in compositor output and render
+     * layer nodes. */
+    BLI_rcti_init(&r_area,
+                  rd->border.xmin * width,
+                  rd->border.xmax * width,
+                  rd->border.ymin * height,
+                  rd->border.ymax * height);
+  }
+}
+
+void FullFrameExecutionModel::addAreaToRender(NodeOperation *operation, const rcti &area)
+{
+  OperationState &state = m_states[operation];
+  rcti clipped;
+  if (operation->isSetOperation()) {
+    /* Rendered once into a single element buffer, valid for the whole canvas. */
+    get_canvas(operation, clipped);
+  }
+  else {
+    rcti canvas;
+    get_canvas(operation, canvas);
+    BLI_rcti_isect(&area, &canvas, &clipped);
+  }
+
+  if (!state.hasArea || BLI_rcti_is_empty(&state.area)) {
+    state.area = clipped;
+    state.hasArea = true;
+  }
+  else if (!BLI_rcti_is_empty(&clipped)) {
+    BLI_rcti_union(&state.area, &clipped);
+  }
+}
+
+void FullFrameExecutionModel::determineAreasToRender(const std::vector<NodeOperation *> &outputs)
+{
+  std::unordered_set<NodeOperation *> visited;
+  for (NodeOperation *output : outputs) {
+    sort_operations_recursive(m_order, visited, output);
+  }
+
+  for (NodeOperation *output : outputs) {
+    rcti area;
+    determineOutputArea(output, area);
+    addAreaToRender(output, area);
+  }
+
+  /* Readers come after their inputs, so their area is complete when reaching them. */
+  for (auto iter = m_order.rbegin(); iter != m_order.rend(); ++iter) {
+    NodeOperation *operation = *iter;
+    const rcti area = m_states[operation].area;
+    for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+      NodeOperation *input = get_input_operation(operation, i);
+      if (input == nullptr) {
+        continue;
+      }
+      rcti inputArea;
+      if (BLI_rcti_is_empty(&area)) {
+        BLI_rcti_init(&inputArea, 0, 0, 0, 0);
+      }
+      else {
+        operation->getAreaOfInterest(i, area, inputArea);
+      }
+      addAreaToRender(input, inputArea);
+      m_states[input].pendingReads++;
+    }
+
+    /* Read buffer operations read the whole buffer of the write buffer operation. */
+    NodeOperation *writeOperation = get_write_buffer_operation(operation);
+    if (writeOperation) {
+      rcti canvas;
+      get_canvas(writeOperation, canvas);
+      addAreaToRender(writeOperation, canvas);
+    }
+  }
+}
+
+static bool has_settings_key(const NodeOperation *operation)
+{
+  uint64_t key = 0;
+  return operation->hashSettings(key);
+}
+
+/* Hashes of outputs are needed by the keys of cached operations, through any number of
+ * operations identified by their settings. */
+void FullFrameExecutionModel::determineHashesNeeded()
+{
+  if (!OutputCache::isEnabled()) {
+    return;
+  }
+  for (auto iter = m_order.rbegin(); iter != m_order.rend(); ++iter) {
+    NodeOperation *operation = *iter;
+    const OperationState &state = m_states[operation];
+    const bool isCached = operation->useOutputCache() && has_settings_key(operation);
+    if (!isCached && !(state.needsHash && has_settings_key(operation))) {
+      continue;
+    }
+    for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+      NodeOperation *input = get_input_operation(operation, i);
+      if (input) {
+        m_states[input].needsHash = true;
+      }
+    }
+  }
+}
+
+/* Input buffers may not contain the area read by the operation when the resolution of an input
+ * differs. */
+static bool can_update_memory_buffer(NodeOperation *operation,
+                                     MemoryBuffer *output,
+                                     const std::vector<MemoryBuffer *> &inputs)
+{
+  if (!operation->isFullFrameOperation() || output == nullptr || output->isSingleElem()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < inputs.size(); i++) {
+    MemoryBuffer *input = inputs[i];
+    if (input == nullptr) {
+      return false;
+    }
+    if (input->isSingleElem()) {
+      continue;
+    }
+    rcti inputArea;
+    operation->getAreaOfInterest(i, *output->getRect(), inputArea);
+    if (!BLI_rcti_is_empty(&inputArea) && !BLI_rcti_inside_rcti(input->getRect(), &inputArea)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FullFrameExecutionModel::renderOperation(NodeOperation *operation)
+{
+  OperationState &state = m_states[operation];
+  if (state.isRendered) {
+    return;
+  }
+  state.isRendered = true;
+
+  const unsigned int numInputs = operation->getNumberOfInputSockets();
+  for (unsigned int i = 0; i < numInputs; i++) {
+    NodeOperation *input = get_input_operation(operation, i);
+    if (input) {
+      renderOperation(input);
+    }
+  }
+  NodeOperation *writeOperation = get_write_buffer_operation(operation);
+  if (writeOperation) {
+    renderOperation(writeOperation);
+  }
+
+  uint64_t cacheKey;
+  const bool isCacheable = state.pendingReads > 0 && getCacheKey(operation, cacheKey);
+  if (isCacheable) {
+    MemoryBuffer *cachedBuffer = OutputCache::take(cacheKey);
+    if (cachedBuffer) {
+      state.buffer = cachedBuffer;
+      state.hash = cacheKey;
+      state.hasHash = true;
+      state.isCacheable = true;
+      releaseInputBuffers(operation);
+      return;
+    }
+  }
+
+  /* Let operations rendered per pixel read their inputs from the rendered buffers. */
+  const bNodeTree *tree = m_context.getbNodeTree();
+  std::vector<MemoryBuffer *> inputBuffers(numInputs, nullptr);
+  std::vector<NodeOperationOutput *> originalLinks(numInputs, nullptr);
+  std::vector<BufferOperation *> bufferOperations;
+  for (unsigned int i = 0; i < numInputs; i++) {
+    NodeOperationInput *input = operation->getInputSocket(i);
+    if (!input->isConnected()) {
+      continue;
+    }
+    NodeOperation &inputOperation = input->getLink()->getOperation();
+    MemoryBuffer *buffer = m_states[&inputOperation].buffer;
+    inputBuffers[i] = buffer;
+    if (buffer == nullptr) {
+      continue;
+    }
+
+    BufferOperation *bufferOperation = new BufferOperation(buffer,
+                                                           input->getLink()->getDataType());
+    unsigned int resolution[2] = {inputOperation.getWidth(), inputOperation.getHeight()};
+    bufferOperation->setResolution(resolution);
+    bufferOperation->setbNodeTree(tree);
+    originalLinks[i] = input->getLink();
+    input->setLink(bufferOperation->getOutputSocket());
+    bufferOperations.push_back(bufferOperation);
+  }
+
+  MemoryBuffer *output = nullptr;
+  if (operation->getNumberOfOutputSockets() > 0) {
+    output = new MemoryBuffer(
+        operation->getOutputSocket()->getDataType(), &state.area, operation->isSetOperation());
+  }
+
+  operation->setbNodeTree(tree);
+  if (operation->isReadBufferOperation()) {
+    ((ReadBufferOperation *)operation)->updateMemoryBuffer();
+  }
+  operation->initExecution();
+
+  if (can_update_memory_buffer(operation, output, inputBuffers)) {
+    m_system.executeWork(state.area, [&](const rcti &splitArea) {
+      operation->updateMemoryBuffer(output, splitArea, inputBuffers);
+    });
+  }
+  else {
+    renderPixels(operation, output, state.area);
+  }
+
+  if (operation->isWriteBufferOperation()) {
+    m_writeBufferOperations.push_back(operation);
+  }
+  else {
+    operation->deinitExecution();
+  }
+
+  for (unsigned int i = 0; i < numInputs; i++) {
+    if (originalLinks[i]) {
+      operation->getInputSocket(i)->setLink(originalLinks[i]);
+    }
+  }
+  for (BufferOperation *bufferOperation : bufferOperations) {
+    delete bufferOperation;
+  }
+
+  releaseInputBuffers(operation);
+
+  if (state.pendingReads > 0) {
+    state.buffer = output;
+    /* Buffers of cancelled executions are incomplete. */
+    if (isCacheable && !m_system.isBreaked()) {
+      state.hash = cacheKey;
+      state.hasHash = true;
+      state.isCacheable = true;
+    }
+    else if (state.needsHash) {
+      /* While the buffer and the ones of the inputs are available. */
+      getBufferHash(operation);
+    }
+  }
+  else {
+    delete output;
+  }
+}
+
+/* Free input buffers once all their readers are rendered. */
+void FullFrameExecutionModel::releaseInputBuffers(NodeOperation *operation)
+{
+  for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+    NodeOperation *input = get_input_operation(operation, i);
+    if (input == nullptr) {
+      continue;
+    }
+    OperationState &inputState = m_states[input];
+    if (--inputState.pendingReads == 0 && inputState.buffer) {
+      releaseBuffer(inputState);
+    }
+  }
+}
+
+void FullFrameExecutionModel::releaseBuffer(OperationState &state)
+{
+  if (state.isCacheable) {
+    OutputCache::add(state.hash, state.buffer);
+  }
+  else {
+    delete state.buffer;
+  }
+  state.buffer = nullptr;
+}
+
+uint64_t FullFrameExecutionModel::getBufferHash(NodeOperation *operation)
+{
+  OperationState &state = m_states[operation];
+  if (!state.hasHash) {
+    uint64_t key;
+    if (getSettingsKey(operation, key)) {
+      state.hash = key;
+    }
+    else {
+      state.hash = state.buffer ? hashBufferContent(state.buffer) : 0;
+    }
+    state.hasHash = true;
+  }
+  return state.hash;
+}
+
+uint64_t FullFrameExecutionModel::hashBufferContent(MemoryBuffer *buffer)
+{
+  BLI_PROFILE_SCOPE("compositor_hash_buffer");
+  const rcti rect = *buffer->getRect();
+  uint64_t hash = 0;
+  NodeOperation::hashCombine(hash, rect);
+  NodeOperation::hashCombine(hash, buffer->get_num_channels());
+  if (buffer->isSingleElem()) {
+    NodeOperation::hashCombine(
+        hash, buffer->getBuffer(), sizeof(float) * buffer->get_num_channels());
+    return hash;
+  }
+
+  /* Hash rows separately, so the result doesn't depend on how the work is split. */
+  std::vector<uint64_t> rowHashes(BLI_rcti_size_y(&rect), 0);
+  const size_t rowSize = sizeof(float) * buffer->getRowStride();
+  m_system.executeWork(rect, [&](const rcti &splitArea) {
+    for (int y = splitArea.ymin; y < splitArea.ymax; y++) {
+      NodeOperation::hashCombine(
+          rowHashes[y - rect.ymin], buffer->getElem(rect.xmin, y), rowSize);
+    }
+  });
+  NodeOperation::hashCombine(hash, rowHashes.data(), sizeof(uint64_t) * rowHashes.size());
+  return hash;
+}
+
+/* The output of an operation is determined by its settings, area and inputs. */
+bool FullFrameExecutionModel::getSettingsKey(NodeOperation *operation, uint64_t &r_key)
+{
+  uint64_t key = 0;
+  if (!operation->hashSettings(key)) {
+    return false;
+  }
+  NodeOperation::hashCombine(key, typeid(*operation).hash_code());
+  NodeOperation::hashCombine(key, m_states[operation].area);
+  NodeOperation::hashCombine(key, operation->getWidth());
+  NodeOperation::hashCombine(key, operation->getHeight());
+  NodeOperation::hashCombine(key, operation->getOutputSocket()->getDataType());
+  for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+    NodeOperation *input = get_input_operation(operation, i);
+    NodeOperation::hashCombine(key, input ? getBufferHash(input) : 0);
+  }
+  r_key = key;
+  return true;
+}
+
+bool FullFrameExecutionModel::getCacheKey(NodeOperation *operation, uint64_t &r_key)
+{
+  if (!OutputCache::isEnabled() || !operation->useOutputCache()) {
+    return false;
+  }
+  return getSettingsKey(operation, r_key);
+}
+
+void FullFrameExecutionModel::renderPixels(NodeOperation *operation,
+                                           MemoryBuffer *output,
+                                           const rcti &area)
+{
+  if (output && output->isSingleElem()) {
+    float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    operation->readSampled(color, 0.0f, 0.0f, COM_PS_NEAREST);
+    memcpy(output->getBuffer(), color, sizeof(float) * output->get_num_channels());
+    return;
+  }
+
+  m_system.executeWork(area, [&](const rcti &splitArea) {
+    rcti rect = splitArea;
+    if (output == nullptr) {
+      /* Output operations write their results themselves. */
+      operation->executeRegion(&rect, 0);
+      return;
+    }
+
+    const int numChannels = output->get_num_channels();
+    const bool isComplex = operation->isComplex();
+    void *data = isComplex ? operation->initializeTileData(&rect) : nullptr;
+    float color[4];
+    for (int y = rect.ymin; y < rect.ymax; y++) {
+      float *elem = output->getElem(rect.xmin, y);
+      for (int x = rect.xmin; x < rect.xmax; x++, elem += numChannels) {
+        if (isComplex) {
+          operation->read(color, x, y, data);
+        }
+        else {
+          operation->readSampled(color, x, y, COM_PS_NEAREST);
+        }
+        memcpy(elem, color, sizeof(float) * numChannels);
+      }
+    }
+    if (isComplex) {
+      operation->deinitializeTileData(&rect, data);
+    }
+  });
+}
@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "COM_CompositorContext.h"
+#include "COM_NodeOperation.h"
+
+class ExecutionSystem;
+
+/**
+ * \brief executes the operations of an ExecutionSystem one after another on whole buffers
+ *
+ * The area of interest of every operation is determined once, from the outputs to the inputs.
+ * Operations are then rendered in dependency order, each into a MemoryBuffer covering its area
+ * of interest, which is freed as soon as all operations reading it are rendered.
+ *
+ * Outputs of operations implementing NodeOperation.useOutputCache are kept in the OutputCache,
+ * and taken from it instead of being rendered when their settings and inputs didn't change.
+ * Inputs are identified by keys derived from the settings of the operations upstream
+ * (NodeOperation.hashSettings), only outputs of other operations have their content hashed.
+ *
+ * Operations implementing NodeOperation.updateMemoryBuffer render areas of their output buffer
+ * in tight loops over their input buffers. Other operations are rendered pixel by pixel through
+ * their usual execution methods, with their inputs temporarily replaced by BufferOperations.
+ *
+ * \see COM_EM_FULL_FRAME
+ * \ingroup Execution
+ */
+class FullFrameExecutionModel {
+ private:
+  struct OperationState {
+    /** \brief area of the output to render, union of the areas of interest of the readers */
+    rcti area;
+    bool hasArea = false;
+    /** \brief number of readers of the output buffer which are not rendered yet */
+    int pendingReads = 0;
+    MemoryBuffer *buffer = nullptr;
+    bool isRendered = false;
+    /** \brief identifies the content of the buffer, either its cache key or a content hash */
+    uint64_t hash = 0;
+    bool hasHash = false;
+    /** \brief the buffer is added to the OutputCache when released, with its hash as key */
+    bool isCacheable = false;
+    /** \brief the hash is used by the key of a cached operation downstream */
+    bool needsHash = false;
+  };
+
+  const CompositorContext &m_context;
+  ExecutionSystem &m_system;
+  const std::vector<NodeOperation *> &m_operations;
+
+  /** \brief operations to render, inputs before the operations reading them */
+  std::vector<NodeOperation *> m_order;
+  std::unordered_map<NodeOperation *, OperationState> m_states;
+
+  /** \brief write buffer operations, deinitialized last as read buffer operations use them */
+  std::vector<NodeOperation *> m_writeBufferOperations;
+
+ public:
+  FullFrameExecutionModel(const CompositorContext &context,
+                          ExecutionSystem &system,
+                          const std::vector<NodeOperation *> &operations);
+  ~FullFrameExecutionModel();
+
+  void execute();
+
+ private:
+  void getOutputOperations(std::vector<NodeOperation *> &r_outputs) const;
+  void determineOutputArea(NodeOperation *output, rcti &r_area) const;
+  void addAreaToRender(NodeOperation *operation, const rcti &area);
+  void determineAreasToRender(const std::vector<NodeOperation *> &outputs);
+  void determineHashesNeeded();
+
+  void renderOperation(NodeOperation *operation);
+  void renderPixels(NodeOperation *operation, MemoryBuffer *output, const rcti &area);
+  void releaseInputBuffers(NodeOperation *operation);
+  void releaseBuffer(OperationState &state);
+
+  uint64_t getBufferHash(NodeOperation *operation);
+  uint64_t hashBufferContent(MemoryBuffer *buffer);
+  bool getSettingsKey(NodeOperation *operation, uint64_t &r_key);
+  bool getCacheKey(NodeOperation *operation, uint64_t &r_key);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FullFrameExecutionModel")
+#endif
+};
@@ -38,7 +38,7 @@ static unsigned int determine_num_channels(DataType datatype)
 
 unsigned int MemoryBuffer::determineBufferSize()
 {
-  return getWidth() * getHeight();
+  return this->m_is_single_elem ? 1 : getWidth() * getHeight();
 }
 
 int MemoryBuffer::getWidth() const
@@ -55,6 +55,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
   BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
   this->m_width = BLI_rcti_size_x(&this->m_rect);
   this->m_height = BLI_rcti_size_y(&this->m_rect);
+  this->m_is_single_elem = false;
   this->m_memoryProxy = memoryProxy;
   this->m_chunkNumber = chunkNumber;
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
@@ -69,6 +70,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
   BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
   this->m_width = BLI_rcti_size_x(&this->m_rect);
   this->m_height = BLI_rcti_size_y(&this->m_rect);
+  this->m_is_single_elem = false;
   this->m_memoryProxy = memoryProxy;
   this->m_chunkNumber = -1;
   this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
@@ -77,12 +79,16 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = memoryProxy->getDataType();
 }
-MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
+MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect) : MemoryBuffer(dataType, rect, false)
+{
+}
+
+MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect, bool is_single_elem)
 {
   BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
   this->m_width = BLI_rcti_size_x(&this->m_rect);
   this->m_height = BLI_rcti_size_y(&this->m_rect);
-  this->m_height = this->m_rect.ymax - this->m_rect.ymin;
+  this->m_is_single_elem = is_single_elem;
   this->m_memoryProxy = nullptr;
   this->m_chunkNumber = -1;
   this->m_num_channels = determine_num_channels(dataType);
@@ -99,6 +105,18 @@ MemoryBuffer *MemoryBuffer::duplicate()
          this->determineBufferSize() * this->m_num_channels * sizeof(float));
   return result;
 }
+MemoryBuffer *MemoryBuffer::inflate()
+{
+  BLI_assert(this->m_is_single_elem);
+  MemoryBuffer *result = new MemoryBuffer(this->m_datatype, &this->m_rect);
+  const unsigned int size = result->determineBufferSize();
+  float *dst = result->m_buffer;
+  for (unsigned int i = 0; i < size; i++, dst += this->m_num_channels) {
+    memcpy(dst, this->m_buffer, this->m_num_channels * sizeof(float));
+  }
+  return result;
+}
+
 void MemoryBuffer::clear()
 {
   memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
@@ -94,6 +94,12 @@ class MemoryBuffer {
   int m_width;
   int m_height;
 
+  /**
+   * \brief the buffer stores a single element, which is the value of every pixel of its rect
+   * \note only used by the full frame execution model, for constant operations
+   */
+  bool m_is_single_elem;
+
  public:
   /**
    * \brief construct new MemoryBuffer for a chunk
@@ -110,6 +116,12 @@ class MemoryBuffer {
    */
   MemoryBuffer(DataType datatype, rcti *rect);
 
+  /**
+   * \brief construct new temporarily MemoryBuffer for an area, storing only a single element
+   * when \a is_single_elem is set
+   */
+  MemoryBuffer(DataType datatype, rcti *rect, bool is_single_elem);
+
   /**
    * \brief destructor
    */
@@ -137,6 +149,38 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  bool isSingleElem() const
+  {
+    return this->m_is_single_elem;
+  }
+
+  /**
+   * \brief number of floats between two elements of a row, zero for a single element buffer
+   */
+  int getElemStride() const
+  {
+    return this->m_is_single_elem ? 0 : this->m_num_channels;
+  }
+
+  /**
+   * \brief number of floats between two rows, zero for a single element buffer
+   */
+  int getRowStride() const
+  {
+    return this->m_is_single_elem ? 0 : this->m_width * this->m_num_channels;
+  }
+
+  /**
+   * \brief get the element at the given position, which must be inside the rect of the buffer
+   */
+  float *getElem(int x, int y)
+  {
+    BLI_assert(this->m_is_single_elem || (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
+                                          y >= this->m_rect.ymin && y < this->m_rect.ymax));
+    return this->m_buffer + (y - this->m_rect.ymin) * getRowStride() +
+           (x - this->m_rect.xmin) * getElemStride();
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
@@ -244,7 +288,7 @@ class MemoryBuffer {
       int u = x;
       int v = y;
       this->wrap_pixel(u, v, extend_x, extend_y);
-      const int offset = (this->m_width * y + x) * this->m_num_channels;
+      const int offset = (this->m_width * v + u) * this->m_num_channels;
       float *buffer = &this->m_buffer[offset];
       memcpy(result, buffer, sizeof(float) * this->m_num_channels);
     }
@@ -304,6 +348,24 @@ class MemoryBuffer {
 
   void readEWA(float *result, const float uv[2], const float derivatives[2][2]);
 
+  /**
+   * \brief sample the buffer like a BufferOperation reading it, zero outside of the buffer
+   * \note full frame operations sampling their inputs use this, so they give the same results
+   * as when they are rendered per pixel
+   */
+  inline void readSampled(float *result, float x, float y, PixelSampler sampler)
+  {
+    if (this->m_is_single_elem) {
+      memcpy(result, this->m_buffer, sizeof(float) * this->m_num_channels);
+    }
+    else if (sampler == COM_PS_NEAREST) {
+      read(result, (int)x, (int)y);
+    }
+    else {
+      readBilinear(result, x, y);
+    }
+  }
+
   /**
    * \brief is this MemoryBuffer a temporarily buffer (based on an area, not on a chunk)
    */
@@ -346,9 +408,23 @@ class MemoryBuffer {
 
   MemoryBuffer *duplicate();
 
+  /**
+   * \brief create a buffer of the same rect, with the single element of this buffer copied to
+   * all its pixels
+   */
+  MemoryBuffer *inflate();
+
   float getMaximumValue();
   float getMaximumValue(rcti *rect);
 
+  /**
+   * \brief number of bytes used by the pixels of this buffer
+   */
+  size_t getMemorySize()
+  {
+    return sizeof(float) * determineBufferSize() * this->m_num_channels;
+  }
+
  private:
   unsigned int determineBufferSize();
 
@@ -17,6 +17,7 @@
  */
 
 #include <stdio.h>
+#include <string_view>
 #include <typeinfo>
 
 #include "COM_ExecutionSystem.h"
@@ -36,6 +37,7 @@ NodeOperation::NodeOperation()
   this->m_height = 0;
   this->m_isResolutionSet = false;
   this->m_openCL = false;
+  this->m_fullFrame = false;
   this->m_btree = nullptr;
 }
 
@@ -149,6 +151,48 @@ NodeOperation *NodeOperation::getInputOperation(unsigned int inputSocketIndex)
   return nullptr;
 }
 
+bool NodeOperation::readConstantInput(unsigned int inputSocketIndex, float r_value[4])
+{
+  NodeOperation *input = getInputOperation(inputSocketIndex);
+  if (input == nullptr || !input->isSetOperation()) {
+    return false;
+  }
+  input->readSampled(r_value, 0.0f, 0.0f, COM_PS_NEAREST);
+  return true;
+}
+
+/* Reads outside of the canvas are zero, also when they are outside of the input buffer. */
+static int clip_to_canvas(float value, int size)
+{
+  if (value <= 0.0f) {
+    return 0;
+  }
+  if (value >= size) {
+    return size;
+  }
+  return (int)value;
+}
+
+void NodeOperation::getSampledArea(unsigned int inputSocketIndex,
+                                   float xmin,
+                                   float xmax,
+                                   float ymin,
+                                   float ymax,
+                                   rcti &r_inputArea)
+{
+  NodeOperation *input = getInputOperation(inputSocketIndex);
+  const int width = input->getWidth();
+  const int height = input->getHeight();
+  if (!(isfinite(xmin) && isfinite(xmax) && isfinite(ymin) && isfinite(ymax))) {
+    BLI_rcti_init(&r_inputArea, 0, width, 0, height);
+    return;
+  }
+  r_inputArea.xmin = clip_to_canvas(floorf(xmin) - 1.0f, width);
+  r_inputArea.xmax = clip_to_canvas(ceilf(xmax) + 1.0f, width);
+  r_inputArea.ymin = clip_to_canvas(floorf(ymin) - 1.0f, height);
+  r_inputArea.ymax = clip_to_canvas(ceilf(ymax) + 1.0f, height);
+}
+
 void NodeOperation::getConnectedInputSockets(Inputs *sockets)
 {
   for (Inputs::const_iterator it = m_inputs.begin(); it != m_inputs.end(); ++it) {
@@ -192,6 +236,24 @@ bool NodeOperation::determineDependingAreaOfInterest(rcti *input,
   return !first;
 }
 
+void NodeOperation::getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea)
+{
+  if (isFullFrameOperation()) {
+    r_inputArea = outputArea;
+  }
+  else {
+    /* Operations rendered per pixel may read their inputs anywhere. */
+    NodeOperation *inputOperation = this->getInputOperation(inputIndex);
+    BLI_rcti_init(&r_inputArea, 0, inputOperation->getWidth(), 0, inputOperation->getHeight());
+  }
+}
+
+void NodeOperation::hashCombine(uint64_t &hash, const void *data, size_t size)
+{
+  const uint64_t value = std::hash<std::string_view>()(std::string_view((const char *)data, size));
+  hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+}
+
 /*****************
  **** OpInput ****
  *****************/
@@ -102,6 +102,14 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief does this operation implement updateMemoryBuffer.
+   *
+   * Used by the full frame execution model (see #COM_EM_FULL_FRAME), other operations are
+   * rendered through their per pixel execution methods, reading their inputs from buffers.
+   */
+  bool m_fullFrame;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -317,6 +325,73 @@ class NodeOperation : public SocketReader {
                                                 ReadBufferOperation *readOperation,
                                                 rcti *output);
 
+  /**
+   * \brief does this operation render its output buffers with updateMemoryBuffer
+   * \see FullFrameExecutionModel
+   */
+  bool isFullFrameOperation() const
+  {
+    return this->m_fullFrame;
+  }
+
+  /**
+   * \brief determine the area of an input that is read to render an area of the output
+   * \note only used by the full frame execution model
+   * \param inputIndex: the index of the input socket
+   * \param outputArea: the area of the output to render
+   * \param r_inputArea: the area of the input buffer that is read
+   */
+  virtual void getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea);
+
+  /**
+   * \brief render an area of the output buffer, reading the input buffers
+   * \note only called for full frame operations, possibly from multiple threads for
+   * separate areas
+   * \param output: the output buffer, which contains at least the area
+   * \param area: the area to render
+   * \param inputs: the buffers of the inputs, containing their area of interest
+   */
+  virtual void updateMemoryBuffer(MemoryBuffer * /*output*/,
+                                  const rcti & /*area*/,
+                                  const std::vector<MemoryBuffer *> & /*inputs*/)
+  {
+  }
+
+  /**
+   * \brief add the settings determining the output of this operation to \a r_hash
+   *
+   * Operations returning true are identified by a key combining their settings with the keys of
+   * their inputs, instead of a hash of their output content. Operations reading them (through
+   * any number of operations returning true) can then be cached without hashing buffers.
+   * \note only used by the full frame execution model
+   * \see hashCombine
+   * \see useOutputCache
+   */
+  virtual bool hashSettings(uint64_t & /*r_hash*/) const
+  {
+    return false;
+  }
+
+  /**
+   * \brief keep the output in the OutputCache across executions
+   *
+   * Only worth it for operations implementing hashSettings that are expensive to render.
+   * \note only used by the full frame execution model
+   */
+  virtual bool useOutputCache() const
+  {
+    return false;
+  }
+
+  /**
+   * \brief combine the bytes of a value into a hash, for hashSettings
+   */
+  static void hashCombine(uint64_t &hash, const void *data, size_t size);
+  template<typename T> static void hashCombine(uint64_t &hash, const T &value)
+  {
+    hashCombine(hash, &value, sizeof(T));
+  }
+
   /**
    * \brief set the index of the input socket that will determine the resolution of this operation
    * \param index: the index to set
@@ -396,6 +471,26 @@ class NodeOperation : public SocketReader {
   SocketReader *getInputSocketReader(unsigned int inputSocketindex);
   NodeOperation *getInputOperation(unsigned int inputSocketindex);
 
+  /**
+   * \brief read an input which is a set operation, before the execution
+   * \note for areas of interest depending on inputs, which are determined before any operation
+   * is rendered
+   * \return false when the input isn't constant
+   */
+  bool readConstantInput(unsigned int inputSocketIndex, float r_value[4]);
+
+  /**
+   * \brief area of interest of an input sampled between the given coordinates, inclusive
+   * \note includes a margin for bilinear sampling and is clipped to the canvas of the input,
+   * the whole canvas is used for coordinates which aren't finite
+   */
+  void getSampledArea(unsigned int inputSocketIndex,
+                      float xmin,
+                      float xmax,
+                      float ymin,
+                      float ymax,
+                      rcti &r_inputArea);
+
   void deinitMutex();
   void initMutex();
   void lockMutex();
@@ -412,6 +507,15 @@ class NodeOperation : public SocketReader {
     this->m_complex = complex;
   }
 
+  /**
+   * \brief set whether this operation implements updateMemoryBuffer
+   * \see isFullFrameOperation
+   */
+  void setFullFrameOperation(bool fullFrame)
+  {
+    this->m_fullFrame = fullFrame;
+  }
+
   /**
    * \brief set if this NodeOperation can be scheduled on a OpenCLDevice
    */
@@ -104,8 +104,13 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
   determineResolutions();
 
+  /* The full frame execution model renders every operation into a buffer already. */
+  const bool is_full_frame = m_context->getExecutionModel() == COM_EM_FULL_FRAME;
+
   /* surround complex ops with read/write buffer */
-  add_complex_operation_buffers();
+  if (!is_full_frame) {
+    add_complex_operation_buffers();
+  }
 
   /* links not available from here on */
   /* XXX make m_links a local variable to avoid confusion! */
@@ -117,7 +122,9 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /*sort_operations();*/ /* not needed yet */
 
   /* create execution groups */
-  group_operations();
+  if (!is_full_frame) {
+    group_operations();
+  }
 
   /* transfer resulting operations to the system */
   system->set_operations(m_operations, m_groups);
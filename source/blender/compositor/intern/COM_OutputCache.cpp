@@ -0,0 +1,104 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "COM_MemoryBuffer.h"
+#include "COM_OutputCache.h"
+
+#include "DNA_userdef_types.h"
+
+#include "BLI_profile.h"
+
+struct CacheEntry {
+  uint64_t key;
+  MemoryBuffer *buffer;
+  size_t size;
+};
+
+/* Most recently added entries first. */
+static std::list<CacheEntry> g_entries;
+static std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> g_entry_by_key;
+static size_t g_memory_used = 0;
+static std::mutex g_mutex;
+
+static size_t get_memory_limit()
+{
+  return (size_t)std::max(U.compositor_cache_limit, 0) * 1024 * 1024;
+}
+
+static void remove_entry(std::list<CacheEntry>::iterator entry)
+{
+  g_memory_used -= entry->size;
+  g_entry_by_key.erase(entry->key);
+  g_entries.erase(entry);
+}
+
+bool OutputCache::isEnabled()
+{
+  return U.compositor_cache_limit > 0;
+}
+
+MemoryBuffer *OutputCache::take(uint64_t key)
+{
+  std::lock_guard<std::mutex> lock(g_mutex);
+  auto found = g_entry_by_key.find(key);
+  if (found == g_entry_by_key.end()) {
+    return nullptr;
+  }
+  MemoryBuffer *buffer = found->second->buffer;
+  remove_entry(found->second);
+  return buffer;
+}
+
+void OutputCache::add(uint64_t key, MemoryBuffer *buffer)
+{
+  BLI_PROFILE_SCOPE("compositor_output_cache_add");
+  std::lock_guard<std::mutex> lock(g_mutex);
+  auto found = g_entry_by_key.find(key);
+  if (found != g_entry_by_key.end()) {
+    delete found->second->buffer;
+    remove_entry(found->second);
+  }
+
+  const size_t size = buffer->getMemorySize();
+  g_entries.push_front({key, buffer, size});
+  g_entry_by_key[key] = g_entries.begin();
+  g_memory_used += size;
+
+  const size_t limit = get_memory_limit();
+  while (g_memory_used > limit && !g_entries.empty()) {
+    auto least_recent = std::prev(g_entries.end());
+    delete least_recent->buffer;
+    remove_entry(least_recent);
+  }
+}
+
+void OutputCache::clear()
+{
+  std::lock_guard<std::mutex> lock(g_mutex);
+  for (CacheEntry &entry : g_entries) {
+    delete entry.buffer;
+  }
+  g_entries.clear();
+  g_entry_by_key.clear();
+  g_memory_used = 0;
+}
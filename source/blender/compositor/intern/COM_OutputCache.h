@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+class MemoryBuffer;
+
+/**
+ * \brief keeps output buffers of expensive operations across executions of the compositor
+ *
+ * Buffers are identified by a key combining the settings of the operation, the area and the
+ * hashes of its inputs, so edits downstream of an operation, or frames where its inputs don't
+ * change, reuse the buffer instead of rendering it again.
+ *
+ * Buffers are moved out of the cache while used by an execution and added back after, the least
+ * recently used ones are freed when the memory budget of the user preferences is exceeded.
+ *
+ * \see NodeOperation.hashSettings
+ * \see FullFrameExecutionModel
+ * \ingroup Execution
+ */
+class OutputCache {
+ public:
+  /**
+   * \brief is the cache enabled in the user preferences
+   */
+  static bool isEnabled();
+
+  /**
+   * \brief remove the buffer of a key from the cache
+   * \return the buffer owned by the caller, or nullptr when it isn't cached
+   */
+  static MemoryBuffer *take(uint64_t key);
+
+  /**
+   * \brief add a buffer to the cache, which takes ownership of it
+   *
+   * The least recently added buffers are freed until the memory budget is respected, including
+   * the added buffer when it doesn't fit.
+   */
+  static void add(uint64_t key, MemoryBuffer *buffer);
+
+  /**
+   * \brief free all cached buffers
+   */
+  static void clear();
+};
@@ -0,0 +1,49 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_SIMD.h"
+
+#include "BLI_system.h"
+
+static SIMDLevel g_simd_level = COM_SIMD_NONE;
+
+static SIMDLevel simd_level_supported()
+{
+#ifdef __SSE2__
+  if (BLI_cpu_support_sse2()) {
+    return COM_SIMD_SSE2;
+  }
+#endif
+  return COM_SIMD_NONE;
+}
+
+void COM_simd_init()
+{
+  g_simd_level = simd_level_supported();
+}
+
+SIMDLevel COM_simd_level_get()
+{
+  return g_simd_level;
+}
+
+void COM_simd_level_set(SIMDLevel level)
+{
+  const SIMDLevel supported = simd_level_supported();
+  g_simd_level = (level > supported) ? supported : level;
+}
@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <math.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include "BLI_compiler_compat.h"
+
+/**
+ * \brief instruction set used by the row kernels of full frame operations
+ *
+ * Kernels are compiled for every instruction set the build supports, the one to use is chosen
+ * at runtime from the capabilities of the CPU.
+ *
+ * \see NodeOperation.updateMemoryBuffer
+ * \ingroup Execution
+ */
+typedef enum SIMDLevel {
+  /** \brief scalar kernels, always available */
+  COM_SIMD_NONE = 0,
+  /** \brief SSE2 kernels, processing a color or four values at once */
+  COM_SIMD_SSE2 = 1,
+} SIMDLevel;
+
+/**
+ * \brief detect the best instruction set supported by both the build and the CPU
+ */
+void COM_simd_init(void);
+
+/**
+ * \brief get the instruction set used by the row kernels
+ */
+SIMDLevel COM_simd_level_get(void);
+
+/**
+ * \brief force an instruction set, limited to the supported ones
+ * \note useful to compare the results or performance of kernels
+ */
+void COM_simd_level_set(SIMDLevel level);
+
+#ifdef __SSE2__
+/**
+ * \brief the color with the alpha of \a alpha_source
+ */
+BLI_INLINE __m128 com_simd_with_alpha(const __m128 color, const __m128 alpha_source)
+{
+  const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  return _mm_or_ps(_mm_andnot_ps(alpha_mask, color), _mm_and_ps(alpha_mask, alpha_source));
+}
+
+BLI_INLINE __m128 com_simd_clamp_01(const __m128 v)
+{
+  return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+BLI_INLINE __m128 com_simd_abs(const __m128 v)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+/**
+ * \brief broadcast lane \a Lane of \a v to all lanes
+ */
+template<int Lane> BLI_INLINE __m128 com_simd_broadcast(const __m128 v)
+{
+  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+}
+
+/**
+ * \brief apply the scalar function \a func to the RGB lanes of a color, alpha is kept
+ *
+ * For functions without SSE2 equivalent (powf and the color space conversions based on it),
+ * so the rest of a kernel can stay vectorized while giving the same results as the scalar one.
+ */
+template<typename Func> BLI_INLINE __m128 com_simd_map_rgb(const __m128 color, Func func)
+{
+  float lanes[4];
+  _mm_storeu_ps(lanes, color);
+  return _mm_setr_ps(func(lanes[0]), func(lanes[1]), func(lanes[2]), lanes[3]);
+}
+
+/**
+ * \brief powf of the RGB lanes of \a base, alpha is kept
+ * \see com_simd_map_rgb
+ */
+BLI_INLINE __m128 com_simd_pow_rgb(const __m128 base, const __m128 exponent)
+{
+  float b[4], e[4];
+  _mm_storeu_ps(b, base);
+  _mm_storeu_ps(e, exponent);
+  return _mm_setr_ps(powf(b[0], e[0]), powf(b[1], e[1]), powf(b[2], e[2]), b[3]);
+}
+
+/**
+ * \brief load four consecutive values, or broadcast a single element when \a stride is zero
+ */
+BLI_INLINE __m128 com_simd_load_values(const float *values, const int stride)
+{
+  return stride == 0 ? _mm_set1_ps(values[0]) : _mm_loadu_ps(values);
+}
+#endif
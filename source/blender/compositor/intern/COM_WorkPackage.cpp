@@ -18,8 +18,17 @@
 
 #include "COM_WorkPackage.h"
 
-WorkPackage::WorkPackage(ExecutionGroup *group, unsigned int chunkNumber)
+WorkPackage::WorkPackage(ExecutionGroup *group, unsigned int chunkNumber, unsigned int priority)
 {
   this->m_executionGroup = group;
   this->m_chunkNumber = chunkNumber;
+  this->m_priority = priority;
+}
+
+WorkPackage::WorkPackage(std::function<void()> executeFunction)
+{
+  this->m_executionGroup = nullptr;
+  this->m_chunkNumber = 0;
+  this->m_priority = 0;
+  this->m_executeFunction = std::move(executeFunction);
 }
@@ -23,6 +23,8 @@ class WorkPackage;
 class ExecutionGroup;
 #include "COM_ExecutionGroup.h"
 
+#include <functional>
+
 /**
  * \brief contains data about work that can be scheduled
  * \see WorkScheduler
@@ -39,13 +41,30 @@ class WorkPackage {
    */
   unsigned int m_chunkNumber;
 
+  /**
+   * \brief function to execute instead of a chunk, used by the full frame execution model
+   */
+  std::function<void()> m_executeFunction;
+
+  /**
+   * \brief packages with a lower priority value are executed first
+   */
+  unsigned int m_priority;
+
  public:
   /**
    * constructor
    * \param group: the ExecutionGroup
    * \param chunkNumber: the number of the chunk
+   * \param priority: the index of the chunk in the ChunkOrder of the output group
+   */
+  WorkPackage(ExecutionGroup *group, unsigned int chunkNumber, unsigned int priority = 0);
+
+  /**
+   * constructor
+   * \param executeFunction: the function to execute
    */
-  WorkPackage(ExecutionGroup *group, unsigned int chunkNumber);
+  WorkPackage(std::function<void()> executeFunction);
 
   /**
    * \brief get the ExecutionGroup
@@ -63,6 +82,22 @@ class WorkPackage {
     return this->m_chunkNumber;
   }
 
+  /**
+   * \brief get the function to execute, empty when a chunk is to be executed
+   */
+  const std::function<void()> &getExecuteFunction() const
+  {
+    return this->m_executeFunction;
+  }
+
+  /**
+   * \brief get the priority, packages with a lower value are executed first
+   */
+  unsigned int getPriority() const
+  {
+    return this->m_priority;
+  }
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkPackage")
 #endif
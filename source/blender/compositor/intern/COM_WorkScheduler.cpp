@@ -17,11 +17,13 @@
  */
 
 #include <list>
+#include <set>
 #include <stdio.h>
 
 #include "COM_CPUDevice.h"
 #include "COM_OpenCLDevice.h"
 #include "COM_OpenCLKernels.cl.h"
+#include "COM_SIMD.h"
 #include "COM_WorkScheduler.h"
 #include "COM_WriteBufferOperation.h"
 #include "COM_compositor.h"
@@ -49,11 +51,44 @@ static vector<CPUDevice *> g_cpudevices;
 static ThreadLocal(CPUDevice *) g_thread_device;
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+/** \brief orders work by priority, work with the same priority stays in scheduling order. */
+struct WorkPackagePriorityCompare {
+  bool operator()(const WorkPackage *a, const WorkPackage *b) const
+  {
+    return a->getPriority() < b->getPriority();
+  }
+};
+
+/**
+ * \brief work scheduled on a CPUDevice.
+ * A CPUDevice executes its own work first, so chunks are executed by the thread that has their
+ * inputs in its cache. When it runs out of work it steals the most urgent work of another device.
+ */
+struct CPUWorkQueue {
+  std::multiset<WorkPackage *, WorkPackagePriorityCompare> packages;
+
+  /* Statistics since WorkScheduler.start. */
+  unsigned int numExecuted = 0;
+  unsigned int numStolen = 0;
+  double busyTime = 0.0;
+  double idleTime = 0.0;
+};
+
 /** \brief list of all thread for every CPUDevice in cpudevices a thread exists. */
 static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
-/** \brief all scheduled work for the cpu */
-static ThreadQueue *g_cpuqueue;
+/** \brief all scheduled work for the cpu, a queue for every CPUDevice */
+static vector<CPUWorkQueue> g_cpuqueues;
+/** \brief protects the cpu queues, only held while picking work, not while executing it. */
+static ThreadMutex g_cpuqueue_mutex;
+static ThreadCondition g_cpuqueue_work_condition;
+static ThreadCondition g_cpuqueue_finished_condition;
+/** \brief number of scheduled packages for the cpu that are not executed yet */
+static unsigned int g_cpuqueue_num_pending;
+/** \brief queue for work without a preferred device, to distribute it round robin */
+static unsigned int g_cpuqueue_next;
+static bool g_cpuqueue_stopping;
+static double g_cpuqueue_start_time;
 static ThreadQueue *g_gpuqueue;
 #  ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -70,15 +105,103 @@ static bool g_openclInitialized = false;
 #endif
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+static void cpu_queue_push(WorkPackage *package, int preferredThread)
+{
+  BLI_mutex_lock(&g_cpuqueue_mutex);
+  unsigned int index = preferredThread;
+  if (preferredThread < 0 || index >= g_cpuqueues.size()) {
+    index = g_cpuqueue_next;
+    g_cpuqueue_next = (g_cpuqueue_next + 1) % g_cpuqueues.size();
+  }
+  g_cpuqueues[index].packages.insert(package);
+  g_cpuqueue_num_pending++;
+  /* Any idle device can take the package, by stealing when it's not its own. */
+  BLI_condition_notify_one(&g_cpuqueue_work_condition);
+  BLI_mutex_unlock(&g_cpuqueue_mutex);
+}
+
+/* Must be called with the queue mutex locked. */
+static WorkPackage *cpu_queue_pop(unsigned int index, bool *r_stolen)
+{
+  CPUWorkQueue *queue = &g_cpuqueues[index];
+  *r_stolen = false;
+  if (queue->packages.empty()) {
+    queue = nullptr;
+    for (CPUWorkQueue &victim : g_cpuqueues) {
+      if (victim.packages.empty()) {
+        continue;
+      }
+      if (queue == nullptr || WorkPackagePriorityCompare()(*victim.packages.begin(),
+                                                           *queue->packages.begin())) {
+        queue = &victim;
+      }
+    }
+    if (queue == nullptr) {
+      return nullptr;
+    }
+    *r_stolen = true;
+  }
+  WorkPackage *work = *queue->packages.begin();
+  queue->packages.erase(queue->packages.begin());
+  return work;
+}
+
+static void cpu_queue_print_statistics()
+{
+  const double time = PIL_check_seconds_timer() - g_cpuqueue_start_time;
+  printf("Compositor CPU scheduling, %.3f s:\n", time);
+  for (unsigned int index = 0; index < g_cpuqueues.size(); index++) {
+    const CPUWorkQueue &queue = g_cpuqueues[index];
+    printf("  thread %u: %u packages (%u stolen), busy %.3f s, idle %.3f s\n",
+           index,
+           queue.numExecuted,
+           queue.numStolen,
+           queue.busyTime,
+           queue.idleTime);
+  }
+}
+
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
   CPUDevice *device = (CPUDevice *)data;
-  WorkPackage *work;
+  const unsigned int index = device->thread_id();
   BLI_thread_local_set(g_thread_device, device);
-  while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
+
+  BLI_mutex_lock(&g_cpuqueue_mutex);
+  while (true) {
+    bool stolen;
+    WorkPackage *work = cpu_queue_pop(index, &stolen);
+    if (work == nullptr) {
+      if (g_cpuqueue_stopping) {
+        break;
+      }
+      const double idleStartTime = PIL_check_seconds_timer();
+      BLI_condition_wait(&g_cpuqueue_work_condition, &g_cpuqueue_mutex);
+      g_cpuqueues[index].idleTime += PIL_check_seconds_timer() - idleStartTime;
+      continue;
+    }
+    BLI_mutex_unlock(&g_cpuqueue_mutex);
+
+    ExecutionGroup *group = work->getExecutionGroup();
+    const unsigned int chunkNumber = work->getChunkNumber();
+    const double startTime = PIL_check_seconds_timer();
     device->execute(work);
     delete work;
+    const double time = PIL_check_seconds_timer() - startTime;
+
+    BLI_mutex_lock(&g_cpuqueue_mutex);
+    if (group) {
+      group->recordChunkExecution(chunkNumber, index, time);
+    }
+    CPUWorkQueue &queue = g_cpuqueues[index];
+    queue.numExecuted++;
+    queue.numStolen += stolen ? 1 : 0;
+    queue.busyTime += time;
+    if (--g_cpuqueue_num_pending == 0) {
+      BLI_condition_notify_all(&g_cpuqueue_finished_condition);
+    }
   }
+  BLI_mutex_unlock(&g_cpuqueue_mutex);
 
   return nullptr;
 }
@@ -97,9 +220,12 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 }
 #endif
 
-void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
+void WorkScheduler::schedule(ExecutionGroup *group,
+                             int chunkNumber,
+                             unsigned int priority,
+                             int preferredThread)
 {
-  WorkPackage *package = new WorkPackage(group, chunkNumber);
+  WorkPackage *package = new WorkPackage(group, chunkNumber, priority);
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
   CPUDevice device(0);
   device.execute(package);
@@ -110,19 +236,38 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
     BLI_thread_queue_push(g_gpuqueue, package);
   }
   else {
-    BLI_thread_queue_push(g_cpuqueue, package);
+    cpu_queue_push(package, preferredThread);
   }
 #  else
-  BLI_thread_queue_push(g_cpuqueue, package);
+  cpu_queue_push(package, preferredThread);
 #  endif
 #endif
 }
 
+void WorkScheduler::schedule(std::function<void()> executeFunction)
+{
+  WorkPackage *package = new WorkPackage(std::move(executeFunction));
+#if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
+  CPUDevice device(0);
+  device.execute(package);
+  delete package;
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  cpu_queue_push(package, -1);
+#endif
+}
+
 void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   unsigned int index;
-  g_cpuqueue = BLI_thread_queue_init();
+  BLI_mutex_init(&g_cpuqueue_mutex);
+  BLI_condition_init(&g_cpuqueue_work_condition);
+  BLI_condition_init(&g_cpuqueue_finished_condition);
+  g_cpuqueues.assign(g_cpudevices.size(), CPUWorkQueue());
+  g_cpuqueue_num_pending = 0;
+  g_cpuqueue_next = 0;
+  g_cpuqueue_stopping = false;
+  g_cpuqueue_start_time = PIL_check_seconds_timer();
   BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
   for (index = 0; index < g_cpudevices.size(); index++) {
     Device *device = g_cpudevices[index];
@@ -150,23 +295,30 @@ void WorkScheduler::finish()
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_wait_finish(g_gpuqueue);
-    BLI_thread_queue_wait_finish(g_cpuqueue);
   }
-  else {
-    BLI_thread_queue_wait_finish(g_cpuqueue);
-  }
-#  else
-  BLI_thread_queue_wait_finish(cpuqueue);
 #  endif
+  BLI_mutex_lock(&g_cpuqueue_mutex);
+  while (g_cpuqueue_num_pending > 0) {
+    BLI_condition_wait(&g_cpuqueue_finished_condition, &g_cpuqueue_mutex);
+  }
+  BLI_mutex_unlock(&g_cpuqueue_mutex);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  BLI_thread_queue_nowait(g_cpuqueue);
+  BLI_mutex_lock(&g_cpuqueue_mutex);
+  g_cpuqueue_stopping = true;
+  BLI_condition_notify_all(&g_cpuqueue_work_condition);
+  BLI_mutex_unlock(&g_cpuqueue_mutex);
   BLI_threadpool_end(&g_cputhreads);
-  BLI_thread_queue_free(g_cpuqueue);
-  g_cpuqueue = nullptr;
+  if (G.debug & G_DEBUG) {
+    cpu_queue_print_statistics();
+  }
+  g_cpuqueues.clear();
+  BLI_condition_end(&g_cpuqueue_work_condition);
+  BLI_condition_end(&g_cpuqueue_finished_condition);
+  BLI_mutex_end(&g_cpuqueue_mutex);
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_nowait(g_gpuqueue);
@@ -203,6 +355,8 @@ static void CL_CALLBACK clContextError(const char *errinfo,
 
 void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 {
+  COM_simd_init();
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   /* deinitialize if number of threads doesn't match */
   if (g_cpudevices.size() != num_cpu_threads) {
@@ -364,6 +518,15 @@ void WorkScheduler::deinitialize()
 #endif
 }
 
+int WorkScheduler::getNumCPUThreads()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+  return g_cpudevices.size();
+#else
+  return 1;
+#endif
+}
+
 int WorkScheduler::current_thread_id()
 {
   CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
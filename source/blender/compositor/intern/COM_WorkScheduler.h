@@ -58,8 +58,20 @@ class WorkScheduler {
    * \see ExecutionGroup.execute
    * \param group: the execution group
    * \param chunkNumber: the number of the chunk in the group to be executed
+   * \param priority: packages with a lower priority are executed first
+   * \param preferredThread: thread id of the CPUDevice that should execute the chunk, other
+   * devices only take it when they run out of work. -1 to distribute it over the devices.
    */
-  static void schedule(ExecutionGroup *group, int chunkNumber);
+  static void schedule(ExecutionGroup *group,
+                       int chunkNumber,
+                       unsigned int priority = 0,
+                       int preferredThread = -1);
+
+  /**
+   * \brief schedule a function to be executed by a CPUDevice
+   * \see ExecutionSystem.executeWork
+   */
+  static void schedule(std::function<void()> executeFunction);
 
   /**
    * \brief initialize the WorkScheduler
@@ -109,6 +121,11 @@ class WorkScheduler {
    */
   static bool hasGPUDevices();
 
+  /**
+   * \brief number of CPUDevices, which execute the scheduled work in parallel
+   */
+  static int getNumCPUThreads();
+
   static int current_thread_id();
 
 #ifdef WITH_CXX_GUARDEDALLOC
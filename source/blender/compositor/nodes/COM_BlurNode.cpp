@@ -44,14 +44,23 @@ void BlurNode::convertToOperations(NodeConverter &converter,
 
   const float size = this->getInputSocket(1)->getEditorValueFloat();
   const bool extend_bounds = (editorNode->custom1 & CMP_NODEFLAG_BLUR_EXTEND_BOUNDS) != 0;
+  /* The bokeh shaped kernel isn't separable, approximate it with the separable blurs. */
+  const bool fast_bokeh = data->bokeh &&
+                          (editorNode->custom1 & CMP_NODEFLAG_BLUR_VARIABLE_SIZE) == 0 &&
+                          (editorNode->custom1 & CMP_NODEFLAG_BLUR_FAST_APPROXIMATION) != 0;
 
   CompositorQuality quality = context.getQuality();
   NodeOperation *input_operation = nullptr, *output_operation = nullptr;
 
-  if (data->filtertype == R_FILTER_FAST_GAUSS) {
+  if (data->filtertype == R_FILTER_FAST_GAUSS ||
+      (fast_bokeh && data->filtertype == R_FILTER_GAUSS)) {
     FastGaussianBlurOperation *operationfgb = new FastGaussianBlurOperation();
     operationfgb->setData(data);
     operationfgb->setExtendBounds(extend_bounds);
+    if (data->filtertype == R_FILTER_GAUSS) {
+      /* Match the gaussian filter, which reaches three sigma at the blur size. */
+      operationfgb->setSigmaFactor(1.0f / 3.0f);
+    }
     converter.addOperation(operationfgb);
 
     converter.mapInputSocket(getInputSocket(1), operationfgb->getInputSocket(1));
@@ -103,7 +112,7 @@ void BlurNode::convertToOperations(NodeConverter &converter,
     output_operation = operation;
     input_operation = operation;
   }
-  else if (!data->bokeh) {
+  else if (!data->bokeh || fast_bokeh) {
     GaussianXBlurOperation *operationx = new GaussianXBlurOperation();
     operationx->setData(data);
     operationx->setQuality(quality);
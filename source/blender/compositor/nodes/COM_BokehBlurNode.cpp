@@ -39,6 +39,7 @@ void BokehBlurNode::convertToOperations(NodeConverter &converter,
 
   bool connectedSizeSocket = inputSizeSocket->isLinked();
   const bool extend_bounds = (b_node->custom1 & CMP_NODEFLAG_BLUR_EXTEND_BOUNDS) != 0;
+  const bool fast = (b_node->custom1 & CMP_NODEFLAG_BLUR_FAST_APPROXIMATION) != 0;
 
   if ((b_node->custom1 & CMP_NODEFLAG_BLUR_VARIABLE_SIZE) && connectedSizeSocket) {
     VariableSizeBokehBlurOperation *operation = new VariableSizeBokehBlurOperation();
@@ -46,6 +47,7 @@ void BokehBlurNode::convertToOperations(NodeConverter &converter,
     operation->setThreshold(0.0f);
     operation->setMaxBlur(b_node->custom4);
     operation->setDoScaleSize(true);
+    operation->setFastApproximation(fast);
 
     converter.addOperation(operation);
     converter.mapInputSocket(getInputSocket(0), operation->getInputSocket(0));
@@ -57,6 +59,7 @@ void BokehBlurNode::convertToOperations(NodeConverter &converter,
     BokehBlurOperation *operation = new BokehBlurOperation();
     operation->setQuality(context.getQuality());
     operation->setExtendBounds(extend_bounds);
+    operation->setFastApproximation(fast);
 
     converter.addOperation(operation);
     converter.mapInputSocket(getInputSocket(0), operation->getInputSocket(0));
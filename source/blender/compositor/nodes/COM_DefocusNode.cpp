@@ -117,6 +117,7 @@ void DefocusNode::convertToOperations(NodeConverter &converter,
   }
   operation->setMaxBlur(data->maxblur);
   operation->setThreshold(data->bthresh);
+  operation->setFastApproximation((node->custom1 & CMP_NODEFLAG_BLUR_FAST_APPROXIMATION) != 0);
   converter.addOperation(operation);
 
   converter.addLink(bokeh->getOutputSocket(), operation->getInputSocket(1));
@@ -39,6 +39,15 @@ void BlurBaseOperation::initExecution()
 {
   this->m_inputProgram = this->getInputSocketReader(0);
   this->m_inputSize = this->getInputSocketReader(1);
+  updateRelativeSize();
+
+  QualityStepHelper::initExecution(COM_QH_MULTIPLY);
+}
+
+/* Relative sizes depend on the resolution, also used before the execution by the areas of
+ * interest. */
+void BlurBaseOperation::updateRelativeSize()
+{
   this->m_data.image_in_width = this->getWidth();
   this->m_data.image_in_height = this->getHeight();
   if (this->m_data.relative) {
@@ -59,8 +68,6 @@ void BlurBaseOperation::initExecution()
     this->m_data.sizex = round_fl_to_int(this->m_data.percentx * 0.01f * sizex);
     this->m_data.sizey = round_fl_to_int(this->m_data.percenty * 0.01f * sizey);
   }
-
-  QualityStepHelper::initExecution(COM_QH_MULTIPLY);
 }
 
 float *BlurBaseOperation::make_gausstab(float rad, int size)
@@ -173,6 +180,21 @@ void BlurBaseOperation::updateSize()
   }
 }
 
+/* The size is known before the execution when it's set or its input is constant. */
+bool BlurBaseOperation::getConstantSize(float &r_size)
+{
+  if (this->m_sizeavailable) {
+    r_size = this->m_size;
+    return true;
+  }
+  float result[4];
+  if (readConstantInput(1, result)) {
+    r_size = result[0];
+    return true;
+  }
+  return false;
+}
+
 void BlurBaseOperation::determineResolution(unsigned int resolution[2],
                                             unsigned int preferredResolution[2])
 {
@@ -182,3 +204,13 @@ void BlurBaseOperation::determineResolution(unsigned int resolution[2],
     resolution[1] += 2 * this->m_size * m_data.sizey;
   }
 }
+
+bool BlurBaseOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_data);
+  hashCombine(r_hash, this->m_size);
+  hashCombine(r_hash, this->m_sizeavailable);
+  hashCombine(r_hash, this->m_extend_bounds);
+  hashCombine(r_hash, this->getQuality());
+  return true;
+}
@@ -38,6 +38,8 @@ class BlurBaseOperation : public NodeOperation, public QualityStepHelper {
   float *make_dist_fac_inverse(float rad, int size, int falloff);
 
   void updateSize();
+  void updateRelativeSize();
+  bool getConstantSize(float &r_size);
 
   /**
    * Cached reference to the inputProgram
@@ -62,6 +64,12 @@ class BlurBaseOperation : public NodeOperation, public QualityStepHelper {
    */
   void deinitExecution();
 
+  bool hashSettings(uint64_t &r_hash) const;
+  bool useOutputCache() const
+  {
+    return true;
+  }
+
   void setData(const NodeBlurData *data);
 
   void setSize(float size)
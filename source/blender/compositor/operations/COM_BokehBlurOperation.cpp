@@ -20,6 +20,8 @@
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "RE_pipeline.h"
 
 BokehBlurOperation::BokehBlurOperation()
@@ -39,6 +41,8 @@ BokehBlurOperation::BokehBlurOperation()
   this->m_inputBoundingBoxReader = nullptr;
 
   this->m_extend_bounds = false;
+  this->m_fast = false;
+  this->m_rowSums = nullptr;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -48,6 +52,9 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
     updateSize();
   }
   void *buffer = getInputOperation(0)->initializeTileData(nullptr);
+  if (this->m_fast && this->m_rowSums == nullptr) {
+    initializeFastApproximation((MemoryBuffer *)buffer);
+  }
   unlockMutex();
   return buffer;
 }
@@ -77,7 +84,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
   float bokeh[4];
 
   this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-  if (tempBoundingBox[0] > 0.0f) {
+  if (tempBoundingBox[0] > 0.0f && this->m_fast) {
+    executePixelFast(output, x, y, (MemoryBuffer *)data);
+  }
+  else if (tempBoundingBox[0] > 0.0f) {
     float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
     float *buffer = inputBuffer->getBuffer();
@@ -130,9 +140,98 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
   }
 }
 
+void BokehBlurOperation::initializeFastApproximation(MemoryBuffer *inputBuffer)
+{
+  const float max_dim = max(this->getWidth(), this->getHeight());
+  const int pixelSize = this->m_size * max_dim / 100.0f;
+  const float m = this->m_bokehDimension / max(pixelSize, 1);
+
+  /* Reduce every row of the bokeh to the span between its first and last visible pixel. */
+  this->m_spans.clear();
+  for (int dy = -pixelSize; dy < pixelSize; dy++) {
+    BokehBlurSpan span = {dy, 0, 0, {0.0f, 0.0f, 0.0f, 0.0f}};
+    for (int dx = -pixelSize; dx < pixelSize; dx++) {
+      float bokeh[4];
+      const float u = this->m_bokehMidX - dx * m;
+      const float v = this->m_bokehMidY - dy * m;
+      this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
+      if (max_ff(max_ff(bokeh[0], bokeh[1]), max_ff(bokeh[2], bokeh[3])) <= 0.0f) {
+        continue;
+      }
+      if (span.xmin == span.xmax) {
+        span.xmin = dx;
+      }
+      span.xmax = dx + 1;
+      add_v4_v4(span.weight, bokeh);
+    }
+    if (span.xmin != span.xmax) {
+      mul_v4_fl(span.weight, 1.0f / (span.xmax - span.xmin));
+      this->m_spans.push_back(span);
+    }
+  }
+
+  /* Sums of the input rows, the sum of a span is the difference of the sums at its ends. */
+  const int width = inputBuffer->getWidth();
+  const int height = inputBuffer->getHeight();
+  const float *buffer = inputBuffer->getBuffer();
+  this->m_rowSums = (float *)MEM_mallocN(
+      sizeof(float) * COM_NUM_CHANNELS_COLOR * (width + 1) * height, __func__);
+  for (int y = 0; y < height; y++) {
+    const float *row = &buffer[y * width * COM_NUM_CHANNELS_COLOR];
+    float *sums = &this->m_rowSums[y * (width + 1) * COM_NUM_CHANNELS_COLOR];
+    zero_v4(sums);
+    for (int x = 0; x < width; x++) {
+      add_v4_v4v4(&sums[(x + 1) * COM_NUM_CHANNELS_COLOR],
+                  &sums[x * COM_NUM_CHANNELS_COLOR],
+                  &row[x * COM_NUM_CHANNELS_COLOR]);
+    }
+  }
+}
+
+void BokehBlurOperation::executePixelFast(float output[4],
+                                          int x,
+                                          int y,
+                                          MemoryBuffer *inputBuffer)
+{
+  const float max_dim = max(this->getWidth(), this->getHeight());
+  const int pixelSize = this->m_size * max_dim / 100.0f;
+  if (pixelSize < 2 || this->m_spans.empty()) {
+    this->m_inputProgram->readSampled(output, x, y, COM_PS_NEAREST);
+    return;
+  }
+
+  const rcti *rect = inputBuffer->getRect();
+  const int rowLength = (inputBuffer->getWidth() + 1) * COM_NUM_CHANNELS_COLOR;
+  float color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (const BokehBlurSpan &span : this->m_spans) {
+    const int ny = y + span.dy;
+    const int minx = max(x + span.xmin, rect->xmin);
+    const int maxx = min(x + span.xmax, rect->xmax);
+    if (ny < rect->ymin || ny >= rect->ymax || minx >= maxx) {
+      continue;
+    }
+    const float *rowSums = &this->m_rowSums[(ny - rect->ymin) * rowLength];
+    const float *sum_min = &rowSums[(minx - rect->xmin) * COM_NUM_CHANNELS_COLOR];
+    const float *sum_max = &rowSums[(maxx - rect->xmin) * COM_NUM_CHANNELS_COLOR];
+    for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+      color_accum[c] += span.weight[c] * (sum_max[c] - sum_min[c]);
+      multiplier_accum[c] += span.weight[c] * (maxx - minx);
+    }
+  }
+  for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+    output[c] = (multiplier_accum[c] > 0.0f) ? color_accum[c] / multiplier_accum[c] : 0.0f;
+  }
+}
+
 void BokehBlurOperation::deinitExecution()
 {
   deinitMutex();
+  if (this->m_rowSums) {
+    MEM_freeN(this->m_rowSums);
+    this->m_rowSums = nullptr;
+  }
+  this->m_spans.clear();
   this->m_inputProgram = nullptr;
   this->m_inputBokehProgram = nullptr;
   this->m_inputBoundingBoxReader = nullptr;
@@ -240,3 +339,13 @@ void BokehBlurOperation::determineResolution(unsigned int resolution[2],
     resolution[1] += 2 * this->m_size * max_dim / 100.0f;
   }
 }
+
+bool BokehBlurOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_size);
+  hashCombine(r_hash, this->m_sizeavailable);
+  hashCombine(r_hash, this->m_extend_bounds);
+  hashCombine(r_hash, this->m_fast);
+  hashCombine(r_hash, this->getQuality());
+  return true;
+}
@@ -21,6 +21,16 @@
 #include "COM_NodeOperation.h"
 #include "COM_QualityStepHelper.h"
 
+/**
+ * \brief a row of the bokeh used by the fast approximation, with the average weight of the row.
+ */
+struct BokehBlurSpan {
+  int dy;
+  int xmin;
+  int xmax;
+  float weight[4];
+};
+
 class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
  private:
   SocketReader *m_inputProgram;
@@ -34,6 +44,17 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
   float m_bokehDimension;
   bool m_extend_bounds;
 
+  /**
+   * \brief approximate the bokeh by a span per row, summed with the row prefix sums of the input,
+   * so the cost per pixel grows linear with the size instead of quadratic.
+   */
+  bool m_fast;
+  vector<BokehBlurSpan> m_spans;
+  float *m_rowSums;
+
+  void initializeFastApproximation(MemoryBuffer *inputBuffer);
+  void executePixelFast(float output[4], int x, int y, MemoryBuffer *inputBuffer);
+
  public:
   BokehBlurOperation();
 
@@ -53,6 +74,12 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
    */
   void deinitExecution();
 
+  bool hashSettings(uint64_t &r_hash) const;
+  bool useOutputCache() const
+  {
+    return true;
+  }
+
   bool determineDependingAreaOfInterest(rcti *input,
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
@@ -75,5 +102,12 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
     this->m_extend_bounds = extend_bounds;
   }
 
+  void setFastApproximation(bool fast)
+  {
+    this->m_fast = fast;
+    /* The OpenCL kernel only implements the accurate blur. */
+    this->setOpenCL(!fast);
+  }
+
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 };
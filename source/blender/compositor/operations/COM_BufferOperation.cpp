@@ -0,0 +1,104 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_BufferOperation.h"
+
+BufferOperation::BufferOperation(MemoryBuffer *buffer, DataType datatype)
+{
+  this->addOutputSocket(datatype);
+  this->m_buffer = buffer;
+  this->m_canvasBuffer = nullptr;
+  this->initMutex();
+}
+
+BufferOperation::~BufferOperation()
+{
+  delete this->m_canvasBuffer.load();
+  this->deinitMutex();
+}
+
+MemoryBuffer *BufferOperation::getCanvasBuffer()
+{
+  rcti canvas;
+  BLI_rcti_init(&canvas, 0, this->getWidth(), 0, this->getHeight());
+  if (!this->m_buffer->isSingleElem() && BLI_rcti_compare(this->m_buffer->getRect(), &canvas)) {
+    return this->m_buffer;
+  }
+
+  MemoryBuffer *canvasBuffer = this->m_canvasBuffer.load(std::memory_order_acquire);
+  if (canvasBuffer) {
+    return canvasBuffer;
+  }
+
+  this->lockMutex();
+  canvasBuffer = this->m_canvasBuffer.load(std::memory_order_relaxed);
+  if (canvasBuffer == nullptr) {
+    if (this->m_buffer->isSingleElem()) {
+      BLI_assert(BLI_rcti_compare(this->m_buffer->getRect(), &canvas));
+      canvasBuffer = this->m_buffer->inflate();
+    }
+    else {
+      canvasBuffer = new MemoryBuffer(this->getOutputSocket()->getDataType(), &canvas);
+      canvasBuffer->clear();
+      if (BLI_rcti_isect(this->m_buffer->getRect(), &canvas, nullptr)) {
+        canvasBuffer->copyContentFrom(this->m_buffer);
+      }
+    }
+    this->m_canvasBuffer.store(canvasBuffer, std::memory_order_release);
+  }
+  this->unlockMutex();
+  return canvasBuffer;
+}
+
+void *BufferOperation::initializeTileData(rcti * /*rect*/)
+{
+  return getCanvasBuffer();
+}
+
+void BufferOperation::executePixelSampled(float output[4],
+                                          float x,
+                                          float y,
+                                          PixelSampler sampler)
+{
+  if (this->m_buffer->isSingleElem()) {
+    memcpy(output, this->m_buffer->getBuffer(), sizeof(float) * m_buffer->get_num_channels());
+    return;
+  }
+  switch (sampler) {
+    case COM_PS_NEAREST:
+      this->m_buffer->read(output, x, y);
+      break;
+    case COM_PS_BILINEAR:
+    case COM_PS_BICUBIC:
+    default:
+      getCanvasBuffer()->readBilinear(output, x, y);
+      break;
+  }
+}
+
+void BufferOperation::executePixelFiltered(
+    float output[4], float x, float y, float dx[2], float dy[2])
+{
+  if (this->m_buffer->isSingleElem()) {
+    memcpy(output, this->m_buffer->getBuffer(), sizeof(float) * m_buffer->get_num_channels());
+    return;
+  }
+  const float uv[2] = {x, y};
+  const float deriv[2][2] = {{dx[0], dx[1]}, {dy[0], dy[1]}};
+  getCanvasBuffer()->readEWA(output, uv, deriv);
+}
@@ -0,0 +1,55 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "COM_NodeOperation.h"
+
+/**
+ * \brief reads a rendered MemoryBuffer, in place of the operation that rendered it
+ *
+ * Used by the full frame execution model to let operations without a full frame implementation
+ * read their inputs through their usual SocketReader calls.
+ * \ingroup Operation
+ */
+class BufferOperation : public NodeOperation {
+ private:
+  MemoryBuffer *m_buffer;
+
+  /**
+   * \brief buffer covering exactly the resolution of the operation, created on demand when
+   * m_buffer is a single element or has another rect
+   */
+  std::atomic<MemoryBuffer *> m_canvasBuffer;
+
+ public:
+  BufferOperation(MemoryBuffer *buffer, DataType datatype);
+  ~BufferOperation();
+
+  MemoryBuffer *getCanvasBuffer();
+
+  void *initializeTileData(rcti *rect);
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executePixelFiltered(float output[4], float x, float y, float dx[2], float dy[2]);
+  MemoryBuffer *getInputMemoryBuffer(MemoryBuffer ** /*memoryBuffers*/)
+  {
+    return getCanvasBuffer();
+  }
+};
@@ -17,6 +17,8 @@
  */
 
 #include "COM_ColorBalanceASCCDLOperation.h"
+#include "COM_SIMD.h"
+
 #include "BLI_math.h"
 
 inline float colorbalance_cdl(float in, float offset, float power, float slope)
@@ -31,6 +33,38 @@ inline float colorbalance_cdl(float in, float offset, float power, float slope)
   return powf(x, power);
 }
 
+#ifdef __SSE2__
+static void colorbalance_cdl_row_sse2(float *out,
+                                      const float *value,
+                                      const float *color,
+                                      int value_stride,
+                                      int color_stride,
+                                      int width,
+                                      const float offset[3],
+                                      const float power[3],
+                                      const float slope[3])
+{
+  const __m128 offset_v = _mm_setr_ps(offset[0], offset[1], offset[2], 0.0f);
+  const __m128 power_v = _mm_setr_ps(power[0], power[1], power[2], 0.0f);
+  const __m128 slope_v = _mm_setr_ps(slope[0], slope[1], slope[2], 0.0f);
+  for (int i = 0; i < width; i++) {
+    const __m128 fac = _mm_set1_ps(min(1.0f, value[0]));
+    const __m128 mfac = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+    const __m128 color_v = _mm_loadu_ps(color);
+    /* prevent NaN, keeps NaN inputs like the scalar kernel */
+    const __m128 x = _mm_max_ps(_mm_setzero_ps(),
+                                _mm_add_ps(_mm_mul_ps(color_v, slope_v), offset_v));
+    const __m128 balanced = com_simd_pow_rgb(x, power_v);
+    const __m128 result = _mm_add_ps(_mm_mul_ps(mfac, color_v), _mm_mul_ps(fac, balanced));
+    _mm_storeu_ps(out, com_simd_with_alpha(result, color_v));
+
+    out += COM_NUM_CHANNELS_COLOR;
+    value += value_stride;
+    color += color_stride;
+  }
+}
+#endif
+
 ColorBalanceASCCDLOperation::ColorBalanceASCCDLOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
@@ -39,6 +73,7 @@ ColorBalanceASCCDLOperation::ColorBalanceASCCDLOperation()
   this->m_inputValueOperation = nullptr;
   this->m_inputColorOperation = nullptr;
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrameOperation(true);
 }
 
 void ColorBalanceASCCDLOperation::initExecution()
@@ -79,3 +114,54 @@ void ColorBalanceASCCDLOperation::deinitExecution()
   this->m_inputValueOperation = nullptr;
   this->m_inputColorOperation = nullptr;
 }
+
+bool ColorBalanceASCCDLOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_offset);
+  hashCombine(r_hash, this->m_power);
+  hashCombine(r_hash, this->m_slope);
+  return true;
+}
+
+void ColorBalanceASCCDLOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                     const rcti &area,
+                                                     const std::vector<MemoryBuffer *> &inputs)
+{
+  MemoryBuffer *inputValue = inputs[0];
+  MemoryBuffer *inputColor = inputs[1];
+  const int valueStride = inputValue->getElemStride();
+  const int colorStride = inputColor->getElemStride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    const float *value = inputValue->getElem(area.xmin, y);
+    const float *color = inputColor->getElem(area.xmin, y);
+#ifdef __SSE2__
+    if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+      colorbalance_cdl_row_sse2(out,
+                                value,
+                                color,
+                                valueStride,
+                                colorStride,
+                                BLI_rcti_size_x(&area),
+                                this->m_offset,
+                                this->m_power,
+                                this->m_slope);
+      continue;
+    }
+#endif
+    for (int x = area.xmin; x < area.xmax; x++) {
+      const float fac = min(1.0f, value[0]);
+      const float mfac = 1.0f - fac;
+      for (int c = 0; c < 3; c++) {
+        const float balanced = colorbalance_cdl(
+            color[c], this->m_offset[c], this->m_power[c], this->m_slope[c]);
+        out[c] = mfac * color[c] + fac * balanced;
+      }
+      out[3] = color[3];
+
+      out += COM_NUM_CHANNELS_COLOR;
+      value += valueStride;
+      color += colorStride;
+    }
+  }
+}
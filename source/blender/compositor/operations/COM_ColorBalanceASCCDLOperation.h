@@ -57,6 +57,12 @@ class ColorBalanceASCCDLOperation : public NodeOperation {
    */
   void deinitExecution();
 
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
+
+  bool hashSettings(uint64_t &r_hash) const;
+
   void setOffset(float offset[3])
   {
     copy_v3_v3(this->m_offset, offset);
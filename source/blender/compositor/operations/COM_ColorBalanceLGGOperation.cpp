@@ -17,6 +17,8 @@
  */
 
 #include "COM_ColorBalanceLGGOperation.h"
+#include "COM_SIMD.h"
+
 #include "BLI_math.h"
 
 inline float colorbalance_lgg(float in, float lift_lgg, float gamma_inv, float gain)
@@ -36,6 +38,42 @@ inline float colorbalance_lgg(float in, float lift_lgg, float gamma_inv, float g
   return powf(srgb_to_linearrgb(x), gamma_inv);
 }
 
+#ifdef __SSE2__
+/* Same as #colorbalance_lgg for the RGB of a pixel, the color space conversions and powf are
+ * done per channel. */
+static void colorbalance_lgg_row_sse2(float *out,
+                                      const float *value,
+                                      const float *color,
+                                      int value_stride,
+                                      int color_stride,
+                                      int width,
+                                      const float lift[3],
+                                      const float gamma_inv[3],
+                                      const float gain[3])
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 lift_v = _mm_setr_ps(lift[0], lift[1], lift[2], 0.0f);
+  const __m128 gamma_inv_v = _mm_setr_ps(gamma_inv[0], gamma_inv[1], gamma_inv[2], 0.0f);
+  const __m128 gain_v = _mm_setr_ps(gain[0], gain[1], gain[2], 0.0f);
+  for (int i = 0; i < width; i++) {
+    const __m128 fac = _mm_set1_ps(min(1.0f, value[0]));
+    const __m128 mfac = _mm_sub_ps(one, fac);
+    const __m128 color_v = _mm_loadu_ps(color);
+    const __m128 srgb = com_simd_map_rgb(color_v, linearrgb_to_srgb);
+    __m128 x = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(srgb, one), lift_v), one), gain_v);
+    /* prevent NaN, keeps NaN inputs like the scalar kernel */
+    x = _mm_max_ps(_mm_setzero_ps(), x);
+    const __m128 balanced = com_simd_pow_rgb(com_simd_map_rgb(x, srgb_to_linearrgb), gamma_inv_v);
+    const __m128 result = _mm_add_ps(_mm_mul_ps(mfac, color_v), _mm_mul_ps(fac, balanced));
+    _mm_storeu_ps(out, com_simd_with_alpha(result, color_v));
+
+    out += COM_NUM_CHANNELS_COLOR;
+    value += value_stride;
+    color += color_stride;
+  }
+}
+#endif
+
 ColorBalanceLGGOperation::ColorBalanceLGGOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
@@ -44,6 +82,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation()
   this->m_inputValueOperation = nullptr;
   this->m_inputColorOperation = nullptr;
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrameOperation(true);
 }
 
 void ColorBalanceLGGOperation::initExecution()
@@ -84,3 +123,54 @@ void ColorBalanceLGGOperation::deinitExecution()
   this->m_inputValueOperation = nullptr;
   this->m_inputColorOperation = nullptr;
 }
+
+bool ColorBalanceLGGOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_gain);
+  hashCombine(r_hash, this->m_lift);
+  hashCombine(r_hash, this->m_gamma_inv);
+  return true;
+}
+
+void ColorBalanceLGGOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                  const rcti &area,
+                                                  const std::vector<MemoryBuffer *> &inputs)
+{
+  MemoryBuffer *inputValue = inputs[0];
+  MemoryBuffer *inputColor = inputs[1];
+  const int valueStride = inputValue->getElemStride();
+  const int colorStride = inputColor->getElemStride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    const float *value = inputValue->getElem(area.xmin, y);
+    const float *color = inputColor->getElem(area.xmin, y);
+#ifdef __SSE2__
+    if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+      colorbalance_lgg_row_sse2(out,
+                                value,
+                                color,
+                                valueStride,
+                                colorStride,
+                                BLI_rcti_size_x(&area),
+                                this->m_lift,
+                                this->m_gamma_inv,
+                                this->m_gain);
+      continue;
+    }
+#endif
+    for (int x = area.xmin; x < area.xmax; x++) {
+      const float fac = min(1.0f, value[0]);
+      const float mfac = 1.0f - fac;
+      for (int c = 0; c < 3; c++) {
+        const float balanced = colorbalance_lgg(
+            color[c], this->m_lift[c], this->m_gamma_inv[c], this->m_gain[c]);
+        out[c] = mfac * color[c] + fac * balanced;
+      }
+      out[3] = color[3];
+
+      out += COM_NUM_CHANNELS_COLOR;
+      value += valueStride;
+      color += colorStride;
+    }
+  }
+}
@@ -57,6 +57,12 @@ class ColorBalanceLGGOperation : public NodeOperation {
    */
   void deinitExecution();
 
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
+
+  bool hashSettings(uint64_t &r_hash) const;
+
   void setGain(const float gain[3])
   {
     copy_v3_v3(this->m_gain, gain);
@@ -160,3 +160,9 @@ void DenoiseOperation::generateDenoise(float *data,
            inputBufferColor,
            sizeof(float[4]) * inputTileColor->getWidth() * inputTileColor->getHeight());
 }
+
+bool DenoiseOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_settings->hdr);
+  return true;
+}
@@ -47,6 +47,12 @@ class DenoiseOperation : public SingleThreadedOperation {
    */
   void deinitExecution();
 
+  bool hashSettings(uint64_t &r_hash) const;
+  bool useOutputCache() const
+  {
+    return true;
+  }
+
   void setDenoiseSettings(NodeDenoise *settings)
   {
     this->m_settings = settings;
@@ -25,6 +25,7 @@
 FastGaussianBlurOperation::FastGaussianBlurOperation() : BlurBaseOperation(COM_DT_COLOR)
 {
   this->m_iirgaus = nullptr;
+  this->m_sigmaFactor = 0.5f;
 }
 
 void FastGaussianBlurOperation::executePixel(float output[4], int x, int y, void *data)
@@ -84,8 +85,8 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
     updateSize();
 
     int c;
-    this->m_sx = this->m_data.sizex * this->m_size / 2.0f;
-    this->m_sy = this->m_data.sizey * this->m_size / 2.0f;
+    this->m_sx = this->m_data.sizex * this->m_size * this->m_sigmaFactor;
+    this->m_sy = this->m_data.sizey * this->m_size * this->m_sigmaFactor;
 
     if ((this->m_sx == this->m_sy) && (this->m_sx > 0.0f)) {
       for (c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
@@ -110,6 +111,13 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
   return this->m_iirgaus;
 }
 
+bool FastGaussianBlurOperation::hashSettings(uint64_t &r_hash) const
+{
+  BlurBaseOperation::hashSettings(r_hash);
+  hashCombine(r_hash, this->m_sigmaFactor);
+  return true;
+}
+
 void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
                                           float sigma,
                                           unsigned int chan,
@@ -25,6 +25,7 @@ class FastGaussianBlurOperation : public BlurBaseOperation {
  private:
   float m_sx;
   float m_sy;
+  float m_sigmaFactor;
   MemoryBuffer *m_iirgaus;
 
  public:
@@ -38,6 +39,16 @@ class FastGaussianBlurOperation : public BlurBaseOperation {
   void *initializeTileData(rcti *rect);
   void deinitExecution();
   void initExecution();
+
+  bool hashSettings(uint64_t &r_hash) const;
+
+  /**
+   * \brief set the sigma of the gaussian relative to the blur size, a half by default.
+   */
+  void setSigmaFactor(float sigmaFactor)
+  {
+    this->m_sigmaFactor = sigmaFactor;
+  }
 };
 
 enum {
@@ -26,6 +26,7 @@ FlipOperation::FlipOperation()
   this->m_inputOperation = nullptr;
   this->m_flipX = true;
   this->m_flipY = false;
+  this->setFullFrameOperation(true);
 }
 void FlipOperation::initExecution()
 {
@@ -45,6 +46,38 @@ void FlipOperation::executePixelSampled(float output[4], float x, float y, Pixel
   this->m_inputOperation->readSampled(output, nx, ny, sampler);
 }
 
+void FlipOperation::getAreaOfInterest(int /*inputIndex*/,
+                                      const rcti &outputArea,
+                                      rcti &r_inputArea)
+{
+  r_inputArea = outputArea;
+  if (this->m_flipX) {
+    const int w = (int)this->getWidth();
+    r_inputArea.xmin = w - outputArea.xmax;
+    r_inputArea.xmax = w - outputArea.xmin;
+  }
+  if (this->m_flipY) {
+    const int h = (int)this->getHeight();
+    r_inputArea.ymin = h - outputArea.ymax;
+    r_inputArea.ymax = h - outputArea.ymin;
+  }
+}
+
+void FlipOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                       const rcti &area,
+                                       const std::vector<MemoryBuffer *> &inputs)
+{
+  const int w = (int)this->getWidth() - 1;
+  const int h = (int)this->getHeight() - 1;
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const int ny = this->m_flipY ? h - y : y;
+    for (int x = area.xmin; x < area.xmax; x++) {
+      const int nx = this->m_flipX ? w - x : x;
+      inputs[0]->readSampled(output->getElem(x, y), nx, ny, COM_PS_NEAREST);
+    }
+  }
+}
+
 bool FlipOperation::determineDependingAreaOfInterest(rcti *input,
                                                      ReadBufferOperation *readOperation,
                                                      rcti *output)
@@ -32,6 +32,10 @@ class FlipOperation : public NodeOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea);
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
 
   void initExecution();
   void deinitExecution();
@@ -26,6 +26,7 @@ GammaOperation::GammaOperation()
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputProgram = nullptr;
   this->m_inputGammaProgram = nullptr;
+  this->setFullFrameOperation(true);
 }
 void GammaOperation::initExecution()
 {
@@ -54,3 +55,35 @@ void GammaOperation::deinitExecution()
   this->m_inputProgram = nullptr;
   this->m_inputGammaProgram = nullptr;
 }
+
+bool GammaOperation::hashSettings(uint64_t & /*r_hash*/) const
+{
+  /* The gamma is an input. */
+  return true;
+}
+
+void GammaOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                        const rcti &area,
+                                        const std::vector<MemoryBuffer *> &inputs)
+{
+  MemoryBuffer *inputColor = inputs[0];
+  MemoryBuffer *inputGamma = inputs[1];
+  const int colorStride = inputColor->getElemStride();
+  const int gammaStride = inputGamma->getElemStride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    const float *color = inputColor->getElem(area.xmin, y);
+    const float *gamma = inputGamma->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++) {
+      /* check for negative to avoid nan's */
+      out[0] = color[0] > 0.0f ? powf(color[0], gamma[0]) : color[0];
+      out[1] = color[1] > 0.0f ? powf(color[1], gamma[0]) : color[1];
+      out[2] = color[2] > 0.0f ? powf(color[2], gamma[0]) : color[2];
+      out[3] = color[3];
+
+      out += COM_NUM_CHANNELS_COLOR;
+      color += colorStride;
+      gamma += gammaStride;
+    }
+  }
+}
@@ -45,4 +45,10 @@ class GammaOperation : public NodeOperation {
    * Deinitialize the execution
    */
   void deinitExecution();
+
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
+
+  bool hashSettings(uint64_t &r_hash) const;
 };
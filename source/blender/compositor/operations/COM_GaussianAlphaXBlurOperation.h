@@ -48,6 +48,8 @@ class GaussianAlphaXBlurOperation : public BlurBaseOperation {
    */
   void deinitExecution();
 
+  bool hashSettings(uint64_t &r_hash) const;
+
   void *initializeTileData(rcti *rect);
   bool determineDependingAreaOfInterest(rcti *input,
                                         ReadBufferOperation *readOperation,
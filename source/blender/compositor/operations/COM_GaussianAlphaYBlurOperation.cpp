@@ -187,3 +187,11 @@ bool GaussianAlphaYBlurOperation::determineDependingAreaOfInterest(
     return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
   }
 }
+
+bool GaussianAlphaYBlurOperation::hashSettings(uint64_t &r_hash) const
+{
+  BlurBaseOperation::hashSettings(r_hash);
+  hashCombine(r_hash, this->m_do_subtract);
+  hashCombine(r_hash, this->m_falloff);
+  return true;
+}
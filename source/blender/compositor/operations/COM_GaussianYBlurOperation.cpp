@@ -30,6 +30,7 @@ GaussianYBlurOperation::GaussianYBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = nullptr;
 #endif
   this->m_filtersize = 0;
+  this->setFullFrameOperation(true);
 }
 
 void *GaussianYBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -117,6 +118,54 @@ void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *d
   mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianYBlurOperation::getAreaOfInterest(int inputIndex,
+                                               const rcti &outputArea,
+                                               rcti &r_inputArea)
+{
+  if (inputIndex == 1) {
+    /* The size is read at the origin only. */
+    BLI_rcti_init(&r_inputArea, 0, 1, 0, 1);
+    return;
+  }
+
+  /* Only clipped along the blur. With extended bounds, columns outside of the input canvas
+   * aren't in the input buffer and the blur is rendered per pixel. */
+  r_inputArea = outputArea;
+  r_inputArea.ymin = 0;
+  r_inputArea.ymax = getInputOperation(0)->getHeight();
+  float size;
+  if (getConstantSize(size)) {
+    updateRelativeSize();
+    const int filtersize = min_ii(ceil(max_ff(size * m_data.sizey, 0.0f)), MAX_GAUSSTAB_RADIUS);
+    r_inputArea.ymin = max_ii(outputArea.ymin - filtersize - 1, r_inputArea.ymin);
+    r_inputArea.ymax = min_ii(outputArea.ymax + filtersize + 1, r_inputArea.ymax);
+  }
+}
+
+void GaussianYBlurOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                const rcti &area,
+                                                const std::vector<MemoryBuffer *> &inputs)
+{
+  lockMutex();
+  if (!this->m_sizeavailable) {
+    updateGauss();
+  }
+  unlockMutex();
+
+  MemoryBuffer *input = inputs[0];
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      float *out = output->getElem(x, y);
+      if (input->isSingleElem()) {
+        copy_v4_v4(out, input->getBuffer());
+      }
+      else {
+        executePixel(out, x, y, input);
+      }
+    }
+  }
+}
+
 void GaussianYBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer,
                                            cl_mem clOutputBuffer,
@@ -56,6 +56,10 @@ class GaussianYBlurOperation : public BlurBaseOperation {
   void deinitExecution();
 
   void *initializeTileData(rcti *rect);
+  void getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea);
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
   bool determineDependingAreaOfInterest(rcti *input,
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
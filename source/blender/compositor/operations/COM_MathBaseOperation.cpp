@@ -17,6 +17,7 @@
  */
 
 #include "COM_MathBaseOperation.h"
+#include "COM_SIMD.h"
 
 #include "BLI_math.h"
 
@@ -46,6 +47,12 @@ void MathBaseOperation::deinitExecution()
   this->m_inputValue3Operation = nullptr;
 }
 
+bool MathBaseOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_useClamp);
+  return true;
+}
+
 void MathBaseOperation::determineResolution(unsigned int resolution[2],
                                             unsigned int preferredResolution[2])
 {
@@ -71,6 +78,58 @@ void MathBaseOperation::clampIfNeeded(float *color)
   }
 }
 
+void MathBaseOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                           const rcti &area,
+                                           const std::vector<MemoryBuffer *> &inputs)
+{
+  MathRow row;
+  row.value1_stride = inputs[0]->getElemStride();
+  row.value2_stride = inputs[1]->getElemStride();
+  row.value3_stride = inputs[2]->getElemStride();
+  row.width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    row.value1 = inputs[0]->getElem(area.xmin, y);
+    row.value2 = inputs[1]->getElem(area.xmin, y);
+    row.value3 = inputs[2]->getElem(area.xmin, y);
+    computeRow(output->getElem(area.xmin, y), row);
+  }
+}
+
+template<typename MathFunc>
+void MathBaseOperation::computeRowScalar(float *out, const MathRow &row, int start, MathFunc math)
+{
+  const float *value1 = row.value1 + start * row.value1_stride;
+  const float *value2 = row.value2 + start * row.value2_stride;
+  for (int i = start; i < row.width; i++) {
+    out[i] = math(value1[0], value2[0]);
+    clampIfNeeded(&out[i]);
+    value1 += row.value1_stride;
+    value2 += row.value2_stride;
+  }
+}
+
+#ifdef __SSE2__
+template<typename MathFunc>
+int MathBaseOperation::computeRowSSE2(float *out, const MathRow &row, MathFunc math)
+{
+  BLI_assert(row.value1_stride <= 1 && row.value2_stride <= 1);
+  const float *value1 = row.value1;
+  const float *value2 = row.value2;
+  int i = 0;
+  for (; i + 4 <= row.width; i += 4) {
+    __m128 result = math(com_simd_load_values(value1, row.value1_stride),
+                         com_simd_load_values(value2, row.value2_stride));
+    if (this->m_useClamp) {
+      result = com_simd_clamp_01(result);
+    }
+    _mm_storeu_ps(&out[i], result);
+    value1 += row.value1_stride * 4;
+    value2 += row.value2_stride * 4;
+  }
+  return i;
+}
+#endif
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputValue1[4];
@@ -84,6 +143,17 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
   clampIfNeeded(output);
 }
 
+void MathAddOperation::computeRow(float *out, const MathRow &row)
+{
+  int start = 0;
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    start = computeRowSSE2(out, row, [](__m128 a, __m128 b) { return _mm_add_ps(a, b); });
+  }
+#endif
+  computeRowScalar(out, row, start, [](float a, float b) { return a + b; });
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -100,6 +170,17 @@ void MathSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathSubtractOperation::computeRow(float *out, const MathRow &row)
+{
+  int start = 0;
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    start = computeRowSSE2(out, row, [](__m128 a, __m128 b) { return _mm_sub_ps(a, b); });
+  }
+#endif
+  computeRowScalar(out, row, start, [](float a, float b) { return a - b; });
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -116,6 +197,17 @@ void MathMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::computeRow(float *out, const MathRow &row)
+{
+  int start = 0;
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    start = computeRowSSE2(out, row, [](__m128 a, __m128 b) { return _mm_mul_ps(a, b); });
+  }
+#endif
+  computeRowScalar(out, row, start, [](float a, float b) { return a * b; });
+}
+
 void MathDivideOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -137,6 +229,21 @@ void MathDivideOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathDivideOperation::computeRow(float *out, const MathRow &row)
+{
+  int start = 0;
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    start = computeRowSSE2(out, row, [](__m128 a, __m128 b) {
+      /* We don't want to divide by zero. */
+      const __m128 nonzero = _mm_cmpneq_ps(b, _mm_setzero_ps());
+      return _mm_and_ps(nonzero, _mm_div_ps(a, b));
+    });
+  }
+#endif
+  computeRowScalar(out, row, start, [](float a, float b) { return (b == 0.0f) ? 0.0f : a / b; });
+}
+
 void MathSineOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -356,6 +463,17 @@ void MathMinimumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMinimumOperation::computeRow(float *out, const MathRow &row)
+{
+  int start = 0;
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    start = computeRowSSE2(out, row, [](__m128 a, __m128 b) { return _mm_min_ps(a, b); });
+  }
+#endif
+  computeRowScalar(out, row, start, [](float a, float b) { return min(a, b); });
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -372,6 +490,17 @@ void MathMaximumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMaximumOperation::computeRow(float *out, const MathRow &row)
+{
+  int start = 0;
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    start = computeRowSSE2(out, row, [](__m128 a, __m128 b) { return _mm_max_ps(a, b); });
+  }
+#endif
+  computeRowScalar(out, row, start, [](float a, float b) { return max(a, b); });
+}
+
 void MathRoundOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -43,6 +43,40 @@ class MathBaseOperation : public NodeOperation {
 
   void clampIfNeeded(float color[4]);
 
+  /**
+   * \brief a row of the input buffers for the full frame execution model
+   * \note strides are in floats, zero for single element buffers
+   */
+  struct MathRow {
+    const float *value1;
+    const float *value2;
+    const float *value3;
+    int value1_stride;
+    int value2_stride;
+    int value3_stride;
+    int width;
+  };
+
+  /**
+   * \brief compute a row of values, operations implementing it are full frame operations
+   * \see updateMemoryBuffer
+   */
+  virtual void computeRow(float * /*out*/, const MathRow & /*row*/)
+  {
+  }
+
+  /**
+   * \brief loop over a row of two input values from \a start, \a math computes a value from
+   * both inputs
+   */
+  template<typename MathFunc>
+  void computeRowScalar(float *out, const MathRow &row, int start, MathFunc math);
+  /**
+   * \brief like computeRowScalar, \a math computes four values at once with SSE2
+   * \return the number of computed values, the remaining ones are left to computeRowScalar
+   */
+  template<typename MathFunc> int computeRowSSE2(float *out, const MathRow &row, MathFunc math);
+
  public:
   /**
    * the inner loop of this program
@@ -64,6 +98,12 @@ class MathBaseOperation : public NodeOperation {
    */
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
+
+  bool hashSettings(uint64_t &r_hash) const;
+
   void setUseClamp(bool value)
   {
     this->m_useClamp = value;
@@ -71,30 +111,46 @@ class MathBaseOperation : public NodeOperation {
 };
 
 class MathAddOperation : public MathBaseOperation {
+ protected:
+  void computeRow(float *out, const MathRow &row);
+
  public:
   MathAddOperation() : MathBaseOperation()
   {
+    this->setFullFrameOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
 class MathSubtractOperation : public MathBaseOperation {
+ protected:
+  void computeRow(float *out, const MathRow &row);
+
  public:
   MathSubtractOperation() : MathBaseOperation()
   {
+    this->setFullFrameOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
 class MathMultiplyOperation : public MathBaseOperation {
+ protected:
+  void computeRow(float *out, const MathRow &row);
+
  public:
   MathMultiplyOperation() : MathBaseOperation()
   {
+    this->setFullFrameOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
 class MathDivideOperation : public MathBaseOperation {
+ protected:
+  void computeRow(float *out, const MathRow &row);
+
  public:
   MathDivideOperation() : MathBaseOperation()
   {
+    this->setFullFrameOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
@@ -178,16 +234,24 @@ class MathLogarithmOperation : public MathBaseOperation {
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
 class MathMinimumOperation : public MathBaseOperation {
+ protected:
+  void computeRow(float *out, const MathRow &row);
+
  public:
   MathMinimumOperation() : MathBaseOperation()
   {
+    this->setFullFrameOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
 class MathMaximumOperation : public MathBaseOperation {
+ protected:
+  void computeRow(float *out, const MathRow &row);
+
  public:
   MathMaximumOperation() : MathBaseOperation()
   {
+    this->setFullFrameOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
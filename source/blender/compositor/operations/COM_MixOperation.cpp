@@ -17,6 +17,7 @@
  */
 
 #include "COM_MixOperation.h"
+#include "COM_SIMD.h"
 
 #include "BLI_math.h"
 
@@ -95,11 +96,138 @@ void MixBaseOperation::deinitExecution()
   this->m_inputColor2Operation = nullptr;
 }
 
+bool MixBaseOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_valueAlphaMultiply);
+  hashCombine(r_hash, this->m_useClamp);
+  return true;
+}
+
+void MixBaseOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                          const rcti &area,
+                                          const std::vector<MemoryBuffer *> &inputs)
+{
+  MemoryBuffer *value = inputs[0];
+  MemoryBuffer *color1 = inputs[1];
+  MemoryBuffer *color2 = inputs[2];
+  MixRow row;
+  row.value_stride = value->getElemStride();
+  row.color1_stride = color1->getElemStride();
+  row.color2_stride = color2->getElemStride();
+  row.width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    row.value = value->getElem(area.xmin, y);
+    row.color1 = color1->getElem(area.xmin, y);
+    row.color2 = color2->getElem(area.xmin, y);
+    mixRow(output->getElem(area.xmin, y), row);
+  }
+}
+
+template<typename MixFunc>
+void MixBaseOperation::mixRowScalar(float *out, const MixRow &row, MixFunc mix)
+{
+  const float *value = row.value;
+  const float *color1 = row.color1;
+  const float *color2 = row.color2;
+  for (int i = 0; i < row.width; i++) {
+    mix(getMixFactor(value, color2), color1, color2, out);
+    out[3] = color1[3];
+    clampIfNeeded(out);
+
+    out += COM_NUM_CHANNELS_COLOR;
+    value += row.value_stride;
+    color1 += row.color1_stride;
+    color2 += row.color2_stride;
+  }
+}
+
+#ifdef __SSE2__
+template<typename MixFunc>
+void MixBaseOperation::mixRowSSE2(float *out, const MixRow &row, MixFunc mix)
+{
+  const float *value = row.value;
+  const float *color1 = row.color1;
+  const float *color2 = row.color2;
+  const int value_stride = row.value_stride;
+  const int color1_stride = row.color1_stride;
+  const int color2_stride = row.color2_stride;
+
+  auto mix_pixel = [&](const __m128 fac, const float *c1, const float *c2, float *r_out) {
+    const __m128 color1_v = _mm_loadu_ps(c1);
+    __m128 result = com_simd_with_alpha(mix(fac, color1_v, _mm_loadu_ps(c2)), color1_v);
+    if (this->m_useClamp) {
+      result = com_simd_clamp_01(result);
+    }
+    _mm_storeu_ps(r_out, result);
+  };
+
+  /* Four pixels per iteration: their mix factors are computed at once, and the pixels don't
+   * depend on each other so their instructions can overlap. */
+  int i = 0;
+  for (; i + 4 <= row.width; i += 4) {
+    __m128 facs = _mm_setr_ps(
+        value[0], value[value_stride], value[2 * value_stride], value[3 * value_stride]);
+    if (this->m_valueAlphaMultiply) {
+      facs = _mm_mul_ps(facs,
+                        _mm_setr_ps(color2[3],
+                                    color2[color2_stride + 3],
+                                    color2[2 * color2_stride + 3],
+                                    color2[3 * color2_stride + 3]));
+    }
+    mix_pixel(com_simd_broadcast<0>(facs), color1, color2, out);
+    mix_pixel(com_simd_broadcast<1>(facs),
+              color1 + color1_stride,
+              color2 + color2_stride,
+              out + COM_NUM_CHANNELS_COLOR);
+    mix_pixel(com_simd_broadcast<2>(facs),
+              color1 + 2 * color1_stride,
+              color2 + 2 * color2_stride,
+              out + 2 * COM_NUM_CHANNELS_COLOR);
+    mix_pixel(com_simd_broadcast<3>(facs),
+              color1 + 3 * color1_stride,
+              color2 + 3 * color2_stride,
+              out + 3 * COM_NUM_CHANNELS_COLOR);
+
+    out += 4 * COM_NUM_CHANNELS_COLOR;
+    value += 4 * value_stride;
+    color1 += 4 * color1_stride;
+    color2 += 4 * color2_stride;
+  }
+  for (; i < row.width; i++) {
+    mix_pixel(_mm_set1_ps(getMixFactor(value, color2)), color1, color2, out);
+
+    out += COM_NUM_CHANNELS_COLOR;
+    value += value_stride;
+    color1 += color1_stride;
+    color2 += color2_stride;
+  }
+}
+#endif
+
+void MixBaseOperation::mixRow(float *out, const MixRow &row)
+{
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    mixRowSSE2(out, row, [](const __m128 fac, const __m128 color1, const __m128 color2) {
+      const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+      return _mm_add_ps(_mm_mul_ps(facm, color1), _mm_mul_ps(fac, color2));
+    });
+    return;
+  }
+#endif
+  mixRowScalar(out, row, [](float fac, const float *color1, const float *color2, float *r_color) {
+    const float facm = 1.0f - fac;
+    r_color[0] = facm * color1[0] + fac * color2[0];
+    r_color[1] = facm * color1[1] + fac * color2[1];
+    r_color[2] = facm * color1[2] + fac * color2[2];
+  });
+}
+
 /* ******** Mix Add Operation ******** */
 
 MixAddOperation::MixAddOperation()
 {
-  /* pass */
+  this->setFullFrameOperation(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -124,11 +252,28 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::mixRow(float *out, const MixRow &row)
+{
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    mixRowSSE2(out, row, [](const __m128 fac, const __m128 color1, const __m128 color2) {
+      return _mm_add_ps(color1, _mm_mul_ps(fac, color2));
+    });
+    return;
+  }
+#endif
+  mixRowScalar(out, row, [](float fac, const float *color1, const float *color2, float *r_color) {
+    r_color[0] = color1[0] + fac * color2[0];
+    r_color[1] = color1[1] + fac * color2[1];
+    r_color[2] = color1[2] + fac * color2[2];
+  });
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation()
 {
-  /* pass */
+  this->setFullFrameOperation(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4],
@@ -158,6 +303,25 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::mixRow(float *out, const MixRow &row)
+{
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    mixRowSSE2(out, row, [](const __m128 fac, const __m128 color1, const __m128 color2) {
+      const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+      return _mm_add_ps(_mm_mul_ps(facm, color1), _mm_mul_ps(fac, color2));
+    });
+    return;
+  }
+#endif
+  mixRowScalar(out, row, [](float fac, const float *color1, const float *color2, float *r_color) {
+    const float facm = 1.0f - fac;
+    r_color[0] = facm * color1[0] + fac * color2[0];
+    r_color[1] = facm * color1[1] + fac * color2[1];
+    r_color[2] = facm * color1[2] + fac * color2[2];
+  });
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation()
@@ -323,7 +487,7 @@ void MixDarkenOperation::executePixelSampled(float output[4],
 
 MixDifferenceOperation::MixDifferenceOperation()
 {
-  /* pass */
+  this->setFullFrameOperation(true);
 }
 
 void MixDifferenceOperation::executePixelSampled(float output[4],
@@ -352,6 +516,26 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::mixRow(float *out, const MixRow &row)
+{
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    mixRowSSE2(out, row, [](const __m128 fac, const __m128 color1, const __m128 color2) {
+      const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+      const __m128 difference = com_simd_abs(_mm_sub_ps(color1, color2));
+      return _mm_add_ps(_mm_mul_ps(facm, color1), _mm_mul_ps(fac, difference));
+    });
+    return;
+  }
+#endif
+  mixRowScalar(out, row, [](float fac, const float *color1, const float *color2, float *r_color) {
+    const float facm = 1.0f - fac;
+    r_color[0] = facm * color1[0] + fac * fabsf(color1[0] - color2[0]);
+    r_color[1] = facm * color1[1] + fac * fabsf(color1[1] - color2[1]);
+    r_color[2] = facm * color1[2] + fac * fabsf(color1[2] - color2[2]);
+  });
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation()
@@ -676,7 +860,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
 
 MixMultiplyOperation::MixMultiplyOperation()
 {
-  /* pass */
+  this->setFullFrameOperation(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4],
@@ -705,6 +889,25 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::mixRow(float *out, const MixRow &row)
+{
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    mixRowSSE2(out, row, [](const __m128 fac, const __m128 color1, const __m128 color2) {
+      const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+      return _mm_mul_ps(color1, _mm_add_ps(facm, _mm_mul_ps(fac, color2)));
+    });
+    return;
+  }
+#endif
+  mixRowScalar(out, row, [](float fac, const float *color1, const float *color2, float *r_color) {
+    const float facm = 1.0f - fac;
+    r_color[0] = color1[0] * (facm + fac * color2[0]);
+    r_color[1] = color1[1] * (facm + fac * color2[1]);
+    r_color[2] = color1[2] * (facm + fac * color2[2]);
+  });
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation()
@@ -801,7 +1004,7 @@ void MixSaturationOperation::executePixelSampled(float output[4],
 
 MixScreenOperation::MixScreenOperation()
 {
-  /* pass */
+  this->setFullFrameOperation(true);
 }
 
 void MixScreenOperation::executePixelSampled(float output[4],
@@ -831,6 +1034,27 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixScreenOperation::mixRow(float *out, const MixRow &row)
+{
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    mixRowSSE2(out, row, [](const __m128 fac, const __m128 color1, const __m128 color2) {
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128 facm = _mm_sub_ps(one, fac);
+      const __m128 inv = _mm_add_ps(facm, _mm_mul_ps(fac, _mm_sub_ps(one, color2)));
+      return _mm_sub_ps(one, _mm_mul_ps(inv, _mm_sub_ps(one, color1)));
+    });
+    return;
+  }
+#endif
+  mixRowScalar(out, row, [](float fac, const float *color1, const float *color2, float *r_color) {
+    const float facm = 1.0f - fac;
+    r_color[0] = 1.0f - (facm + fac * (1.0f - color2[0])) * (1.0f - color1[0]);
+    r_color[1] = 1.0f - (facm + fac * (1.0f - color2[1])) * (1.0f - color1[1]);
+    r_color[2] = 1.0f - (facm + fac * (1.0f - color2[2])) * (1.0f - color1[2]);
+  });
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation()
@@ -881,7 +1105,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
 
 MixSubtractOperation::MixSubtractOperation()
 {
-  /* pass */
+  this->setFullFrameOperation(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4],
@@ -909,6 +1133,23 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::mixRow(float *out, const MixRow &row)
+{
+#ifdef __SSE2__
+  if (COM_simd_level_get() >= COM_SIMD_SSE2) {
+    mixRowSSE2(out, row, [](const __m128 fac, const __m128 color1, const __m128 color2) {
+      return _mm_sub_ps(color1, _mm_mul_ps(fac, color2));
+    });
+    return;
+  }
+#endif
+  mixRowScalar(out, row, [](float fac, const float *color1, const float *color2, float *r_color) {
+    r_color[0] = color1[0] - fac * color2[0];
+    r_color[1] = color1[1] - fac * color2[1];
+    r_color[2] = color1[2] - fac * color2[2];
+  });
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation()
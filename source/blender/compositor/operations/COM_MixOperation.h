@@ -43,6 +43,42 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * \brief a row of the input buffers for the full frame execution model
+   * \note strides are in floats, zero for single element buffers
+   */
+  struct MixRow {
+    const float *value;
+    const float *color1;
+    const float *color2;
+    int value_stride;
+    int color1_stride;
+    int color2_stride;
+    int width;
+  };
+
+  inline float getMixFactor(const float *value, const float *color2)
+  {
+    return this->m_valueAlphaMultiply ? value[0] * color2[3] : value[0];
+  }
+
+  /**
+   * \brief mix a row of pixels, operations implementing it are full frame operations
+   * \see updateMemoryBuffer
+   */
+  virtual void mixRow(float *out, const MixRow &row);
+
+  /**
+   * \brief loop over a row of pixels, \a mix computes the RGB of a pixel from the mix factor
+   * and both colors, the alpha of the first color is kept and the result clamped if needed
+   */
+  template<typename MixFunc> void mixRowScalar(float *out, const MixRow &row, MixFunc mix);
+  /**
+   * \brief like mixRowScalar, \a mix computes all channels of a color with SSE2, four pixels
+   * are processed per iteration
+   */
+  template<typename MixFunc> void mixRowSSE2(float *out, const MixRow &row, MixFunc mix);
+
  public:
   /**
    * Default constructor
@@ -66,6 +102,12 @@ class MixBaseOperation : public NodeOperation {
 
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
+
+  bool hashSettings(uint64_t &r_hash) const;
+
   void setUseValueAlphaMultiply(const bool value)
   {
     this->m_valueAlphaMultiply = value;
@@ -81,12 +123,18 @@ class MixBaseOperation : public NodeOperation {
 };
 
 class MixAddOperation : public MixBaseOperation {
+ protected:
+  void mixRow(float *out, const MixRow &row);
+
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
 
 class MixBlendOperation : public MixBaseOperation {
+ protected:
+  void mixRow(float *out, const MixRow &row);
+
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
@@ -111,6 +159,9 @@ class MixDarkenOperation : public MixBaseOperation {
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
+ protected:
+  void mixRow(float *out, const MixRow &row);
+
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
@@ -153,6 +204,9 @@ class MixLinearLightOperation : public MixBaseOperation {
 };
 
 class MixMultiplyOperation : public MixBaseOperation {
+ protected:
+  void mixRow(float *out, const MixRow &row);
+
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
@@ -171,6 +225,9 @@ class MixSaturationOperation : public MixBaseOperation {
 };
 
 class MixScreenOperation : public MixBaseOperation {
+ protected:
+  void mixRow(float *out, const MixRow &row);
+
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
@@ -183,6 +240,9 @@ class MixSoftLightOperation : public MixBaseOperation {
 };
 
 class MixSubtractOperation : public MixBaseOperation {
+ protected:
+  void mixRow(float *out, const MixRow &row);
+
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
@@ -45,6 +45,10 @@ class QualityStepHelper {
   {
     return this->m_offsetadd;
   }
+  inline CompositorQuality getQuality() const
+  {
+    return this->m_quality;
+  }
 
  public:
   QualityStepHelper();
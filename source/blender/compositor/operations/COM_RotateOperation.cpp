@@ -29,6 +29,7 @@ RotateOperation::RotateOperation()
   this->m_degreeSocket = nullptr;
   this->m_doDegree2RadConversion = false;
   this->m_isDegreeSet = false;
+  this->setFullFrameOperation(true);
 }
 void RotateOperation::initExecution()
 {
@@ -44,20 +45,25 @@ void RotateOperation::deinitExecution()
   this->m_degreeSocket = nullptr;
 }
 
+static void get_rotation(float degree, bool degree_to_rad, float &r_sine, float &r_cosine)
+{
+  double rad;
+  if (degree_to_rad) {
+    rad = DEG2RAD((double)degree);
+  }
+  else {
+    rad = degree;
+  }
+  r_cosine = cos(rad);
+  r_sine = sin(rad);
+}
+
 inline void RotateOperation::ensureDegree()
 {
   if (!this->m_isDegreeSet) {
     float degree[4];
     this->m_degreeSocket->readSampled(degree, 0, 0, COM_PS_NEAREST);
-    double rad;
-    if (this->m_doDegree2RadConversion) {
-      rad = DEG2RAD((double)degree[0]);
-    }
-    else {
-      rad = degree[0];
-    }
-    this->m_cosine = cos(rad);
-    this->m_sine = sin(rad);
+    get_rotation(degree[0], this->m_doDegree2RadConversion, this->m_sine, this->m_cosine);
 
     this->m_isDegreeSet = true;
   }
@@ -73,6 +79,68 @@ void RotateOperation::executePixelSampled(float output[4], float x, float y, Pix
   this->m_imageSocket->readSampled(output, nx, ny, sampler);
 }
 
+void RotateOperation::getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea)
+{
+  if (inputIndex == 1) {
+    /* The degree is read at the origin only. */
+    BLI_rcti_init(&r_inputArea, 0, 1, 0, 1);
+    return;
+  }
+
+  float degree[4];
+  if (!readConstantInput(1, degree)) {
+    NodeOperation *input = getInputOperation(0);
+    BLI_rcti_init(&r_inputArea, 0, input->getWidth(), 0, input->getHeight());
+    return;
+  }
+  float sine, cosine;
+  get_rotation(degree[0], this->m_doDegree2RadConversion, sine, cosine);
+
+  /* The center is only set by initExecution. */
+  const float centerX = (getWidth() - 1) / 2.0;
+  const float centerY = (getHeight() - 1) / 2.0;
+  const float dxmin = outputArea.xmin - centerX;
+  const float dymin = outputArea.ymin - centerY;
+  const float dxmax = outputArea.xmax - 1 - centerX;
+  const float dymax = outputArea.ymax - 1 - centerY;
+
+  const float x1 = centerX + (cosine * dxmin + sine * dymin);
+  const float x2 = centerX + (cosine * dxmax + sine * dymin);
+  const float x3 = centerX + (cosine * dxmin + sine * dymax);
+  const float x4 = centerX + (cosine * dxmax + sine * dymax);
+  const float y1 = centerY + (-sine * dxmin + cosine * dymin);
+  const float y2 = centerY + (-sine * dxmax + cosine * dymin);
+  const float y3 = centerY + (-sine * dxmin + cosine * dymax);
+  const float y4 = centerY + (-sine * dxmax + cosine * dymax);
+  getSampledArea(0,
+                 min(x1, min(x2, min(x3, x4))),
+                 max(x1, max(x2, max(x3, x4))),
+                 min(y1, min(y2, min(y3, y4))),
+                 max(y1, max(y2, max(y3, y4))),
+                 r_inputArea);
+}
+
+void RotateOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                         const rcti &area,
+                                         const std::vector<MemoryBuffer *> &inputs)
+{
+  /* Not using ensureDegree, areas are rendered from multiple threads. */
+  float degree[4];
+  inputs[1]->readSampled(degree, 0.0f, 0.0f, COM_PS_NEAREST);
+  float sine, cosine;
+  get_rotation(degree[0], this->m_doDegree2RadConversion, sine, cosine);
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      const float dy = y - this->m_centerY;
+      const float dx = x - this->m_centerX;
+      const float nx = this->m_centerX + (cosine * dx + sine * dy);
+      const float ny = this->m_centerY + (-sine * dx + cosine * dy);
+      inputs[0]->readSampled(output->getElem(x, y), nx, ny, COM_PS_NEAREST);
+    }
+  }
+}
+
 bool RotateOperation::determineDependingAreaOfInterest(rcti *input,
                                                        ReadBufferOperation *readOperation,
                                                        rcti *output)
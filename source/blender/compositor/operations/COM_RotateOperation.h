@@ -37,6 +37,10 @@ class RotateOperation : public NodeOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea);
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
   void initExecution();
   void deinitExecution();
   void setDoDegree2RadConversion(bool abool)
@@ -33,6 +33,23 @@ BaseScaleOperation::BaseScaleOperation()
   m_sampler = -1;
 #endif
   m_variable_size = false;
+  this->setFullFrameOperation(true);
+}
+
+/* Area of the image input read around the center of the output, for relative scales. */
+void BaseScaleOperation::getScaledArea(const rcti &outputArea,
+                                       float scaleX,
+                                       float scaleY,
+                                       rcti &r_inputArea)
+{
+  /* The center is only set by initExecution. */
+  const float centerX = this->getWidth() / 2.0;
+  const float centerY = this->getHeight() / 2.0;
+  const float x1 = centerX + (outputArea.xmin - centerX) / scaleX;
+  const float x2 = centerX + (outputArea.xmax - 1 - centerX) / scaleX;
+  const float y1 = centerY + (outputArea.ymin - centerY) / scaleY;
+  const float y2 = centerY + (outputArea.ymax - 1 - centerY) / scaleY;
+  getSampledArea(0, min_ff(x1, x2), max_ff(x1, x2), min_ff(y1, y2), max_ff(y1, y2), r_inputArea);
 }
 
 ScaleOperation::ScaleOperation() : BaseScaleOperation()
@@ -109,6 +126,51 @@ bool ScaleOperation::determineDependingAreaOfInterest(rcti *input,
   return BaseScaleOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
 }
 
+void ScaleOperation::getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea)
+{
+  if (inputIndex != 0) {
+    /* Scales are sampled at the rendered pixels. */
+    getSampledArea(inputIndex,
+                   outputArea.xmin,
+                   outputArea.xmax - 1,
+                   outputArea.ymin,
+                   outputArea.ymax - 1,
+                   r_inputArea);
+    return;
+  }
+
+  float scaleX[4];
+  float scaleY[4];
+  if (!m_variable_size && readConstantInput(1, scaleX) && readConstantInput(2, scaleY)) {
+    getScaledArea(outputArea, scaleX[0], scaleY[0], r_inputArea);
+  }
+  else {
+    NodeOperation *input = getInputOperation(0);
+    BLI_rcti_init(&r_inputArea, 0, input->getWidth(), 0, input->getHeight());
+  }
+}
+
+void ScaleOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                        const rcti &area,
+                                        const std::vector<MemoryBuffer *> &inputs)
+{
+  /* Sampled like when rendering pixels, see FullFrameExecutionModel::renderPixels. */
+  PixelSampler effective_sampler = getEffectiveSampler(COM_PS_NEAREST);
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      float scaleX[4];
+      float scaleY[4];
+      inputs[1]->readSampled(scaleX, x, y, effective_sampler);
+      inputs[2]->readSampled(scaleY, x, y, effective_sampler);
+
+      const float nx = this->m_centerX + (x - this->m_centerX) / scaleX[0];
+      const float ny = this->m_centerY + (y - this->m_centerY) / scaleY[0];
+      inputs[0]->readSampled(output->getElem(x, y), nx, ny, effective_sampler);
+    }
+  }
+}
+
 // SCALE ABSOLUTE
 ScaleAbsoluteOperation::ScaleAbsoluteOperation() : BaseScaleOperation()
 {
@@ -200,6 +262,59 @@ bool ScaleAbsoluteOperation::determineDependingAreaOfInterest(rcti *input,
   return BaseScaleOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
 }
 
+void ScaleAbsoluteOperation::getAreaOfInterest(int inputIndex,
+                                               const rcti &outputArea,
+                                               rcti &r_inputArea)
+{
+  if (inputIndex != 0) {
+    /* Scales are sampled at the rendered pixels. */
+    getSampledArea(inputIndex,
+                   outputArea.xmin,
+                   outputArea.xmax - 1,
+                   outputArea.ymin,
+                   outputArea.ymax - 1,
+                   r_inputArea);
+    return;
+  }
+
+  float scaleX[4];
+  float scaleY[4];
+  if (!m_variable_size && readConstantInput(1, scaleX) && readConstantInput(2, scaleY)) {
+    const float width = this->getWidth();
+    const float height = this->getHeight();
+    getScaledArea(outputArea, scaleX[0] / width, scaleY[0] / height, r_inputArea);
+  }
+  else {
+    NodeOperation *input = getInputOperation(0);
+    BLI_rcti_init(&r_inputArea, 0, input->getWidth(), 0, input->getHeight());
+  }
+}
+
+void ScaleAbsoluteOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                const rcti &area,
+                                                const std::vector<MemoryBuffer *> &inputs)
+{
+  /* Sampled like when rendering pixels, see FullFrameExecutionModel::renderPixels. */
+  PixelSampler effective_sampler = getEffectiveSampler(COM_PS_NEAREST);
+  const float width = this->getWidth();
+  const float height = this->getHeight();
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      float scaleX[4];
+      float scaleY[4];
+      inputs[1]->readSampled(scaleX, x, y, effective_sampler);
+      inputs[2]->readSampled(scaleY, x, y, effective_sampler);
+
+      const float relativeXScale = scaleX[0] / width;
+      const float relativeYScale = scaleY[0] / height;
+      const float nx = this->m_centerX + (x - this->m_centerX) / relativeXScale;
+      const float ny = this->m_centerY + (y - this->m_centerY) / relativeYScale;
+      inputs[0]->readSampled(output->getElem(x, y), nx, ny, effective_sampler);
+    }
+  }
+}
+
 // Absolute fixed size
 ScaleFixedSizeOperation::ScaleFixedSizeOperation() : BaseScaleOperation()
 {
@@ -298,6 +413,37 @@ bool ScaleFixedSizeOperation::determineDependingAreaOfInterest(rcti *input,
   return BaseScaleOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
 }
 
+void ScaleFixedSizeOperation::getAreaOfInterest(int /*inputIndex*/,
+                                                const rcti & /*outputArea*/,
+                                                rcti &r_inputArea)
+{
+  /* The scale and offsets are only known after initExecution. */
+  NodeOperation *input = getInputOperation(0);
+  BLI_rcti_init(&r_inputArea, 0, input->getWidth(), 0, input->getHeight());
+}
+
+void ScaleFixedSizeOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                 const rcti &area,
+                                                 const std::vector<MemoryBuffer *> &inputs)
+{
+  /* Sampled like when rendering pixels, see FullFrameExecutionModel::renderPixels. */
+  PixelSampler effective_sampler = getEffectiveSampler(COM_PS_NEAREST);
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      float *out = output->getElem(x, y);
+      if (this->m_is_offset) {
+        const float nx = ((x - this->m_offsetX) * this->m_relX);
+        const float ny = ((y - this->m_offsetY) * this->m_relY);
+        inputs[0]->readSampled(out, nx, ny, effective_sampler);
+      }
+      else {
+        inputs[0]->readSampled(out, x * this->m_relX, y * this->m_relY, effective_sampler);
+      }
+    }
+  }
+}
+
 void ScaleFixedSizeOperation::determineResolution(unsigned int resolution[2],
                                                   unsigned int /*preferredResolution*/[2])
 {
@@ -39,6 +39,8 @@ class BaseScaleOperation : public NodeOperation {
     return (m_sampler == -1) ? sampler : (PixelSampler)m_sampler;
   }
 
+  void getScaledArea(const rcti &outputArea, float scaleX, float scaleY, rcti &r_inputArea);
+
   int m_sampler;
   bool m_variable_size;
 };
@@ -57,6 +59,10 @@ class ScaleOperation : public BaseScaleOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea);
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
 
   void initExecution();
   void deinitExecution();
@@ -75,6 +81,10 @@ class ScaleAbsoluteOperation : public BaseScaleOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea);
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
 
   void initExecution();
   void deinitExecution();
@@ -103,6 +113,10 @@ class ScaleFixedSizeOperation : public BaseScaleOperation {
                                         rcti *output);
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void getAreaOfInterest(int inputIndex, const rcti &outputArea, rcti &r_inputArea);
+  void updateMemoryBuffer(MemoryBuffer *output,
+                          const rcti &area,
+                          const std::vector<MemoryBuffer *> &inputs);
 
   void initExecution();
   void deinitExecution();
@@ -31,6 +31,7 @@ TranslateOperation::TranslateOperation()
   this->m_isDeltaSet = false;
   this->m_factorX = 1.0f;
   this->m_factorY = 1.0f;
+  this->setFullFrameOperation(true);
 }
 void TranslateOperation::initExecution()
 {
@@ -75,6 +76,53 @@ bool TranslateOperation::determineDependingAreaOfInterest(rcti *input,
   return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
 }
 
+void TranslateOperation::getAreaOfInterest(int inputIndex,
+                                           const rcti &outputArea,
+                                           rcti &r_inputArea)
+{
+  if (inputIndex != 0) {
+    /* The deltas are read at the origin only. */
+    BLI_rcti_init(&r_inputArea, 0, 1, 0, 1);
+    return;
+  }
+
+  float deltaX[4];
+  float deltaY[4];
+  if (readConstantInput(1, deltaX) && readConstantInput(2, deltaY)) {
+    deltaX[0] *= this->m_factorX;
+    deltaY[0] *= this->m_factorY;
+    getSampledArea(0,
+                   outputArea.xmin - deltaX[0],
+                   outputArea.xmax - 1 - deltaX[0],
+                   outputArea.ymin - deltaY[0],
+                   outputArea.ymax - 1 - deltaY[0],
+                   r_inputArea);
+  }
+  else {
+    NodeOperation *input = getInputOperation(0);
+    BLI_rcti_init(&r_inputArea, 0, input->getWidth(), 0, input->getHeight());
+  }
+}
+
+void TranslateOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                            const rcti &area,
+                                            const std::vector<MemoryBuffer *> &inputs)
+{
+  /* Not using ensureDelta, areas are rendered from multiple threads. */
+  float deltaX[4];
+  float deltaY[4];
+  inputs[1]->readSampled(deltaX, 0.0f, 0.0f, COM_PS_NEAREST);
+  inputs[2]->readSampled(deltaY, 0.0f, 0.0f, COM_PS_NEAREST);
+  deltaX[0] *= this->m_factorX;
+  deltaY[0] *= this->m_factorY;
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      inputs[0]->readSampled(output->getElem(x, y), x - deltaX[0], y - deltaY[0], COM_PS_BILINEAR);
+    }
+  }
+}
+
 void TranslateOperation::setFactorXY(float factorX, float factorY)
 {
   m_factorX = factorX;
@@ -22,6 +22,9 @@
 
 #include "RE_pipeline.h"
 
+/* Number of samples on each side of a pixel gathered by the fast approximation. */
+static const int FAST_APPROXIMATION_SAMPLES = 16;
+
 VariableSizeBokehBlurOperation::VariableSizeBokehBlurOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
@@ -41,6 +44,7 @@ VariableSizeBokehBlurOperation::VariableSizeBokehBlurOperation()
   this->m_maxBlur = 32.0f;
   this->m_threshold = 1.0f;
   this->m_do_size_scale = false;
+  this->m_fast = false;
 #ifdef COM_DEFOCUS_SEARCH
   this->m_inputSearchProgram = NULL;
 #endif
@@ -133,7 +137,18 @@ void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y,
     copy_v4_fl(multiplier_accum, 1.0f);
     float size_center = tempSize[0] * scalar;
 
-    const int addXStepValue = QualityStepHelper::getStep();
+    int addXStepValue = QualityStepHelper::getStep();
+    if (this->m_fast) {
+      /* Neighbors only contribute within their size, which is limited to the size of this pixel.
+       * The samples are spread over that radius, aligned to this pixel. */
+      const int radius = min(maxBlurScalar, (int)ceilf(size_center));
+      addXStepValue = max(addXStepValue,
+                          (radius + FAST_APPROXIMATION_SAMPLES - 1) / FAST_APPROXIMATION_SAMPLES);
+      minx = x - min(radius, x) / addXStepValue * addXStepValue;
+      miny = y - min(radius, y) / addXStepValue * addXStepValue;
+      maxx = min(x + radius + 1, (int)m_width);
+      maxy = min(y + radius + 1, (int)m_height);
+    }
     const int addYStepValue = addXStepValue;
     const int addXStepColor = addXStepValue * COM_NUM_CHANNELS_COLOR;
 
@@ -274,6 +289,16 @@ bool VariableSizeBokehBlurOperation::determineDependingAreaOfInterest(
   return false;
 }
 
+bool VariableSizeBokehBlurOperation::hashSettings(uint64_t &r_hash) const
+{
+  hashCombine(r_hash, this->m_maxBlur);
+  hashCombine(r_hash, this->m_threshold);
+  hashCombine(r_hash, this->m_do_size_scale);
+  hashCombine(r_hash, this->m_fast);
+  hashCombine(r_hash, this->getQuality());
+  return true;
+}
+
 #ifdef COM_DEFOCUS_SEARCH
 // InverseSearchRadiusOperation
 InverseSearchRadiusOperation::InverseSearchRadiusOperation()
@@ -28,6 +28,7 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
   int m_maxBlur;
   float m_threshold;
   bool m_do_size_scale; /* scale size, matching 'BokehBlurNode' */
+  bool m_fast;          /* gather a limited number of samples per pixel */
   SocketReader *m_inputProgram;
   SocketReader *m_inputBokehProgram;
   SocketReader *m_inputSizeProgram;
@@ -57,6 +58,12 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
    */
   void deinitExecution();
 
+  bool hashSettings(uint64_t &r_hash) const;
+  bool useOutputCache() const
+  {
+    return true;
+  }
+
   bool determineDependingAreaOfInterest(rcti *input,
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
@@ -76,6 +83,13 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
     this->m_do_size_scale = scale_size;
   }
 
+  void setFastApproximation(bool fast)
+  {
+    this->m_fast = fast;
+    /* The OpenCL kernel only implements the accurate blur. */
+    this->setOpenCL(!fast);
+  }
+
   void executeOpenCL(OpenCLDevice *device,
                      MemoryBuffer *outputMemoryBuffer,
                      cl_mem clOutputBuffer,
@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+#include "BLI_rect.h"
+
+#include "DNA_scene_types.h"
+
+#include "COM_BufferOperation.h"
+#include "COM_FlipOperation.h"
+#include "COM_GaussianXBlurOperation.h"
+#include "COM_GaussianYBlurOperation.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_RotateOperation.h"
+#include "COM_ScaleOperation.h"
+#include "COM_SetValueOperation.h"
+#include "COM_TranslateOperation.h"
+
+#include <memory>
+
+namespace blender::compositor::tests {
+
+#define WIDTH 41
+#define HEIGHT 23
+
+/**
+ * Operations rendering areas with updateMemoryBuffer must give the same results as when they are
+ * rendered per pixel, reading only the areas of interest of their inputs.
+ */
+class FullFrameOperationTest : public testing::Test {
+ protected:
+  RandomNumberGenerator rng{42};
+  rcti canvas;
+  /* Partial area with an offset, so buffers of the areas of interest have one too. */
+  rcti area;
+  std::unique_ptr<MemoryBuffer> image;
+  std::vector<std::unique_ptr<NodeOperation>> operations;
+  std::vector<std::unique_ptr<MemoryBuffer>> buffers;
+
+  virtual void SetUp()
+  {
+    BLI_rcti_init(&canvas, 0, WIDTH, 0, HEIGHT);
+    BLI_rcti_init(&area, 7, 30, 4, 17);
+    image = std::make_unique<MemoryBuffer>(COM_DT_COLOR, &canvas);
+    for (int i = 0; i < WIDTH * HEIGHT * COM_NUM_CHANNELS_COLOR; i++) {
+      image->getBuffer()[i] = rng.get_float();
+    }
+  }
+
+  void set_resolution(NodeOperation &operation)
+  {
+    unsigned int resolution[2] = {WIDTH, HEIGHT};
+    operation.setResolution(resolution);
+  }
+
+  void link_image(NodeOperation &operation)
+  {
+    operations.push_back(std::make_unique<BufferOperation>(image.get(), COM_DT_COLOR));
+    NodeOperation *input = operations.back().get();
+    set_resolution(*input);
+    operation.getInputSocket(0)->setLink(input->getOutputSocket());
+  }
+
+  void link_value(NodeOperation &operation, unsigned int index, float value)
+  {
+    operations.push_back(std::make_unique<SetValueOperation>());
+    SetValueOperation *input = (SetValueOperation *)operations.back().get();
+    input->setValue(value);
+    set_resolution(*input);
+    operation.getInputSocket(index)->setLink(input->getOutputSocket());
+  }
+
+  /* Buffers of the areas of interest, like the ones rendered by FullFrameExecutionModel. */
+  std::vector<MemoryBuffer *> get_input_buffers(NodeOperation &operation)
+  {
+    std::vector<MemoryBuffer *> inputs;
+    for (unsigned int i = 0; i < operation.getNumberOfInputSockets(); i++) {
+      rcti inputArea;
+      operation.getAreaOfInterest(i, area, inputArea);
+      NodeOperation *input = &operation.getInputSocket(i)->getLink()->getOperation();
+      if (input->isSetOperation()) {
+        buffers.push_back(std::make_unique<MemoryBuffer>(COM_DT_VALUE, &inputArea, true));
+        input->readSampled(buffers.back()->getBuffer(), 0.0f, 0.0f, COM_PS_NEAREST);
+      }
+      else {
+        EXPECT_TRUE(BLI_rcti_inside_rcti(&canvas, &inputArea));
+        buffers.push_back(std::make_unique<MemoryBuffer>(COM_DT_COLOR, &inputArea));
+        buffers.back()->copyContentFrom(image.get());
+      }
+      inputs.push_back(buffers.back().get());
+    }
+    return inputs;
+  }
+
+  void expect_equal_to_pixels(NodeOperation &operation)
+  {
+    ASSERT_TRUE(operation.isFullFrameOperation());
+    set_resolution(operation);
+    const std::vector<MemoryBuffer *> inputs = get_input_buffers(operation);
+    operation.initExecution();
+
+    MemoryBuffer expected(COM_DT_COLOR, &area);
+    void *data = operation.isComplex() ? operation.initializeTileData(&area) : nullptr;
+    for (int y = area.ymin; y < area.ymax; y++) {
+      for (int x = area.xmin; x < area.xmax; x++) {
+        if (data) {
+          operation.read(expected.getElem(x, y), x, y, data);
+        }
+        else {
+          operation.readSampled(expected.getElem(x, y), x, y, COM_PS_NEAREST);
+        }
+      }
+    }
+
+    MemoryBuffer output(COM_DT_COLOR, &area);
+    operation.updateMemoryBuffer(&output, area, inputs);
+    operation.deinitExecution();
+
+    const int len = BLI_rcti_size_x(&area) * BLI_rcti_size_y(&area) * COM_NUM_CHANNELS_COLOR;
+    for (int i = 0; i < len; i++) {
+      EXPECT_FLOAT_EQ(expected.getBuffer()[i], output.getBuffer()[i]) << "at float " << i;
+    }
+  }
+};
+
+TEST_F(FullFrameOperationTest, GaussianBlur)
+{
+  NodeBlurData data = {0};
+  data.sizex = 6;
+  data.sizey = 4;
+  data.filtertype = R_FILTER_GAUSS;
+
+  GaussianXBlurOperation blur_x;
+  blur_x.setData(&data);
+  link_image(blur_x);
+  link_value(blur_x, 1, 0.8f);
+  expect_equal_to_pixels(blur_x);
+
+  GaussianYBlurOperation blur_y;
+  blur_y.setData(&data);
+  link_image(blur_y);
+  link_value(blur_y, 1, 1.0f);
+  blur_y.setSize(1.0f);
+  expect_equal_to_pixels(blur_y);
+}
+
+TEST_F(FullFrameOperationTest, Flip)
+{
+  for (const bool flip_x : {false, true}) {
+    for (const bool flip_y : {false, true}) {
+      FlipOperation flip;
+      flip.setFlipX(flip_x);
+      flip.setFlipY(flip_y);
+      link_image(flip);
+      expect_equal_to_pixels(flip);
+    }
+  }
+}
+
+TEST_F(FullFrameOperationTest, Translate)
+{
+  TranslateOperation translate;
+  link_image(translate);
+  link_value(translate, 1, 3.4f);
+  link_value(translate, 2, -2.7f);
+  expect_equal_to_pixels(translate);
+}
+
+TEST_F(FullFrameOperationTest, Rotate)
+{
+  RotateOperation rotate;
+  rotate.setDoDegree2RadConversion(true);
+  link_image(rotate);
+  link_value(rotate, 1, 30.0f);
+  expect_equal_to_pixels(rotate);
+}
+
+TEST_F(FullFrameOperationTest, Scale)
+{
+  ScaleOperation scale;
+  link_image(scale);
+  link_value(scale, 1, 1.7f);
+  link_value(scale, 2, -0.6f);
+  expect_equal_to_pixels(scale);
+
+  ScaleAbsoluteOperation scale_absolute;
+  link_image(scale_absolute);
+  link_value(scale_absolute, 1, 30.0f);
+  link_value(scale_absolute, 2, 50.0f);
+  expect_equal_to_pixels(scale_absolute);
+}
+
+}  // namespace blender::compositor::tests
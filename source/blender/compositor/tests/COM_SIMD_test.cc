@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+#include "BLI_rect.h"
+
+#include "COM_ColorBalanceASCCDLOperation.h"
+#include "COM_ColorBalanceLGGOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MixOperation.h"
+#include "COM_SIMD.h"
+
+#include <memory>
+
+namespace blender::compositor::tests {
+
+/* Not a multiple of four, so the scalar tails of the row kernels are used too. */
+#define WIDTH 37
+#define HEIGHT 5
+
+class SIMDKernelTest : public testing::Test {
+ protected:
+  RandomNumberGenerator rng{42};
+  rcti area;
+  std::vector<std::unique_ptr<MemoryBuffer>> buffers;
+
+  virtual void SetUp()
+  {
+    BLI_rcti_init(&area, 0, WIDTH, 0, HEIGHT);
+  }
+
+  virtual void TearDown()
+  {
+    COM_simd_init();
+  }
+
+  MemoryBuffer *random_buffer(DataType datatype, float min, float max, bool is_single_elem)
+  {
+    buffers.push_back(std::make_unique<MemoryBuffer>(datatype, &area, is_single_elem));
+    MemoryBuffer *buffer = buffers.back().get();
+    const int len = (is_single_elem ? 1 : WIDTH * HEIGHT) * buffer->get_num_channels();
+    for (int i = 0; i < len; i++) {
+      buffer->getBuffer()[i] = min + rng.get_float() * (max - min);
+    }
+    return buffer;
+  }
+
+  /* Render the operation with the scalar and the SSE2 kernels, the results must match. */
+  void expect_kernels_match(NodeOperation &operation,
+                            DataType output_type,
+                            const std::vector<MemoryBuffer *> &inputs)
+  {
+    MemoryBuffer scalar(output_type, &area);
+    MemoryBuffer simd(output_type, &area);
+
+    COM_simd_level_set(COM_SIMD_NONE);
+    ASSERT_EQ(COM_simd_level_get(), COM_SIMD_NONE);
+    operation.updateMemoryBuffer(&scalar, area, inputs);
+
+    COM_simd_level_set(COM_SIMD_SSE2);
+    operation.updateMemoryBuffer(&simd, area, inputs);
+
+    const int len = WIDTH * HEIGHT * scalar.get_num_channels();
+    for (int i = 0; i < len; i++) {
+      EXPECT_FLOAT_EQ(scalar.getBuffer()[i], simd.getBuffer()[i]) << "at float " << i;
+    }
+  }
+
+  void test_mix(MixBaseOperation &operation)
+  {
+    for (const bool use_clamp : {false, true}) {
+      for (const bool alpha_multiply : {false, true}) {
+        for (const bool single_value : {false, true}) {
+          operation.setUseClamp(use_clamp);
+          operation.setUseValueAlphaMultiply(alpha_multiply);
+          expect_kernels_match(operation,
+                               COM_DT_COLOR,
+                               {random_buffer(COM_DT_VALUE, -0.2f, 1.2f, single_value),
+                                random_buffer(COM_DT_COLOR, -0.5f, 2.0f, false),
+                                random_buffer(COM_DT_COLOR, -0.5f, 2.0f, single_value)});
+        }
+      }
+    }
+  }
+
+  void test_math(MathBaseOperation &operation)
+  {
+    for (const bool use_clamp : {false, true}) {
+      for (const bool single_value : {false, true}) {
+        operation.setUseClamp(use_clamp);
+        expect_kernels_match(operation,
+                             COM_DT_VALUE,
+                             {random_buffer(COM_DT_VALUE, -2.0f, 2.0f, false),
+                              random_buffer(COM_DT_VALUE, 0.1f, 2.0f, single_value),
+                              random_buffer(COM_DT_VALUE, 0.0f, 1.0f, true)});
+      }
+    }
+  }
+};
+
+TEST_F(SIMDKernelTest, Mix)
+{
+  MixBaseOperation blend_base;
+  test_mix(blend_base);
+  MixAddOperation add;
+  test_mix(add);
+  MixBlendOperation blend;
+  test_mix(blend);
+  MixDifferenceOperation difference;
+  test_mix(difference);
+  MixMultiplyOperation multiply;
+  test_mix(multiply);
+  MixScreenOperation screen;
+  test_mix(screen);
+  MixSubtractOperation subtract;
+  test_mix(subtract);
+}
+
+TEST_F(SIMDKernelTest, Math)
+{
+  MathAddOperation add;
+  test_math(add);
+  MathSubtractOperation subtract;
+  test_math(subtract);
+  MathMultiplyOperation multiply;
+  test_math(multiply);
+  MathDivideOperation divide;
+  test_math(divide);
+  MathMinimumOperation minimum;
+  test_math(minimum);
+  MathMaximumOperation maximum;
+  test_math(maximum);
+}
+
+TEST_F(SIMDKernelTest, ColorBalance)
+{
+  float lift[3] = {0.9f, 1.0f, 1.2f};
+  float gamma_inv[3] = {1.1f, 0.8f, 1.0f};
+  float gain[3] = {1.3f, 0.7f, 1.0f};
+
+  ColorBalanceLGGOperation lgg;
+  lgg.setLift(lift);
+  lgg.setGammaInv(gamma_inv);
+  lgg.setGain(gain);
+  ColorBalanceASCCDLOperation cdl;
+  cdl.setOffset(lift);
+  cdl.setPower(gamma_inv);
+  cdl.setSlope(gain);
+
+  for (const bool single_value : {false, true}) {
+    const std::vector<MemoryBuffer *> inputs = {
+        random_buffer(COM_DT_VALUE, 0.0f, 1.5f, single_value),
+        random_buffer(COM_DT_COLOR, -0.5f, 2.0f, false)};
+    expect_kernels_match(lgg, COM_DT_COLOR, inputs);
+    expect_kernels_match(cdl, COM_DT_COLOR, inputs);
+  }
+}
+
+}  // namespace blender::compositor::tests
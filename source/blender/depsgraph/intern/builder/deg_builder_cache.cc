@@ -27,6 +27,9 @@
 
 #include "DNA_anim_types.h"
 
+#include "BLI_array.hh"
+#include "BLI_ghash.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_animsys.h"
@@ -83,7 +86,9 @@ namespace {
 struct AnimatedPropertyCallbackData {
   PointerRNA pointer_rna;
   AnimatedPropertyStorage *animated_property_storage;
+  /* Only one of those is used for properties of other IDs. */
   DepsgraphBuilderCache *builder_cache;
+  Vector<ForeignAnimatedProperty> *foreign_properties;
 };
 
 void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
@@ -103,16 +108,42 @@ void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
    * This is needed to deal with cases when nested datablock is animated by its parent. */
   AnimatedPropertyStorage *animated_property_storage = data->animated_property_storage;
   if (pointer_rna.owner_id != data->pointer_rna.owner_id) {
+    if (data->foreign_properties != nullptr) {
+      data->foreign_properties->append(
+          {pointer_rna.owner_id, AnimatedPropertyID(&pointer_rna, property_rna)});
+      return;
+    }
     animated_property_storage = data->builder_cache->ensureAnimatedPropertyStorage(
         pointer_rna.owner_id);
+    animated_property_storage->animated_by_ids.add(data->pointer_rna.owner_id);
   }
   /* Set the property as animated. */
   animated_property_storage->tagPropertyAsAnimated(&pointer_rna, property_rna);
 }
 
+void fcurves_hash_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
+{
+  uint64_t *hash = static_cast<uint64_t *>(data_v);
+  const uint64_t path_hash = (fcurve->rna_path != nullptr) ?
+                                 BLI_ghashutil_strhash_p(fcurve->rna_path) :
+                                 0;
+  *hash = (*hash * 33) ^ (((uint64_t)(uintptr_t)fcurve >> 4) + path_hash * 31 +
+                          (uint64_t)fcurve->array_index);
+}
+
+/* Hash of the RNA paths of all F-Curves of the ID, changes whenever the set of animated
+ * properties might have changed. */
+uint64_t fcurves_hash_from_id(ID *id)
+{
+  uint64_t hash = 0;
+  BKE_fcurves_id_cb(id, fcurves_hash_cb, &hash);
+  return hash;
+}
+
 }  // namespace
 
-AnimatedPropertyStorage::AnimatedPropertyStorage() : is_fully_initialized(false)
+AnimatedPropertyStorage::AnimatedPropertyStorage()
+    : is_fully_initialized(false), session_uuid(0), fcurves_hash(0), build_index(0)
 {
 }
 
@@ -122,7 +153,31 @@ void AnimatedPropertyStorage::initializeFromID(DepsgraphBuilderCache *builder_ca
   RNA_id_pointer_create(id, &data.pointer_rna);
   data.animated_property_storage = this;
   data.builder_cache = builder_cache;
+  data.foreign_properties = nullptr;
+  BKE_fcurves_id_cb(id, animated_property_cb, &data);
+  session_uuid = id->session_uuid;
+  fcurves_hash = fcurves_hash_from_id(id);
+}
+
+void AnimatedPropertyStorage::initializeFromID(
+    ID *id, Vector<ForeignAnimatedProperty> *foreign_properties)
+{
+  AnimatedPropertyCallbackData data;
+  RNA_id_pointer_create(id, &data.pointer_rna);
+  data.animated_property_storage = this;
+  data.builder_cache = nullptr;
+  data.foreign_properties = foreign_properties;
   BKE_fcurves_id_cb(id, animated_property_cb, &data);
+  session_uuid = id->session_uuid;
+  fcurves_hash = fcurves_hash_from_id(id);
+}
+
+bool AnimatedPropertyStorage::isValidForID(ID *id) const
+{
+  if (session_uuid != id->session_uuid) {
+    return false;
+  }
+  return !is_fully_initialized || fcurves_hash == fcurves_hash_from_id(id);
 }
 
 void AnimatedPropertyStorage::tagPropertyAsAnimated(const AnimatedPropertyID &property_id)
@@ -149,22 +204,98 @@ bool AnimatedPropertyStorage::isPropertyAnimated(const PointerRNA *pointer_rna,
 
 /* Builder cache itself. */
 
-DepsgraphBuilderCache::DepsgraphBuilderCache()
+namespace {
+
+struct InitializeStoragesData {
+  Span<ID *> ids;
+  /* Storages and properties of other IDs initialized for every ID. */
+  Array<AnimatedPropertyStorage *> storages;
+  Array<Vector<ForeignAnimatedProperty>> foreign_properties;
+};
+
+void initialize_storage_func(void *__restrict data_v,
+                             const int i,
+                             const TaskParallelTLS *__restrict /*tls*/)
+{
+  InitializeStoragesData *data = static_cast<InitializeStoragesData *>(data_v);
+  AnimatedPropertyStorage *storage = new AnimatedPropertyStorage();
+  storage->initializeFromID(data->ids[i], &data->foreign_properties[i]);
+  data->storages[i] = storage;
+}
+
+}  // namespace
+
+DepsgraphBuilderCache::DepsgraphBuilderCache() : build_index_(0), invalidate_all_(false)
 {
+  BLI_mutex_init(&invalidate_mutex_);
 }
 
 DepsgraphBuilderCache::~DepsgraphBuilderCache()
 {
-  for (AnimatedPropertyStorage *animated_property_storage :
-       animated_property_storage_map_.values()) {
-    delete animated_property_storage;
+  removeAllAnimatedPropertyStorages();
+  BLI_mutex_end(&invalidate_mutex_);
+}
+
+void DepsgraphBuilderCache::beginBuild()
+{
+  build_index_++;
+
+  BLI_mutex_lock(&invalidate_mutex_);
+  if (invalidate_all_) {
+    removeAllAnimatedPropertyStorages();
+  }
+  else {
+    for (ID *id : invalidated_ids_) {
+      removeAnimatedPropertyStorage(id);
+    }
+  }
+  invalidated_ids_.clear();
+  invalidate_all_ = false;
+  BLI_mutex_unlock(&invalidate_mutex_);
+}
+
+void DepsgraphBuilderCache::endBuild()
+{
+  /* Storages which were not used might belong to IDs which were freed, their pointers can not be
+   * used for validation in a later build. */
+  Vector<ID *> unused_ids;
+  for (auto item : animated_property_storage_map_.items()) {
+    if (item.value->build_index != build_index_) {
+      unused_ids.append(item.key);
+    }
+  }
+  for (ID *id : unused_ids) {
+    removeAnimatedPropertyStorage(id);
+  }
+}
+
+AnimatedPropertyStorage *DepsgraphBuilderCache::validateAnimatedPropertyStorage(
+    ID *id, AnimatedPropertyStorage *storage)
+{
+  if (storage->build_index == build_index_) {
+    return storage;
   }
+  if (!storage->isValidForID(id)) {
+    removeAnimatedPropertyStorage(id);
+    return nullptr;
+  }
+  storage->build_index = build_index_;
+  return storage;
 }
 
 AnimatedPropertyStorage *DepsgraphBuilderCache::ensureAnimatedPropertyStorage(ID *id)
 {
-  return animated_property_storage_map_.lookup_or_add_cb(
-      id, []() { return new AnimatedPropertyStorage(); });
+  AnimatedPropertyStorage *storage = animated_property_storage_map_.lookup_default(id, nullptr);
+  if (storage != nullptr) {
+    storage = validateAnimatedPropertyStorage(id, storage);
+  }
+  if (storage == nullptr) {
+    storage = new AnimatedPropertyStorage();
+    storage->session_uuid = id->session_uuid;
+    storage->build_index = build_index_;
+    animated_property_storage_map_.add_new(id, storage);
+  }
+  return storage;
 }
 
 AnimatedPropertyStorage *DepsgraphBuilderCache::ensureInitializedAnimatedPropertyStorage(ID *id)
@@ -177,4 +308,103 @@ AnimatedPropertyStorage *DepsgraphBuilderCache::ensureInitializedAnimatedPropert
   return animated_property_storage;
 }
 
+void DepsgraphBuilderCache::ensureInitializedAnimatedPropertyStorages(Span<ID *> ids)
+{
+  /* Validate all storages first: removing an invalid storage requires IDs animating it to be
+   * initialized again. */
+  for (ID *id : ids) {
+    ensureAnimatedPropertyStorage(id);
+  }
+  Vector<ID *> ids_to_initialize;
+  for (ID *id : ids) {
+    if (!animated_property_storage_map_.lookup(id)->is_fully_initialized) {
+      ids_to_initialize.append(id);
+    }
+  }
+
+  /* Resolving RNA paths of F-Curves is the expensive part, it is done for every ID in parallel,
+   * collecting properties of other IDs separately. */
+  InitializeStoragesData data;
+  data.ids = ids_to_initialize;
+  data.storages.reinitialize(ids_to_initialize.size());
+  data.foreign_properties.reinitialize(ids_to_initialize.size());
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 8;
+  BLI_task_parallel_range(0, ids_to_initialize.size(), &data, initialize_storage_func, &settings);
+
+  /* Merge the results, properties of the ID might have been tagged already by other IDs. */
+  for (const int i : ids_to_initialize.index_range()) {
+    ID *id = ids_to_initialize[i];
+    AnimatedPropertyStorage *new_storage = data.storages[i];
+    AnimatedPropertyStorage *storage = ensureAnimatedPropertyStorage(id);
+    for (const AnimatedPropertyID &property_id : new_storage->animated_properties_set) {
+      storage->tagPropertyAsAnimated(property_id);
+    }
+    storage->session_uuid = new_storage->session_uuid;
+    storage->fcurves_hash = new_storage->fcurves_hash;
+    storage->is_fully_initialized = true;
+    delete new_storage;
+  }
+  for (const int i : ids_to_initialize.index_range()) {
+    addForeignAnimatedProperties(ids_to_initialize[i], data.foreign_properties[i]);
+  }
+  /* Storages of other IDs are validated when properties are added to them, which might require
+   * some IDs to be initialized again. */
+  for (ID *id : ids) {
+    ensureInitializedAnimatedPropertyStorage(id);
+  }
+}
+
+void DepsgraphBuilderCache::addForeignAnimatedProperties(
+    ID *id, Span<ForeignAnimatedProperty> foreign_properties)
+{
+  for (const ForeignAnimatedProperty &foreign_property : foreign_properties) {
+    AnimatedPropertyStorage *storage = ensureAnimatedPropertyStorage(foreign_property.first);
+    storage->animated_by_ids.add(id);
+    storage->tagPropertyAsAnimated(foreign_property.second);
+  }
+}
+
+void DepsgraphBuilderCache::invalidateAnimatedPropertyStorage(ID *id)
+{
+  BLI_mutex_lock(&invalidate_mutex_);
+  invalidated_ids_.add(id);
+  BLI_mutex_unlock(&invalidate_mutex_);
+}
+
+void DepsgraphBuilderCache::invalidateAllAnimatedPropertyStorages()
+{
+  BLI_mutex_lock(&invalidate_mutex_);
+  invalidate_all_ = true;
+  BLI_mutex_unlock(&invalidate_mutex_);
+}
+
+void DepsgraphBuilderCache::removeAnimatedPropertyStorage(ID *id)
+{
+  AnimatedPropertyStorage *storage = animated_property_storage_map_.pop_default(id, nullptr);
+  if (storage == nullptr) {
+    return;
+  }
+  /* Properties tagged by other IDs are lost, so those are to be initialized again. */
+  for (ID *animated_by_id : storage->animated_by_ids) {
+    AnimatedPropertyStorage *animated_by_storage = animated_property_storage_map_.lookup_default(
+        animated_by_id, nullptr);
+    if (animated_by_storage != nullptr) {
+      animated_by_storage->is_fully_initialized = false;
+    }
+  }
+  delete storage;
+}
+
+void DepsgraphBuilderCache::removeAllAnimatedPropertyStorages()
+{
+  for (AnimatedPropertyStorage *animated_property_storage :
+       animated_property_storage_map_.values()) {
+    delete animated_property_storage;
+  }
+  animated_property_storage_map_.clear();
+}
+
 }  // namespace blender::deg
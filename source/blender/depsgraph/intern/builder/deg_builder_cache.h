@@ -25,6 +25,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_threads.h"
+
 #include "intern/depsgraph_type.h"
 
 #include "RNA_access.h"
@@ -57,11 +59,21 @@ class AnimatedPropertyID {
   MEM_CXX_CLASS_ALLOC_FUNCS("AnimatedPropertyID");
 };
 
+/* Animated property of another ID than the one whose F-Curves are being handled. */
+typedef pair<ID *, AnimatedPropertyID> ForeignAnimatedProperty;
+
 class AnimatedPropertyStorage {
  public:
   AnimatedPropertyStorage();
 
   void initializeFromID(DepsgraphBuilderCache *builder_cache, ID *id);
+  /* Same as above, but does not access the builder cache, so it can be used from threads.
+   * Animated properties of other IDs are collected into foreign_properties. */
+  void initializeFromID(ID *id, Vector<ForeignAnimatedProperty> *foreign_properties);
+
+  /* Check whether the storage is still valid for the given ID, which might have been re-allocated
+   * or have its F-Curves modified since the storage was initialized. */
+  bool isValidForID(ID *id) const;
 
   void tagPropertyAsAnimated(const AnimatedPropertyID &property_id);
   void tagPropertyAsAnimated(const PointerRNA *pointer_rna, const PropertyRNA *property_rna);
@@ -72,22 +84,55 @@ class AnimatedPropertyStorage {
   /* The storage is fully initialized from all F-Curves from corresponding ID. */
   bool is_fully_initialized;
 
+  /* Session UUID of the ID, and hash of its F-Curves when the storage was initialized. */
+  uint session_uuid;
+  uint64_t fcurves_hash;
+
+  /* Index of the last build which used this storage (see #DepsgraphBuilderCache::beginBuild). */
+  int build_index;
+
+  /* IDs whose F-Curves animate properties of this ID. */
+  Set<ID *> animated_by_ids;
+
   /* indexed by PointerRNA.data. */
   Set<AnimatedPropertyID> animated_properties_set;
 
   MEM_CXX_CLASS_ALLOC_FUNCS("AnimatedPropertyStorage");
 };
 
-/* Cached data which can be re-used by multiple builders. */
+/* Cached data which can be re-used by multiple builders.
+ *
+ * The cache is owned by the dependency graph and is kept across its rebuilds, including the ones
+ * caused by relations updates: storages of IDs which were tagged for update are invalidated, and
+ * all others are checked to still match their ID (session UUID and F-Curves) the first time a
+ * build uses them. Storages which were not used by a build are removed.
+ *
+ * Animated properties are identified by pointers into the ID data, so the whole cache is
+ * invalidated when all IDs are re-allocated (undo reading a new Main).
+ *
+ * Only builds access the storages. Invalidation can be requested from any thread at any time,
+ * it is applied when the next build begins. */
 class DepsgraphBuilderCache {
  public:
   DepsgraphBuilderCache();
   ~DepsgraphBuilderCache();
 
+  void beginBuild();
+  void endBuild();
+
   /* Makes sure storage for animated properties exists and initialized for the given ID. */
   AnimatedPropertyStorage *ensureAnimatedPropertyStorage(ID *id);
   AnimatedPropertyStorage *ensureInitializedAnimatedPropertyStorage(ID *id);
 
+  /* Initialize storages of all given IDs, using multiple threads. */
+  void ensureInitializedAnimatedPropertyStorages(Span<ID *> ids);
+
+  /* Remove storage of the ID, IDs which animate its properties are to be initialized again.
+   * Thread safe, applied when the next build begins. */
+  void invalidateAnimatedPropertyStorage(ID *id);
+  /* Remove all storages. Thread safe, applied when the next build begins. */
+  void invalidateAllAnimatedPropertyStorages();
+
   /* Shortcuts to go through ensureInitializedAnimatedPropertyStorage and its
    * isPropertyAnimated.
    *
@@ -105,6 +150,23 @@ class DepsgraphBuilderCache {
 
   Map<ID *, AnimatedPropertyStorage *> animated_property_storage_map_;
 
+  /* Incremented for every build, storages which are used by a build are stamped with it. */
+  int build_index_;
+
+ protected:
+  /* Check the storage is valid for the current build, removes it when it is not.
+   * Returns the storage if it is still to be used. */
+  AnimatedPropertyStorage *validateAnimatedPropertyStorage(ID *id,
+                                                           AnimatedPropertyStorage *storage);
+  void addForeignAnimatedProperties(ID *id, Span<ForeignAnimatedProperty> foreign_properties);
+  void removeAnimatedPropertyStorage(ID *id);
+  void removeAllAnimatedPropertyStorages();
+
+  /* Invalidation requested since the last build began, protected by the mutex. */
+  ThreadMutex invalidate_mutex_;
+  Set<ID *> invalidated_ids_;
+  bool invalidate_all_;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("DepsgraphBuilderCache");
 };
 
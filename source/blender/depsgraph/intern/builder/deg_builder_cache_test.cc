@@ -0,0 +1,271 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include <thread>
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_appdir.h"
+#include "BKE_collection.h"
+#include "BKE_fcurve.h"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "DNA_ID.h"
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+
+#include "CLG_log.h"
+
+/* After the tests header, #BLI_threads.h defines a `ThreadLocal` macro which GTest uses too. */
+#include "intern/builder/deg_builder_cache.h"
+#include "intern/depsgraph.h"
+
+namespace blender::deg::tests {
+
+static AnimatedPropertyID test_property_id(void *data)
+{
+  AnimatedPropertyID property_id;
+  property_id.data = data;
+  return property_id;
+}
+
+static bool test_is_property_animated(DepsgraphBuilderCache &cache, ID *id)
+{
+  AnimatedPropertyStorage *storage = cache.ensureAnimatedPropertyStorage(id);
+  return storage->isPropertyAnimated(test_property_id(id));
+}
+
+static void test_build(DepsgraphBuilderCache &cache, Span<ID *> ids)
+{
+  cache.beginBuild();
+  for (ID *id : ids) {
+    cache.ensureAnimatedPropertyStorage(id)->tagPropertyAsAnimated(test_property_id(id));
+  }
+  cache.endBuild();
+}
+
+TEST(deg_builder_cache, invalidate)
+{
+  ID id_a = {nullptr};
+  ID id_b = {nullptr};
+  DepsgraphBuilderCache cache;
+  test_build(cache, {&id_a, &id_b});
+
+  /* Storages are kept across builds. */
+  cache.beginBuild();
+  EXPECT_TRUE(test_is_property_animated(cache, &id_a));
+  EXPECT_TRUE(test_is_property_animated(cache, &id_b));
+  /* Storages used by the current build stay until the next one. */
+  cache.invalidateAnimatedPropertyStorage(&id_a);
+  EXPECT_TRUE(test_is_property_animated(cache, &id_a));
+  cache.endBuild();
+
+  cache.beginBuild();
+  EXPECT_FALSE(test_is_property_animated(cache, &id_a));
+  EXPECT_TRUE(test_is_property_animated(cache, &id_b));
+  cache.endBuild();
+}
+
+TEST(deg_builder_cache, invalidate_animated_by)
+{
+  ID id_a = {nullptr};
+  ID id_b = {nullptr};
+  DepsgraphBuilderCache cache;
+
+  /* Properties of B are animated by A. */
+  cache.beginBuild();
+  cache.ensureAnimatedPropertyStorage(&id_a)->is_fully_initialized = true;
+  AnimatedPropertyStorage *storage_b = cache.ensureAnimatedPropertyStorage(&id_b);
+  storage_b->animated_by_ids.add(&id_a);
+  storage_b->tagPropertyAsAnimated(test_property_id(&id_b));
+  cache.endBuild();
+
+  /* A is to be initialized again, to tag the properties of B. */
+  cache.invalidateAnimatedPropertyStorage(&id_b);
+  cache.beginBuild();
+  EXPECT_FALSE(cache.animated_property_storage_map_.contains(&id_b));
+  EXPECT_FALSE(cache.animated_property_storage_map_.lookup(&id_a)->is_fully_initialized);
+  cache.endBuild();
+}
+
+TEST(deg_builder_cache, invalidate_all)
+{
+  ID id_a = {nullptr};
+  ID id_b = {nullptr};
+  DepsgraphBuilderCache cache;
+  test_build(cache, {&id_a, &id_b});
+
+  cache.invalidateAllAnimatedPropertyStorages();
+  cache.beginBuild();
+  EXPECT_TRUE(cache.animated_property_storage_map_.is_empty());
+  cache.endBuild();
+
+  /* Only once. */
+  test_build(cache, {&id_a, &id_b});
+  cache.beginBuild();
+  EXPECT_TRUE(test_is_property_animated(cache, &id_a));
+  EXPECT_TRUE(test_is_property_animated(cache, &id_b));
+  cache.endBuild();
+}
+
+TEST(deg_builder_cache, invalidate_threaded)
+{
+  ID ids[64];
+  Vector<ID *> id_pointers;
+  for (ID &id : ids) {
+    id = {nullptr};
+    id_pointers.append(&id);
+  }
+  DepsgraphBuilderCache cache;
+
+  /* Tagging for updates from other threads while the graph is built. */
+  std::thread invalidate_thread([&]() {
+    for (int i = 0; i < 1000; i++) {
+      for (ID *id : id_pointers) {
+        cache.invalidateAnimatedPropertyStorage(id);
+      }
+    }
+  });
+  for (int i = 0; i < 1000; i++) {
+    test_build(cache, id_pointers);
+  }
+  invalidate_thread.join();
+
+  for (ID *id : id_pointers) {
+    cache.invalidateAnimatedPropertyStorage(id);
+  }
+  cache.beginBuild();
+  EXPECT_TRUE(cache.animated_property_storage_map_.is_empty());
+  cache.endBuild();
+}
+
+class BuilderCacheGraphTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  ::Depsgraph *depsgraph = nullptr;
+  Object *object = nullptr;
+
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    /* Color management, used by the scene defaults. */
+    IMB_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestCase()
+  {
+    DEG_free_node_types();
+    IMB_exit();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  virtual void SetUp()
+  {
+    bmain = BKE_main_new();
+    Scene *scene = BKE_scene_add(bmain, "Scene");
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+
+    /* Animated location. */
+    object = BKE_object_add_only_object(bmain, OB_EMPTY, "Object");
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+    AnimData *adt = BKE_animdata_add_id(&object->id);
+    adt->action = BKE_action_add(bmain, "Action");
+    FCurve *fcurve = BKE_fcurve_create();
+    fcurve->rna_path = BLI_strdup("location");
+    BLI_addtail(&adt->action->curves, fcurve);
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  virtual void TearDown()
+  {
+    DEG_graph_free(depsgraph);
+    BKE_main_free(bmain);
+  }
+
+  AnimatedPropertyStorage *object_storage_get()
+  {
+    DepsgraphBuilderCache *cache = reinterpret_cast<Depsgraph *>(depsgraph)->builder_cache;
+    return cache->animated_property_storage_map_.lookup_default(&object->id, nullptr);
+  }
+
+  void relations_update()
+  {
+    DEG_graph_tag_relations_update(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+};
+
+TEST_F(BuilderCacheGraphTest, KeptAcrossRelationsUpdate)
+{
+  AnimatedPropertyStorage *storage = object_storage_get();
+  ASSERT_NE(storage, nullptr);
+  EXPECT_TRUE(storage->is_fully_initialized);
+  EXPECT_FALSE(storage->animated_properties_set.is_empty());
+  /* Marks the storage, which isn't initialized again. */
+  storage->tagPropertyAsAnimated(test_property_id(object));
+
+  relations_update();
+  storage = object_storage_get();
+  ASSERT_NE(storage, nullptr);
+  EXPECT_TRUE(storage->isPropertyAnimated(test_property_id(object)));
+
+  /* Tagging the ID invalidates its storage. */
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+  relations_update();
+  storage = object_storage_get();
+  ASSERT_NE(storage, nullptr);
+  EXPECT_FALSE(storage->isPropertyAnimated(test_property_id(object)));
+
+  /* Changing the F-Curves without tagging does too. */
+  storage->tagPropertyAsAnimated(test_property_id(object));
+  FCurve *fcurve = static_cast<FCurve *>(object->adt->action->curves.first);
+  fcurve->array_index = 1;
+  relations_update();
+  storage = object_storage_get();
+  ASSERT_NE(storage, nullptr);
+  EXPECT_FALSE(storage->isPropertyAnimated(test_property_id(object)));
+}
+
+}  // namespace blender::deg::tests
@@ -31,7 +31,9 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_action_types.h"
@@ -2733,10 +2735,43 @@ void DepsgraphRelationBuilder::build_scene_speakers(Scene * /*scene*/, ViewLayer
   }
 }
 
+namespace {
+
+struct CopyOnWriteRelationsData {
+  DepsgraphRelationBuilder *builder;
+  Span<IDNode *> id_nodes;
+  Array<Vector<DepsgraphRelationBuilder::PendingRelation>> relations;
+};
+
+void build_copy_on_write_relations_func(void *__restrict data_v,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict /*tls*/)
+{
+  CopyOnWriteRelationsData *data = static_cast<CopyOnWriteRelationsData *>(data_v);
+  data->builder->build_copy_on_write_relations(data->id_nodes[i], &data->relations[i]);
+}
+
+}  // namespace
+
 void DepsgraphRelationBuilder::build_copy_on_write_relations()
 {
-  for (IDNode *id_node : graph_->id_nodes) {
-    build_copy_on_write_relations(id_node);
+  /* Relations of every ID are gathered in parallel into their own buffer, and added to the graph
+   * afterwards in the order of ID nodes, so the result does not depend on threading. */
+  CopyOnWriteRelationsData data;
+  data.builder = this;
+  data.id_nodes = graph_->id_nodes;
+  data.relations.reinitialize(graph_->id_nodes.size());
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(
+      0, graph_->id_nodes.size(), &data, build_copy_on_write_relations_func, &settings);
+
+  for (Span<PendingRelation> relations : data.relations) {
+    for (const PendingRelation &relation : relations) {
+      graph_->add_new_relation(relation.from, relation.to, relation.description, relation.flags);
+    }
   }
 }
 
@@ -2769,7 +2804,8 @@ void DepsgraphRelationBuilder::build_nested_shapekey(ID *owner, Key *key)
   build_nested_datablock(owner, &key->id);
 }
 
-void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
+void DepsgraphRelationBuilder::build_copy_on_write_relations(
+    IDNode *id_node, Vector<PendingRelation> *r_relations)
 {
   ID *id_orig = id_node->id_orig;
   const ID_Type id_type = GS(id_orig->name);
@@ -2820,8 +2856,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
      * copy of ID. */
     OperationNode *op_entry = comp_node->get_entry_operation();
     if (op_entry != nullptr) {
-      Relation *rel = graph_->add_new_relation(op_cow, op_entry, "CoW Dependency");
-      rel->flag |= rel_flag;
+      r_relations->append({op_cow, op_entry, "CoW Dependency", rel_flag});
     }
     /* All dangling operations should also be executed after copy-on-write. */
     for (OperationNode *op_node : comp_node->operations_map->values()) {
@@ -2829,8 +2864,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
         continue;
       }
       if (op_node->inlinks.is_empty()) {
-        Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-        rel->flag |= rel_flag;
+        r_relations->append({op_cow, op_node, "CoW Dependency", rel_flag});
       }
       else {
         bool has_same_comp_dependency = false;
@@ -2845,8 +2879,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
           }
         }
         if (!has_same_comp_dependency) {
-          Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-          rel->flag |= rel_flag;
+          r_relations->append({op_cow, op_node, "CoW Dependency", rel_flag});
         }
       }
     }
@@ -2867,8 +2900,10 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       if (deg_copy_on_write_is_needed(object_data_id)) {
         OperationKey data_copy_on_write_key(
             object_data_id, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
-        add_relation(
-            data_copy_on_write_key, copy_on_write_key, "Eval Order", RELATION_FLAG_GODMODE);
+        OperationNode *op_data_cow = get_node(data_copy_on_write_key);
+        if (op_data_cow != nullptr) {
+          r_relations->append({op_data_cow, op_cow, "Eval Order", RELATION_FLAG_GODMODE});
+        }
       }
     }
     else {
@@ -311,8 +311,18 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
                                          bool add_absorption,
                                          const char *name);
 
+  /* Relation which is added to the graph after relations of all IDs were gathered. */
+  struct PendingRelation {
+    OperationNode *from;
+    OperationNode *to;
+    const char *description;
+    int flags;
+  };
+
   virtual void build_copy_on_write_relations();
-  virtual void build_copy_on_write_relations(IDNode *id_node);
+  /* Only reads the graph, so it can be used from multiple threads. */
+  virtual void build_copy_on_write_relations(IDNode *id_node,
+                                             Vector<PendingRelation> *r_relations);
   virtual void build_driver_relations();
   virtual void build_driver_relations(IDNode *id_node);
 
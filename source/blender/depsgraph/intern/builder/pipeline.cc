@@ -30,13 +30,16 @@
 #include "deg_builder_relations.h"
 #include "deg_builder_transitive.h"
 
+#include "intern/node/deg_node_id.h"
+
 namespace blender::deg {
 
 AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
     : deg_graph_(reinterpret_cast<Depsgraph *>(graph)),
       bmain_(deg_graph_->bmain),
       scene_(deg_graph_->scene),
-      view_layer_(deg_graph_->view_layer)
+      view_layer_(deg_graph_->view_layer),
+      builder_cache_(deg_graph_->builder_cache)
 {
 }
 
@@ -51,10 +54,12 @@ void AbstractBuilderPipeline::build()
     start_time = PIL_check_seconds_timer();
   }
 
+  builder_cache_->beginBuild();
   build_step_sanity_check();
   build_step_nodes();
   build_step_relations();
   build_step_finalize();
+  builder_cache_->endBuild();
 
   if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
     printf("Depsgraph built in %f seconds.\n", PIL_check_seconds_timer() - start_time);
@@ -79,6 +84,14 @@ void AbstractBuilderPipeline::build_step_nodes()
 
 void AbstractBuilderPipeline::build_step_relations()
 {
+  /* Initialize animated properties of all IDs at once, this can be done in parallel. */
+  Vector<ID *> ids;
+  ids.reserve(deg_graph_->id_nodes.size());
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    ids.append(id_node->id_orig);
+  }
+  builder_cache_->ensureInitializedAnimatedPropertyStorages(ids);
+
   /* Hook up relationships between operations - to determine evaluation order. */
   unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
   relation_builder->begin_build();
@@ -115,12 +128,12 @@ void AbstractBuilderPipeline::build_step_finalize()
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
 {
-  return std::make_unique<DepsgraphNodeBuilder>(bmain_, deg_graph_, &builder_cache_);
+  return std::make_unique<DepsgraphNodeBuilder>(bmain_, deg_graph_, builder_cache_);
 }
 
 unique_ptr<DepsgraphRelationBuilder> AbstractBuilderPipeline::construct_relation_builder()
 {
-  return std::make_unique<DepsgraphRelationBuilder>(bmain_, deg_graph_, &builder_cache_);
+  return std::make_unique<DepsgraphRelationBuilder>(bmain_, deg_graph_, builder_cache_);
 }
 
 }  // namespace blender::deg
@@ -59,7 +59,7 @@ class AbstractBuilderPipeline {
   Main *bmain_;
   Scene *scene_;
   ViewLayer *view_layer_;
-  DepsgraphBuilderCache builder_cache_;
+  DepsgraphBuilderCache *builder_cache_;
 
   virtual unique_ptr<DepsgraphNodeBuilder> construct_node_builder();
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder();
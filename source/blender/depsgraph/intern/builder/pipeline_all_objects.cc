@@ -64,12 +64,12 @@ AllObjectsBuilderPipeline::AllObjectsBuilderPipeline(::Depsgraph *graph)
 
 unique_ptr<DepsgraphNodeBuilder> AllObjectsBuilderPipeline::construct_node_builder()
 {
-  return std::make_unique<AllObjectsNodeBuilder>(bmain_, deg_graph_, &builder_cache_);
+  return std::make_unique<AllObjectsNodeBuilder>(bmain_, deg_graph_, builder_cache_);
 }
 
 unique_ptr<DepsgraphRelationBuilder> AllObjectsBuilderPipeline::construct_relation_builder()
 {
-  return std::make_unique<AllObjectsRelationBuilder>(bmain_, deg_graph_, &builder_cache_);
+  return std::make_unique<AllObjectsRelationBuilder>(bmain_, deg_graph_, builder_cache_);
 }
 
 }  // namespace blender::deg
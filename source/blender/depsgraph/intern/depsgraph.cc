@@ -46,6 +46,8 @@
 #include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_update.h"
 
+#include "intern/builder/deg_builder_cache.h"
+
 #include "intern/eval/deg_eval_copy_on_write.h"
 
 #include "intern/node/deg_node.h"
@@ -62,6 +64,9 @@ namespace blender::deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      is_update_state_clear(false),
+      is_partial_update(false),
+      need_clear_all_recalc(true),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
@@ -76,6 +81,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
   memset(id_type_updated, 0, sizeof(id_type_updated));
   memset(id_type_exist, 0, sizeof(id_type_exist));
   memset(physics_relations, 0, sizeof(physics_relations));
+  builder_cache = new DepsgraphBuilderCache();
 
   add_time_source();
 }
@@ -84,6 +90,7 @@ Depsgraph::~Depsgraph()
 {
   clear_id_nodes();
   delete time_source;
+  delete builder_cache;
   BLI_spin_end(&lock);
 }
 
@@ -235,6 +242,19 @@ void Depsgraph::clear_all_nodes()
   clear_id_nodes();
   delete time_source;
   time_source = nullptr;
+  is_update_state_clear = false;
+  is_partial_update = false;
+  partial_update_operations.clear();
+  need_clear_all_recalc = true;
+  recalc_id_nodes.clear();
+}
+
+Span<OperationNode *> Depsgraph::get_update_operations() const
+{
+  if (is_partial_update) {
+    return partial_update_operations;
+  }
+  return operations;
 }
 
 ID *Depsgraph::get_cow_id(const ID *id_orig) const
@@ -289,6 +309,10 @@ void DEG_graph_replace_owners(struct Depsgraph *depsgraph,
   if (do_update_register && deg_graph->bmain != nullptr) {
     deg::unregister_graph(deg_graph);
   }
+  if (do_update_register) {
+    /* IDs of the new #Main might be allocated where other IDs used to be (undo). */
+    deg_graph->builder_cache->invalidateAllAnimatedPropertyStorages();
+  }
 
   deg_graph->bmain = bmain;
   deg_graph->scene = scene;
@@ -52,6 +52,7 @@ struct ViewLayer;
 namespace blender {
 namespace deg {
 
+class DepsgraphBuilderCache;
 struct IDNode;
 struct Node;
 struct OperationNode;
@@ -88,6 +89,10 @@ struct Depsgraph {
   /* Clear storage used by all nodes. */
   void clear_all_nodes();
 
+  /* Operations which are to be visited by the evaluation of the current update: only the ones
+   * reached by the flush of a partial update, all operations otherwise. */
+  Span<OperationNode *> get_update_operations() const;
+
   /* Copy-on-Write Functionality ........ */
 
   /* For given original ID get ID which is created by CoW system. */
@@ -121,6 +126,22 @@ struct Depsgraph {
   /* Nodes which have been tagged as "directly modified". */
   Set<OperationNode *> entry_tags;
 
+  /* Update state of all nodes (`scheduled` of operations, `custom_flags` of ID and component
+   * nodes) is known to be cleared, so the flush only needs to reset nodes it modified itself.
+   * Nodes created by the builder have no known state. */
+  bool is_update_state_clear;
+
+  /* All entry tags only affect object transforms, and the update is limited to the operations
+   * the flush has reached (see #deg_graph_flush_updates). */
+  bool is_partial_update;
+  OperationNodes partial_update_operations;
+
+  /* ID nodes which were tagged or reached by a flush since their recalc flags were last cleared.
+   * Only gathered while all updates in between are partial, otherwise the recalc flags of all
+   * ID nodes are cleared (see #DEG_ids_clear_recalc). */
+  bool need_clear_all_recalc;
+  Set<IDNode *> recalc_id_nodes;
+
   /* Convenience Data ................... */
 
   /* XXX: should be collected after building (if actually needed?) */
@@ -167,6 +188,9 @@ struct Depsgraph {
    * created along with relations, for fast lookup during evaluation. */
   Map<const ID *, ListBase *> *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
 
+  /* Data cached by the builder, kept across rebuilds of the relations. */
+  DepsgraphBuilderCache *builder_cache;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("Depsgraph");
 };
 
@@ -38,6 +38,7 @@
 #include "DNA_simulation_types.h"
 
 #include "BKE_main.h"
+#include "BKE_playback_prefetch.h"
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
@@ -258,6 +259,8 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg_graph->need_update = true;
+  /* NOTE: The builder cache is kept: IDs whose data was re-allocated are tagged for update
+   * themselves, other storages are validated when the next build uses them. */
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -285,6 +288,7 @@ void DEG_graph_relations_update(Depsgraph *graph)
 void DEG_relations_tag_update(Main *bmain)
 {
   DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations for update.\n", __func__);
+  BKE_playback_prefetch_tag_update(bmain, 0);
   for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
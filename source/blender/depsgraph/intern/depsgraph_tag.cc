@@ -47,6 +47,7 @@
 #include "BKE_global.h"
 #include "BKE_idtype.h"
 #include "BKE_node.h"
+#include "BKE_playback_prefetch.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
 #include "BKE_workspace.h"
@@ -56,6 +57,7 @@
 #include "DEG_depsgraph_query.h"
 
 #include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_cache.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_registry.h"
 #include "intern/depsgraph_update.h"
@@ -610,6 +612,7 @@ NodeType geometry_tag_to_component(const ID *id)
 void id_tag_update(Main *bmain, ID *id, int flag, eUpdateSource update_source)
 {
   graph_id_tag_update(bmain, nullptr, id, flag, update_source);
+  BKE_playback_prefetch_tag_update(bmain, flag);
   for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
     graph_id_tag_update(bmain, depsgraph, id, flag, update_source);
   }
@@ -637,8 +640,16 @@ void graph_id_tag_update(
            update_source_as_string(update_source));
   }
   IDNode *id_node = (graph != nullptr) ? graph->find_id_node(id) : nullptr;
+  if (id_node != nullptr && !graph->need_clear_all_recalc) {
+    graph->recalc_id_nodes.add(id_node);
+  }
   if (graph != nullptr) {
     DEG_graph_id_type_tag(reinterpret_cast<::Depsgraph *>(graph), GS(id->name));
+    /* Properties which are animated might not resolve to the same data anymore. Tags coming from
+     * the graph itself (relations and visibility updates) don't change the data. */
+    if (update_source == DEG_UPDATE_SOURCE_USER_EDIT) {
+      graph->builder_cache->invalidateAnimatedPropertyStorage(id);
+    }
   }
   if (flag == 0) {
     deg_graph_node_tag_zero(bmain, graph, id_node, update_source);
@@ -838,6 +849,18 @@ static void deg_graph_clear_id_recalc_flags(ID *id)
   /* XXX And what about scene's master collection here? */
 }
 
+static void deg_graph_clear_id_node_recalc_flags(deg::Depsgraph *deg_graph, deg::IDNode *id_node)
+{
+  /* TODO: we clear original ID recalc flags here, but this may not work
+   * correctly when there are multiple depsgraph with others still using
+   * the recalc flag. */
+  id_node->is_user_modified = false;
+  deg_graph_clear_id_recalc_flags(id_node->id_cow);
+  if (deg_graph->is_active) {
+    deg_graph_clear_id_recalc_flags(id_node->id_orig);
+  }
+}
+
 void DEG_ids_clear_recalc(Main *UNUSED(bmain), Depsgraph *depsgraph)
 {
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(depsgraph);
@@ -846,16 +869,19 @@ void DEG_ids_clear_recalc(Main *UNUSED(bmain), Depsgraph *depsgraph)
   if (!DEG_id_type_any_updated(depsgraph)) {
     return;
   }
-  /* Go over all ID nodes nodes, clearing tags. */
-  for (deg::IDNode *id_node : deg_graph->id_nodes) {
-    /* TODO: we clear original ID recalc flags here, but this may not work
-     * correctly when there are multiple depsgraph with others still using
-     * the recalc flag. */
-    id_node->is_user_modified = false;
-    deg_graph_clear_id_recalc_flags(id_node->id_cow);
-    if (deg_graph->is_active) {
-      deg_graph_clear_id_recalc_flags(id_node->id_orig);
+  /* Go over the ID nodes which can have recalc flags set, clearing tags. After partial updates
+   * these are only the tagged ID nodes and the ones reached by the flush. */
+  if (deg_graph->need_clear_all_recalc) {
+    for (deg::IDNode *id_node : deg_graph->id_nodes) {
+      deg_graph_clear_id_node_recalc_flags(deg_graph, id_node);
+    }
+  }
+  else {
+    for (deg::IDNode *id_node : deg_graph->recalc_id_nodes) {
+      deg_graph_clear_id_node_recalc_flags(deg_graph, id_node);
     }
   }
+  deg_graph->need_clear_all_recalc = false;
+  deg_graph->recalc_id_nodes.clear();
   memset(deg_graph->id_type_updated, 0, sizeof(deg_graph->id_type_updated));
 }
@@ -25,12 +25,18 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
+#include "BLI_profile.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -68,10 +74,7 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool);
 
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
@@ -95,6 +98,11 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+
+  /* Operations which are ready to be evaluated by the task pool, ordered by their critical path
+   * time (longest first). */
+  Heap *ready_operations;
+  SpinLock ready_operations_lock;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -103,31 +111,43 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
-  if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
-  }
-  else {
-    operation_node->evaluate(depsgraph);
-  }
+  BLI_PROFILE_SCOPE(operationCodeAsString(operation_node->opcode));
+  /* Perform operation, the timing is always gathered since it's used for scheduling. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
+  /* Every task evaluates one operation, not necessarily the one it was pushed for:
+   * the ready operation with the longest critical path is evaluated first. */
+  BLI_spin_lock(&state->ready_operations_lock);
+  OperationNode *operation_node = (OperationNode *)BLI_heap_pop_min(state->ready_operations);
+  BLI_spin_unlock(&state->ready_operations_lock);
+
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
   schedule_children(state, operation_node, schedule_node_to_pool, pool);
 }
 
-bool check_operation_node_visible(OperationNode *op_node)
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_heap_insert(state->ready_operations, -node->critical_path_time, node);
+  BLI_spin_unlock(&state->ready_operations_lock);
+
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+bool check_operation_node_visible(const OperationNode *op_node)
 {
   const ComponentNode *comp_node = op_node->owner;
   /* Special exception, copy on write component is to be always evaluated,
@@ -172,20 +192,89 @@ void calculate_pending_parents_for_node(OperationNode *node)
 
 void calculate_pending_parents(Depsgraph *graph)
 {
-  for (OperationNode *node : graph->operations) {
+  for (OperationNode *node : graph->get_update_operations()) {
     calculate_pending_parents_for_node(node);
   }
 }
 
-void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
+bool need_evaluate_operation(const OperationNode *node)
+{
+  return check_operation_node_visible(node) && (node->flag & DEPSOP_FLAG_NEEDS_UPDATE);
+}
+
+/* Estimated cost of an operation, a small constant is added so that long chains of operations
+ * are favored even when their timing is unknown. */
+float operation_cost_estimate(const OperationNode *node)
+{
+  if (node->is_noop()) {
+    return 0.0f;
+  }
+  return (float)node->stats.average_time + 1e-6f;
+}
+
+/* Calculate #OperationNode.critical_path_time of all operations which need to be evaluated,
+ * visiting them in reverse topological order with a depth first traversal. */
+void calculate_critical_path_times(Depsgraph *graph)
+{
+  enum { OP_UNVISITED = 0, OP_VISITING = 1, OP_DONE = 2 };
+  struct StackEntry {
+    OperationNode *node;
+    int64_t outlink_index;
+  };
+
+  const Span<OperationNode *> operations = graph->get_update_operations();
+  for (OperationNode *node : operations) {
+    node->custom_flags = OP_UNVISITED;
+    node->critical_path_time = 0.0f;
+  }
+
+  Vector<StackEntry> stack;
+  for (OperationNode *root : operations) {
+    if (root->custom_flags != OP_UNVISITED || !need_evaluate_operation(root)) {
+      continue;
+    }
+    root->custom_flags = OP_VISITING;
+    stack.append({root, 0});
+
+    while (!stack.is_empty()) {
+      StackEntry &entry = stack.last();
+      OperationNode *node = entry.node;
+
+      if (entry.outlink_index < node->outlinks.size()) {
+        Relation *rel = node->outlinks[entry.outlink_index++];
+        OperationNode *child = (OperationNode *)rel->to;
+        if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && child->custom_flags == OP_UNVISITED &&
+            need_evaluate_operation(child)) {
+          child->custom_flags = OP_VISITING;
+          stack.append({child, 0});
+        }
+        continue;
+      }
+
+      /* Only children which are evaluated have their time calculated, the others might have a
+       * time left from a previous update. */
+      float children_time = 0.0f;
+      for (Relation *rel : node->outlinks) {
+        if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 &&
+            need_evaluate_operation((const OperationNode *)rel->to)) {
+          const OperationNode *child = (const OperationNode *)rel->to;
+          children_time = std::max(children_time, child->critical_path_time);
+        }
+      }
+      node->critical_path_time = operation_cost_estimate(node) + children_time;
+      node->custom_flags = OP_DONE;
+      stack.remove_last();
+    }
+  }
+}
+
+void initialize_execution(DepsgraphEvalState *UNUSED(state), Depsgraph *graph)
 {
-  const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  calculate_critical_path_times(graph);
   /* Clear tags and other things which needs to be clear. */
-  for (OperationNode *node : graph->operations) {
-    if (do_stats) {
-      node->stats.reset_current();
-    }
+  for (OperationNode *node : graph->get_update_operations()) {
+    node->stats.reset_current();
   }
 }
 
@@ -280,7 +369,7 @@ void schedule_graph(DepsgraphEvalState *state,
                     ScheduleFunction *schedule_function,
                     ScheduleFunctionArgs... schedule_function_args)
 {
-  for (OperationNode *node : state->graph->operations) {
+  for (OperationNode *node : state->graph->get_update_operations()) {
     schedule_node(state, node, false, schedule_function, schedule_function_args...);
   }
 }
@@ -349,6 +438,8 @@ void depsgraph_ensure_view_layer(Depsgraph *graph)
 
 static TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
 {
+  BLI_assert(BLI_heap_is_empty(state->ready_operations));
+
   if (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) {
     return BLI_task_pool_create_no_threads(state);
   }
@@ -370,6 +461,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     return;
   }
 
+  BLI_PROFILE_SCOPE("depsgraph_evaluate");
   graph->debug.begin_graph_evaluation();
 
   graph->is_evaluating = true;
@@ -379,8 +471,11 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.ready_operations = BLI_heap_new();
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
+  const double start_time = state.do_stats ? PIL_check_seconds_timer() : 0.0;
 
   /* Do actual evaluation now. */
   /* First, process all Copy-On-Write nodes. */
@@ -402,12 +497,17 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     evaluate_graph_single_threaded(&state);
   }
 
+  BLI_heap_free(state.ready_operations, nullptr);
+  BLI_spin_end(&state.ready_operations_lock);
+
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
+    deg_eval_stats_print_parallelism(graph, PIL_check_seconds_timer() - start_time);
   }
+  deg_eval_stats_update_average(graph);
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
@@ -301,10 +301,14 @@ bool id_copy_inplace_no_main(const ID *id, ID *newid)
   id_for_copy = nested_id_hack_get_discarded_pointers(&id_hack_storage, id);
 #endif
 
+  /* Geometry arrays are shared with the original data-block, evaluation only copies the ones it
+   * modifies. Code writing to the original in-place makes its layers mutable first, see
+   * #BKE_mesh_duplicate_referenced_layers. */
   bool result = (BKE_id_copy_ex(nullptr,
                                 (ID *)id_for_copy,
                                 &newid,
-                                LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE) != nullptr);
+                                LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE |
+                                    LIB_ID_COPY_CD_REFERENCE) != nullptr);
 
 #ifdef NESTED_ID_NASTY_WORKAROUND
   if (result) {
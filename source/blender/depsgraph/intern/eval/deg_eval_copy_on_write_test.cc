@@ -0,0 +1,197 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include "BKE_appdir.h"
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "BLI_threads.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "IMB_imbuf.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "CLG_log.h"
+
+namespace blender::deg::tests {
+
+#define TOTVERT 4
+
+class CopyOnWriteTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Depsgraph *depsgraph = nullptr;
+  Mesh *mesh = nullptr;
+  Object *object = nullptr;
+
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    /* Color management, used by the scene defaults. */
+    IMB_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestCase()
+  {
+    DEG_free_node_types();
+    IMB_exit();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  virtual void SetUp()
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+
+    mesh = BKE_mesh_add(bmain, "Mesh");
+    mesh->totvert = TOTVERT;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, TOTVERT);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+
+    object = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    object->data = mesh;
+    id_us_plus(&mesh->id);
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  virtual void TearDown()
+  {
+    if (depsgraph) {
+      DEG_graph_free(depsgraph);
+    }
+    BKE_main_free(bmain);
+  }
+
+  Mesh *mesh_eval_get()
+  {
+    return reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+  }
+};
+
+TEST_F(CopyOnWriteTest, EditOriginalAfterEvaluation)
+{
+  Mesh *mesh_eval = mesh_eval_get();
+  ASSERT_NE(mesh_eval, mesh);
+  ASSERT_EQ(mesh_eval->totvert, TOTVERT);
+  /* The evaluated copy shares the layers of the original. */
+  EXPECT_EQ(mesh_eval->mvert, mesh->mvert);
+
+  /* Tools writing to the original in-place make its layers mutable first. The evaluated copy
+   * must not see the writes before it's updated. */
+  BKE_mesh_duplicate_referenced_layers(mesh);
+  EXPECT_NE(mesh_eval->mvert, mesh->mvert);
+  for (int i = 0; i < TOTVERT; i++) {
+    mesh->mvert[i].co[0] = float(i + 1);
+  }
+  for (int i = 0; i < TOTVERT; i++) {
+    EXPECT_EQ(mesh_eval->mvert[i].co[0], 0.0f);
+  }
+
+  /* Until it's tagged for an update. */
+  DEG_id_tag_update_ex(bmain, &mesh->id, ID_RECALC_GEOMETRY);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+  mesh_eval = mesh_eval_get();
+  EXPECT_EQ(mesh_eval->mvert, mesh->mvert);
+  for (int i = 0; i < TOTVERT; i++) {
+    EXPECT_EQ(mesh_eval->mvert[i].co[0], float(i + 1));
+  }
+}
+
+TEST_F(CopyOnWriteTest, OriginalOutlivesEvaluation)
+{
+  /* Copying the layers of the original doesn't free the ones still used by the evaluated copy,
+   * and the original doesn't copy layers it's the only user of anymore. */
+  Mesh *mesh_eval = mesh_eval_get();
+  MVert *mvert_eval = mesh_eval->mvert;
+  BKE_mesh_duplicate_referenced_layers(mesh);
+  MVert *mvert = mesh->mvert;
+  EXPECT_EQ(mesh_eval->mvert, mvert_eval);
+
+  DEG_graph_free(depsgraph);
+  depsgraph = nullptr;
+  BKE_mesh_duplicate_referenced_layers(mesh);
+  EXPECT_EQ(mesh->mvert, mvert);
+}
+
+TEST_F(CopyOnWriteTest, ClearRecalcAfterTransformUpdate)
+{
+  /* Moving an object only visits part of the graph, its recalc flags are still cleared. */
+  DEG_make_active(depsgraph);
+  for (int i = 0; i < 2; i++) {
+    object->loc[0] += 1.0f;
+    DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+    EXPECT_NE(object->id.recalc & ID_RECALC_TRANSFORM, 0);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+    Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+    EXPECT_EQ(object_eval->loc[0], object->loc[0]);
+    EXPECT_EQ(object_eval->id.recalc & ID_RECALC_ALL, 0);
+    EXPECT_EQ(object->id.recalc & ID_RECALC_ALL, 0);
+  }
+}
+
+TEST_F(CopyOnWriteTest, ShareEvaluated)
+{
+  /* Copies of evaluated data are only modified after making the layers mutable, they share them
+   * with the evaluated data-block. */
+  Mesh *mesh_eval = mesh_eval_get();
+  Mesh *mesh_copy = BKE_mesh_copy_for_eval(mesh_eval, true);
+  EXPECT_EQ(mesh_copy->mvert, mesh_eval->mvert);
+
+  MVert *mvert = static_cast<MVert *>(
+      CustomData_duplicate_referenced_layer(&mesh_copy->vdata, CD_MVERT, TOTVERT));
+  BKE_mesh_update_customdata_pointers(mesh_copy, false);
+  EXPECT_NE(mvert, mesh_eval->mvert);
+  EXPECT_EQ(mesh_copy->mvert, mvert);
+
+  mesh_copy->mvert[0].co[0] = 1.0f;
+  EXPECT_EQ(mesh_eval->mvert[0].co[0], 0.0f);
+  BKE_id_free(nullptr, mesh_copy);
+}
+
+}  // namespace blender::deg::tests
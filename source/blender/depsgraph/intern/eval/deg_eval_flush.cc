@@ -83,6 +83,7 @@ enum {
 };
 
 typedef deque<OperationNode *> FlushQueue;
+typedef Vector<IDNode *> FlushIDNodes;
 
 namespace {
 
@@ -113,6 +114,24 @@ inline void flush_prepare(Depsgraph *graph)
   }
 }
 
+/* Check whether all tagged operations only affect object transforms. Tagging the transform also
+ * tags the copy-on-write component of the object, which does not flush to other components. */
+bool flush_is_transform_only_update(const Depsgraph *graph)
+{
+  for (const OperationNode *op_node : graph->entry_tags) {
+    const ComponentNode *comp_node = op_node->owner;
+    if (comp_node->type == NodeType::TRANSFORM) {
+      continue;
+    }
+    if (comp_node->type == NodeType::COPY_ON_WRITE &&
+        GS(comp_node->owner->id_orig->name) == ID_OB) {
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
 inline void flush_schedule_entrypoints(Depsgraph *graph, FlushQueue *queue)
 {
   for (OperationNode *op_node : graph->entry_tags) {
@@ -125,9 +144,13 @@ inline void flush_schedule_entrypoints(Depsgraph *graph, FlushQueue *queue)
   }
 }
 
-inline void flush_handle_id_node(IDNode *id_node)
+inline void flush_handle_id_node(IDNode *id_node, FlushIDNodes *modified_id_nodes)
 {
+  if (id_node->custom_flags == ID_STATE_MODIFIED) {
+    return;
+  }
   id_node->custom_flags = ID_STATE_MODIFIED;
+  modified_id_nodes->append(id_node);
 }
 
 /* TODO(sergey): We can reduce number of arguments here. */
@@ -217,12 +240,11 @@ void flush_engine_data_update(ID *id)
 }
 
 /* NOTE: It will also accumulate flags from changed components. */
-void flush_editors_id_update(Depsgraph *graph, const DEGEditorUpdateContext *update_ctx)
+void flush_editors_id_update(Depsgraph *graph,
+                             const FlushIDNodes &modified_id_nodes,
+                             const DEGEditorUpdateContext *update_ctx)
 {
-  for (IDNode *id_node : graph->id_nodes) {
-    if (id_node->custom_flags != ID_STATE_MODIFIED) {
-      continue;
-    }
+  for (IDNode *id_node : modified_id_nodes) {
     DEG_graph_id_type_tag(reinterpret_cast<::Depsgraph *>(graph), GS(id_node->id_orig->name));
     /* TODO(sergey): Do we need to pass original or evaluated ID here? */
     ID *id_orig = id_node->id_orig;
@@ -344,6 +366,36 @@ void invalidate_tagged_evaluated_data(Depsgraph *graph)
 #endif
 }
 
+/* Reset the flush state of the modified nodes, so the next flush does not need to reset the
+ * whole graph. Operations of a partial update are gathered here as well. */
+void flush_finalize(Depsgraph *graph, const FlushIDNodes &modified_id_nodes)
+{
+  if (!graph->is_partial_update) {
+    graph->need_clear_all_recalc = true;
+  }
+  for (IDNode *id_node : modified_id_nodes) {
+    id_node->custom_flags = ID_STATE_NONE;
+    if (!graph->need_clear_all_recalc) {
+      graph->recalc_id_nodes.add(id_node);
+    }
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      if (comp_node->custom_flags == COMPONENT_STATE_NONE) {
+        continue;
+      }
+      comp_node->custom_flags = COMPONENT_STATE_NONE;
+      /* Every operation which was scheduled or tagged by the flush belongs to a handled
+       * component. */
+      for (OperationNode *op_node : comp_node->operations) {
+        op_node->scheduled = false;
+        if (graph->is_partial_update) {
+          graph->partial_update_operations.append(op_node);
+        }
+      }
+    }
+  }
+  graph->is_update_state_clear = true;
+}
+
 }  // namespace
 
 /* Flush updates from tagged nodes outwards until all affected nodes
@@ -361,8 +413,18 @@ void deg_graph_flush_updates(Depsgraph *graph)
   if (graph->entry_tags.is_empty()) {
     return;
   }
-  /* Reset all flags, get ready for the flush. */
-  flush_prepare(graph);
+  /* Moving objects around does not need to visit the whole graph, neither for the flush nor
+   * for the evaluation. Statistics are gathered for all operations, so don't use partial update
+   * when they are requested. */
+  graph->is_partial_update = graph->is_update_state_clear &&
+                             !graph->debug.do_time_debug() &&
+                             flush_is_transform_only_update(graph);
+  graph->partial_update_operations.clear();
+  /* Reset all flags, get ready for the flush. Not needed when the previous flush and evaluation
+   * did reset the nodes they modified. */
+  if (!graph->is_update_state_clear) {
+    flush_prepare(graph);
+  }
   /* Starting from the tagged "entry" nodes, flush outwards. */
   FlushQueue queue;
   flush_schedule_entrypoints(graph, &queue);
@@ -372,6 +434,7 @@ void deg_graph_flush_updates(Depsgraph *graph)
   update_ctx.depsgraph = (::Depsgraph *)graph;
   update_ctx.scene = graph->scene;
   update_ctx.view_layer = graph->view_layer;
+  FlushIDNodes modified_id_nodes;
   /* Do actual flush. */
   while (!queue.empty()) {
     OperationNode *op_node = queue.front();
@@ -382,29 +445,39 @@ void deg_graph_flush_updates(Depsgraph *graph)
       /* Inform corresponding ID and component nodes about the change. */
       ComponentNode *comp_node = op_node->owner;
       IDNode *id_node = comp_node->owner;
-      flush_handle_id_node(id_node);
+      flush_handle_id_node(id_node, &modified_id_nodes);
       flush_handle_component_node(id_node, comp_node, &queue);
       /* Flush to nodes along links. */
       op_node = flush_schedule_children(op_node, &queue);
     }
   }
   /* Inform editors about all changes. */
-  flush_editors_id_update(graph, &update_ctx);
+  flush_editors_id_update(graph, modified_id_nodes, &update_ctx);
   /* Reset evaluation result tagged which is tagged for update to some state
    * which is obvious to catch. */
   invalidate_tagged_evaluated_data(graph);
+  flush_finalize(graph, modified_id_nodes);
 }
 
-/* Clear tags from all operation nodes. */
+/* Clear tags from all operation nodes which were visited by the update. */
 void deg_graph_clear_tags(Depsgraph *graph)
 {
   /* Go over all operation nodes, clearing tags. */
-  for (OperationNode *node : graph->operations) {
+  for (OperationNode *node : graph->get_update_operations()) {
+    node->flag &= ~(DEPSOP_FLAG_DIRECTLY_MODIFIED | DEPSOP_FLAG_NEEDS_UPDATE |
+                    DEPSOP_FLAG_USER_MODIFIED);
+    node->scheduled = false;
+  }
+  /* Clear any entry tags which haven't been flushed. Those are outside of the operations of a
+   * partial update when they were tagged during evaluation. */
+  for (OperationNode *node : graph->entry_tags) {
     node->flag &= ~(DEPSOP_FLAG_DIRECTLY_MODIFIED | DEPSOP_FLAG_NEEDS_UPDATE |
                     DEPSOP_FLAG_USER_MODIFIED);
+    node->scheduled = false;
   }
-  /* Clear any entry tags which haven't been flushed. */
   graph->entry_tags.clear();
+  graph->is_partial_update = false;
+  graph->partial_update_operations.clear();
 
   graph->time_source->tagged_for_update = false;
 }
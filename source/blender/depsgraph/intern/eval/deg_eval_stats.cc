@@ -23,6 +23,10 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include <cstdio>
+
+#include "BLI_math_base.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "intern/depsgraph.h"
@@ -54,4 +58,40 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_update_average(Depsgraph *graph)
+{
+  for (OperationNode *op_node : graph->get_update_operations()) {
+    if (op_node->scheduled && !op_node->is_noop() &&
+        (op_node->flag & DEPSOP_FLAG_NEEDS_UPDATE)) {
+      op_node->stats.update_average();
+    }
+  }
+}
+
+void deg_eval_stats_print_parallelism(Depsgraph *graph, double evaluation_time)
+{
+  int num_operations = 0;
+  double work_time = 0.0;
+  float critical_path_time = 0.0f;
+  for (OperationNode *op_node : graph->operations) {
+    if (op_node->stats.current_time != 0.0) {
+      num_operations++;
+      work_time += op_node->stats.current_time;
+    }
+    critical_path_time = max_ff(critical_path_time, op_node->critical_path_time);
+  }
+
+  printf("Depsgraph evaluated %d operations using %d threads.\n",
+         num_operations,
+         BLI_system_thread_count());
+  printf("  Work time: %f seconds, critical path (estimated): %f seconds.\n",
+         work_time,
+         critical_path_time);
+  /* The achieved parallelism is limited by the number of threads and by the critical path
+   * (the evaluation can not finish before the longest chain of operations is evaluated). */
+  printf("  Parallelism: %.2f achieved, %.2f available.\n",
+         (evaluation_time > 0.0) ? work_time / evaluation_time : 0.0,
+         (critical_path_time > 0.0f) ? work_time / critical_path_time : 0.0);
+}
+
 }  // namespace blender::deg
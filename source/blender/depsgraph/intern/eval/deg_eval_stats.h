@@ -31,5 +31,12 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Fold operation timings of the current evaluation into their average timing,
+ * which is used to schedule the next evaluations. */
+void deg_eval_stats_update_average(Depsgraph *graph);
+
+/* Print how much of the evaluation ran in parallel. */
+void deg_eval_stats_print_parallelism(Depsgraph *graph, double evaluation_time);
+
 }  // namespace deg
 }  // namespace blender
@@ -278,6 +278,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -285,6 +286,18 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::update_average()
+{
+  /* Weight of the current evaluation, high enough to follow changes of the scene quickly. */
+  const double weight = 0.25;
+  if (average_time == 0.0) {
+    average_time = current_time;
+  }
+  else {
+    average_time += (current_time - average_time) * weight;
+  }
+}
+
 /*******************************************************************************
  * Node itself.
  */
@@ -161,8 +161,13 @@ struct Node {
     /* Reset counters needed for the current graph evaluation, does not
      * touch averaging accumulators. */
     void reset_current();
+    /* Fold the time of the current graph evaluation into the average time. */
+    void update_average();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Exponential moving average of the time spent on this node, over the evaluations which
+     * evaluated it. Used to schedule operations on the critical path first. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
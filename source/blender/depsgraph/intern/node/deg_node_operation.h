@@ -266,6 +266,11 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time to evaluate this operation and the longest chain of operations which depend
+   * on it, based on previous evaluations. Ready operations with the longest critical path are
+   * evaluated first. */
+  float critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
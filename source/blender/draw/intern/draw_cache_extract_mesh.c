@@ -32,6 +32,7 @@
 #include "BLI_jitter_2d.h"
 #include "BLI_math_bits.h"
 #include "BLI_math_vector.h"
+#include "BLI_profile.h"
 #include "BLI_string.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -5390,6 +5391,7 @@ static void extract_init(ExtractTaskData *data)
 static void extract_run(void *__restrict taskdata)
 {
   ExtractTaskData *data = (ExtractTaskData *)taskdata;
+  BLI_PROFILE_BEGIN(extract_run);
   if (data->tasktype == EXTRACT_MESH_EXTRACT) {
     mesh_extract_iter(data->mr,
                       data->iter_type,
@@ -5407,6 +5409,7 @@ static void extract_run(void *__restrict taskdata)
   else if (data->tasktype == EXTRACT_LINES_LOOSE) {
     extract_lines_loose_subbuffer(data->mr, data->cache);
   }
+  BLI_PROFILE_END(extract_run, "mesh_extract");
 }
 
 static void extract_init_and_run(void *__restrict taskdata)
@@ -5441,8 +5444,10 @@ static void mesh_extract_render_data_node_exec(void *__restrict task_data)
   const eMRIterType iter_type = update_task_data->iter_type;
   const eMRDataType data_flag = update_task_data->data_flag;
 
+  BLI_PROFILE_BEGIN(render_data_update);
   mesh_render_data_update_normals(mr, iter_type, data_flag);
   mesh_render_data_update_looptris(mr, iter_type, data_flag);
+  BLI_PROFILE_END(render_data_update, "mesh_render_data_update");
 }
 
 static struct TaskNode *mesh_extract_render_data_node_create(struct TaskGraph *task_graph,
@@ -41,6 +41,7 @@
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_playback_prefetch.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
 #include "BKE_sound.h"
@@ -1469,6 +1470,7 @@ void ED_screen_animation_timer(bContext *C, int redraws, int sync, int enable)
   if (stopscreen) {
     WM_event_remove_timer(wm, win, stopscreen->animtimer);
     stopscreen->animtimer = NULL;
+    BKE_playback_prefetch_stop(NULL);
   }
 
   if (enable) {
@@ -55,6 +55,7 @@
 #include "BKE_main.h"
 #include "BKE_mask.h"
 #include "BKE_object.h"
+#include "BKE_playback_prefetch.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -4539,6 +4540,8 @@ static int screen_animation_step_invoke(bContext *C, wmOperator *UNUSED(op), con
 
   /* since we follow drawflags, we can't send notifier but tag regions ourselves */
   if (depsgraph != NULL) {
+    BKE_playback_prefetch_update(
+        bmain, scene, view_layer, (sad->flag & ANIMPLAY_FLAG_REVERSE) != 0);
     ED_update_for_newframe(bmain, depsgraph);
   }
 
@@ -1468,6 +1468,9 @@ static void node_composit_buts_blur(uiLayout *layout, bContext *UNUSED(C), Point
     uiItemR(col, ptr, "use_variable_size", DEFAULT_FLAGS, NULL, ICON_NONE);
     if (!reference) {
       uiItemR(col, ptr, "use_bokeh", DEFAULT_FLAGS, NULL, ICON_NONE);
+      if (RNA_boolean_get(ptr, "use_bokeh")) {
+        uiItemR(col, ptr, "use_fast_approximation", DEFAULT_FLAGS, NULL, ICON_NONE);
+      }
     }
     uiItemR(col, ptr, "use_gamma_correction", DEFAULT_FLAGS, NULL, ICON_NONE);
   }
@@ -1547,6 +1550,7 @@ static void node_composit_buts_defocus(uiLayout *layout, bContext *C, PointerRNA
 
   col = uiLayoutColumn(layout, false);
   uiItemR(col, ptr, "use_preview", DEFAULT_FLAGS, NULL, ICON_NONE);
+  uiItemR(col, ptr, "use_fast_approximation", DEFAULT_FLAGS, NULL, ICON_NONE);
 
   uiTemplateID(layout, C, ptr, "scene", NULL, NULL, NULL, UI_TEMPLATE_ID_FILTER_ALL, false, NULL);
 
@@ -2376,6 +2380,7 @@ static void node_composit_buts_bokehblur(uiLayout *layout, bContext *UNUSED(C),
   // uiItemR(layout, ptr, "f_stop", DEFAULT_FLAGS, NULL, ICON_NONE); /* UNUSED */
   uiItemR(layout, ptr, "blur_max", DEFAULT_FLAGS, NULL, ICON_NONE);
   uiItemR(layout, ptr, "use_extended_bounds", DEFAULT_FLAGS, NULL, ICON_NONE);
+  uiItemR(layout, ptr, "use_fast_approximation", DEFAULT_FLAGS, NULL, ICON_NONE);
 }
 
 static void node_composit_backdrop_viewer(
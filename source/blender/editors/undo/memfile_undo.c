@@ -266,6 +266,10 @@ static void memfile_undosys_step_free(UndoStep *us_p)
     if (us_next_p != NULL) {
       MemFileUndoStep *us_next = (MemFileUndoStep *)us_next_p;
       BLO_memfile_merge(&us->data->memfile, &us_next->data->memfile);
+      /* The next step now accounts for the buffers it shared with this one. */
+      us_next->data->undo_size = us_next->data->memfile.size;
+      us_next->data->undo_size_shared = us_next->data->memfile.size_shared;
+      us_next_p->data_size = us_next->data->undo_size;
     }
   }
 
@@ -31,6 +31,8 @@
 extern "C" {
 #endif
 
+struct CustomDataSharingInfo;
+
 /** Descriptor and storage for a custom data layer. */
 typedef struct CustomDataLayer {
   /** Type of data in layer. */
@@ -53,6 +55,11 @@ typedef struct CustomDataLayer {
   char name[64];
   /** Layer data. */
   void *data;
+  /**
+   * Run-time reference count of `data` when it is shared with layers of other #CustomData
+   * (see #CD_SHARE), NULL when the layer is the only user of its data.
+   */
+  struct CustomDataSharingInfo *sharing_info;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
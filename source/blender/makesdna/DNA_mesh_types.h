@@ -97,6 +97,12 @@ typedef struct Mesh_Runtime {
   int64_t cd_dirty_loop;
   int64_t cd_dirty_poly;
 
+  /**
+   * Identifies the data of an evaluated mesh used as input of the modifier stack, so the modifier
+   * cache can reuse its hash. Reset on copy, which is how evaluated meshes get updated.
+   */
+  uint64_t modifier_cache_input_id;
+
   struct MLoopTri_Store looptris;
 
   /** `BVHCache` defined in 'BKE_bvhutil.c' */
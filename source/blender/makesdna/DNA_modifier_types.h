@@ -148,6 +148,11 @@ typedef enum {
    * Only one modifier on an object should have this flag set.
    */
   eModifierFlag_Active = (1 << 2),
+  /**
+   * Keep the result of this modifier in the run-time data of the evaluated object, so the
+   * modifier stack doesn't have to be evaluated up to it again when only later modifiers change.
+   */
+  eModifierFlag_CacheResult = (1 << 3),
 } ModifierFlag;
 
 /* not a real modifier */
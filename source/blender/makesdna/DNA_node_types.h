@@ -519,6 +519,7 @@ typedef struct bNodeTree {
 
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
+#define NTREE_COM_FULL_FRAME (1 << 6) /* compositor operations process whole buffers */
 
 /* ntree->update */
 typedef enum eNodeTreeUpdate {
@@ -612,6 +613,7 @@ enum {
 enum {
   CMP_NODEFLAG_BLUR_VARIABLE_SIZE = (1 << 0),
   CMP_NODEFLAG_BLUR_EXTEND_BOUNDS = (1 << 1),
+  CMP_NODEFLAG_BLUR_FAST_APPROXIMATION = (1 << 2),
 };
 
 typedef struct NodeFrame {
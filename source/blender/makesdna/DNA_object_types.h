@@ -188,6 +188,12 @@ typedef struct Object_Runtime {
   /** Runtime evaluated curve-specific data, not stored in the file. */
   struct CurveCache *curve_cache;
 
+  /**
+   * Results of modifiers with #eModifierFlag_CacheResult, see `BKE_modifier_cache.h`.
+   * Kept when the geometry is re-evaluated, only freed with the object.
+   */
+  struct ModifierStackCache *modifier_cache;
+
   unsigned short local_collections_bits;
   short _pad2[3];
 } Object_Runtime;
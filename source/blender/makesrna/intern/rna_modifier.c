@@ -7300,6 +7300,15 @@ void RNA_def_modifier(BlenderRNA *brna)
   RNA_def_property_ui_icon(prop, ICON_SURFACE_DATA, 0);
   RNA_def_property_update(prop, 0, "rna_Modifier_update");
 
+  prop = RNA_def_property(srna, "use_cache_result", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", eModifierFlag_CacheResult);
+  RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+  RNA_def_property_ui_text(prop,
+                           "Cache Result",
+                           "Keep the result of this modifier in memory, so only the following "
+                           "modifiers are evaluated again when they change");
+  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
   /* types */
   rna_def_modifier_subsurf(brna);
   rna_def_modifier_lattice(brna);
@@ -5776,6 +5776,14 @@ static void def_cmp_blur(StructRNA *srna)
       prop, "Extend Bounds", "Extend bounds of the input image to fully fit blurred image");
   RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
 
+  prop = RNA_def_property(srna, "use_fast_approximation", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "custom1", CMP_NODEFLAG_BLUR_FAST_APPROXIMATION);
+  RNA_def_property_ui_text(
+      prop,
+      "Fast Approximation",
+      "Approximate the bokeh shaped blur, which is much faster for large sizes");
+  RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
+
   RNA_def_struct_sdna_from(srna, "NodeBlurData", "storage");
 
   prop = RNA_def_property(srna, "size_x", PROP_INT, PROP_NONE);
@@ -6773,6 +6781,14 @@ static void def_cmp_defocus(StructRNA *srna)
       prop, "Scene", "Scene from which to select the active camera (render scene if undefined)");
   RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
 
+  prop = RNA_def_property(srna, "use_fast_approximation", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "custom1", CMP_NODEFLAG_BLUR_FAST_APPROXIMATION);
+  RNA_def_property_ui_text(
+      prop,
+      "Fast Approximation",
+      "Approximate the bokeh shaped blur, which is much faster for large sizes");
+  RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
+
   RNA_def_struct_sdna_from(srna, "NodeDefocus", "storage");
 
   prop = RNA_def_property(srna, "bokeh", PROP_ENUM, PROP_NONE);
@@ -7596,6 +7612,14 @@ static void def_cmp_bokehblur(StructRNA *srna)
       prop, "Extend Bounds", "Extend bounds of the input image to fully fit blurred image");
   RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
 
+  prop = RNA_def_property(srna, "use_fast_approximation", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "custom1", CMP_NODEFLAG_BLUR_FAST_APPROXIMATION);
+  RNA_def_property_ui_text(
+      prop,
+      "Fast Approximation",
+      "Approximate the bokeh shaped blur, which is much faster for large sizes");
+  RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
+
 #  if 0
   prop = RNA_def_property(srna, "f_stop", PROP_FLOAT, PROP_NONE);
   RNA_def_property_float_sdna(prop, NULL, "custom3");
@@ -10026,6 +10050,13 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_GROUPNODE_BUFFER);
   RNA_def_property_ui_text(prop, "Buffer Groups", "Enable buffering of group nodes");
 
+  prop = RNA_def_property(srna, "use_full_frame", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_FULL_FRAME);
+  RNA_def_property_ui_text(prop,
+                           "Full Frame",
+                           "Execute every operation on whole buffers at once instead of "
+                           "evaluating chunks pixel by pixel (experimental)");
+
   prop = RNA_def_property(srna, "use_two_pass", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_TWO_PASS);
   RNA_def_property_ui_text(prop,
@@ -45,6 +45,10 @@ const EnumPropertyItem rna_enum_unpack_method_items[] = {
 static void rna_PackedImage_data_get(PointerRNA *ptr, char *value)
 {
   PackedFile *pf = (PackedFile *)ptr->data;
+  if (!BKE_packedfile_data_ensure(pf)) {
+    memset(value, 0, (size_t)pf->size + 1);
+    return;
+  }
   memcpy(value, pf->data, (size_t)pf->size);
   value[pf->size] = '\0';
 }
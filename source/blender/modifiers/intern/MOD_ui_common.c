@@ -256,6 +256,12 @@ static void modifier_ops_extra_draw(bContext *C, uiLayout *layout, void *md_v)
             "OBJECT_OT_modifier_copy");
   }
 
+  /* Cache Result, only used by the mesh modifier stack. */
+  if (ob->type == OB_MESH) {
+    uiItemS(layout);
+    uiItemR(layout, &ptr, "use_cache_result", 0, NULL, ICON_NONE);
+  }
+
   uiItemS(layout);
 
   /* Move to first. */
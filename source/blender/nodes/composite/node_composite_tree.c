@@ -254,6 +254,14 @@ void ntreeCompositExecTree(Scene *scene,
   UNUSED_VARS(do_preview);
 }
 
+/* Outputs kept by the compositor refer to data of the previous file. */
+void ntreeCompositClearCaches(void)
+{
+#ifdef WITH_COMPOSITOR
+  COM_clearCaches();
+#endif
+}
+
 /* *********************************************** */
 
 /* Update the outputs of the render layer nodes.
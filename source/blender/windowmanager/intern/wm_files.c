@@ -82,6 +82,8 @@
 #include "BKE_lib_id.h"
 #include "BKE_lib_override.h"
 #include "BKE_main.h"
+#include "BKE_modifier_cache.h"
+#include "BKE_node.h"
 #include "BKE_packedFile.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
@@ -414,6 +416,7 @@ static void wm_init_userdef(Main *bmain)
   }
 
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  BKE_modifier_cache_memory_limit_set(((size_t)U.modifier_cache_limit) * 1024 * 1024);
   BKE_sound_init(bmain);
 
   /* Update the temporary directory from the preferences or fallback to the system default. */
@@ -448,7 +451,7 @@ static int wm_read_exotic(const char *name)
 {
   int len;
   gzFile gzfile;
-  char header[7];
+  char header[8];
   int retval;
 
   /* make sure we're not trying to read a directory.... */
@@ -468,6 +471,15 @@ static int wm_read_exotic(const char *name)
       if (len == sizeof(header) && STREQLEN(header, "BLENDER", 7)) {
         retval = BKE_READ_EXOTIC_OK_BLEND;
       }
+      else if (len == sizeof(header) &&
+               STREQLEN(header, MEMFILE_JOURNAL_MAGIC, sizeof(header))) {
+        /* Auto-save journal, checked here to avoid reading the file it contains. */
+        retval = BKE_READ_EXOTIC_OK_BLEND;
+      }
+      else if (BLO_has_bfile_header(name)) {
+        /* Compressed formats zlib doesn't handle (Zstandard). */
+        retval = BKE_READ_EXOTIC_OK_BLEND;
+      }
       else {
         /* We may want to support loading other file formats
          * from their header bytes or file extension.
@@ -582,6 +594,8 @@ static void wm_file_read_post(bContext *C,
       wm_window_ghostwindows_remove_invalid(C, wm);
     }
     CTX_wm_window_set(C, wm->windows.first);
+    /* The main database they were computed from has been freed. */
+    ntreeCompositClearCaches();
   }
 
 #ifdef WITH_PYTHON
@@ -730,7 +744,9 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
          * Further it's just confusing if a user loads a file and various preferences change. */
         &(const struct BlendFileReadParams){
             .is_startup = false,
-            .skip_flags = BLO_READ_SKIP_USERDEF,
+            .skip_flags = BLO_READ_SKIP_USERDEF |
+                          ((G.fileflags & G_FILE_LAZY_PACKED_DATA) ? BLO_READ_LAZY_PACKED_DATA :
+                                                                     0),
         },
         reports);
 
@@ -1562,6 +1578,12 @@ static bool wm_file_write(bContext *C,
 /** \name Auto-Save API
  * \{ */
 
+/**
+ * Auto-saves using the undo memfile are written incrementally,
+ * only appending the data which changed since the previous auto-save.
+ */
+static MemFileJournal *wm_autosave_journal = NULL;
+
 void wm_autosave_location(char *filepath)
 {
   const int pid = abs(getpid());
@@ -1633,7 +1655,10 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     /* fast save of last undobuffer, now with UI */
     struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
     if (memfile) {
-      BLO_memfile_write_file(memfile, filepath);
+      if (wm_autosave_journal == NULL) {
+        wm_autosave_journal = BLO_memfile_journal_new();
+      }
+      BLO_memfile_journal_write(wm_autosave_journal, memfile, filepath);
     }
   }
   else {
@@ -1661,6 +1686,11 @@ void wm_autosave_delete(void)
 {
   char filename[FILE_MAX];
 
+  if (wm_autosave_journal != NULL) {
+    BLO_memfile_journal_free(wm_autosave_journal);
+    wm_autosave_journal = NULL;
+  }
+
   wm_autosave_location(filename);
 
   if (BLI_exists(filename)) {
@@ -2332,6 +2362,9 @@ static int wm_open_mainfile__open(bContext *C, wmOperator *op)
     G.f &= ~G_FLAG_SCRIPT_AUTOEXEC;
   }
 
+  SET_FLAG_FROM_TEST(
+      G.fileflags, RNA_boolean_get(op->ptr, "lazy_packed_data"), G_FILE_LAZY_PACKED_DATA);
+
   success = wm_file_read_opwrap(C, filepath, op->reports, !(G.f & G_FLAG_SCRIPT_AUTOEXEC));
 
   /* for file open also popup for warnings, not only errors */
@@ -2493,8 +2526,15 @@ void WM_OT_open_mainfile(wmOperatorType *ot)
                   "Allow .blend file to execute scripts automatically, default available from "
                   "system preferences");
 
-  PropertyRNA *prop = RNA_def_boolean(
-      ot->srna, "display_file_selector", true, "Display File Selector", "");
+  PropertyRNA *prop = RNA_def_boolean(ot->srna,
+                                      "lazy_packed_data",
+                                      false,
+                                      "Lazy Packed Data",
+                                      "Only read packed files (images, sounds, fonts, volumes) "
+                                      "from the .blend file when they are first used");
+  RNA_def_property_flag(prop, PROP_HIDDEN | PROP_SKIP_SAVE);
+
+  prop = RNA_def_boolean(ot->srna, "display_file_selector", true, "Display File Selector", "");
   RNA_def_property_flag(prop, PROP_SKIP_SAVE);
 
   create_operator_state(ot, OPEN_MAINFILE_STATE_DISCARD_CHANGES);
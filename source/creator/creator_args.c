@@ -37,6 +37,7 @@
 #  include "BLI_listbase.h"
 #  include "BLI_mempool.h"
 #  include "BLI_path_util.h"
+#  include "BLI_profile.h"
 #  include "BLI_string.h"
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
@@ -45,6 +46,7 @@
 
 #  include "BLO_readfile.h" /* only for BLO_has_bfile_extension */
 
+#  include "BKE_blender.h"
 #  include "BKE_blender_version.h"
 #  include "BKE_context.h"
 
@@ -597,6 +599,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 #  endif
   BLI_args_print_arg_doc(ba, "--debug-all");
   BLI_args_print_arg_doc(ba, "--debug-io");
+  BLI_args_print_arg_doc(ba, "--profile");
 
   printf("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
@@ -1080,6 +1083,26 @@ static int arg_handle_debug_value_set(int argc, const char **argv, void *UNUSED(
   return 0;
 }
 
+static void arg_handle_profile_write(void *UNUSED(user_data))
+{
+  BLI_profile_write();
+}
+
+static const char arg_handle_profile_set_doc[] =
+    "<filepath>\n"
+    "\tRecord a trace profile of depsgraph evaluation, modifiers, draw caches and compositing,\n"
+    "\twritten to <filepath> on exit (Chrome trace format, open in 'chrome://tracing').";
+static int arg_handle_profile_set(int argc, const char **argv, void *UNUSED(data))
+{
+  if (argc > 1) {
+    BLI_profile_enable(argv[1]);
+    BKE_blender_atexit_register(arg_handle_profile_write, NULL);
+    return 1;
+  }
+  printf("\nError: you must specify a filepath after '--profile'.\n");
+  return 0;
+}
+
 static const char arg_handle_debug_fpe_set_doc[] =
     "\n\t"
     "Enable floating point exceptions.";
@@ -2176,6 +2199,7 @@ void main_args_setup(bContext *C, bArgs *ba)
                CB_EX(arg_handle_debug_mode_generic_set, gpumem),
                (void *)G_DEBUG_GPU_FORCE_WORKAROUNDS);
   BLI_args_add(ba, NULL, "--debug-exit-on-error", CB(arg_handle_debug_exit_on_error), NULL);
+  BLI_args_add(ba, NULL, "--profile", CB(arg_handle_profile_set), NULL);
 
   BLI_args_add(ba, NULL, "--verbose", CB(arg_handle_verbosity_set), NULL);
 
@@ -0,0 +1,184 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Compare the speed and quality of the accurate and fast approximation modes of the compositor
+blur nodes: Bokeh Blur with a constant and a variable size, Defocus and Blur with a bokeh
+shaped kernel. Every node is rendered on a generated image with both modes, the median times,
+the root mean square and the largest difference between the resulting pixels are printed.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \\
+    --python tests/python/compositor_blur_benchmark.py -- \\
+    --size=2048 \\
+    --blur-size=5.0 \\
+    --runs=3
+"""
+
+import os
+import sys
+import tempfile
+import time
+
+
+def image_generate(name, size, seed):
+    import bpy
+    import numpy as np
+
+    # Sparse bright spots on a smooth gradient, which make the shape of the bokeh visible.
+    rng = np.random.default_rng(seed)
+    gradient = np.linspace(0.0, 1.0, size, dtype=np.float32)
+    pixels = np.empty((size, size, 4), dtype=np.float32)
+    pixels[:, :, 0] = gradient[np.newaxis, :]
+    pixels[:, :, 1] = gradient[:, np.newaxis]
+    pixels[:, :, 2] = 0.25
+    pixels[:, :, 3] = 1.0
+    spots = rng.random((size, size)) > 0.999
+    pixels[spots, 0:3] = 10.0
+
+    image = bpy.data.images.new(name, size, size, alpha=True, float_buffer=True)
+    image.pixels.foreach_set(pixels.ravel())
+    image.pack()
+    return image
+
+
+def tree_generate(scene, size, blur_size, node_type):
+    tree = scene.node_tree
+    tree.nodes.clear()
+
+    image_node = tree.nodes.new("CompositorNodeImage")
+    image_node.image = image_generate("BenchmarkImage", size, 0)
+
+    if node_type in {'BOKEH_BLUR', 'BOKEH_BLUR_VARIABLE'}:
+        blur = tree.nodes.new("CompositorNodeBokehBlur")
+        bokeh = tree.nodes.new("CompositorNodeBokehImage")
+        bokeh.flaps = 6
+        tree.links.new(bokeh.outputs["Image"], blur.inputs["Bokeh"])
+        blur.inputs["Size"].default_value = blur_size
+        if node_type == 'BOKEH_BLUR_VARIABLE':
+            # A horizontal ramp of sizes, from sharp to the full blur size.
+            blur.use_variable_size = True
+            blur.blur_max = blur_size * size / 100.0
+            ramp = tree.nodes.new("CompositorNodeImage")
+            ramp.image = image_generate("BenchmarkRamp", size, 1)
+            tree.links.new(ramp.outputs["Image"], blur.inputs["Size"])
+    elif node_type == 'DEFOCUS':
+        blur = tree.nodes.new("CompositorNodeDefocus")
+        blur.use_zbuffer = False
+        blur.blur_max = blur_size * size / 100.0
+        blur.z_scale = blur.blur_max
+        ramp = tree.nodes.new("CompositorNodeImage")
+        ramp.image = image_generate("BenchmarkRamp", size, 1)
+        tree.links.new(ramp.outputs["Image"], blur.inputs["Z"])
+    else:
+        blur = tree.nodes.new("CompositorNodeBlur")
+        blur.use_bokeh = True
+        blur.filter_type = 'GAUSS' if node_type == 'BLUR_BOKEH_GAUSS' else 'QUAD'
+        blur.size_x = blur.size_y = int(blur_size * size / 100.0)
+
+    tree.links.new(image_node.outputs["Image"], blur.inputs["Image"])
+    composite = tree.nodes.new("CompositorNodeComposite")
+    tree.links.new(blur.outputs["Image"], composite.inputs["Image"])
+    return blur
+
+
+def render_pixels(filepath):
+    import bpy
+    import numpy as np
+
+    image = bpy.data.images.load(filepath)
+    pixels = np.empty(len(image.pixels), dtype=np.float32)
+    image.pixels.foreach_get(pixels)
+    bpy.data.images.remove(image)
+    return pixels
+
+
+def benchmark_mode(scene, blur, num_runs, use_fast, filepath):
+    import bpy
+
+    blur.use_fast_approximation = use_fast
+    timings = []
+    for _ in range(num_runs):
+        start_time = time.perf_counter()
+        bpy.ops.render.render(write_still=True, scene=scene.name)
+        timings.append(time.perf_counter() - start_time)
+
+    timings.sort()
+    return timings[len(timings) // 2], render_pixels(filepath)
+
+
+def benchmark_node(scene, size, blur_size, node_type, num_runs):
+    import numpy as np
+
+    blur = tree_generate(scene, size, blur_size, node_type)
+    with tempfile.TemporaryDirectory() as tempdir:
+        filepath = os.path.join(tempdir, "result.exr")
+        scene.render.filepath = filepath
+        accurate_time, accurate_pixels = benchmark_mode(scene, blur, num_runs, False, filepath)
+        fast_time, fast_pixels = benchmark_mode(scene, blur, num_runs, True, filepath)
+
+    difference = np.abs(accurate_pixels - fast_pixels)
+    rms = float(np.sqrt(np.mean(difference * difference))) if difference.size else 0.0
+    print("%-24s %12.3f %12.3f %8.2fx %10.6f %10.6f" % (
+        node_type, accurate_time * 1000.0, fast_time * 1000.0,
+        accurate_time / max(fast_time, 1e-9), rms, float(np.max(difference, initial=0.0))))
+
+
+def main():
+    import argparse
+    import bpy
+
+    argv = sys.argv
+    if "--" not in argv:
+        argv = []
+    else:
+        argv = argv[argv.index("--") + 1:]
+
+    node_types = ('BOKEH_BLUR', 'BOKEH_BLUR_VARIABLE', 'DEFOCUS', 'BLUR_BOKEH_GAUSS',
+                  'BLUR_BOKEH_QUAD')
+    parser = argparse.ArgumentParser(description="Compare accurate and fast compositor blurs")
+    parser.add_argument("--size", type=int, default=2048,
+                        help="Resolution of the generated image")
+    parser.add_argument("--blur-size", type=float, default=5.0,
+                        help="Blur size in percent of the image size")
+    parser.add_argument("--nodes", nargs="+", default=node_types, choices=node_types,
+                        help="Blur nodes to benchmark")
+    parser.add_argument("--runs", type=int, default=3,
+                        help="Number of measured renders for every mode")
+    args = parser.parse_args(argv)
+
+    scene = bpy.context.scene
+    scene.render.resolution_x = args.size
+    scene.render.resolution_y = args.size
+    scene.render.resolution_percentage = 100
+    scene.render.image_settings.file_format = 'OPEN_EXR'
+    scene.render.image_settings.color_depth = '32'
+    scene.render.use_file_extension = False
+    scene.use_nodes = True
+
+    print("%-24s %12s %12s %9s %10s %10s" % (
+        "Node", "Accurate (ms)", "Fast (ms)", "Speedup", "RMS Diff", "Max Diff"))
+    for node_type in args.nodes:
+        benchmark_node(scene, args.size, args.blur_size, node_type, max(args.runs, 1))
+
+
+if __name__ == "__main__":
+    main()
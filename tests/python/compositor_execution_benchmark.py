@@ -0,0 +1,184 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Compare the render time of compositor node trees with the tiled and full frame execution models.
+Every tree is rendered with both models, the median times and the largest difference between
+the resulting pixels are printed.
+
+Files given on the command line are rendered with their own scene and node tree. Without files
+a synthetic tree of blurs, mixes, math and color correction nodes on generated images is used.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \\
+    --python tests/python/compositor_execution_benchmark.py -- \\
+    --files production_tree.blend \\
+    --runs=5
+"""
+
+import os
+import sys
+import tempfile
+import time
+
+
+def image_generate(name, size, seed):
+    import bpy
+    import numpy as np
+
+    rng = np.random.default_rng(seed)
+    image = bpy.data.images.new(name, size, size, alpha=True, float_buffer=True)
+    image.pixels.foreach_set(rng.random(size * size * 4, dtype=np.float32))
+    image.pack()
+    return image
+
+
+def scene_generate(size, num_branches):
+    import bpy
+
+    scene = bpy.context.scene
+    scene.render.resolution_x = size
+    scene.render.resolution_y = size
+    scene.render.resolution_percentage = 100
+    scene.use_nodes = True
+    tree = scene.node_tree
+    tree.nodes.clear()
+
+    result = None
+    for i in range(num_branches):
+        image_node = tree.nodes.new("CompositorNodeImage")
+        image_node.image = image_generate("BenchmarkImage%d" % i, size, i)
+
+        blur = tree.nodes.new("CompositorNodeBlur")
+        blur.size_x = blur.size_y = 4 + i
+        tree.links.new(image_node.outputs["Image"], blur.inputs["Image"])
+
+        gamma = tree.nodes.new("CompositorNodeGamma")
+        gamma.inputs["Gamma"].default_value = 1.2
+        tree.links.new(blur.outputs["Image"], gamma.inputs["Image"])
+
+        balance = tree.nodes.new("CompositorNodeColorBalance")
+        balance.correction_method = 'OFFSET_POWER_SLOPE'
+        tree.links.new(gamma.outputs["Image"], balance.inputs["Image"])
+
+        math = tree.nodes.new("CompositorNodeMath")
+        math.operation = 'MULTIPLY'
+        math.inputs[1].default_value = 0.5
+        tree.links.new(image_node.outputs["Alpha"], math.inputs[0])
+
+        if result is None:
+            result = balance.outputs["Image"]
+            continue
+        mix = tree.nodes.new("CompositorNodeMixRGB")
+        mix.blend_type = ('MULTIPLY', 'ADD', 'SCREEN', 'MIX')[i % 4]
+        tree.links.new(math.outputs["Value"], mix.inputs["Fac"])
+        tree.links.new(result, mix.inputs[1])
+        tree.links.new(balance.outputs["Image"], mix.inputs[2])
+        result = mix.outputs["Image"]
+
+    composite = tree.nodes.new("CompositorNodeComposite")
+    tree.links.new(result, composite.inputs["Image"])
+    return scene
+
+
+def render_pixels(filepath):
+    import bpy
+    import numpy as np
+
+    image = bpy.data.images.load(filepath)
+    pixels = np.empty(len(image.pixels), dtype=np.float32)
+    image.pixels.foreach_get(pixels)
+    bpy.data.images.remove(image)
+    return pixels
+
+
+def benchmark_scene(scene, num_runs, use_full_frame, filepath):
+    import bpy
+
+    scene.node_tree.use_full_frame = use_full_frame
+    scene.render.filepath = filepath
+    scene.render.image_settings.file_format = 'OPEN_EXR'
+    scene.render.image_settings.color_depth = '32'
+    scene.render.use_file_extension = False
+
+    timings = []
+    for _ in range(num_runs):
+        start_time = time.perf_counter()
+        bpy.ops.render.render(write_still=True, scene=scene.name)
+        timings.append(time.perf_counter() - start_time)
+
+    timings.sort()
+    return timings[len(timings) // 2], render_pixels(filepath)
+
+
+def benchmark_file(name, num_runs):
+    import bpy
+    import numpy as np
+
+    scene = bpy.context.scene
+    with tempfile.TemporaryDirectory() as tempdir:
+        filepath = os.path.join(tempdir, "result.exr")
+        tiled_time, tiled_pixels = benchmark_scene(scene, num_runs, False, filepath)
+        full_frame_time, full_frame_pixels = benchmark_scene(scene, num_runs, True, filepath)
+
+    if tiled_pixels.shape == full_frame_pixels.shape:
+        difference = float(np.max(np.abs(tiled_pixels - full_frame_pixels), initial=0.0))
+    else:
+        difference = float("inf")
+    print("%-32s %12.3f %12.3f %8.2fx %12.6f" % (
+        name[-32:], tiled_time * 1000.0, full_frame_time * 1000.0,
+        tiled_time / max(full_frame_time, 1e-9), difference))
+
+
+def main():
+    import argparse
+    import bpy
+
+    argv = sys.argv
+    if "--" not in argv:
+        argv = []
+    else:
+        argv = argv[argv.index("--") + 1:]
+
+    parser = argparse.ArgumentParser(description="Compare compositor execution models")
+    parser.add_argument("--files", nargs="+", default=[],
+                        help="Blend files with a compositor node tree to render")
+    parser.add_argument("--size", type=int, default=2048,
+                        help="Resolution of the synthetic tree, used when no files are given")
+    parser.add_argument("--branches", type=int, default=4,
+                        help="Number of image branches mixed together in the synthetic tree")
+    parser.add_argument("--runs", type=int, default=5,
+                        help="Number of measured renders for every execution model")
+    args = parser.parse_args(argv)
+    num_runs = max(args.runs, 1)
+
+    print("%-32s %12s %12s %9s %12s" % (
+        "Tree", "Tiled (ms)", "Full (ms)", "Speedup", "Max Diff"))
+    if not args.files:
+        scene_generate(args.size, max(args.branches, 1))
+        benchmark_file("synthetic %dx%d" % (args.size, args.size), num_runs)
+    for filepath in args.files:
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        benchmark_file(os.path.basename(filepath), num_runs)
+
+
+if __name__ == "__main__":
+    main()
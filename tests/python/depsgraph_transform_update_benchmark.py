@@ -0,0 +1,119 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Measure dependency graph update latency of moving a single object, versus the number of objects
+in the scene. Scenes are generated with objects parented into chains, every chain sharing one
+mesh, so the moved object has dependents.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \\
+    --python tests/python/depsgraph_transform_update_benchmark.py -- \\
+    --counts 1000 10000 100000 \\
+    --chain-length=4 \\
+    --updates=100
+"""
+
+import sys
+import time
+
+
+def scene_generate(scene, num_objects, chain_length):
+    import bpy
+
+    mesh = bpy.data.meshes.new("BenchmarkMesh")
+    mesh.from_pydata(((0.0, 0.0, 0.0), (1.0, 0.0, 0.0), (0.0, 1.0, 0.0)), (), ((0, 1, 2),))
+
+    collection = scene.collection
+    objects = []
+    parent = None
+    for i in range(num_objects):
+        ob = bpy.data.objects.new("Object.%d" % i, mesh)
+        ob.location = (float(i % 100), float(i // 100), 0.0)
+        if i % chain_length != 0:
+            ob.parent = parent
+        collection.objects.link(ob)
+        objects.append(ob)
+        parent = ob
+    return objects
+
+
+def scene_clear():
+    import bpy
+
+    bpy.data.batch_remove(tuple(bpy.data.objects) + tuple(bpy.data.meshes))
+
+
+def benchmark_transform_update(num_objects, chain_length, num_updates):
+    import bpy
+
+    scene = bpy.context.scene
+    objects = scene_generate(scene, num_objects, chain_length)
+
+    # Initial evaluation, includes building the relations.
+    start_time = time.perf_counter()
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    build_time = time.perf_counter() - start_time
+
+    # Move the root of a chain in the middle of the scene.
+    ob = objects[(num_objects // 2) // chain_length * chain_length]
+    timings = []
+    for i in range(num_updates):
+        ob.location.z = float(i % 2)
+        start_time = time.perf_counter()
+        depsgraph.update()
+        timings.append(time.perf_counter() - start_time)
+
+    scene_clear()
+
+    timings.sort()
+    return build_time, sum(timings) / len(timings), timings[len(timings) // 2]
+
+
+def main():
+    import argparse
+
+    argv = sys.argv
+    if "--" not in argv:
+        argv = []
+    else:
+        argv = argv[argv.index("--") + 1:]
+
+    parser = argparse.ArgumentParser(
+        description="Measure depsgraph update latency of a transform change")
+    parser.add_argument("--counts", type=int, nargs="+", default=[1000, 10000, 100000],
+                        help="Numbers of objects of the generated scenes")
+    parser.add_argument("--chain-length", type=int, default=4,
+                        help="Number of objects in every parent chain")
+    parser.add_argument("--updates", type=int, default=100,
+                        help="Number of measured updates for every scene")
+    args = parser.parse_args(argv)
+
+    print("%10s %14s %14s %14s" % ("Objects", "Build (ms)", "Mean (ms)", "Median (ms)"))
+    for num_objects in args.counts:
+        build_time, mean_time, median_time = benchmark_transform_update(
+            num_objects, max(args.chain_length, 1), max(args.updates, 1))
+        print("%10d %14.3f %14.3f %14.3f" %
+              (num_objects, build_time * 1000.0, mean_time * 1000.0, median_time * 1000.0))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Measure the computation time of split (custom) normals, versus the number of face corners.
+Meshes are generated as noisy grids with some sharp edges and flat faces, so smooth fans of
+all kinds are used. A checksum of the normals is printed, to compare the results of builds.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \\
+    --python tests/python/mesh_split_normals_benchmark.py -- \\
+    --corners 100000 1000000 20000000 \\
+    --runs=5 \\
+    --custom-normals
+"""
+
+import sys
+import time
+
+
+def mesh_generate(num_corners):
+    import bpy
+    import numpy as np
+
+    size = max(int((num_corners / 4) ** 0.5), 1) + 1
+    num_verts = size * size
+    num_quads = (size - 1) * (size - 1)
+
+    rng = np.random.default_rng(0)
+    x, y = np.meshgrid(np.arange(size, dtype=np.float32), np.arange(size, dtype=np.float32))
+    co = np.stack((x.ravel(), y.ravel(), rng.random(num_verts, dtype=np.float32)), axis=1)
+
+    quad_x, quad_y = np.meshgrid(np.arange(size - 1), np.arange(size - 1))
+    first = (quad_y * size + quad_x).ravel()
+    quads = np.stack((first, first + 1, first + size + 1, first + size), axis=1)
+
+    mesh = bpy.data.meshes.new("BenchmarkMesh")
+    mesh.vertices.add(num_verts)
+    mesh.vertices.foreach_set("co", co.ravel())
+    mesh.loops.add(num_quads * 4)
+    mesh.loops.foreach_set("vertex_index", quads.ravel().astype(np.int32))
+    mesh.polygons.add(num_quads)
+    mesh.polygons.foreach_set("loop_start", np.arange(0, num_quads * 4, 4, dtype=np.int32))
+    mesh.polygons.foreach_set("loop_total", np.full(num_quads, 4, dtype=np.int32))
+    mesh.polygons.foreach_set("use_smooth", rng.random(num_quads) > 0.02)
+    mesh.update(calc_edges=True)
+    mesh.edges.foreach_set("use_edge_sharp", rng.random(len(mesh.edges)) < 0.05)
+
+    mesh.use_auto_smooth = True
+    return mesh
+
+
+def mesh_normals_checksum(mesh):
+    import hashlib
+    import numpy as np
+
+    normals = np.empty(len(mesh.loops) * 3, dtype=np.float32)
+    mesh.loops.foreach_get("normal", normals)
+    return hashlib.md5(normals.tobytes()).hexdigest()
+
+
+def benchmark_split_normals(num_corners, num_runs, use_custom_normals):
+    import bpy
+
+    mesh = mesh_generate(num_corners)
+    if use_custom_normals:
+        # Zero custom normals are replaced by the auto ones, still computing all the spaces.
+        mesh.normals_split_custom_set(((0.0, 0.0, 0.0),) * len(mesh.loops))
+
+    timings = []
+    for _ in range(num_runs):
+        start_time = time.perf_counter()
+        mesh.calc_normals_split()
+        timings.append(time.perf_counter() - start_time)
+
+    num_corners = len(mesh.loops)
+    checksum = mesh_normals_checksum(mesh)
+    bpy.data.meshes.remove(mesh)
+
+    timings.sort()
+    return num_corners, timings[len(timings) // 2], checksum
+
+
+def main():
+    import argparse
+
+    argv = sys.argv
+    if "--" not in argv:
+        argv = []
+    else:
+        argv = argv[argv.index("--") + 1:]
+
+    parser = argparse.ArgumentParser(description="Measure split normals computation time")
+    parser.add_argument("--corners", type=int, nargs="+",
+                        default=[100000, 1000000, 5000000, 20000000],
+                        help="Approximate numbers of face corners of the generated meshes")
+    parser.add_argument("--runs", type=int, default=5,
+                        help="Number of measured computations for every mesh")
+    parser.add_argument("--custom-normals", action="store_true",
+                        help="Use custom normals, which also computes the normal spaces")
+    args = parser.parse_args(argv)
+
+    print("%10s %14s  %s" % ("Corners", "Median (ms)", "Checksum"))
+    for num_corners in args.corners:
+        num_corners, median_time, checksum = benchmark_split_normals(
+            num_corners, max(args.runs, 1), args.custom_normals)
+        print("%10d %14.3f  %s" % (num_corners, median_time * 1000.0, checksum))
+
+
+if __name__ == "__main__":
+    main()